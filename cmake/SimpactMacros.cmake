@@ -113,8 +113,10 @@ macro(simpact_setup)
 		${PROJECT_SOURCE_DIR}/src/lib/util/util.cpp
 		${PROJECT_SOURCE_DIR}/src/lib/util/csvfile.cpp
 		${PROJECT_SOURCE_DIR}/src/lib/util/mutex.cpp
+		${PROJECT_SOURCE_DIR}/src/lib/util/workerpool.cpp
 		${PROJECT_SOURCE_DIR}/src/lib/util/discretedistribution.cpp
 		${PROJECT_SOURCE_DIR}/src/lib/util/discretedistributionfast.cpp
+		${PROJECT_SOURCE_DIR}/src/lib/util/discretedistributionalias.cpp
 		${PROJECT_SOURCE_DIR}/src/lib/util/discretedistribution2d.cpp
 		${PROJECT_SOURCE_DIR}/src/lib/util/populationdistributioncsv.cpp
 		${PROJECT_SOURCE_DIR}/src/lib/util/populationdistribution.cpp
@@ -126,6 +128,8 @@ macro(simpact_setup)
 		#${PROJECT_SOURCE_DIR}/src/lib/util/experimental/inverseerfi.cpp
 		#${PROJECT_SOURCE_DIR}/src/lib/util/experimental/exponentialfunction.cpp
 		${PROJECT_SOURCE_DIR}/src/lib/util/hazardfunction.cpp
+		${PROJECT_SOURCE_DIR}/src/lib/util/tabulatedhazardfunction.cpp
+		${PROJECT_SOURCE_DIR}/src/lib/util/hazardfunctionexpbound.cpp
 		${PROJECT_SOURCE_DIR}/src/lib/util/logfile.cpp 
 		${PROJECT_SOURCE_DIR}/src/lib/util/tiffdensityfile.cpp 
 		${PROJECT_SOURCE_DIR}/src/lib/util/configwriter.cpp 
@@ -137,6 +141,8 @@ macro(simpact_setup)
 		${PROJECT_SOURCE_DIR}/src/lib/util/discretedistributionwrapper.cpp
 		${PROJECT_SOURCE_DIR}/src/lib/util/gridvaluescsv.cpp
 		${PROJECT_SOURCE_DIR}/src/lib/util/discretedistributionwrapper2d.cpp
+		${PROJECT_SOURCE_DIR}/src/lib/util/mappedfile.cpp
+		${PROJECT_SOURCE_DIR}/src/lib/util/polygon2d.cpp
 		)
 	set(SOURCES_MRNM
 		${PROJECT_SOURCE_DIR}/src/lib/mnrm/gslrandomnumbergenerator.cpp
@@ -145,6 +151,8 @@ macro(simpact_setup)
 		${PROJECT_SOURCE_DIR}/src/lib/mnrm/booltype.cpp
 		${PROJECT_SOURCE_DIR}/src/lib/mnrm/eventbase.cpp
 		${PROJECT_SOURCE_DIR}/src/lib/mnrm/debugtimer.cpp
+		${PROJECT_SOURCE_DIR}/src/lib/mnrm/eventprofiler.cpp
+		${PROJECT_SOURCE_DIR}/src/lib/mnrm/eventtracer.cpp
 		)
 	set(SOURCES_CORE
 		${PROJECT_SOURCE_DIR}/src/lib/core/personbase.cpp
@@ -23,18 +23,22 @@ import platform
 #
 #     [ 'simpact-cyan-opt', '--showconfigoptions' ]
 #
-# to retrieve all config options in JSON format. It then expands the
-# options which are of type 'distTypes' into the available 1D distribution
-# types listed in the JSON config
+# to retrieve all config options in JSON format. If 'executable' is a
+# SimpactServer instance, the options are requested from that server
+# instead. It then expands the options which are of type 'distTypes' into
+# the available 1D distribution types listed in the JSON config
 
 def _getExpandedSettingsOptions(executable):
 
-    with open(os.devnull, "w") as nullFile:
-        proc = subprocess.Popen(executable, stdout=subprocess.PIPE, stderr=nullFile)
-        jsonData, unusedErr = proc.communicate()
-        proc.wait()
+    if isinstance(executable, SimpactServer):
+        jsonData = executable.getConfigOptions()
+    else:
+        with open(os.devnull, "w") as nullFile:
+            proc = subprocess.Popen(executable, stdout=subprocess.PIPE, stderr=nullFile)
+            jsonData, unusedErr = proc.communicate()
+            proc.wait()
 
-    jsonData = jsonData.decode("utf-8") # Needed for python3
+        jsonData = jsonData.decode("utf-8") # Needed for python3
 
     configOptions = json.loads(jsonData)
     configNames = configOptions["configNames"]
@@ -354,6 +358,144 @@ def _getSimpactPathBasedOnModule():
 
     return possiblePaths
 
+class SimpactServer(object):
+    """Client for a simpact-cyan program that was started with the '--serve'
+    option, which stays running and executes the runs that are submitted to it.
+    Each run is done in a separate process that's forked from the server, so
+    that the program doesn't need to start again, and the config options and
+    CSV files only need to be read once."""
+
+    def __init__(self, executable = None, maxRuns = 1, socketPath = None):
+        """If `socketPath` is specified, this connects to a server that's listening
+        on that Unix domain socket. Otherwise, `executable` is started in server
+        mode, executing at most `maxRuns` simulations at the same time, and the
+        requests are sent using its standard input and output."""
+
+        self._proc = None
+        self._sock = None
+        self._nextId = 1
+        self._results = { }
+        self._options = None
+
+        if socketPath is not None:
+            import socket
+
+            self._sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            self._sock.connect(socketPath)
+            self._input = self._sock.makefile("rb")
+            self._output = self._sock.makefile("wb")
+        else:
+            if not executable:
+                raise Exception("Either an executable or a socket path must be specified")
+
+            self._proc = subprocess.Popen([ executable, "--serve", str(maxRuns) ], stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+            self._input = self._proc.stdout
+            self._output = self._proc.stdin
+
+        line = self._readLine()
+        if not line.startswith("ready"):
+            raise Exception("Unexpected reply from simpact server: '{}'".format(line))
+
+    def _send(self, lines):
+        self._output.write(("\n".join(lines) + "\n").encode("utf-8"))
+        self._output.flush()
+
+    def _readLine(self):
+        line = self._input.readline()
+        if not line:
+            raise Exception("Connection to simpact server was closed")
+        return line.decode("utf-8").rstrip("\r\n")
+
+    # Stores the result of a 'done' or 'error' reply, an error for a specific
+    # run means that it will not be executed
+    def _processReply(self, line):
+        parts = line.split(" ", 2)
+        if parts[0] == "done" and len(parts) == 3:
+            self._results[parts[1]] = int(parts[2])
+        elif parts[0] == "error" and len(parts) == 3:
+            if parts[1] == "-":
+                raise Exception("Error reported by simpact server: {}".format(parts[2]))
+            self._results[parts[1]] = Exception(parts[2])
+        elif parts[0] not in [ "started", "idle" ]:
+            raise Exception("Unexpected reply from simpact server: '{}'".format(line))
+
+    def getConfigOptions(self):
+        """Returns the JSON description of the config options, as shown by
+        '--showconfigoptions'. It is only requested from the server once."""
+
+        if self._options is None:
+            self._send([ "options" ])
+            while True:
+                line = self._readLine()
+                if line.startswith("options "):
+                    numBytes = int(line[8:])
+                    self._options = self._input.read(numBytes + 1)[:numBytes].decode("utf-8")
+                    break
+                self._processReply(line)
+
+        return self._options
+
+    def submit(self, configFile, parallel = False, algo = "opt", env = { }, outputFile = None, workDir = None):
+        """Queues a run of `configFile` and returns its identifier, to be used in
+        `wait`. The run is done in directory `workDir`, with the environment
+        variables in the `env` dictionary set in addition to the ones of the
+        server. Its output is written to `outputFile` if specified, otherwise
+        it is discarded. Relative paths are relative to `workDir`."""
+
+        runId = str(self._nextId)
+        self._nextId += 1
+
+        lines = [ "run " + runId, "config " + configFile, "parallel " + ("1" if parallel else "0"), "algo " + algo ]
+        if workDir is not None:
+            lines.append("dir " + workDir)
+        if outputFile is not None:
+            lines.append("output " + outputFile)
+        for k in env:
+            lines.append("env {}={}".format(k, env[k]))
+        lines.append("end")
+
+        self._send(lines)
+        return runId
+
+    def wait(self, runId):
+        """Waits until the specified run has finished, and returns its exit code;
+        a negative value means that the run was stopped by that signal."""
+
+        while not runId in self._results:
+            self._processReply(self._readLine())
+
+        result = self._results.pop(runId)
+        if isinstance(result, Exception):
+            raise result
+        return result
+
+    def cancel(self, runId):
+        """Stops the run, or removes it from the queue if it hasn't started yet.
+        The `wait` function must still be called for it."""
+        self._send([ "cancel " + runId ])
+
+    def close(self):
+        """Waits for the submitted runs to finish and closes the connection, which
+        also stops a server that was started by this object."""
+
+        if self._output is None:
+            return
+
+        try:
+            self._send([ "quit" ])
+        except:
+            pass
+
+        self._output.close()
+        self._input.close()
+        if self._sock is not None:
+            self._sock.close()
+        if self._proc is not None:
+            self._proc.wait()
+
+        self._output = None
+        self._input = None
+
 class PySimpactCyan(object):
     """ This class is used to run SimpactCyan based simulations."""
 
@@ -361,6 +503,8 @@ class PySimpactCyan(object):
         self._execPrefix = "simpact-cyan"
         self._dataDirectory = self._findSimpactDataDirectory()
         self._execDir = self._findSimpactDirectory()
+        self._server = None
+        self._serverExecPath = None
 
     def setSimpactDirectory(self, dirName):
         """ Sets the directory in which the simpact binaries were installed to `dirName`"""
@@ -458,9 +602,32 @@ class PySimpactCyan(object):
             fullPath = os.path.join(self._execDir, fullPath)
         return fullPath
 
+    def startServer(self, maxRuns = 1, release = True, socketPath = None):
+        """Starts a simpact-cyan program in server mode (or connects to the one
+        listening on `socketPath`), which is then used by `run` and `runDirect`
+        instead of starting the program for each simulation. The SimpactServer
+        object is returned, so that it can also be used to start several runs
+        at the same time."""
+
+        self.stopServer()
+
+        fullPath = self._getExecPath(True, release)
+        self._server = SimpactServer(fullPath, maxRuns, socketPath)
+        self._serverExecPath = fullPath
+        return self._server
+
+    def stopServer(self):
+        """Stops using the server that was started by `startServer`."""
+
+        if self._server is not None:
+            self._server.close()
+            self._server = None
+            self._serverExecPath = None
+
     def runDirect(self, configFile, parallel = False, opt = True, release = True, outputFile = None, seed = -1, destDir = None, quiet = False):
 
         fullPath = self._getExecPath(opt, release)
+        useServer = self._server is not None and self._serverExecPath == fullPath
         parallelStr = "1" if parallel else "0"
 
         if type(opt) == bool:
@@ -482,29 +649,44 @@ class PySimpactCyan(object):
 
                 f = open(outputFile, "w+t")
                 closeOutput = True
+            elif useServer: # the server needs a file name to write to
+                f = tempfile.NamedTemporaryFile(mode='w+t')
             else:
                 f = tempfile.TemporaryFile(mode='w+t')
 
-            newEnv = copy.deepcopy(os.environ)
+            extraEnv = { }
             if seed >= 0:
-                newEnv["MNRM_DEBUG_SEED"] = str(seed)
+                extraEnv["MNRM_DEBUG_SEED"] = str(seed)
 
             if self._dataDirectory is not None:
-                newEnv["SIMPACT_DATA_DIR"] = str(self._dataDirectory)
+                extraEnv["SIMPACT_DATA_DIR"] = str(self._dataDirectory)
             
             if not quiet:
                 print("Results will be stored in directory '%s'" % os.getcwd())
                 print("Running simpact executable '{}' ...".format(fullPath))
 
-            proc = subprocess.Popen([fullPath, configFile, parallelStr, algoStr], stdout=f, stderr=f, cwd=os.getcwd(), env=newEnv)
-            try:
-                proc.wait() # Wait for the process to finish
-            except:
-                try: 
-                    proc.kill()
+            if useServer:
+                runId = self._server.submit(configFile, parallel, algoStr, extraEnv, os.path.abspath(f.name), os.getcwd())
+                try:
+                    returnCode = self._server.wait(runId)
+                except KeyboardInterrupt:
+                    self._server.cancel(runId)
+                    self._server.wait(runId)
+                    raise
+            else:
+                newEnv = copy.deepcopy(os.environ)
+                newEnv.update(extraEnv)
+
+                proc = subprocess.Popen([fullPath, configFile, parallelStr, algoStr], stdout=f, stderr=f, cwd=os.getcwd(), env=newEnv)
+                try:
+                    proc.wait() # Wait for the process to finish
                 except:
-                    pass
-                raise
+                    try: 
+                        proc.kill()
+                    except:
+                        pass
+                    raise
+                returnCode = proc.returncode
 
             f.flush()
             f.seek(0)
@@ -520,8 +702,8 @@ class PySimpactCyan(object):
                     sys.stdout.write(l)
                 sys.stdout.flush()
 
-            if proc.returncode != 0:
-                raise Exception(self._getProgramExitError(lines, proc.returncode))
+            if returnCode != 0:
+                raise Exception(self._getProgramExitError(lines, returnCode))
 
         finally:
             os.chdir(origDir)
@@ -543,12 +725,18 @@ class PySimpactCyan(object):
 
         return "Program exited with an error code ({})".format(code)
 
+    # When a server is running, the config options are requested from it
+    def _getOptionsExecutable(self):
+        if self._server is not None:
+            return self._server
+        return [ self._getExecPath(), "--showconfigoptions" ]
+
     def _createConfigLines(self, inputConfig, checkNone = True, ignoreKeys = []):
-        executable = [ self._getExecPath(), "--showconfigoptions" ]
+        executable = self._getOptionsExecutable()
         return createConfigLines(executable, inputConfig, checkNone, ignoreKeys)
 
     def _checkKnownKeys(self, keyList):
-        executable = [ self._getExecPath(), "--showconfigoptions" ]
+        executable = self._getOptionsExecutable()
 
         configNames = _getExpandedSettingsOptions(executable)
 
@@ -0,0 +1,32 @@
+#ifndef BENCHTIMER_H
+
+#define BENCHTIMER_H
+
+// Wall clock timing for the benchmark programs. This uses steady_clock, so
+// that the measurements are not affected by changes of the system time.
+
+#include <chrono>
+
+class BenchTimer
+{
+public:
+	BenchTimer()																{ restart(); }
+
+	void restart()																{ m_start = std::chrono::steady_clock::now(); }
+
+	// The number of seconds since the timer was created or last restarted
+	double getSeconds() const													{ return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count(); }
+private:
+	std::chrono::steady_clock::time_point m_start;
+};
+
+// Calls f once and returns the number of seconds this took
+template<class Func>
+inline double timeSeconds(Func f)
+{
+	BenchTimer timer;
+	f();
+	return timer.getSeconds();
+}
+
+#endif // BENCHTIMER_H
@@ -0,0 +1,163 @@
+// Measures the startup cost of a discrete 2D distribution that is limited to
+// a region by a polygon, as is done when a population density grid is
+// restricted to the borders of a country. The polygon resembles such a
+// border: starting from an ellipse, each edge is repeatedly split in two
+// with the new point displaced perpendicular to the edge, until the
+// requested number of vertices is reached.
+//
+// The time needed to test each pixel center using Polygon2D::isInside is
+// compared to the time needed by Polygon2D::getInsideMask, and both results
+// are checked to be the same. Finally, the construction of the
+// DiscreteDistribution2D itself is timed, using a grid of random values.
+//
+// Usage: densitybench-release [width height numvertices]
+
+#include "gslrandomnumbergenerator.h"
+#include "discretedistribution2d.h"
+#include "gridvalues.h"
+#include "polygon2d.h"
+#include "util.h"
+#include "benchtimer.h"
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+using namespace std;
+
+class RandomGridValues : public GridValues
+{
+public:
+	RandomGridValues(int width, int height, GslRandomNumberGenerator &rng) : m_width(width), m_height(height)
+	{
+		m_values.resize((size_t)width*(size_t)height);
+		for (size_t i = 0 ; i < m_values.size() ; i++)
+			m_values[i] = rng.pickRandomDouble()*100.0;
+	}
+
+	bool_t init(const string &fileName, bool noNegativeValues, bool flipY)				{ return "Not supported"; }
+	int getWidth() const										{ return m_width; }
+	int getHeight() const										{ return m_height; }
+	double getValue(int x, int y) const								{ return m_values[(size_t)y*m_width + x]; }
+	void setValue(int x, int y, double v)								{ m_values[(size_t)y*m_width + x] = v; }
+	bool isYFlipped() const										{ return false; }
+private:
+	int m_width, m_height;
+	vector<double> m_values;
+};
+
+static vector<Point2D> createBorder(int numVertices, GslRandomNumberGenerator &rng)
+{
+	vector<Point2D> points;
+	const int numStart = 8;
+
+	for (int i = 0 ; i < numStart ; i++)
+	{
+		double angle = 2.0*M_PI*(double)i/(double)numStart;
+		points.push_back(Point2D(0.5 + 0.4*cos(angle), 0.5 + 0.3*sin(angle)));
+	}
+
+	while ((int)points.size() < numVertices)
+	{
+		size_t numSplit = std::min(points.size(), (size_t)numVertices - points.size());
+		vector<Point2D> newPoints;
+
+		for (size_t i = 0 ; i < points.size() ; i++)
+		{
+			const Point2D &p1 = points[i];
+			newPoints.push_back(p1);
+
+			if (i < numSplit)
+			{
+				const Point2D &p2 = points[(i+1)%points.size()];
+				double dx = p2.x - p1.x;
+				double dy = p2.y - p1.y;
+				double f = (rng.pickRandomDouble() - 0.5)*0.4;
+
+				newPoints.push_back(Point2D(0.5*(p1.x + p2.x) - f*dy, 0.5*(p1.y + p2.y) + f*dx));
+			}
+		}
+		points = newPoints;
+	}
+	return points;
+}
+
+int main(int argc, char *argv[])
+{
+	int width = 1000, height = 1000, numVertices = 2000;
+
+	if (argc == 4)
+	{
+		if (!parseAsInt(argv[1], width) || !parseAsInt(argv[2], height) || !parseAsInt(argv[3], numVertices) ||
+		    width < 1 || height < 1 || numVertices < 8)
+		{
+			cerr << "Invalid arguments" << endl;
+			return -1;
+		}
+	}
+	else if (argc != 1)
+	{
+		cerr << "Usage: " << argv[0] << " [width height numvertices]" << endl;
+		return -1;
+	}
+
+	GslRandomNumberGenerator rng(12345, false);
+	RandomGridValues grid(width, height, rng);
+	Polygon2D border;
+	bool_t r;
+
+	const double xOffset = -10, yOffset = 20, xSize = 50, ySize = 40;
+	const double pixelWidth = xSize/(double)width, pixelHeight = ySize/(double)height;
+	vector<Point2D> scaled = createBorder(numVertices, rng);
+
+	// Use the same coordinates as the grid
+	for (size_t i = 0 ; i < scaled.size() ; i++)
+		scaled[i] = Point2D(xOffset + scaled[i].x*xSize, yOffset + scaled[i].y*ySize);
+	if (!(r = border.init(scaled)))
+	{
+		cerr << "Unable to create polygon: " << r.getErrorString() << endl;
+		return -1;
+	}
+
+	cout << "# Grid of " << width << "x" << height << " pixels, border with " << border.getNumberOfPoints() << " vertices" << endl;
+
+	BenchTimer timer;
+	vector<char> reference((size_t)width*(size_t)height);
+	for (int y = 0 ; y < height ; y++)
+	{
+		for (int x = 0 ; x < width ; x++)
+		{
+			double xCoord = xOffset + pixelWidth*(0.5+(double)x);
+			double yCoord = yOffset + pixelHeight*(0.5+(double)y);
+			reference[(size_t)y*width + x] = (border.isInside(xCoord, yCoord))?1:0;
+		}
+	}
+	double dtIsInside = timer.getSeconds();
+
+	timer.restart();
+	vector<char> mask;
+	border.getInsideMask(xOffset, yOffset, pixelWidth, pixelHeight, width, height, mask);
+	double dtMask = timer.getSeconds();
+
+	size_t numInside = 0, numDifferent = 0;
+	for (size_t i = 0 ; i < mask.size() ; i++)
+	{
+		if (mask[i])
+			numInside++;
+		if (mask[i] != reference[i])
+			numDifferent++;
+	}
+
+	cout << "# Pixels inside border: " << numInside << ", different from isInside: " << numDifferent << endl;
+	cout << "# isInside for each pixel: " << dtIsInside << " s" << endl;
+	cout << "# getInsideMask: " << dtMask << " s" << endl;
+
+	timer.restart();
+	DiscreteDistribution2D *pDist = new DiscreteDistribution2D(xOffset, yOffset, xSize, ySize, grid, false, &rng, border);
+	double dtDist = timer.getSeconds();
+
+	cout << "# DiscreteDistribution2D construction with border: " << dtDist << " s" << endl;
+
+	delete pDist;
+	return (numDifferent == 0)?0:-1;
+}
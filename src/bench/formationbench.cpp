@@ -0,0 +1,236 @@
+// Measures how many formation hazard recalculations per second can be
+// performed for the initial population described in a simpact config file.
+// Each (man, woman) pair in which both persons are sexually active gets an
+// EventFormation instance, and for every repetition the internal time
+// interval is calculated and the real time interval is solved for each of
+// them, which is what the mNRM algorithm does when an event needs to be
+// recalculated. This is done twice, once with the population's
+// PersonAttributeTable enabled and once reading the values from the Person
+// instances themselves. Afterwards, the time per solveForRealTimeInterval
+// call is measured with and without the pair-invariant hazard terms that
+// are cached in each EventFormation, and when the hazard's batch solver is
+// used (only for the 'agegap' hazard).
+
+#include "gslrandomnumbergenerator.h"
+#include "populationdistributioncsv.h"
+#include "simpactpopulation.h"
+#include "eventformation.h"
+#include "configsettings.h"
+#include "configutil.h"
+#include "populationutil.h"
+#include "benchtimer.h"
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+#include <memory>
+
+using namespace std;
+
+SimpactPopulation *createSimpactPopulation(PopulationAlgorithmInterface &alg, PopulationStateInterface &state);
+
+// Only used to get access to the protected hazard functions
+class BenchEventFormation : public EventFormation
+{
+public:
+	BenchEventFormation(Person *pPerson1, Person *pPerson2) : EventFormation(pPerson1, pPerson2, -1, 0)			{ }
+
+	using EventFormation::calculateInternalTimeInterval;
+	using EventFormation::solveForRealTimeInterval;
+	using EventFormation::getBatchSolver;
+};
+
+double runRecalculations(vector<BenchEventFormation *> &events, const State *pState, int repetitions, double &checkSum)
+{
+	const double dt = 1.0;
+	const double Tdiff = 1.0;
+
+	checkSum = 0;
+
+	BenchTimer timer;
+
+	for (int r = 0 ; r < repetitions ; r++)
+	{
+		double t0 = 0.01*r;
+
+		for (size_t i = 0 ; i < events.size() ; i++)
+		{
+			checkSum += events[i]->calculateInternalTimeInterval(pState, t0, dt);
+			checkSum += events[i]->solveForRealTimeInterval(pState, Tdiff, t0);
+		}
+	}
+
+	return timer.getSeconds();
+}
+
+double runSolves(vector<BenchEventFormation *> &events, const State *pState, int repetitions, double &checkSum)
+{
+	checkSum = 0;
+
+	BenchTimer timer;
+
+	for (int r = 0 ; r < repetitions ; r++)
+	{
+		double t0 = 0.01*r;
+		double Tdiff = 1.0 + 0.01*r;
+
+		for (size_t i = 0 ; i < events.size() ; i++)
+			checkSum += events[i]->solveForRealTimeInterval(pState, Tdiff, t0);
+	}
+
+	return timer.getSeconds();
+}
+
+double runBatchSolves(vector<BenchEventFormation *> &events, const State *pState, int repetitions, double &checkSum)
+{
+	EventBatchSolver *pSolver = events[0]->getBatchSolver(pState);
+	vector<EventBase *> batchEvents(events.begin(), events.end());
+	vector<double> Tdiff(events.size());
+	vector<double> dt(events.size());
+
+	checkSum = 0;
+	if (!pSolver)
+		return -1;
+
+	BenchTimer timer;
+
+	for (int r = 0 ; r < repetitions ; r++)
+	{
+		double t0 = 0.01*r;
+
+		for (size_t i = 0 ; i < Tdiff.size() ; i++)
+			Tdiff[i] = 1.0 + 0.01*r;
+
+		pSolver->solveForRealTimeIntervals(pState, &batchEvents[0], &Tdiff[0], (int)events.size(), t0, &dt[0]);
+
+		for (size_t i = 0 ; i < dt.size() ; i++)
+			checkSum += dt[i];
+	}
+
+	return timer.getSeconds();
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 2 && argc != 3)
+	{
+		cerr << "Usage: " << argv[0] << " configfile.txt [repetitions]" << endl;
+		return -1;
+	}
+
+	string confFileName(argv[1]);
+	int repetitions = (argc == 3) ? atoi(argv[2]) : 10;
+	ConfigSettings config;
+	bool_t r;
+
+	if (repetitions < 1)
+	{
+		cerr << "The number of repetitions must be at least one" << endl;
+		return -1;
+	}
+
+	if (!(r = config.load(confFileName)))
+	{
+		cerr << "Error loading configuration file " << confFileName << endl;
+		cerr << "  " << r.getErrorString() << endl;
+		return -1;
+	}
+
+	GslRandomNumberGenerator rng;
+	PopulationDistributionCSV ageDist(&rng);
+	SimpactPopulationConfig populationConfig;
+	double tMax = -1;
+	int64_t maxEvents = -1;
+
+	if (!(r = configure(config, populationConfig, ageDist, &rng, tMax, maxEvents)))
+	{
+		cerr << r.getErrorString() << endl;
+		return -1;
+	}
+
+	PopulationAlgorithmInterface *pAlgo = 0;
+	PopulationStateInterface *pState = 0;
+
+	if (!(r = PopulationUtil::selectAlgorithmAndState("opt", rng, false, &pAlgo, &pState)))
+	{
+		cerr << r.getErrorString() << endl;
+		return -1;
+	}
+
+	unique_ptr<PopulationAlgorithmInterface> algorithm(pAlgo);
+	unique_ptr<PopulationStateInterface> state(pState);
+	unique_ptr<SimpactPopulation> population(createSimpactPopulation(*pAlgo, *pState));
+
+	if (!(r = population->init(populationConfig, ageDist)))
+	{
+		cerr << "Unable to initialize population: " << r.getErrorString() << endl;
+		return -1;
+	}
+
+	vector<BenchEventFormation *> events;
+	Man **ppMen = population->getMen();
+	Woman **ppWomen = population->getWomen();
+
+	for (int i = 0 ; i < population->getNumberOfMen() ; i++)
+	{
+		if (!ppMen[i]->isSexuallyActive())
+			continue;
+
+		for (int j = 0 ; j < population->getNumberOfWomen() ; j++)
+		{
+			if (ppWomen[j]->isSexuallyActive())
+				events.push_back(new BenchEventFormation(ppMen[i], ppWomen[j]));
+		}
+	}
+
+	if (events.size() == 0)
+	{
+		cerr << "No sexually active (man, woman) pairs in the initial population" << endl;
+		return -1;
+	}
+
+	double checkSumTable = 0, checkSumPerson = 0;
+
+	population->setAttributeTableEnabled(true);
+	double tTable = runRecalculations(events, pState, repetitions, checkSumTable);
+
+	population->setAttributeTableEnabled(false);
+	double tPerson = runRecalculations(events, pState, repetitions, checkSumPerson);
+
+	population->setAttributeTableEnabled(true);
+
+	double checkSumCache = 0, checkSumNoCache = 0;
+
+	EventFormation::setHazardCacheEnabled(true);
+	double tCache = runSolves(events, pState, repetitions, checkSumCache);
+
+	EventFormation::setHazardCacheEnabled(false);
+	double tNoCache = runSolves(events, pState, repetitions, checkSumNoCache);
+
+	EventFormation::setHazardCacheEnabled(true);
+
+	double checkSumBatch = 0;
+	double tBatch = runBatchSolves(events, pState, repetitions, checkSumBatch);
+
+	double numCalcs = (double)events.size() * (double)repetitions;
+
+	cout << "# Pairs: " << events.size() << ", repetitions: " << repetitions << endl;
+	cout << "# Mode, seconds, recalculations/second, checksum" << endl;
+	cout << "table, " << tTable << ", " << numCalcs/tTable << ", " << checkSumTable << endl;
+	cout << "person, " << tPerson << ", " << numCalcs/tPerson << ", " << checkSumPerson << endl;
+	cout << "# Mode, seconds, nanoseconds per solveForRealTimeInterval call, checksum" << endl;
+	cout << "cache, " << tCache << ", " << tCache/numCalcs*1e9 << ", " << checkSumCache << endl;
+	cout << "nocache, " << tNoCache << ", " << tNoCache/numCalcs*1e9 << ", " << checkSumNoCache << endl;
+	if (tBatch >= 0)
+		cout << "batch, " << tBatch << ", " << tBatch/numCalcs*1e9 << ", " << checkSumBatch << endl;
+
+	for (size_t i = 0 ; i < events.size() ; i++)
+		delete events[i];
+
+	if (checkSumTable != checkSumPerson || checkSumCache != checkSumNoCache || (tBatch >= 0 && checkSumBatch != checkSumCache))
+	{
+		cerr << "ERROR: results differ between both modes" << endl;
+		return -1;
+	}
+
+	return 0;
+}
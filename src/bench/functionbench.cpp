@@ -0,0 +1,138 @@
+// Compares the number of evaluations per second of a PieceWiseLinearFunction
+// to those of a linear scan over all points (which is how the function was
+// evaluated before), for a number of points. The points are either equally
+// spaced or have random x-coordinates. The x values at which the function is
+// evaluated are random, and are used one at a time, as an array, and as a
+// sorted array. As a check, all results are compared to the ones of the
+// linear scan.
+//
+// Usage: functionbench-release [numevaluations]
+
+#include "gslrandomnumbergenerator.h"
+#include "piecewiselinearfunction.h"
+#include "util.h"
+#include "benchtimer.h"
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+// The previous implementation of PieceWiseLinearFunction::evaluate
+static double evaluateLinearScan(const vector<Point2D> &points, double leftValue, double rightValue, double x)
+{
+	size_t num = points.size() - 1;
+
+	if (x < points[0].x)
+		return leftValue;
+
+	for (size_t i = 0 ; i < num ; i++)
+	{
+		double x0 = points[i].x;
+		double x1 = points[i+1].x;
+
+		if (x >= x0 && x < x1)
+		{
+			double frac = (x-x0)/(x1-x0);
+			double y0 = points[i].y;
+			double y1 = points[i+1].y;
+			
+			return (y1-y0)*frac + y0;
+		}
+	}
+	return rightValue;
+}
+
+// Compares the values bit by bit, so that two NaN values are also the same
+static bool sameValues(const vector<double> &a, const vector<double> &b)
+{
+	return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](double x, double y)
+	{
+		return x == y || (x != x && y != y);
+	});
+}
+
+template<class Func>
+static double timeIt(Func f, int numEval)
+{
+	return (double)numEval/timeSeconds(f);
+}
+
+int main(int argc, char *argv[])
+{
+	int numEval = 1000000;
+
+	if (argc > 2 || (argc == 2 && (!parseAsInt(argv[1], numEval) || numEval < 1)))
+	{
+		cerr << "Usage: " << argv[0] << " [numevaluations]" << endl;
+		return -1;
+	}
+
+	GslRandomNumberGenerator rng(12345, false);
+	const int pointCounts[] = { 10, 30, 100, 300, 1000, 3000, 10000 };
+	bool allSame = true;
+
+	printf("# %6s %7s %16s %16s %16s %16s %5s\n", "points", "spacing", "scan (evals/s)", "single (evals/s)", 
+	       "array (evals/s)", "sorted (evals/s)", "same");
+
+	for (size_t p = 0 ; p < sizeof(pointCounts)/sizeof(int) ; p++)
+	{
+		for (int equal = 1 ; equal >= 0 ; equal--)
+		{
+			const int num = pointCounts[p];
+			vector<Point2D> points(num);
+
+			for (int i = 0 ; i < num ; i++)
+			{
+				double x = (equal)?0.5*(double)i:0.5*(double)num*rng.pickRandomDouble();
+				points[i] = Point2D(x, rng.pickRandomDouble());
+			}
+			sort(points.begin(), points.end(), [](const Point2D &a, const Point2D &b) { return a.x < b.x; });
+
+			PieceWiseLinearFunction func(points, -1, 2);
+
+			// Also some values outside the range of the points
+			vector<double> xValues(numEval), sortedXValues;
+			for (int i = 0 ; i < numEval ; i++)
+				xValues[i] = 0.5*(double)num*(1.2*rng.pickRandomDouble() - 0.1);
+
+			sortedXValues = xValues;
+			sort(sortedXValues.begin(), sortedXValues.end());
+
+			// The linear scan is slow for many points, only use part of the values then
+			int numScan = std::max(1000, (int)(numEval*std::min(1.0, 100.0/num)));
+			vector<double> scanValues(numScan), scanSortedValues(numScan);
+			vector<double> singleValues(numEval), arrayValues(numEval), sortedValues(numEval);
+
+			double rateScan = timeIt([&]()
+			{
+				for (int i = 0 ; i < numScan ; i++)
+					scanValues[i] = evaluateLinearScan(points, -1, 2, xValues[i]);
+			}, numScan);
+
+			double rateSingle = timeIt([&]()
+			{
+				for (int i = 0 ; i < numEval ; i++)
+					singleValues[i] = func.evaluate(xValues[i]);
+			}, numEval);
+
+			double rateArray = timeIt([&]() { func.evaluate(&xValues[0], &arrayValues[0], numEval); }, numEval);
+			double rateSorted = timeIt([&]() { func.evaluate(&sortedXValues[0], &sortedValues[0], numEval); }, numEval);
+
+			for (int i = 0 ; i < numScan ; i++)
+				scanSortedValues[i] = evaluateLinearScan(points, -1, 2, sortedXValues[i]);
+
+			bool same = sameValues(scanValues, vector<double>(singleValues.begin(), singleValues.begin() + numScan)) &&
+				    sameValues(singleValues, arrayValues) &&
+				    sameValues(scanSortedValues, vector<double>(sortedValues.begin(), sortedValues.begin() + numScan));
+
+			printf("  %6d %7s %16.4g %16.4g %16.4g %16.4g %5s\n", num, (func.isEquallySpaced())?"equal":"random",
+			       rateScan, rateSingle, rateArray, rateSorted, (same)?"yes":"NO");
+
+			allSame &= same;
+		}
+	}
+
+	return (allSame)?0:-1;
+}
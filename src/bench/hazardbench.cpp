@@ -0,0 +1,598 @@
+// Measures the cost and the accuracy of the hazard calculations. The simulation
+// described in a simpact config file is run first, so that the hazards are
+// evaluated for a population with realistic ages, eagerness values and
+// relationships (set population.simtime to 0 to use the initial population).
+// Then, for random (man, woman) pairs and random times, the time spent in
+// calculateInternalTimeInterval and solveForRealTimeInterval is measured for
+//
+//  - the EvtHazard implementations as they are called by the formation and
+//    dissolution events, i.e. including the pair caches and the
+//    TimeLimitedHazardFunction wrapper
+//  - the HazardFunction implementations themselves, once on their own and
+//    once wrapped in a TimeLimitedHazardFunction
+//  - TabulatedHazardFunction versions of these: one table per parameter set
+//    for the relocation hazard, as EventRelocation uses it, and one table per
+//    pair for the formation hazards, for which the time to build the tables
+//    is reported as well.
+//
+// For each of these, the relative error of the round trip dt -> Tdiff -> dt
+// is reported, as well as the largest relative difference with a reference
+// value of Tdiff: a numerical integration of the hazard for the analytic
+// HazardFunction implementations, and the analytic form for the tabulated
+// ones. Samples for which the reference is negligible are left out of the
+// latter, since the tables have an absolute tolerance as well.
+//
+// The parameters of each hazard are not fixed: there are several parameter
+// sets, which the samples use in turn. If the config file contains the
+// parameters of a hazard (because it's used in the simulation), these are
+// the first set, the other ones are drawn from the ranges below.
+
+#include "gslrandomnumbergenerator.h"
+#include "populationdistributioncsv.h"
+#include "simpactpopulation.h"
+#include "eventformation.h"
+#include "eventdissolution.h"
+#include "evthazardformationsimple.h"
+#include "evthazardformationagegap.h"
+#include "evthazardformationagegaprefyear.h"
+#include "evthazarddissolution.h"
+#include "hazardfunctionformationsimple.h"
+#include "hazardfunctionformationagegap.h"
+#include "hazardfunctionformationagegaprefyear.h"
+#include "hazardfunctionexp.h"
+#include "tabulatedhazardfunction.h"
+#include "configsettings.h"
+#include "configutil.h"
+#include "populationutil.h"
+#include "benchtimer.h"
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cmath>
+
+using namespace std;
+
+SimpactPopulation *createSimpactPopulation(PopulationAlgorithmInterface &alg, PopulationStateInterface &state);
+
+// The number of parameter sets per hazard
+const int numParameterSets = 16;
+
+// The formation hazards are tabulated for this many pairs, on an interval
+// that contains all the sample times
+const int maxTabulatedPairs = 10000;
+const double tabulationInterval = 40;
+
+// Internal time intervals below this are not compared to the reference value
+const double minReference = 1e-9;
+
+struct HazardParameter
+{
+	const char *m_pKey;
+	double m_minValue, m_maxValue;
+};
+
+// The ranges in which the parameters of fitted simpact configurations usually
+// end up. For the formation hazards, the baseline is relative to the population
+// size, as in the events.
+const HazardParameter simpleParameters[] = {
+	{ "alpha_0", 1.0, 4.0 }, { "alpha_1", -1.5, -0.1 }, { "alpha_2", -1.5, -0.1 }, { "alpha_3", -0.5, 0 },
+	{ "alpha_4", -0.1, 0 }, { "alpha_5", -1.0, -0.1 }, { "alpha_6", 0, 0.5 }, { "alpha_7", -0.5, 0 },
+	{ "alpha_dist", -0.1, 0 }, { "Dp", 0, 5 }, { "beta", 0, 0.1 }, { "t_max", 200, 200 } };
+
+const HazardParameter ageGapParameters[] = {
+	{ "baseline", 1.0, 4.0 }, { "numrel_man", -1.5, -0.1 }, { "numrel_woman", -1.5, -0.1 }, { "numrel_diff", -0.5, 0 },
+	{ "meanage", -0.1, 0 }, { "gap_factor_man", -1.5, -0.1 }, { "eagerness_sum", 0, 0.5 }, { "eagerness_diff", -0.5, 0 },
+	{ "gap_agescale_man", 0, 0.5 }, { "gap_factor_woman", -1.5, -0.1 }, { "gap_agescale_woman", 0, 0.5 },
+	{ "distance", -0.1, 0 }, { "beta", 0, 0.1 }, { "t_max", 200, 200 } };
+
+const HazardParameter ageGapRefYearParameters[] = {
+	{ "baseline", 1.0, 4.0 }, { "numrel_man", -1.5, -0.1 }, { "numrel_scale_man", -0.1, 0 }, { "numrel_woman", -1.5, -0.1 },
+	{ "numrel_scale_woman", -0.1, 0 }, { "numrel_diff", -0.5, 0 }, { "meanage", -0.1, 0 }, { "eagerness_sum", 0, 0.5 },
+	{ "eagerness_diff", -0.5, 0 }, { "gap_agescale_man", 0, 0.5 }, { "gap_agescale_woman", 0, 0.5 },
+	{ "gap_factor_man_const", -1.5, 0 }, { "gap_factor_man_exp", -0.5, 0 }, { "gap_factor_man_age", 0, 0.05 },
+	{ "gap_factor_woman_const", -1.5, 0 }, { "gap_factor_woman_exp", -0.5, 0 }, { "gap_factor_woman_age", 0, 0.05 },
+	{ "distance", -0.1, 0 }, { "beta", 0, 0.1 }, { "t_max", 200, 200 } };
+
+const HazardParameter dissolutionParameters[] = {
+	{ "alpha_0", -1.5, 0.5 }, { "alpha_1", -0.5, 0 }, { "alpha_2", -0.5, 0 }, { "alpha_3", -0.5, 0 },
+	{ "alpha_4", -0.05, 0 }, { "alpha_5", -0.2, 0 }, { "Dp", 0, 5 }, { "beta", 0, 0.1 }, { "t_max", 200, 200 } };
+
+const HazardParameter relocationParameters[] = {
+	{ "a", -4.0, -1.0 }, { "b", 0, 0.05 }, { "t_max", 100, 200 } };
+
+typedef map<string, double> ParameterSet;
+
+// The first set is read from the config file if all keys 'prefix.key' are present
+vector<ParameterSet> getParameterSets(ConfigSettings &config, const string &prefix, const HazardParameter *pParams, size_t numParams,
+                                      GslRandomNumberGenerator &rng, bool &fromConfig)
+{
+	vector<ParameterSet> sets(numParameterSets);
+
+	fromConfig = true;
+	for (size_t i = 0 ; fromConfig && i < numParams ; i++)
+	{
+		double value = 0;
+		if (!config.getKeyValue(prefix + "." + pParams[i].m_pKey, value))
+			fromConfig = false;
+		else
+			sets[0][pParams[i].m_pKey] = value;
+	}
+
+	for (int j = (fromConfig)?1:0 ; j < numParameterSets ; j++)
+	{
+		for (size_t i = 0 ; i < numParams ; i++)
+		{
+			const HazardParameter &p = pParams[i];
+			sets[j][p.m_pKey] = p.m_minValue + (p.m_maxValue - p.m_minValue)*rng.pickRandomDouble();
+		}
+	}
+	return sets;
+}
+
+struct Sample
+{
+	Person *m_pPerson1, *m_pPerson2;
+	double m_t0, m_dt, m_tr;
+};
+
+// Calculates the time mappings for one of the samples
+class HazardKernel
+{
+public:
+	HazardKernel(const string &name) : m_name(name)								{ }
+	virtual ~HazardKernel()											{ }
+
+	const string &getName() const										{ return m_name; }
+
+	virtual double calculateInternalTimeInterval(int idx, double t0, double dt) = 0;
+	virtual double solveForRealTimeInterval(int idx, double Tdiff, double t0) = 0;
+
+	// The value calculateInternalTimeInterval is compared to, or a negative
+	// value if not available
+	virtual double getReference(int idx, double t0, double dt)						{ return -1; }
+private:
+	string m_name;
+};
+
+// Calls an EvtHazard for an event per sample, like the event itself would; the
+// hazards for the different parameter sets are used in turn
+class EvtHazardKernel : public HazardKernel
+{
+public:
+	EvtHazardKernel(const string &name, vector<EvtHazard *> &hazards, const SimpactPopulation &population, vector<SimpactEvent *> &events)
+		: HazardKernel(name), m_hazards(hazards), m_population(population), m_events(events)		{ }
+	~EvtHazardKernel()
+	{
+		for (size_t i = 0 ; i < m_events.size() ; i++)
+			delete m_events[i];
+		for (size_t i = 0 ; i < m_hazards.size() ; i++)
+			delete m_hazards[i];
+	}
+
+	double calculateInternalTimeInterval(int idx, double t0, double dt)				{ return getHazard(idx)->calculateInternalTimeInterval(m_population, *m_events[idx], t0, dt); }
+	double solveForRealTimeInterval(int idx, double Tdiff, double t0)				{ return getHazard(idx)->solveForRealTimeInterval(m_population, *m_events[idx], Tdiff, t0); }
+private:
+	EvtHazard *getHazard(int idx)									{ return m_hazards[idx % m_hazards.size()]; }
+
+	vector<EvtHazard *> m_hazards;
+	const SimpactPopulation &m_population;
+	vector<SimpactEvent *> m_events;
+};
+
+// Calls a HazardFunction instance per sample, optionally wrapped in a
+// TimeLimitedHazardFunction
+class HazardFunctionKernel : public HazardKernel
+{
+public:
+	HazardFunctionKernel(const string &name, vector<HazardFunction *> &hazards) : HazardKernel(name), m_hazards(hazards)	{ }
+	HazardFunctionKernel(const string &name, const HazardFunctionKernel &unlimited, const vector<double> &tMax) : HazardKernel(name)
+	{
+		for (size_t i = 0 ; i < unlimited.m_hazards.size() ; i++)
+			m_hazards.push_back(new TimeLimitedHazardFunction(*unlimited.m_hazards[i], tMax[i]));
+	}
+	~HazardFunctionKernel()
+	{
+		for (size_t i = 0 ; i < m_hazards.size() ; i++)
+			delete m_hazards[i];
+	}
+
+	HazardFunction &getHazard(int idx)								{ return *m_hazards[idx]; }
+
+	double calculateInternalTimeInterval(int idx, double t0, double dt)				{ return m_hazards[idx]->calculateInternalTimeInterval(t0, dt); }
+	double solveForRealTimeInterval(int idx, double Tdiff, double t0)				{ return m_hazards[idx]->solveForRealTimeInterval(t0, Tdiff); }
+	double getReference(int idx, double t0, double dt)						{ return m_hazards[idx]->integrateNumerically(t0, dt); }
+private:
+	vector<HazardFunction *> m_hazards;
+};
+
+// Tabulates the hazard of each of the first 'num' samples of an analytic kernel
+// on the interval [tStart, tEnd], and compares to the analytic form
+class TabulatedHazardKernel : public HazardKernel
+{
+public:
+	TabulatedHazardKernel(const string &name, HazardFunctionKernel &analytic, int num, double tStart, double tEnd)
+		: HazardKernel(name), m_analytic(analytic), m_tables(num)
+	{
+		int numSegments = 0;
+
+		BenchTimer timer;
+		for (int i = 0 ; i < num ; i++)
+		{
+			m_tables[i].build(analytic.getHazard(i), tStart, tEnd);
+			numSegments += m_tables[i].getNumberOfSegments();
+		}
+		double dtBuild = timer.getSeconds();
+
+		cout << "# " << name << ": " << dtBuild/num*1e6
+		     << " us per table, " << (double)numSegments/num << " segments per table" << endl;
+	}
+
+	double calculateInternalTimeInterval(int idx, double t0, double dt)				{ return m_tables[idx].calculateInternalTimeInterval(t0, dt); }
+	double solveForRealTimeInterval(int idx, double Tdiff, double t0)				{ return m_tables[idx].solveForRealTimeInterval(t0, Tdiff); }
+	double getReference(int idx, double t0, double dt)						{ return m_analytic.calculateInternalTimeInterval(idx, t0, dt); }
+private:
+	HazardFunctionKernel &m_analytic;
+	vector<TabulatedHazardFunction> m_tables;
+};
+
+// Like EventRelocation with relocation.hazard.tabulated = yes: the hazard
+// exp(a + b*age) is tabulated once per parameter set as a function of the age
+class TabulatedRelocationKernel : public HazardKernel
+{
+public:
+	TabulatedRelocationKernel(const string &name, const vector<ParameterSet> &params, const vector<Sample> &samples,
+	                          HazardFunctionKernel &analytic) : HazardKernel(name), m_analytic(analytic), m_tables(params.size())
+	{
+		for (size_t i = 0 ; i < params.size() ; i++)
+		{
+			HazardFunctionExp h(params[i].at("a"), params[i].at("b"));
+			m_tables[i].build(h, 0, params[i].at("t_max"));
+		}
+		for (size_t i = 0 ; i < samples.size() ; i++)
+			m_datesOfBirth.push_back(samples[i].m_pPerson1->getDateOfBirth());
+	}
+
+	double calculateInternalTimeInterval(int idx, double t0, double dt)				{ return m_tables[idx % m_tables.size()].calculateInternalTimeInterval(t0 - m_datesOfBirth[idx], dt); }
+	double solveForRealTimeInterval(int idx, double Tdiff, double t0)				{ return m_tables[idx % m_tables.size()].solveForRealTimeInterval(t0 - m_datesOfBirth[idx], Tdiff); }
+	double getReference(int idx, double t0, double dt)						{ return m_analytic.calculateInternalTimeInterval(idx, t0, dt); }
+private:
+	HazardFunctionKernel &m_analytic;
+	vector<TabulatedHazardFunction> m_tables;
+	vector<double> m_datesOfBirth;
+};
+
+void runKernel(HazardKernel &kernel, const vector<Sample> &samples, int numReferences)
+{
+	int N = (int)samples.size();
+	vector<double> Tdiff(N), dt2(N);
+
+	double tCalc = timeSeconds([&]()
+	{
+		for (int i = 0 ; i < N ; i++)
+			Tdiff[i] = kernel.calculateInternalTimeInterval(i, samples[i].m_t0, samples[i].m_dt);
+	});
+	double tSolve = timeSeconds([&]()
+	{
+		for (int i = 0 ; i < N ; i++)
+			dt2[i] = kernel.solveForRealTimeInterval(i, Tdiff[i], samples[i].m_t0);
+	});
+
+	double sumErr = 0, maxErr = 0;
+	int numBad = 0;
+	for (int i = 0 ; i < N ; i++)
+	{
+		double err = std::abs(dt2[i] - samples[i].m_dt)/samples[i].m_dt;
+		if (!std::isfinite(err))
+		{
+			numBad++;
+			continue;
+		}
+		sumErr += err;
+		if (err > maxErr)
+			maxErr = err;
+	}
+	double meanErr = (N > numBad) ? sumErr/(double)(N - numBad) : 0;
+
+	// The numerical integration is slow, so this is only done for some of the samples
+	double maxRefErr = -1;
+	for (int i = 0 ; i < numReferences && i < N ; i++)
+	{
+		double refTdiff = kernel.getReference(i, samples[i].m_t0, samples[i].m_dt);
+		if (refTdiff < 0)
+			break;
+		if (refTdiff < minReference)
+			continue;
+
+		double err = std::abs(Tdiff[i] - refTdiff)/refTdiff;
+		if (err > maxRefErr || !std::isfinite(err))
+			maxRefErr = err;
+	}
+
+	cout << kernel.getName() << ", " << tCalc/N*1e9 << ", " << tSolve/N*1e9 << ", " << meanErr << ", " << maxErr << ", " << numBad << ", ";
+	if (maxRefErr < 0)
+		cout << "-" << endl;
+	else
+		cout << maxRefErr << endl;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 2 && argc != 3)
+	{
+		cerr << "Usage: " << argv[0] << " configfile.txt [samples]" << endl;
+		return -1;
+	}
+
+	string confFileName(argv[1]);
+	int numSamples = (argc == 3) ? atoi(argv[2]) : 100000;
+	ConfigSettings config;
+	bool_t r;
+
+	if (numSamples < 1)
+	{
+		cerr << "The number of samples must be at least one" << endl;
+		return -1;
+	}
+
+	if (!(r = config.load(confFileName)))
+	{
+		cerr << "Error loading configuration file " << confFileName << endl;
+		cerr << "  " << r.getErrorString() << endl;
+		return -1;
+	}
+
+	GslRandomNumberGenerator rng;
+	PopulationDistributionCSV ageDist(&rng);
+	SimpactPopulationConfig populationConfig;
+	double tMax = -1;
+	int64_t maxEvents = -1;
+
+	bool simpleFromConfig, ageGapFromConfig, ageGapRefYearFromConfig, dissolutionFromConfig, relocationFromConfig;
+	vector<ParameterSet> simpleSets = getParameterSets(config, "formation.hazard.simple", simpleParameters,
+	                                                   sizeof(simpleParameters)/sizeof(HazardParameter), rng, simpleFromConfig);
+	vector<ParameterSet> ageGapSets = getParameterSets(config, "formation.hazard.agegap", ageGapParameters,
+	                                                   sizeof(ageGapParameters)/sizeof(HazardParameter), rng, ageGapFromConfig);
+	vector<ParameterSet> ageGapRefYearSets = getParameterSets(config, "formation.hazard.agegapry", ageGapRefYearParameters,
+	                                                          sizeof(ageGapRefYearParameters)/sizeof(HazardParameter), rng, ageGapRefYearFromConfig);
+	vector<ParameterSet> dissolutionSets = getParameterSets(config, "dissolution", dissolutionParameters,
+	                                                        sizeof(dissolutionParameters)/sizeof(HazardParameter), rng, dissolutionFromConfig);
+	vector<ParameterSet> relocationSets = getParameterSets(config, "relocation.hazard", relocationParameters,
+	                                                       sizeof(relocationParameters)/sizeof(HazardParameter), rng, relocationFromConfig);
+
+	if (!(r = configure(config, populationConfig, ageDist, &rng, tMax, maxEvents)))
+	{
+		cerr << r.getErrorString() << endl;
+		return -1;
+	}
+
+	PopulationAlgorithmInterface *pAlgo = 0;
+	PopulationStateInterface *pState = 0;
+
+	if (!(r = PopulationUtil::selectAlgorithmAndState("opt", rng, false, &pAlgo, &pState)))
+	{
+		cerr << r.getErrorString() << endl;
+		return -1;
+	}
+
+	unique_ptr<PopulationAlgorithmInterface> algorithm(pAlgo);
+	unique_ptr<PopulationStateInterface> state(pState);
+	unique_ptr<SimpactPopulation> population(createSimpactPopulation(*pAlgo, *pState));
+
+	if (!(r = population->init(populationConfig, ageDist)))
+	{
+		cerr << "Unable to initialize population: " << r.getErrorString() << endl;
+		return -1;
+	}
+
+	if (tMax > 0)
+	{
+		if (!(r = population->run(tMax, maxEvents)))
+		{
+			cerr << "Unable to run simulation: " << r.getErrorString() << endl;
+			return -1;
+		}
+	}
+
+	int numMen = population->getNumberOfMen();
+	int numWomen = population->getNumberOfWomen();
+	if (numMen == 0 || numWomen == 0)
+	{
+		cerr << "Need at least one man and one woman in the population" << endl;
+		return -1;
+	}
+
+	// Use the existing relationships for the dissolution hazard, or random pairs
+	// if there are none
+	Man **ppMen = population->getMen();
+	Woman **ppWomen = population->getWomen();
+	double tNow = population->getTime();
+	vector<pair<Person *, Person *> > relationships;
+	vector<double> formationTimes;
+
+	for (int i = 0 ; i < numMen ; i++)
+	{
+		double formationTime;
+		Person *pPartner;
+
+		ppMen[i]->startRelationshipIteration();
+		while ((pPartner = ppMen[i]->getNextRelationshipPartner(formationTime)) != 0)
+		{
+			if (pPartner->isWoman())
+			{
+				relationships.push_back(pair<Person *, Person *>(ppMen[i], pPartner));
+				formationTimes.push_back(formationTime);
+			}
+		}
+	}
+
+	vector<Sample> formationSamples(numSamples), dissolutionSamples(numSamples);
+
+	for (int i = 0 ; i < numSamples ; i++)
+	{
+		Sample &s = formationSamples[i];
+
+		// The intervals range from days to decades, log-uniformly
+		s.m_pPerson1 = ppMen[(int)(rng.pickRandomDouble()*numMen) % numMen];
+		s.m_pPerson2 = ppWomen[(int)(rng.pickRandomDouble()*numWomen) % numWomen];
+		s.m_t0 = tNow + 10.0*rng.pickRandomDouble();
+		s.m_dt = 0.001*std::exp(std::log(20000.0)*rng.pickRandomDouble());
+		s.m_tr = (rng.pickRandomDouble() < 0.5) ? -1 : (tNow - 5.0*rng.pickRandomDouble()); // last dissolution time
+
+		Sample &d = dissolutionSamples[i];
+
+		d = s;
+		if (relationships.size() > 0)
+		{
+			int idx = (int)(rng.pickRandomDouble()*relationships.size()) % relationships.size();
+			d.m_pPerson1 = relationships[idx].first;
+			d.m_pPerson2 = relationships[idx].second;
+			d.m_tr = formationTimes[idx];
+		}
+		else
+			d.m_tr = tNow - 5.0*rng.pickRandomDouble();
+	}
+
+	auto source = [](bool fromConfig) { return (fromConfig) ? "config + drawn" : "drawn"; };
+
+	cout << "# Population size: " << population->getNumberOfPeople() << ", relationships: " << relationships.size()
+	     << ", time: " << tNow << ", samples: " << numSamples << ", parameter sets: " << numParameterSets << endl;
+	cout << "# Parameters: simple " << source(simpleFromConfig) << ", agegap " << source(ageGapFromConfig)
+	     << ", agegapry " << source(ageGapRefYearFromConfig) << ", dissolution " << source(dissolutionFromConfig)
+	     << ", relocation " << source(relocationFromConfig) << endl;
+
+	const int numIntegrations = 1000;
+
+	// The EvtHazard implementations, each with its own events since the pair caches
+	// depend on the hazard
+	auto formationEvents = [&formationSamples]()
+	{
+		vector<SimpactEvent *> events;
+		for (size_t i = 0 ; i < formationSamples.size() ; i++)
+			events.push_back(new EventFormation(formationSamples[i].m_pPerson1, formationSamples[i].m_pPerson2, formationSamples[i].m_tr, 0));
+		return events;
+	};
+
+	vector<SimpactEvent *> dissolutionEvents;
+	for (size_t i = 0 ; i < dissolutionSamples.size() ; i++)
+		dissolutionEvents.push_back(new EventDissolution(dissolutionSamples[i].m_pPerson1, dissolutionSamples[i].m_pPerson2, dissolutionSamples[i].m_tr));
+
+	vector<EvtHazard *> simpleEvtHazards, ageGapEvtHazards, ageGapRefYearEvtHazards, dissolutionEvtHazards;
+
+	for (int j = 0 ; j < numParameterSets ; j++)
+	{
+		ParameterSet &p = simpleSets[j];
+		simpleEvtHazards.push_back(new EvtHazardFormationSimple("simple", false, p["alpha_0"], p["alpha_1"], p["alpha_2"], p["alpha_3"],
+			p["alpha_4"], p["alpha_5"], p["alpha_6"], p["alpha_7"], p["alpha_dist"], p["Dp"], p["beta"], p["t_max"]));
+
+		ParameterSet &q = ageGapSets[j];
+		ageGapEvtHazards.push_back(new EvtHazardFormationAgeGap("agegap", false, q["baseline"], q["numrel_man"], q["numrel_woman"],
+			q["numrel_diff"], q["meanage"], q["gap_factor_man"], q["eagerness_sum"], q["eagerness_diff"], q["gap_agescale_man"],
+			q["gap_factor_woman"], q["gap_agescale_woman"], q["distance"], q["beta"], q["t_max"]));
+
+		// The reference year is not synchronized during the benchmark, so the check
+		// on the difference with t0 is effectively disabled
+		ParameterSet &y = ageGapRefYearSets[j];
+		ageGapRefYearEvtHazards.push_back(new EvtHazardFormationAgeGapRefYear("agegapry", false, y["baseline"], y["numrel_man"],
+			y["numrel_woman"], y["numrel_diff"], y["meanage"], y["eagerness_sum"], y["eagerness_diff"], y["gap_agescale_man"],
+			y["gap_agescale_woman"], y["distance"], y["gap_factor_man_const"], y["gap_factor_man_exp"], y["gap_factor_man_age"],
+			y["gap_factor_woman_const"], y["gap_factor_woman_exp"], y["gap_factor_woman_age"], y["numrel_scale_man"],
+			y["numrel_scale_woman"], y["beta"], y["t_max"], 1e100, false));
+
+		ParameterSet &d = dissolutionSets[j];
+		dissolutionEvtHazards.push_back(new EvtHazardDissolution(false, d["alpha_0"], d["alpha_1"], d["alpha_2"], d["alpha_3"],
+			d["alpha_4"], d["alpha_5"], d["Dp"], d["beta"], d["t_max"]));
+	}
+
+	cout << "# Hazard, ns per calculateInternalTimeInterval, ns per solveForRealTimeInterval, "
+	     << "mean rel. round trip error, max rel. round trip error, non-finite round trips, max rel. difference with reference" << endl;
+
+	{
+		vector<SimpactEvent *> events = formationEvents();
+		EvtHazardKernel k("EvtHazardFormationSimple", simpleEvtHazards, *population, events);
+		runKernel(k, formationSamples, 0);
+	}
+	{
+		vector<SimpactEvent *> events = formationEvents();
+		EvtHazardKernel k("EvtHazardFormationAgeGap", ageGapEvtHazards, *population, events);
+		runKernel(k, formationSamples, 0);
+	}
+	{
+		vector<SimpactEvent *> events = formationEvents();
+		EvtHazardKernel k("EvtHazardFormationAgeGapRefYear", ageGapRefYearEvtHazards, *population, events);
+		runKernel(k, formationSamples, 0);
+	}
+	{
+		EvtHazardKernel k("EvtHazardDissolution", dissolutionEvtHazards, *population, dissolutionEvents);
+		runKernel(k, dissolutionSamples, 0);
+	}
+
+	// The HazardFunction implementations, the limit for the TimeLimitedHazardFunction
+	// is set like in the EvtHazard implementations
+	double logHalfPopulation = std::log(population->getNumberOfPeople()/2.0);
+	vector<HazardFunction *> simple, ageGap, ageGapRefYear, relocation;
+	vector<double> simpleTMax, ageGapTMax, ageGapRefYearTMax, relocationTMax;
+
+	for (int i = 0 ; i < numSamples ; i++)
+	{
+		const Sample &s = formationSamples[i];
+		double tr = (s.m_tr < 0) ? std::max(s.m_pPerson1->getDateOfBirth(), s.m_pPerson2->getDateOfBirth()) + 15.0 : s.m_tr;
+		double tb1 = s.m_pPerson1->getDateOfBirth();
+		double tbMin = std::min(tb1, s.m_pPerson2->getDateOfBirth());
+		ParameterSet &p = simpleSets[i % numParameterSets];
+		ParameterSet &q = ageGapSets[i % numParameterSets];
+		ParameterSet &y = ageGapRefYearSets[i % numParameterSets];
+		ParameterSet &l = relocationSets[i % numParameterSets];
+
+		simple.push_back(new HazardFunctionFormationSimple(s.m_pPerson1, s.m_pPerson2, tr, p["alpha_0"] - logHalfPopulation,
+			p["alpha_1"], p["alpha_2"], p["alpha_3"], p["alpha_4"], p["alpha_5"], p["Dp"], p["beta"]));
+		ageGap.push_back(new HazardFunctionFormationAgeGap(s.m_pPerson1, s.m_pPerson2, tr, q["baseline"] - logHalfPopulation,
+			q["numrel_man"], q["numrel_woman"], q["numrel_diff"], q["meanage"], q["gap_factor_man"], q["gap_agescale_man"],
+			q["gap_factor_woman"], q["gap_agescale_woman"], q["beta"], false));
+		ageGapRefYear.push_back(new HazardFunctionFormationAgeGapRefYear(s.m_pPerson1, s.m_pPerson2, tr, y["baseline"] - logHalfPopulation,
+			y["numrel_man"], y["numrel_woman"], y["numrel_diff"], y["meanage"], y["gap_agescale_man"], y["gap_agescale_woman"],
+			y["gap_factor_man_const"], y["gap_factor_man_exp"], y["gap_factor_man_age"], y["gap_factor_woman_const"],
+			y["gap_factor_woman_exp"], y["gap_factor_woman_age"], y["numrel_scale_man"], y["numrel_scale_woman"], y["beta"], tNow, false));
+		relocation.push_back(new HazardFunctionExp(l["a"] - l["b"]*tb1, l["b"]));
+
+		simpleTMax.push_back(tbMin + p["t_max"]);
+		ageGapTMax.push_back(tbMin + q["t_max"]);
+		ageGapRefYearTMax.push_back(tbMin + y["t_max"]);
+		relocationTMax.push_back(tb1 + l["t_max"]);
+	}
+
+	HazardFunctionKernel kSimple("HazardFunctionFormationSimple", simple);
+	HazardFunctionKernel kAgeGap("HazardFunctionFormationAgeGap", ageGap);
+	HazardFunctionKernel kAgeGapRefYear("HazardFunctionFormationAgeGapRefYear", ageGapRefYear);
+	HazardFunctionKernel kRelocation("HazardFunctionExp(relocation)", relocation);
+	HazardFunctionKernel kSimpleLimited("TimeLimitedHazardFunction(FormationSimple)", kSimple, simpleTMax);
+	HazardFunctionKernel kAgeGapLimited("TimeLimitedHazardFunction(FormationAgeGap)", kAgeGap, ageGapTMax);
+	HazardFunctionKernel kAgeGapRefYearLimited("TimeLimitedHazardFunction(FormationAgeGapRefYear)", kAgeGapRefYear, ageGapRefYearTMax);
+	HazardFunctionKernel kRelocationLimited("TimeLimitedHazardFunction(relocation)", kRelocation, relocationTMax);
+
+	HazardFunctionKernel *pKernels[] = { &kSimple, &kAgeGap, &kAgeGapRefYear, &kRelocation,
+		                             &kSimpleLimited, &kAgeGapLimited, &kAgeGapRefYearLimited, &kRelocationLimited };
+
+	for (size_t i = 0 ; i < sizeof(pKernels)/sizeof(HazardFunctionKernel *) ; i++)
+		runKernel(*pKernels[i], formationSamples, numIntegrations);
+
+	// The tabulated versions, compared to the analytic ones. The relocation hazard
+	// is compared to the time limited version since the table is constant after
+	// t_max as well; all formation samples lie within the tabulated interval
+	TabulatedRelocationKernel kRelocationTabulated("TabulatedHazardFunction(relocation)", relocationSets, formationSamples, kRelocationLimited);
+	runKernel(kRelocationTabulated, formationSamples, numSamples);
+
+	int numTabulated = std::min(numSamples, maxTabulatedPairs);
+	vector<Sample> tabulatedSamples(formationSamples.begin(), formationSamples.begin() + numTabulated);
+	HazardFunctionKernel *pTabulatedKernels[] = { &kSimple, &kAgeGap, &kAgeGapRefYear };
+
+	for (size_t i = 0 ; i < sizeof(pTabulatedKernels)/sizeof(HazardFunctionKernel *) ; i++)
+	{
+		TabulatedHazardKernel k("TabulatedHazardFunction(" + pTabulatedKernels[i]->getName() + ")", *pTabulatedKernels[i],
+		                        numTabulated, tNow, tNow + tabulationInterval);
+		runKernel(k, tabulatedSamples, numTabulated);
+	}
+
+	return 0;
+}
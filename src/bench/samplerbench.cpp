@@ -0,0 +1,169 @@
+// Compares the number of values per second that can be picked from a discrete
+// distribution by DiscreteDistribution (a linear search in the cumulative
+// sums), DiscreteDistributionFast (a search in a binary tree) and
+// DiscreteDistributionAlias (an alias table), for a number of bin counts.
+// The bin weights are random. As a check, the mean of the picked values is
+// compared to the exact mean of the distribution.
+//
+// Afterwards, the time needed to pick from a clipped normal and a clipped
+// binormal distribution is shown for bounds that lie further and further away
+// from the mean.
+//
+// Finally, for the continuous distributions that can be created from the
+// config file, picking numbers one at a time using pickNumber is compared to
+// picking them in blocks using pickNumbers, and the values are checked to be
+// the same.
+//
+// Usage: samplerbench-release [numpicks]
+
+#include "gslrandomnumbergenerator.h"
+#include "discretedistribution.h"
+#include "discretedistributionfast.h"
+#include "discretedistributionalias.h"
+#include "uniformdistribution.h"
+#include "normaldistribution.h"
+#include "lognormaldistribution.h"
+#include "gammadistribution.h"
+#include "betadistribution.h"
+#include "exponentialdistribution.h"
+#include "binormaldistribution.h"
+#include "util.h"
+#include "benchtimer.h"
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include <memory>
+
+using namespace std;
+
+// Returns the number of picks per second, and stores the mean of the values
+static double timePicks(const ProbabilityDistribution &dist, int numPicks, double &mean)
+{
+	BenchTimer timer;
+	double sum = 0;
+
+	for (int i = 0 ; i < numPicks ; i++)
+		sum += dist.pickNumber();
+
+	double dt = timer.getSeconds();
+
+	mean = sum/(double)numPicks;
+	return (double)numPicks/dt;
+}
+
+// Prints the number of picks per second for one at a time and for blocks of
+// numbers, and checks that both give the same values. The blocks are picked
+// using pRng2, which must be in the same state as the generator of dist.
+static bool compareBulk(const char *pName, const ProbabilityDistribution &dist, GslRandomNumberGenerator *pRng2, int numPicks)
+{
+	const size_t blockSize = 1024;
+	vector<double> single(numPicks), bulk(numPicks);
+
+	BenchTimer timer;
+	for (int i = 0 ; i < numPicks ; i++)
+		single[i] = dist.pickNumber();
+	double dtSingle = timer.getSeconds();
+
+	timer.restart();
+	for (size_t i = 0 ; i < (size_t)numPicks ; i += blockSize)
+		dist.pickNumbers(pRng2, &bulk[i], std::min(blockSize, (size_t)numPicks - i));
+	double dtBulk = timer.getSeconds();
+
+	bool same = (single == bulk);
+	printf("  %-22s %18.4g %18.4g %8s\n", pName, (double)numPicks/dtSingle, (double)numPicks/dtBulk, (same)?"yes":"NO");
+	return same;
+}
+
+int main(int argc, char *argv[])
+{
+	int numPicks = 2000000;
+
+	if (argc > 2 || (argc == 2 && (!parseAsInt(argv[1], numPicks) || numPicks < 1)))
+	{
+		cerr << "Usage: " << argv[0] << " [numpicks]" << endl;
+		return -1;
+	}
+
+	GslRandomNumberGenerator rng(12345, false);
+	const int binCounts[] = { 8, 16, 32, 64, 128, 256, 1024, 16384, 1048576 };
+
+	printf("# %8s %18s %18s %18s %12s\n", "bins", "linear (picks/s)", "tree (picks/s)", "alias (picks/s)", "rel. error");
+
+	for (size_t b = 0 ; b < sizeof(binCounts)/sizeof(int) ; b++)
+	{
+		const int num = binCounts[b];
+
+		// Bins of unit width, from 0 to num
+		vector<double> weights(num), binStarts(num+1), histValues(num+1);
+		double totalWeight = 0, exactMean = 0;
+
+		for (int i = 0 ; i < num ; i++)
+		{
+			weights[i] = rng.pickRandomDouble();
+			binStarts[i] = i;
+			histValues[i] = weights[i];
+			totalWeight += weights[i];
+			exactMean += weights[i]*((double)i + 0.5);
+		}
+		binStarts[num] = num;
+		histValues[num] = 0;
+		exactMean /= totalWeight;
+
+		DiscreteDistribution linear(binStarts, histValues, false, &rng);
+		DiscreteDistributionFast tree(0, num, weights, false, &rng);
+		DiscreteDistributionAlias alias(binStarts, weights, false, &rng);
+
+		double meanLinear = 0, meanTree = 0, meanAlias = 0;
+
+		// The linear search becomes too slow for many bins
+		double rateLinear = (num <= 16384)?timePicks(linear, std::max(1000, numPicks/std::max(1, num/64)), meanLinear):0;
+		double rateTree = timePicks(tree, numPicks, meanTree);
+		double rateAlias = timePicks(alias, numPicks, meanAlias);
+
+		printf("  %8d %18.4g %18.4g %18.4g %12.3g\n", num, rateLinear, rateTree, rateAlias, std::abs(meanAlias - exactMean)/exactMean);
+	}
+
+	GslRandomNumberGenerator rng1(54321, false);
+	bool ok = true;
+
+	// Both coordinates are restricted to [dist, dist+0.5], the probability of this
+	// region quickly becomes very small
+	printf("\n# %8s %18s %18s\n", "distance", "normal (picks/s)", "binormal (picks/s)");
+	const double distances[] = { 0, 1, 2, 3, 5, 8 };
+	for (double dist : distances)
+	{
+		NormalDistribution normal(0, 1, &rng1, dist, dist + 0.5);
+		BinormalDistribution binormal(0, 0, 1, 1, 0.5, &rng1, dist, dist + 0.5, dist, dist + 0.5);
+		int num = std::max(1000, numPicks/20);
+		double sum = 0;
+
+		BenchTimer timer;
+		for (int i = 0 ; i < num ; i++)
+			sum += normal.pickNumber();
+		double dtNormal = timer.getSeconds();
+
+		timer.restart();
+		for (int i = 0 ; i < num ; i++)
+			sum += binormal.pickPoint().x;
+		double dtBinormal = timer.getSeconds();
+
+		printf("  %8g %18.4g %18.4g\n", dist, (double)num/dtNormal, (double)num/dtBinormal);
+		if (!(sum >= 2*num*dist))
+			ok = false;
+	}
+
+	printf("\n# %-22s %18s %18s %8s\n", "distribution", "single (picks/s)", "bulk (picks/s)", "same");
+
+	// Two generators with the same seed, one for each method
+	GslRandomNumberGenerator rng2(98765, false), rng3(98765, false);
+
+	ok &= compareBulk("uniform", UniformDistribution(-1, 2, &rng2), &rng3, numPicks);
+	ok &= compareBulk("normal", NormalDistribution(0.5, 0.2, &rng2), &rng3, numPicks);
+	ok &= compareBulk("normal (clipped)", NormalDistribution(0.5, 0.2, &rng2, 0.3, 0.9), &rng3, numPicks);
+	ok &= compareBulk("lognormal", LogNormalDistribution(0, 0.5, &rng2), &rng3, numPicks);
+	ok &= compareBulk("gamma", GammaDistribution(5, 0.2, &rng2), &rng3, numPicks);
+	ok &= compareBulk("beta", BetaDistribution(2, 3, 10, 20, &rng2), &rng3, numPicks);
+	ok &= compareBulk("exponential", ExponentialDistribution(2, &rng2), &rng3, numPicks);
+
+	return (ok)?0:-1;
+}
@@ -0,0 +1,86 @@
+#ifndef FIXEDTIMEEVENTQUEUE_H
+
+#define FIXEDTIMEEVENTQUEUE_H
+
+/**
+ * \file fixedtimeeventqueue.h
+ */
+
+#include "populationevent.h"
+#include <vector>
+#include <algorithm>
+#include <assert.h>
+
+/** Queue for global events for which PopulationEvent::hasFixedFireTime returns
+ *  \c true, used by the 'opt' population based algorithms.
+ *
+ *  The fire time of such an event is calculated once, when the algorithm first
+ *  needs the next event after the event was added, and is never recalculated
+ *  afterwards. Since only a handful of these events exist at the same time, a
+ *  binary heap is used, ordered on the fire time and on the event ID for events
+ *  that fire at the same time (so that the one that was created first will fire
+ *  first).
+ */
+class FixedTimeEventQueue
+{
+public:
+	FixedTimeEventQueue()										{ }
+	~FixedTimeEventQueue()										{ }
+
+	/** Adds an event for which the fire time still needs to be calculated. */
+	void addPendingEvent(PopulationEvent *pEvt)							{ m_pendingEvents.push_back(pEvt); }
+
+	/** Calculates the fire times of the events that were added since the last
+	 *  call, using \c t0 as the current time, and stores them in the queue. */
+	void processPendingEvents(const State *pState, double t0);
+
+	/** Returns the event that will fire first, or NULL if the queue is empty. */
+	PopulationEvent *getFirstEvent() const								{ return (m_heap.empty())?0:m_heap.front(); }
+
+	/** Removes the event returned by FixedTimeEventQueue::getFirstEvent. */
+	void removeFirstEvent();
+
+	/** Returns the number of events in the queue, including the pending ones. */
+	int getNumberOfEvents() const									{ return (int)(m_heap.size() + m_pendingEvents.size()); }
+private:
+	// Returns true if e1 fires after e2, to use the standard (max) heap functions
+	static bool firesLater(const PopulationEvent *e1, const PopulationEvent *e2);
+
+	std::vector<PopulationEvent *> m_heap;
+	std::vector<PopulationEvent *> m_pendingEvents;
+};
+
+inline bool FixedTimeEventQueue::firesLater(const PopulationEvent *e1, const PopulationEvent *e2)
+{
+	double t1 = e1->getEventTime();
+	double t2 = e2->getEventTime();
+
+	if (t1 != t2)
+		return t1 > t2;
+	return e1->getEventID() > e2->getEventID();
+}
+
+inline void FixedTimeEventQueue::processPendingEvents(const State *pState, double t0)
+{
+	for (size_t i = 0 ; i < m_pendingEvents.size() ; i++)
+	{
+		PopulationEvent *pEvt = m_pendingEvents[i];
+
+		assert(pEvt->needsEventTimeCalculation());
+		pEvt->solveForRealTimeInterval(pState, t0);
+
+		m_heap.push_back(pEvt);
+		std::push_heap(m_heap.begin(), m_heap.end(), firesLater);
+	}
+	m_pendingEvents.resize(0);
+}
+
+inline void FixedTimeEventQueue::removeFirstEvent()
+{
+	assert(!m_heap.empty());
+
+	std::pop_heap(m_heap.begin(), m_heap.end(), firesLater);
+	m_heap.pop_back();
+}
+
+#endif // FIXEDTIMEEVENTQUEUE_H
@@ -7,6 +7,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <iostream>
+#include <limits>
+#include <atomic>
 
 inline PersonalEventList *PersonalEventList::personalEventList(PersonBase *pPerson)
 {
@@ -20,6 +22,7 @@ PersonalEventList::PersonalEventList(PersonBase *pPerson)
 {
 	m_pPerson = pPerson;
 	m_pEarliestEvent = 0;
+	m_parkedEarliestTime = std::numeric_limits<double>::infinity();
 	m_listIndex = -1;
 
 #ifdef PERSONALEVENTLIST_EXTRA_DEBUGGING
@@ -52,14 +55,90 @@ void PersonalEventList::processUnsortedEvents(PopulationAlgorithmAdvanced &alg,
 	if (m_untimedEvents.size() == 0) // nothing to do
 		return;
 
-	int num = m_untimedEvents.size();
-	const State *pState = &pop;
+	PopulationEvent *pNewBestEvt = calculateEventTimes(alg, pop, t0, 0, m_untimedEvents.size());
+	mergeUntimedEvents(pNewBestEvt, alg.getParkingTime());
+}
+
+// Collects untimed events that share the same EventBatchSolver, so that their
+// fire times can be calculated together. The calculation itself is done without
+// holding the event locks (the solver only reads from the events), the results
+// are stored afterwards, unless another thread has done so in the mean time.
+class EventTimeBatch
+{
+public:
+	EventTimeBatch(PopulationAlgorithmAdvanced &alg, const State *pState, double t0) 
+		: m_alg(alg), m_pState(pState), m_t0(t0), m_pSolver(0), m_num(0)				{ }
+
+	bool canAdd(EventBatchSolver *pSolver) const							{ return m_num == 0 || (m_pSolver == pSolver && m_num < MaxSize); }
+	void add(EventBatchSolver *pSolver, PopulationEvent *pEvt, int idx)		{ assert(canAdd(pSolver)); m_pSolver = pSolver; m_pEvents[m_num] = pEvt; m_indices[m_num] = idx; m_num++; }
+
+	// The earliest event is tracked together with its position in the list, so that
+	// for equal times the same event is chosen as when no batches are used
+	void solve(PopulationEvent *&pBestEvt, double &bestTime, int &bestIdx);
+private:
+	static const int MaxSize = 64;
+
+	PopulationAlgorithmAdvanced &m_alg;
+	const State *m_pState;
+	const double m_t0;
+	EventBatchSolver *m_pSolver;
+	EventBase *m_pEvents[MaxSize];
+	int m_indices[MaxSize];
+	int m_num;
+};
+
+void EventTimeBatch::solve(PopulationEvent *&pBestEvt, double &bestTime, int &bestIdx)
+{
+	if (m_num == 0)
+		return;
 
-	// First calculate the times
+	double Tdiff[MaxSize];
+	double dt[MaxSize];
 
-	for (int i = 0 ; i < num ; i++)
+	// The internal time intervals are only changed when no event times are being calculated
+	for (int i = 0 ; i < m_num ; i++)
+		Tdiff[i] = m_pEvents[i]->getInternalTimeLeft();
+
+	m_pSolver->solveForRealTimeIntervals(m_pState, m_pEvents, Tdiff, m_num, m_t0, dt);
+
+	for (int i = 0 ; i < m_num ; i++)
+	{
+		PopulationEvent *pEvt = static_cast<PopulationEvent *>(m_pEvents[i]);
+
+		m_alg.lockEvent(pEvt);
+
+		if (pEvt->needsEventTimeCalculation())
+			m_pEvents[i]->setRealTimeInterval(m_pState, m_t0, dt[i]);
+
+		double t = pEvt->getEventTime();
+
+		m_alg.unlockEvent(pEvt);
+
+		if (!pBestEvt || t < bestTime || (t == bestTime && m_indices[i] < bestIdx))
+		{
+			bestTime = t;
+			bestIdx = m_indices[i];
+			pBestEvt = pEvt;
+		}
+	}
+
+	m_num = 0;
+}
+
+PopulationEvent *PersonalEventList::calculateEventTimes(PopulationAlgorithmAdvanced &alg, PopulationStateAdvanced &pop, double t0, int start, int end)
+{
+	assert(start >= 0 && start <= end && end <= (int)m_untimedEvents.size());
+
+	const State *pState = &pop;
+	double newBestTime = 0;
+	int newBestIdx = -1;
+	PopulationEvent *pNewBestEvt = 0;
+	EventTimeBatch batch(alg, pState, t0);
+
+	for (int i = start ; i < end ; i++)
 	{
 		PopulationEvent *pEvt = m_untimedEvents[i];
+		EventBatchSolver *pSolver = 0;
 
 		assert(pEvt != 0);
 		assert(!pEvt->isDeleted());
@@ -86,14 +165,44 @@ void PersonalEventList::processUnsortedEvents(PopulationAlgorithmAdvanced &alg,
 				if (pEvt->needsEventTimeCalculation())
 				{
 					EventBase *pEvtBase = pEvt;
-					pEvtBase->solveForRealTimeInterval(pState, t0);
+
+					pSolver = pEvtBase->getBatchSolver(pState);
+					if (!pSolver)
+						pEvtBase->solveForRealTimeInterval(pState, t0);
+				}
+
+				if (!pSolver)
+				{
+					double t = pEvt->getEventTime();
+
+					if (!pNewBestEvt || t < newBestTime || (t == newBestTime && i < newBestIdx))
+					{
+						newBestTime = t;
+						newBestIdx = i;
+						pNewBestEvt = pEvt;
+					}
 				}
 			}
 		}
 
 		alg.unlockEvent(pEvt);
+
+		// Only done after unlocking, solving the batch locks the events in it
+		if (pSolver)
+		{
+			if (!batch.canAdd(pSolver))
+				batch.solve(pNewBestEvt, newBestTime, newBestIdx);
+			batch.add(pSolver, pEvt, i);
+		}
 	}
 
+	batch.solve(pNewBestEvt, newBestTime, newBestIdx);
+
+	return pNewBestEvt;
+}
+
+void PersonalEventList::mergeUntimedEvents(PopulationEvent *pNewBestEvt, double parkingTime)
+{
 	checkEarliestEvent();
 	
 	// See if we need to check the events currently in m_timedEvents for the best time
@@ -123,8 +232,7 @@ void PersonalEventList::processUnsortedEvents(PopulationAlgorithmAdvanced &alg,
 
 	// merge lists
 	
-	double newBestTime = 0;
-	PopulationEvent *pNewBestEvt = 0;
+	int num = m_untimedEvents.size();
 
 	for (int i = 0 ; i < num ; i++)
 	{
@@ -133,17 +241,15 @@ void PersonalEventList::processUnsortedEvents(PopulationAlgorithmAdvanced &alg,
 		if (pEvt) // can be NULL because of the previous code that checks the validity
 		{
 			assert(!pEvt->isDeleted());
-			int idx = m_timedEvents.size();
 
-			m_timedEvents.push_back(pEvt);
-			pEvt->setEventIndex(m_pPerson, idx); // TODO: this should be safe!
-
-			double t = pEvt->getEventTime();
-
-			if (!pNewBestEvt || t < newBestTime)
+			if (pEvt->getEventTime() > parkingTime)
+				parkEvent(pEvt);
+			else
 			{
-				newBestTime = t;
-				pNewBestEvt = pEvt;
+				int idx = m_timedEvents.size();
+
+				m_timedEvents.push_back(pEvt);
+				pEvt->setEventIndex(m_pPerson, idx); // TODO: this should be safe!
 			}
 		}
 	}
@@ -151,7 +257,8 @@ void PersonalEventList::processUnsortedEvents(PopulationAlgorithmAdvanced &alg,
 	//NOTE: this assertion is no longer valid, since events may become invalid it's definitely possible now
 	//assert(pNewBestEvt != 0);
 	
-	if (pNewBestEvt)
+	// If the earliest one was parked, all of them were
+	if (pNewBestEvt && pNewBestEvt->getEventTime() <= parkingTime)
 	{
 		if (m_pEarliestEvent == 0) // Due to a check earlier on, this should only happen if the original m_timedEvents list was empty
 		{
@@ -159,7 +266,7 @@ void PersonalEventList::processUnsortedEvents(PopulationAlgorithmAdvanced &alg,
 		}
 		else
 		{
-			if (newBestTime < m_pEarliestEvent->getEventTime())
+			if (pNewBestEvt->getEventTime() < m_pEarliestEvent->getEventTime())
 				m_pEarliestEvent = pNewBestEvt;
 		}
 	}
@@ -170,7 +277,8 @@ void PersonalEventList::processUnsortedEvents(PopulationAlgorithmAdvanced &alg,
 	checkEvents();
 }
 
-void PersonalEventList::advanceEventTimes(PopulationAlgorithmAdvanced &alg, const PopulationStateAdvanced &pop, double t1)
+// Returns the number of events that now need a recalculation of their fire times
+int PersonalEventList::advanceEventTimes(PopulationAlgorithmAdvanced &alg, const PopulationStateAdvanced &pop, double t1)
 {
 	checkEarliestEvent();
 	checkEvents();
@@ -201,6 +309,19 @@ void PersonalEventList::advanceEventTimes(PopulationAlgorithmAdvanced &alg, cons
 	
 		m_timedEvents.resize(0);
 		m_pEarliestEvent = 0;
+
+		// The parked events depend on this person as well
+		num = m_parkedEvents.size();
+		for (int i = 0 ; i < num ; i++)
+		{
+			PopulationEvent *pEvt = m_parkedEvents[i];
+			assert(!pEvt->isDeleted());
+
+			m_untimedEvents.push_back(pEvt);
+		}
+
+		m_parkedEvents.resize(0);
+		m_parkedEarliestTime = std::numeric_limits<double>::infinity();
 		//std::cout << "advanceEventTimes: Person " << (void *)m_pPerson << ": timed events cleared, m_untimedEvents " << m_untimedEvents.size() << std::endl;
 	}
 	pop.unlockPerson(m_pPerson);
@@ -210,7 +331,7 @@ void PersonalEventList::advanceEventTimes(PopulationAlgorithmAdvanced &alg, cons
 	// calculate the times in the untimed event list
 	int num = m_untimedEvents.size();
 
-	if (!alg.isParallel())
+	if (!alg.isParallel() || num < alg.getMinParallelEvents())
 	{
 		for (int i = 0 ; i < num ; i++)
 		{
@@ -255,62 +376,69 @@ void PersonalEventList::advanceEventTimes(PopulationAlgorithmAdvanced &alg, cons
 	}
 	else
 	{
-#ifndef DISABLE_PARALLEL
-		#pragma omp parallel for
-#endif // DISABLE_PARALLEL
-		for (int i = 0 ; i < num ; i++)
+		// The events are handed out one by one, they can need quite different
+		// amounts of work
+		std::atomic<int> nextEvent(0);
+
+		alg.getWorkerPool().execute([this, &alg, &pop, t1, num, &nextEvent](int threadIdx)
 		{
-			PopulationEvent *pEvt = m_untimedEvents[i];
+			int i;
+			while ((i = nextEvent.fetch_add(1, std::memory_order_relaxed)) < num)
+			{
+				PopulationEvent *pEvt = m_untimedEvents[i];
 
-			assert(pEvt != 0);
-			assert(!pEvt->isDeleted());
+				assert(pEvt != 0);
+				assert(!pEvt->isDeleted());
 				
-			alg.lockEvent(pEvt);
+				alg.lockEvent(pEvt);
 
-			assert(pEvt->isInitialized());
+				assert(pEvt->isInitialized());
 
-			// Check that we still need to process it, it may already have been done
-			// because of the reason above
-			if (!pEvt->needsEventTimeCalculation())
-			{
-				// check if another person's involved
-
-				int numPersons = pEvt->getNumberOfPersons();
-				bool foundOurselves = false;
-
-				for (int i = 0 ; i < numPersons ; i++)
+				// Check that we still need to process it, it may already have been done
+				// because of the reason above
+				if (!pEvt->needsEventTimeCalculation())
 				{
-					PersonBase *pOtherPerson = pEvt->getPerson(i);
+					// check if another person's involved
 
-					assert(pOtherPerson != 0);
+					int numPersons = pEvt->getNumberOfPersons();
+					bool foundOurselves = false;
 
-					// we need to do this beforehand since we're going
-					// to adjust the event time, which is used as a sorting key
-					if (pOtherPerson != m_pPerson)
+					for (int i = 0 ; i < numPersons ; i++)
 					{
-						pop.lockPerson(pOtherPerson); // can change the lists
-						personalEventList(pOtherPerson)->adjustingEvent(pEvt);
-						pop.unlockPerson(pOtherPerson);
+						PersonBase *pOtherPerson = pEvt->getPerson(i);
+
+						assert(pOtherPerson != 0);
+
+						// we need to do this beforehand since we're going
+						// to adjust the event time, which is used as a sorting key
+						if (pOtherPerson != m_pPerson)
+						{
+							pop.lockPerson(pOtherPerson); // can change the lists
+							personalEventList(pOtherPerson)->adjustingEvent(pEvt);
+							pop.unlockPerson(pOtherPerson);
+						}
+						else
+							foundOurselves = true;
 					}
-					else
-						foundOurselves = true;
-				}
 
-				if (!foundOurselves)
-				{
-					std::cerr << "Consistency error: we're not present in the event" << std::endl;
-					abort();
+					if (!foundOurselves)
+					{
+						std::cerr << "Consistency error: we're not present in the event" << std::endl;
+						abort();
+					}
+
+					pEvt->subtractInternalTimeInterval(&pop, t1);
 				}
 
-				pEvt->subtractInternalTimeInterval(&pop, t1);
+				alg.unlockEvent(pEvt);
 			}
-
-			alg.unlockEvent(pEvt);
-		}
+		});
 	}
 
 	checkEarliestEvent();
 	checkEvents();
+
+	return num;
 }
 
 void PersonalEventList::adjustingEvent(PopulationEvent *pEvt) // this should move the event from the sorted to the unsorted list
@@ -324,6 +452,13 @@ void PersonalEventList::adjustingEvent(PopulationEvent *pEvt) // this should mov
 
 	int idx = pEvt->getEventIndex(m_pPerson);
 
+	if (isParkedIndex(idx))
+	{
+		removeParkedEvent(pEvt, toParkedIndex(idx));
+		m_untimedEvents.push_back(pEvt);
+		return;
+	}
+
 	assert(idx >= 0 && idx < (int)m_timedEvents.size());
 	assert(m_timedEvents[idx] == pEvt);
 
@@ -403,6 +538,13 @@ void PersonalEventList::removeTimedEvent(PopulationEvent *pEvt)
 	assert(!pEvt->isDeleted());
 
 	int idx = pEvt->getEventIndex(m_pPerson);
+
+	if (isParkedIndex(idx))
+	{
+		removeParkedEvent(pEvt, toParkedIndex(idx));
+		return;
+	}
+
 	int lastIdx = m_timedEvents.size()-1;
 
 	if (m_timedEvents[lastIdx] != pEvt)
@@ -419,6 +561,84 @@ void PersonalEventList::removeTimedEvent(PopulationEvent *pEvt)
 	checkEvents();
 }
 
+void PersonalEventList::parkEvent(PopulationEvent *pEvt)
+{
+	int idx = m_parkedEvents.size();
+
+	m_parkedEvents.push_back(pEvt);
+	pEvt->setEventIndex(m_pPerson, toParkedIndex(idx));
+
+	double t = pEvt->getEventTime();
+	if (t < m_parkedEarliestTime)
+		m_parkedEarliestTime = t;
+}
+
+void PersonalEventList::removeParkedEvent(PopulationEvent *pEvt, int idx)
+{
+	assert(idx >= 0 && idx < (int)m_parkedEvents.size());
+	assert(m_parkedEvents[idx] == pEvt);
+
+	int lastIdx = m_parkedEvents.size()-1;
+
+	if (m_parkedEvents[lastIdx] != pEvt)
+	{
+		m_parkedEvents[idx] = m_parkedEvents[lastIdx];
+		m_parkedEvents[idx]->setEventIndex(m_pPerson, toParkedIndex(idx));
+	}
+	m_parkedEvents.resize(lastIdx);
+
+	// m_parkedEarliestTime remains a valid lower bound
+}
+
+int PersonalEventList::unparkEvents(double tLimit)
+{
+	if (m_parkedEarliestTime > tLimit) // nothing to do
+		return 0;
+
+	checkEarliestEvent();
+
+	int num = m_parkedEvents.size();
+	int numKept = 0;
+	double earliestKept = std::numeric_limits<double>::infinity();
+
+	for (int i = 0 ; i < num ; i++)
+	{
+		PopulationEvent *pEvt = m_parkedEvents[i];
+		assert(!pEvt->isDeleted());
+
+		double t = pEvt->getEventTime();
+
+		if (t <= tLimit)
+		{
+			int idx = m_timedEvents.size();
+
+			m_timedEvents.push_back(pEvt);
+			pEvt->setEventIndex(m_pPerson, idx);
+
+			// If m_pEarliestEvent is not set, it will be determined when needed
+			if (m_pEarliestEvent && t < m_pEarliestEvent->getEventTime())
+				m_pEarliestEvent = pEvt;
+		}
+		else
+		{
+			m_parkedEvents[numKept] = pEvt;
+			pEvt->setEventIndex(m_pPerson, toParkedIndex(numKept));
+			numKept++;
+
+			if (t < earliestKept)
+				earliestKept = t;
+		}
+	}
+
+	m_parkedEvents.resize(numKept);
+	m_parkedEarliestTime = earliestKept;
+
+	checkEarliestEvent();
+	checkEvents();
+
+	return num - numKept;
+}
+
 #ifdef PERSONALEVENTLIST_EXTRA_DEBUGGING
 
 void PersonalEventList::checkEarliestEvent() // FOR DEBUGGING
@@ -466,6 +686,9 @@ void PersonalEventList::checkEvents()
 
 	for (int i = 0 ; i < m_untimedEvents.size() ; i++)
 		assert(m_untimedEvents[i] != 0);
+
+	for (int i = 0 ; i < m_parkedEvents.size() ; i++)
+		assert(m_parkedEvents[i] != 0);
 }
 
 #endif // PERSONALEVENTLIST_EXTRA_DEBUGGING
@@ -23,7 +23,22 @@ public:
 
 	void registerPersonalEvent(PopulationEvent *pEvt);
 	void processUnsortedEvents(PopulationAlgorithmAdvanced &alg, PopulationStateAdvanced &pop, double t0);
-	void advanceEventTimes(PopulationAlgorithmAdvanced &alg, const PopulationStateAdvanced &pop, double t1);
+
+	// processUnsortedEvents in two steps, so that the first one can be divided over
+	// several threads for a long list: calculateEventTimes calculates the times for
+	// untimed events [start, end) and returns the earliest one, mergeUntimedEvents
+	// then needs the earliest of these results
+	int getNumberOfUntimedEvents() const						{ return (int)m_untimedEvents.size(); }
+	PopulationEvent *calculateEventTimes(PopulationAlgorithmAdvanced &alg, PopulationStateAdvanced &pop, double t0, int start, int end);
+	void mergeUntimedEvents(PopulationEvent *pNewBestEvt, double parkingTime);
+
+	// Events with a fire time after the parking time are kept apart, so that they
+	// aren't examined when looking for the earliest event. unparkEvents moves the
+	// ones that fire at or before tLimit back, and returns the number of such events
+	int unparkEvents(double tLimit);
+	int getNumberOfParkedEvents() const						{ return (int)m_parkedEvents.size(); }
+	double getParkedEarliestTime() const						{ return m_parkedEarliestTime; }
+	int advanceEventTimes(PopulationAlgorithmAdvanced &alg, const PopulationStateAdvanced &pop, double t1);
 	void adjustingEvent(PopulationEvent *pEvt);
 	void removeTimedEvent(PopulationEvent *pEvt);
 
@@ -33,6 +48,12 @@ public:
 	int getListIndex() const							{ return m_listIndex; }
 private:
 	static PersonalEventList *personalEventList(PersonBase *pPerson);
+	void parkEvent(PopulationEvent *pEvt);
+	void removeParkedEvent(PopulationEvent *pEvt, int idx);
+
+	// The index of a parked event is stored as -2-idx, -1 is not used yet
+	static bool isParkedIndex(int idx)						{ return idx < -1; }
+	static int toParkedIndex(int idx)						{ return -2-idx; }
 #ifndef PERSONALEVENTLIST_EXTRA_DEBUGGING
 	void checkEarliestEvent() { }
 	void checkEvents() { }
@@ -43,6 +64,8 @@ private:
 
 	std::vector<PopulationEvent *> m_timedEvents;
 	std::vector<PopulationEvent *> m_untimedEvents;
+	std::vector<PopulationEvent *> m_parkedEvents;
+	double m_parkedEarliestTime; // a lower bound for the times of the parked events
 	
 	PopulationEvent *m_pEarliestEvent;
 	PersonBase *m_pPerson;
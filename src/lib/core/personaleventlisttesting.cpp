@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <iostream>
+#include <limits>
 
 inline int getResponsiblePersonIndex(PopulationEvent *pEvt)
 {
@@ -28,6 +29,7 @@ PersonalEventListTesting::PersonalEventListTesting(PersonBase *pPerson)
 {
 	m_pPerson = pPerson;
 	m_pEarliestEvent = 0;
+	m_parkedEarliestTime = std::numeric_limits<double>::infinity();
 	m_listIndex = -1;
 
 #ifdef PERSONALEVENTLIST_EXTRA_DEBUGGING
@@ -150,6 +152,7 @@ void PersonalEventListTesting::processUnsortedEvents(PopulationAlgorithmTesting
 	
 	double newBestTime = 0;
 	PopulationEvent *pNewBestEvt = 0;
+	double parkingTime = alg.getParkingTime();
 
 	for (int i = 0 ; i < num ; i++)
 	{
@@ -159,13 +162,19 @@ void PersonalEventListTesting::processUnsortedEvents(PopulationAlgorithmTesting
 		{
 			assert(!pEvt->isDeleted());
 
+			double t = pEvt->getEventTime();
+
+			if (t > parkingTime)
+			{
+				parkEvent(pEvt);
+				continue;
+			}
+
 			int idx = m_timedEventsPrimary.size();
 
 			m_timedEventsPrimary.push_back(pEvt);
 			pEvt->setEventIndex(m_pPerson, idx); // TODO: this should be safe!
 
-			double t = pEvt->getEventTime();
-
 			if (!pNewBestEvt || t < newBestTime)
 			{
 				newBestTime = t;
@@ -226,6 +235,19 @@ void PersonalEventListTesting::advanceEventTimes(PopulationAlgorithmTesting &alg
 	
 		m_timedEventsPrimary.resize(0);
 		m_pEarliestEvent = 0;
+
+		// The parked events depend on this person as well
+		num = m_parkedEventsPrimary.size();
+		for (int i = 0 ; i < num ; i++)
+		{
+			PopulationEvent *pEvt = m_parkedEventsPrimary[i];
+			assert(!pEvt->isDeleted());
+
+			m_untimedEventsPrimary.push_back(pEvt);
+		}
+
+		m_parkedEventsPrimary.resize(0);
+		m_parkedEarliestTime = std::numeric_limits<double>::infinity();
 		//std::cout << "advanceEventTimes: Person " << (void *)m_pPerson << ": timed events cleared, m_untimedEvents " << m_untimedEvents.size() << std::endl;
 	}
 
@@ -294,6 +316,13 @@ void PersonalEventListTesting::adjustingEvent(PopulationEvent *pEvt) // this sho
 
 	int idx = pEvt->getEventIndex(m_pPerson);
 
+	if (isParkedIndex(idx))
+	{
+		removeParkedEvent(pEvt, toParkedIndex(idx));
+		m_untimedEventsPrimary.push_back(pEvt);
+		return;
+	}
+
 	assert(idx >= 0 && idx < (int)m_timedEventsPrimary.size());
 	assert(m_timedEventsPrimary[idx] == pEvt);
 
@@ -380,6 +409,13 @@ void PersonalEventListTesting::removeTimedEvent(PopulationEvent *pEvt)
 	if (pResponsiblePerson == m_pPerson) // it's in the timed event list
 	{
 		int idx = pEvt->getEventIndex(m_pPerson);
+
+		if (isParkedIndex(idx))
+		{
+			removeParkedEvent(pEvt, toParkedIndex(idx));
+			return;
+		}
+
 		int lastIdx = m_timedEventsPrimary.size()-1;
 
 		assert(m_timedEventsPrimary[idx] == pEvt);
@@ -445,6 +481,83 @@ void PersonalEventListTesting::removeSecondaryEvent(PopulationEvent *pEvt)
 	checkEvents();
 }
 
+void PersonalEventListTesting::parkEvent(PopulationEvent *pEvt)
+{
+	int idx = m_parkedEventsPrimary.size();
+
+	m_parkedEventsPrimary.push_back(pEvt);
+	pEvt->setEventIndex(m_pPerson, toParkedIndex(idx));
+
+	double t = pEvt->getEventTime();
+	if (t < m_parkedEarliestTime)
+		m_parkedEarliestTime = t;
+}
+
+void PersonalEventListTesting::removeParkedEvent(PopulationEvent *pEvt, int idx)
+{
+	assert(idx >= 0 && idx < (int)m_parkedEventsPrimary.size());
+	assert(m_parkedEventsPrimary[idx] == pEvt);
+
+	int lastIdx = m_parkedEventsPrimary.size()-1;
+
+	if (m_parkedEventsPrimary[lastIdx] != pEvt)
+	{
+		m_parkedEventsPrimary[idx] = m_parkedEventsPrimary[lastIdx];
+		m_parkedEventsPrimary[idx]->setEventIndex(m_pPerson, toParkedIndex(idx));
+	}
+	m_parkedEventsPrimary.resize(lastIdx);
+
+	// m_parkedEarliestTime remains a valid lower bound
+}
+
+int PersonalEventListTesting::unparkEvents(double tLimit)
+{
+	if (m_parkedEarliestTime > tLimit) // nothing to do
+		return 0;
+
+	checkEarliestEvent();
+
+	int num = m_parkedEventsPrimary.size();
+	int numKept = 0;
+	double earliestKept = std::numeric_limits<double>::infinity();
+
+	for (int i = 0 ; i < num ; i++)
+	{
+		PopulationEvent *pEvt = m_parkedEventsPrimary[i];
+		assert(!pEvt->isDeleted());
+
+		double t = pEvt->getEventTime();
+
+		if (t <= tLimit)
+		{
+			int idx = m_timedEventsPrimary.size();
+
+			m_timedEventsPrimary.push_back(pEvt);
+			pEvt->setEventIndex(m_pPerson, idx);
+
+			// If m_pEarliestEvent is not set, it will be determined when needed
+			if (m_pEarliestEvent && t < m_pEarliestEvent->getEventTime())
+				m_pEarliestEvent = pEvt;
+		}
+		else
+		{
+			m_parkedEventsPrimary[numKept] = pEvt;
+			pEvt->setEventIndex(m_pPerson, toParkedIndex(numKept));
+			numKept++;
+
+			if (t < earliestKept)
+				earliestKept = t;
+		}
+	}
+
+	m_parkedEventsPrimary.resize(numKept);
+	m_parkedEarliestTime = earliestKept;
+
+	checkEarliestEvent();
+	checkEvents();
+
+	return num - numKept;
+}
 
 #ifdef PERSONALEVENTLIST_EXTRA_DEBUGGING
 
@@ -494,6 +607,9 @@ void PersonalEventListTesting::checkEvents()
 	for (int i = 0 ; i < m_untimedEventsPrimary.size() ; i++)
 		assert(m_untimedEventsPrimary[i] != 0);
 
+	for (int i = 0 ; i < m_parkedEventsPrimary.size() ; i++)
+		assert(m_parkedEventsPrimary[i] != 0);
+
 	for (int i = 0 ; i < m_secondaryEvents.size() ; i++)
 		assert(m_secondaryEvents[i] != 0);
 }
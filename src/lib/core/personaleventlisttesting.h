@@ -28,12 +28,25 @@ public:
 	void removeTimedEvent(PopulationEvent *pEvt);
 
 	PopulationEvent *getEarliestEvent();
+
+	// Primary events with a fire time after the parking time are kept apart, see
+	// PopulationAlgorithmTesting. unparkEvents moves the ones that fire at or
+	// before tLimit back, and returns the number of such events
+	int unparkEvents(double tLimit);
+	int getNumberOfParkedEvents() const						{ return (int)m_parkedEventsPrimary.size(); }
+	double getParkedEarliestTime() const						{ return m_parkedEarliestTime; }
 	
 	void setListIndex(int i) 							{ m_listIndex = i; }
 	int getListIndex() const							{ return m_listIndex; }
 private:
 	static PersonalEventListTesting *personalEventList(PersonBase *pPerson);
 	void removeSecondaryEvent(PopulationEvent *pEvt);
+	void parkEvent(PopulationEvent *pEvt);
+	void removeParkedEvent(PopulationEvent *pEvt, int idx);
+
+	// The index of a parked event is stored as -2-idx, -1 is not used yet
+	static bool isParkedIndex(int idx)						{ return idx < -1; }
+	static int toParkedIndex(int idx)						{ return -2-idx; }
 #ifndef PERSONALEVENTLIST_EXTRA_DEBUGGING
 	void checkEarliestEvent() { }
 	void checkEvents() { }
@@ -44,6 +57,8 @@ private:
 
 	std::vector<PopulationEvent *> m_timedEventsPrimary;
 	std::vector<PopulationEvent *> m_untimedEventsPrimary;
+	std::vector<PopulationEvent *> m_parkedEventsPrimary;
+	double m_parkedEarliestTime; // a lower bound for the times of the parked events
 
 	std::vector<PopulationEvent *> m_secondaryEvents;
 	
@@ -9,12 +9,19 @@
 #include "debugwarning.h"
 #include "util.h"
 #include "debugtimer.h"
+#include "eventtracer.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <iostream>
 
 // FOR DEBUGGING
 #include <map>
+#include <algorithm>
+#include <limits>
+#include <atomic>
+#ifndef DISABLEOPENMP
+#include <thread>
+#endif // !DISABLEOPENMP
 
 // For debugging: undefine to always recalculate all events
 //#define POPULATION_ALWAYS_RECALCULATE
@@ -25,11 +32,35 @@
 #define POPULATION_ALWAYS_RECALCULATE_FLAG 0
 #endif
 
+// Default thresholds to decide if a step of the parallel version is done using
+// multiple threads, can be overridden by MNRM_PARALLEL_MINEVENTS and MNRM_PARALLEL_MINPEOPLE
+#define POPULATIONALGORITHMADVANCED_MINPARALLELEVENTS 256
+#define POPULATIONALGORITHMADVANCED_MINPARALLELPEOPLE 4096
+// Maximum number of events of one list that a thread recalculates at once, can
+// be overridden by MNRM_PARALLEL_CHUNKSIZE
+#define POPULATIONALGORITHMADVANCED_PARALLELCHUNKSIZE 64
+// Events that fire more than this time after the current time are parked, can
+// be overridden by MNRM_PARKING_WINDOW (zero disables parking)
+#define POPULATIONALGORITHMADVANCED_PARKINGWINDOW 0
+// Number of times a worker thread checks for new work before it parks, can be
+// overridden by MNRM_POOL_SPINCOUNT
+#define POPULATIONALGORITHMADVANCED_POOLSPINCOUNT 20000
+
 PopulationAlgorithmAdvanced::PopulationAlgorithmAdvanced(PopulationStateAdvanced &popState, GslRandomNumberGenerator &rng,
 		                                 bool parallel) : Algorithm(popState, rng), m_popState(popState)
 {
 	m_init = false;
 	m_parallel = parallel; // Just save the setting for now, in 'init' we may change this
+	m_minParallelEvents = POPULATIONALGORITHMADVANCED_MINPARALLELEVENTS;
+	m_minParallelPeople = POPULATIONALGORITHMADVANCED_MINPARALLELPEOPLE;
+	m_pendingEvents = 0;
+	m_parallelChunkSize = POPULATIONALGORITHMADVANCED_PARALLELCHUNKSIZE;
+	m_measureBusyTime = false;
+	m_parkingWindow = POPULATIONALGORITHMADVANCED_PARKINGWINDOW;
+	m_parkingTime = std::numeric_limits<double>::infinity();
+	m_runEndTime = std::numeric_limits<double>::infinity();
+	m_numParkingMoves = 0;
+	m_numUnparked = 0;
 	m_pOnAboutToFire = 0;
 }
 
@@ -61,15 +92,62 @@ bool_t PopulationAlgorithmAdvanced::init()
 
 	m_nextEventID = 0;
 
+	char *pParkStr = getenv("MNRM_PARKING_WINDOW");
+	if (pParkStr)
+		m_parkingWindow = strtod(pParkStr, 0);
+
+	if (m_parkingWindow > 0)
+		std::cerr << "# PopulationAlgorithmAdvanced: parking events more than " << m_parkingWindow << " after the current time" << std::endl;
+
 	if (m_parallel)
 	{
 #ifndef DISABLEOPENMP
-		std::cerr << "# PopulationAlgorithmAdvanced: using parallel version with " << omp_get_max_threads() << " threads" << std::endl;
-		m_tmpEarliestEvents.resize(omp_get_max_threads());
+#ifndef DISABLE_PARALLEL
+		int numThreads = omp_get_max_threads();
+#else
+		int numThreads = 1;
+#endif // !DISABLE_PARALLEL
+		int spinCount = POPULATIONALGORITHMADVANCED_POOLSPINCOUNT;
+		bool pinThreads = false;
+		char *pEnvStr;
+
+		// With more threads than processor cores, spinning threads would only
+		// take processor time away from the ones that have work to do
+		if (numThreads > (int)std::thread::hardware_concurrency())
+			spinCount = 0;
+
+		if ((pEnvStr = getenv("MNRM_POOL_SPINCOUNT")) != 0)
+			spinCount = (int)strtol(pEnvStr, 0, 10);
+		if ((pEnvStr = getenv("MNRM_POOL_PIN")) != 0)
+			pinThreads = (strtol(pEnvStr, 0, 10) != 0);
+
+		r = m_workerPool.init(numThreads, spinCount, pinThreads);
+		if (!r)
+			return "Unable to start worker threads: " + r.getErrorString();
+
+		std::cerr << "# PopulationAlgorithmAdvanced: using parallel version with " << numThreads << " threads" << std::endl;
+		std::cerr << "# PopulationAlgorithmAdvanced: worker threads spin " << spinCount << " times before parking"
+		          << ((pinThreads)?", bound to cores":"") << std::endl;
+		m_tmpEarliestEvents.resize(numThreads);
 		m_tmpEarliestTimes.resize(m_tmpEarliestEvents.size());
 
 		m_eventMutexes.resize(256); // TODO: what is a good size here?
 		// TODO: in windows it seems that the omp mutex initialization is not ok
+
+		if ((pEnvStr = getenv("MNRM_PARALLEL_MINEVENTS")) != 0)
+			m_minParallelEvents = (int)strtol(pEnvStr, 0, 10);
+		if ((pEnvStr = getenv("MNRM_PARALLEL_MINPEOPLE")) != 0)
+			m_minParallelPeople = (int)strtol(pEnvStr, 0, 10);
+		if ((pEnvStr = getenv("MNRM_PARALLEL_CHUNKSIZE")) != 0)
+			m_parallelChunkSize = (int)strtol(pEnvStr, 0, 10);
+		if (getenv("MNRM_PARALLEL_BUSYTIME") != 0)
+			m_measureBusyTime = true;
+
+		m_threadBusyTimes.resize(numThreads, 0);
+
+		std::cerr << "# PopulationAlgorithmAdvanced: recalculating in parallel from " << m_minParallelEvents
+		          << " events, searching in parallel from " << m_minParallelPeople << " persons" << std::endl;
+		std::cerr << "# PopulationAlgorithmAdvanced: dividing lists in parts of " << m_parallelChunkSize << " events" << std::endl;
 #endif // !DISABLEOPENMP
 	}
 
@@ -85,7 +163,43 @@ bool_t PopulationAlgorithmAdvanced::run(double &tMax, int64_t &maxEvents, double
 	if (!m_init)
 		return "Not initialized";
 
-	return Algorithm::evolve(tMax, maxEvents, startTime, false);
+	if (m_parkingWindow > 0)
+	{
+		m_runEndTime = tMax;
+		moveParkingTime(std::min(startTime + m_parkingWindow, m_runEndTime));
+	}
+
+	bool_t r = Algorithm::evolve(tMax, maxEvents, startTime, false);
+
+	if (m_parkingWindow > 0)
+	{
+		int64_t numParked = 0;
+		for (size_t i = 0 ; i < m_popState.m_people.size() ; i++)
+			numParked += personalEventList(m_popState.m_people[i])->getNumberOfParkedEvents();
+
+		std::cerr << "# PopulationAlgorithmAdvanced: moved parking time " << m_numParkingMoves << " times, brought back " 
+		          << m_numUnparked << " parked events, " << numParked << " events still parked" << std::endl;
+	}
+
+	if (m_measureBusyTime)
+	{
+		double total = 0, maxTime = 0;
+
+		std::cerr << "# PopulationAlgorithmAdvanced: busy time per thread (s):";
+		for (size_t i = 0 ; i < m_threadBusyTimes.size() ; i++)
+		{
+			std::cerr << " " << m_threadBusyTimes[i];
+			total += m_threadBusyTimes[i];
+			maxTime = std::max(maxTime, m_threadBusyTimes[i]);
+		}
+		std::cerr << std::endl;
+
+		if (total > 0)
+			std::cerr << "# PopulationAlgorithmAdvanced: load imbalance (max/average) is " 
+			          << maxTime*m_threadBusyTimes.size()/total << std::endl;
+	}
+
+	return r;
 }
 
 // Each loop we'll delete events that may be deleted
@@ -129,7 +243,20 @@ bool_t PopulationAlgorithmAdvanced::getNextScheduledEvent(double &dt, EventBase
 	pProcessTimer->start();
 #endif // ALGORITHM_DEBUG_TIMER
 
-	if (!m_parallel)
+	bool profile = EventProfiler::isEnabled();
+	bool timing = profile || EventTracer::isTracingStep();
+	int64_t tPhase = (timing)?EventProfiler::getTimestamp():0;
+
+	// Bring back the parked events when the time approaches the parking time
+	if (m_parkingWindow > 0 && m_parkingTime < m_runEndTime && curTime > m_parkingTime - 0.5*m_parkingWindow)
+		moveParkingTime(std::min(curTime + m_parkingWindow, m_runEndTime));
+
+	// Only use multiple threads if there's enough work to be done, otherwise
+	// starting the parallel region costs more than it gains
+	bool parallelStep = m_parallel && m_pendingEvents >= m_minParallelEvents;
+	m_pendingEvents = 0;
+
+	if (!parallelStep)
 	{
 		for (size_t i = 0 ; i < m_people.size() ; i++)
 			personalEventList(m_people[i])->processUnsortedEvents(*this, m_popState, curTime);
@@ -139,22 +266,17 @@ bool_t PopulationAlgorithmAdvanced::getNextScheduledEvent(double &dt, EventBase
 		// really no point in trying to use an m_firstEventTracker?
 	}
 	else
-	{
-#ifndef DISABLEOPENMP
-		int numPeople = m_people.size();
+		processUnsortedEventsParallel(curTime);
 
-#ifndef DISABLE_PARALLEL
-		#pragma omp parallel for 
-#endif // DISABLE_PARALLEL
-		for (int i = 0 ; i < numPeople ; i++)
-			personalEventList(m_people[i])->processUnsortedEvents(*this, m_popState, curTime);
-#endif // !DISABLEOPENMP
-	}
+	m_fixedTimeEvents.processPendingEvents(&m_popState, curTime);
 
 #ifdef ALGORITHM_DEBUG_TIMER
 	pProcessTimer->stop();
 #endif // ALGORITHM_DEBUG_TIMER
 
+	if (timing)
+		tPhase = EventTracer::endPhase(EventProfiler::ProcessUnsortedEvents, tPhase, profile);
+
 #ifdef ALGORITHM_SHOW_EVENTS
 	showEvents();
 #endif // ALGORITHM_SHOW_EVENTS
@@ -168,17 +290,37 @@ bool_t PopulationAlgorithmAdvanced::getNextScheduledEvent(double &dt, EventBase
 	// Then, we should look for the event that happens first
 	PopulationEvent *pEarliestEvent = getEarliestEvent(m_people);
 
+	// If nothing was found, the remaining events are all parked
+	if (pEarliestEvent == 0 && m_parkingWindow > 0)
+		pEarliestEvent = getEarliestParkedEvent(m_people);
+
+	// Compare with the first event that has a fixed fire time. On equal times
+	// this one goes first, just like the global events in the list of the dummy
+	// person do
+	PopulationEvent *pFixedTimeEvent = m_fixedTimeEvents.getFirstEvent();
+	bool fixedTimeEvent = false;
+
+	if (pFixedTimeEvent && (pEarliestEvent == 0 || pFixedTimeEvent->getEventTime() <= pEarliestEvent->getEventTime()))
+	{
+		m_fixedTimeEvents.removeFirstEvent();
+		pEarliestEvent = pFixedTimeEvent;
+		fixedTimeEvent = true;
+	}
+
 #ifdef ALGORITHM_DEBUG_TIMER
 	pInternEarliestTimer->stop();
 #endif // ALGORITHM_DEBUG_TIMER
 
+	if (timing)
+		EventTracer::endPhase(EventProfiler::GetEarliestEvent, tPhase, profile);
+
 	// Once we've found the first event, we must remove it from the
 	// relevant Person's lists
 
 	if (pEarliestEvent == 0)
 		return "No event found";
 
-	int numPersons = pEarliestEvent->getNumberOfPersons();
+	int numPersons = (fixedTimeEvent)?0:pEarliestEvent->getNumberOfPersons();
 	for (int i = 0 ; i < numPersons ; i++)
 	{
 		PersonBase *pPerson = pEarliestEvent->getPerson(i);
@@ -207,6 +349,139 @@ bool_t PopulationAlgorithmAdvanced::getNextScheduledEvent(double &dt, EventBase
 	return true;
 }
 
+void PopulationAlgorithmAdvanced::processUnsortedEventsParallel(double t0)
+{
+#ifndef DISABLEOPENMP
+	std::vector<PersonBase *> &people = m_popState.m_people;
+
+	// Divide the untimed lists in work items, a long list is split in several parts
+	m_workItems.clear();
+	m_workListStarts.resize(0);
+
+	for (size_t i = 0 ; i < people.size() ; i++)
+	{
+		PersonalEventList *pList = personalEventList(people[i]);
+		int num = pList->getNumberOfUntimedEvents();
+
+		if (num == 0)
+			continue;
+
+		int chunkSize = (m_parallelChunkSize > 0)?m_parallelChunkSize:num;
+
+		m_workListStarts.push_back(m_workItems.size());
+		for (int start = 0 ; start < num ; start += chunkSize)
+			m_workItems.push_back(WorkItem(pList, start, std::min(start + chunkSize, num)));
+	}
+	m_workListStarts.push_back(m_workItems.size());
+
+	int numItems = m_workItems.size();
+	int numLists = m_workListStarts.size() - 1;
+
+	// Both loops hand out their indices dynamically, each thread takes the
+	// next item as soon as it's done with the previous one
+	std::atomic<int> nextItem(0);
+	std::atomic<int> nextList(0);
+
+	m_workerPool.execute([this, t0, numItems, numLists, &nextItem, &nextList](int threadIdx)
+	{
+		double busyTime = 0;
+		double startTime = (m_measureBusyTime)?omp_get_wtime():0;
+
+		// First calculate the event times in each part
+		{
+			TraceSpan span("calculateEventTimes");
+
+			int i;
+			while ((i = nextItem.fetch_add(1, std::memory_order_relaxed)) < numItems)
+			{
+				WorkItem &item = m_workItems[i];
+				item.m_pEarliestEvent = item.m_pList->calculateEventTimes(*this, m_popState, t0, item.m_start, item.m_end);
+			}
+		}
+
+		if (m_measureBusyTime)
+			busyTime += omp_get_wtime() - startTime;
+
+		m_workerPool.barrier();
+
+		if (m_measureBusyTime)
+			startTime = omp_get_wtime();
+
+		// Then, combine the earliest events of the parts and merge the lists
+		{
+			TraceSpan span("mergeUntimedEvents");
+
+			int i;
+			while ((i = nextList.fetch_add(1, std::memory_order_relaxed)) < numLists)
+			{
+				PopulationEvent *pBest = 0;
+
+				for (int j = m_workListStarts[i] ; j < m_workListStarts[i+1] ; j++)
+				{
+					PopulationEvent *pEvt = m_workItems[j].m_pEarliestEvent;
+
+					if (pEvt && (!pBest || pEvt->getEventTime() < pBest->getEventTime()))
+						pBest = pEvt;
+				}
+
+				m_workItems[m_workListStarts[i]].m_pList->mergeUntimedEvents(pBest, m_parkingTime);
+			}
+		}
+
+		if (m_measureBusyTime)
+		{
+			busyTime += omp_get_wtime() - startTime;
+			m_threadBusyTimes[threadIdx] += busyTime;
+		}
+	});
+#endif // !DISABLEOPENMP
+}
+
+void PopulationAlgorithmAdvanced::moveParkingTime(double t)
+{
+	std::vector<PersonBase *> &people = m_popState.m_people;
+
+	m_parkingTime = t;
+	for (size_t i = 0 ; i < people.size() ; i++)
+		m_numUnparked += personalEventList(people[i])->unparkEvents(t);
+
+	m_numParkingMoves++;
+}
+
+PopulationEvent *PopulationAlgorithmAdvanced::getEarliestParkedEvent(const std::vector<PersonBase *> &people)
+{
+	PopulationEvent *pEarliestEvent = 0;
+
+	// The stored times of the parked events are only lower bounds, but each
+	// time a list is examined they become exact
+	while (pEarliestEvent == 0)
+	{
+		double tMin = std::numeric_limits<double>::infinity();
+		bool foundParked = false;
+
+		for (size_t i = 0 ; i < people.size() ; i++)
+		{
+			PersonalEventList *pList = personalEventList(people[i]);
+
+			if (pList->getNumberOfParkedEvents() > 0)
+			{
+				foundParked = true;
+				tMin = std::min(tMin, pList->getParkedEarliestTime());
+			}
+		}
+
+		if (!foundParked)
+			break;
+
+		// This can be after the end of the simulation, in which case the
+		// simulation will stop after this event
+		moveParkingTime(std::max(tMin, m_parkingTime));
+		pEarliestEvent = getEarliestEvent(people);
+	}
+
+	return pEarliestEvent;
+}
+
 // all affected event times should be recalculated, again note that an event pointer
 // can be present in both the a man's list and a woman's list
 void PopulationAlgorithmAdvanced::advanceEventTimes(EventBase *pScheduledEvent, double dt)
@@ -230,7 +505,7 @@ void PopulationAlgorithmAdvanced::advanceEventTimes(EventBase *pScheduledEvent,
 
 		assert(pPerson != 0);
 
-		personalEventList(pPerson)->advanceEventTimes(*this, m_popState, newRefTime);
+		m_pendingEvents += personalEventList(pPerson)->advanceEventTimes(*this, m_popState, newRefTime);
 	}
 
 	// also get a list of other persons that are affected
@@ -251,7 +526,7 @@ void PopulationAlgorithmAdvanced::advanceEventTimes(EventBase *pScheduledEvent,
 			assert(pPerson != 0);
 			assert(pPerson->getGender() == PersonBase::Male || pPerson->getGender() == PersonBase::Female);
 
-			personalEventList(pPerson)->advanceEventTimes(*this, m_popState, newRefTime);
+			m_pendingEvents += personalEventList(pPerson)->advanceEventTimes(*this, m_popState, newRefTime);
 		}
 	}
 	else
@@ -266,7 +541,7 @@ void PopulationAlgorithmAdvanced::advanceEventTimes(EventBase *pScheduledEvent,
 			assert(pPerson != 0);
 			assert(pPerson->getGender() == PersonBase::Male || pPerson->getGender() == PersonBase::Female);
 
-			personalEventList(pPerson)->advanceEventTimes(*this, m_popState, newRefTime);
+			m_pendingEvents += personalEventList(pPerson)->advanceEventTimes(*this, m_popState, newRefTime);
 		}
 	}
 
@@ -281,11 +556,33 @@ void PopulationAlgorithmAdvanced::advanceEventTimes(EventBase *pScheduledEvent,
 			assert(pPerson != 0);
 			assert(pPerson->getGender() == PersonBase::GlobalEventDummy);
 
-			personalEventList(pPerson)->advanceEventTimes(*this, m_popState, newRefTime);
+			m_pendingEvents += personalEventList(pPerson)->advanceEventTimes(*this, m_popState, newRefTime);
 		}
 	}
 }
 
+// The candidate time of this event was rejected, which doesn't change the
+// state. getNextScheduledEvent already removed the event from the lists of
+// the persons involved, so it only needs to be added to those lists again
+// (a new internal time difference has already been generated).
+void PopulationAlgorithmAdvanced::onRejectedCandidate(EventBase *pScheduledEvent)
+{
+	assert(m_init);
+
+	PopulationEvent *pEvt = static_cast<PopulationEvent *>(pScheduledEvent);
+	int numPersons = pEvt->getNumberOfPersons();
+
+	for (int i = 0 ; i < numPersons ; i++)
+	{
+		PersonBase *pPerson = pEvt->getPerson(i);
+
+		assert(pPerson != 0);
+
+		personalEventList(pPerson)->registerPersonalEvent(pEvt);
+	}
+	m_pendingEvents += numPersons;
+}
+
 PopulationEvent *PopulationAlgorithmAdvanced::getEarliestEvent(const std::vector<PersonBase *> &people)
 {
 	if (!m_init)
@@ -294,7 +591,7 @@ PopulationEvent *PopulationAlgorithmAdvanced::getEarliestEvent(const std::vector
 	PopulationEvent *pBest = 0;
 	double bestTime = -1;
 
-	if (!m_parallel)
+	if (!m_parallel || (int)people.size() < m_minParallelPeople)
 	{
 		for (size_t i = 0 ; i < people.size() ; i++)
 		{
@@ -323,25 +620,31 @@ PopulationEvent *PopulationAlgorithmAdvanced::getEarliestEvent(const std::vector
 			m_tmpEarliestTimes[i] = -1;
 		}
 
-#ifndef DISABLE_PARALLEL
-		#pragma omp parallel for 
-#endif // DISABLE_PARALLEL
-		for (int i = 0 ; i < numPeople ; i++)
+		// Each thread searches a contiguous range of persons
+		m_workerPool.execute([this, &people, numPeople](int threadIdx)
 		{
-			PopulationEvent *pFirstEvent = personalEventList(people[i])->getEarliestEvent();
+			TraceSpan span("findEarliestEvent");
 
-			if (pFirstEvent != 0) // can happen if there are no events for this person
+			int numThreads = m_workerPool.getNumberOfThreads();
+			int start = (int)(((int64_t)numPeople*threadIdx)/numThreads);
+			int end = (int)(((int64_t)numPeople*(threadIdx+1))/numThreads);
+
+			for (int i = start ; i < end ; i++)
 			{
-				double t = pFirstEvent->getEventTime();
-				int threadIdx = omp_get_thread_num();
+				PopulationEvent *pFirstEvent = personalEventList(people[i])->getEarliestEvent();
 
-				if (m_tmpEarliestEvents[threadIdx] == 0 || t < m_tmpEarliestTimes[threadIdx])
+				if (pFirstEvent != 0) // can happen if there are no events for this person
 				{
-					m_tmpEarliestTimes[threadIdx] = t;
-					m_tmpEarliestEvents[threadIdx] = pFirstEvent;
+					double t = pFirstEvent->getEventTime();
+
+					if (m_tmpEarliestEvents[threadIdx] == 0 || t < m_tmpEarliestTimes[threadIdx])
+					{
+						m_tmpEarliestTimes[threadIdx] = t;
+						m_tmpEarliestEvents[threadIdx] = pFirstEvent;
+					}
 				}
 			}
-		}
+		});
 
 		for (size_t i = 0 ; i < m_tmpEarliestEvents.size() ; i++)
 		{
@@ -431,8 +734,17 @@ void PopulationAlgorithmAdvanced::onNewEvent(PopulationEvent *pEvt)
 		PersonBase *pGlobalEventPerson = m_people[0];
 		assert(pGlobalEventPerson->getGender() == PersonBase::GlobalEventDummy);
 
+		// When such an event fires, the global events are still affected since
+		// the dummy person is set as the event's person
 		pEvt->setGlobalEventPerson(pGlobalEventPerson);
-		personalEventList(pGlobalEventPerson)->registerPersonalEvent(pEvt);
+
+		if (pEvt->hasFixedFireTime())
+			m_fixedTimeEvents.addPendingEvent(pEvt);
+		else
+		{
+			personalEventList(pGlobalEventPerson)->registerPersonalEvent(pEvt);
+			m_pendingEvents++;
+		}
 	}
 	else
 	{
@@ -444,7 +756,103 @@ void PopulationAlgorithmAdvanced::onNewEvent(PopulationEvent *pEvt)
 
 			personalEventList(pPerson)->registerPersonalEvent(pEvt);
 		}
+		m_pendingEvents += numPersons;
+	}
+}
+
+void PopulationAlgorithmAdvanced::onNewEvents(PopulationEvent **ppEvents, int numEvents)
+{
+	assert(numEvents >= 0);
+
+	std::vector<PersonBase *> &m_people = m_popState.m_people; // TODO: rename m_people
+	PersonBase *pGlobalEventPerson = m_people[0];
+	assert(pGlobalEventPerson->getGender() == PersonBase::GlobalEventDummy);
+
+	// The IDs are assigned in the same order as when calling onNewEvent for
+	// each event, and global events are linked to the dummy person
+	for (int i = 0 ; i < numEvents ; i++)
+	{
+		PopulationEvent *pEvt = ppEvents[i];
+
+		assert(pEvt != 0);
+		assert(pEvt->getEventID() < 0);
+		assert(pEvt->isInitialized());
+
+		int64_t id = getNextEventID();
+		pEvt->setEventID(id);
+
+		if (pEvt->getNumberOfPersons() == 0)
+			pEvt->setGlobalEventPerson(pGlobalEventPerson);
+
+		if (isFixedTimeEvent(pEvt))
+			m_fixedTimeEvents.addPendingEvent(pEvt);
+		else
+			m_pendingEvents += pEvt->getNumberOfPersons();
+	}
+
+	if (!m_parallel || numEvents < 10000) // Not worth the effort to do this in parallel
+	{
+		for (int i = 0 ; i < numEvents ; i++)
+		{
+			PopulationEvent *pEvt = ppEvents[i];
+			int numPersons = (isFixedTimeEvent(pEvt))?0:pEvt->getNumberOfPersons();
+
+			for (int j = 0 ; j < numPersons ; j++)
+			{
+				assert(!pEvt->getPerson(j)->hasDied());
+				personalEventList(pEvt->getPerson(j))->registerPersonalEvent(pEvt);
+			}
+		}
+		return;
 	}
+
+#ifndef DISABLEOPENMP
+	// This is done in two steps. First, each thread examines a contiguous range
+	// of the new events, and sorts the registrations it finds according to the
+	// thread that's responsible for the personal list, based on the position of
+	// the person in m_people. Then each thread adds the registrations for its
+	// own lists, taking the ranges of the first step in order. This way no
+	// locking is needed, every event is only examined once, and every personal
+	// list receives its events in the same order as in the serial case.
+	const int numThreads = m_workerPool.getNumberOfThreads();
+
+	m_newEventBuckets.resize(numThreads*numThreads);
+
+	m_workerPool.execute([this, ppEvents, numEvents, numThreads](int threadIdx)
+	{
+		TraceSpan span("registerEvents");
+
+		std::vector<std::pair<PersonalEventList *, PopulationEvent *> > *pOwnBuckets = &m_newEventBuckets[threadIdx*numThreads];
+		const int start = (int)(((int64_t)numEvents*threadIdx)/numThreads);
+		const int end = (int)(((int64_t)numEvents*(threadIdx+1))/numThreads);
+
+		for (int i = start ; i < end ; i++)
+		{
+			PopulationEvent *pEvt = ppEvents[i];
+			int numPersons = (isFixedTimeEvent(pEvt))?0:pEvt->getNumberOfPersons();
+
+			for (int j = 0 ; j < numPersons ; j++)
+			{
+				PersonalEventList *pEvtList = personalEventList(pEvt->getPerson(j));
+
+				assert(!pEvt->getPerson(j)->hasDied());
+				pOwnBuckets[pEvtList->getListIndex() % numThreads].push_back(std::make_pair(pEvtList, pEvt));
+			}
+		}
+
+		m_workerPool.barrier();
+
+		for (int src = 0 ; src < numThreads ; src++)
+		{
+			std::vector<std::pair<PersonalEventList *, PopulationEvent *> > &bucket = m_newEventBuckets[src*numThreads + threadIdx];
+
+			for (size_t i = 0 ; i < bucket.size() ; i++)
+				bucket[i].first->registerPersonalEvent(bucket[i].second);
+
+			bucket.clear();
+		}
+	});
+#endif // !DISABLEOPENMP
 }
 
 #ifdef ALGORITHM_SHOW_EVENTS
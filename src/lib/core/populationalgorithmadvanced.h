@@ -12,7 +12,11 @@
 #include "populationinterfaces.h"
 #include "populationevent.h"
 #include "personaleventlist.h"
+#include "fixedtimeeventqueue.h"
+#include "workerpool.h"
 #include <assert.h>
+#include <vector>
+#include <utility>
 
 #ifdef STATE_SHOW_EVENTS
 #include <iostream>
@@ -82,6 +86,57 @@ class PopulationStateAdvanced;
  * Each person keeps track of which event in his list will fire first. To know which
  * event in the entire simulation will fire first, the algorithm then just needs to
  * check the first event times for all the people.
+ *
+ * #### Parallel version ####
+ *
+ * In the parallel version, the recalculation of the event times and the search for
+ * the earliest event are divided over the threads of a WorkerPool, the number of
+ * which is the one OpenMP would use (e.g. set by \c OMP_NUM_THREADS). Most steps of
+ * the algorithm only affect a few persons however, and then the cost of waking up
+ * the threads and waiting for all of them to finish is larger than the work itself.
+ * For this reason an estimate of the amount of work is kept, the number of events
+ * that were moved to the lists of events that need a recalculation, and only if this
+ * is at least PopulationAlgorithmAdvanced::getMinParallelEvents will this work
+ * be done by several threads (e.g. after an event for which PopulationEvent::isEveryoneAffected
+ * returns true). Similarly, the search for the earliest event is only done in
+ * parallel if the population contains at least PopulationAlgorithmAdvanced::getMinParallelPeople
+ * persons. The default values can be changed using the environment variables
+ * \c MNRM_PARALLEL_MINEVENTS and \c MNRM_PARALLEL_MINPEOPLE; setting them to zero
+ * causes every step to be done in parallel. The worker threads are started once
+ * and stay alive during the entire simulation. In between two parallel steps they
+ * first keep checking for new work, \c MNRM_POOL_SPINCOUNT times (zero by default
+ * if there are more threads than processor cores), and only then park themselves.
+ * If \c MNRM_POOL_PIN is set to a non-zero value, each thread is bound to its own
+ * processor core.
+ *
+ * Some lists can be much longer than the others, for example the list of the
+ * person that holds all global events. So that such a list does not keep one
+ * thread busy while the others are waiting, the lists of events that need a
+ * recalculation are divided in parts of at most PopulationAlgorithmAdvanced::getParallelChunkSize
+ * events (set by \c MNRM_PARALLEL_CHUNKSIZE, zero means that a list is never divided),
+ * which are distributed over the threads. If \c MNRM_PARALLEL_BUSYTIME is set, the
+ * time each thread spends on this work is measured and shown at the end of the
+ * simulation.
+ *
+ * #### Parking events ####
+ *
+ * Many events have fire times far in the future, or even after the end of the
+ * simulation. To avoid that these are examined each time the earliest event of
+ * a person needs to be determined, events that fire after PopulationAlgorithmAdvanced::getParkingTime
+ * are kept in a separate list of that person. This is disabled by default, and is enabled
+ * by setting the \c MNRM_PARKING_WINDOW environment variable to a positive window. The
+ * parking time is then the current time plus this window, but never later than the end
+ * of the simulation.
+ * When the simulation time comes within half a window of the parking time, it is moved
+ * forward and the events that now fire before it are moved back. A parked event is
+ * still recalculated as usual when one of its persons is affected by another event.
+ *
+ * #### Events with a fixed fire time ####
+ *
+ * Global events for which PopulationEvent::hasFixedFireTime returns \c true (e.g.
+ * periodic logging or interventions) are not stored in the list of the global dummy
+ * person, but in a FixedTimeEventQueue. Their fire time is calculated only once, and
+ * in each step the first event of this queue is compared to the earliest other event.
  */
 class PopulationAlgorithmAdvanced : public Algorithm, public PopulationAlgorithmInterface
 {
@@ -95,8 +150,28 @@ public:
 	bool_t init();
 
 	bool isParallel() const							{ return m_parallel; }
+
+	/** In the parallel version, returns the number of events that must need a
+	 *  recalculation before this is done using several threads. */
+	int getMinParallelEvents() const					{ return m_minParallelEvents; }
+
+	/** Returns the pool of threads that is used in the parallel version. */
+	WorkerPool &getWorkerPool()							{ return m_workerPool; }
+
+	/** In the parallel version, returns the number of persons that must be present
+	 *  before the earliest event is looked for using several threads. */
+	int getMinParallelPeople() const					{ return m_minParallelPeople; }
+
+	/** In the parallel version, returns the maximum number of events of a single person's
+	 *  list that are handled by one thread when recalculating event times. */
+	int getParallelChunkSize() const					{ return m_parallelChunkSize; }
+
+	/** Events that fire after this time are parked, i.e. kept apart from the events
+	 *  that are examined when looking for the earliest event. */
+	double getParkingTime() const						{ return m_parkingTime; }
 	bool_t run(double &tMax, int64_t &maxEvents, double startTime = 0);
 	void onNewEvent(PopulationEvent *pEvt);
+	void onNewEvents(PopulationEvent **ppEvents, int numEvents);
 
 	// TODO: shield these from the user somehow? These functions should not be used
 	//       directly by the user, they are used internally by the algorithm
@@ -106,14 +181,19 @@ public:
 
 	double getTime() const															{ return Algorithm::getTime(); }
 	GslRandomNumberGenerator *getRandomNumberGenerator() const						{ return Algorithm::getRandomNumberGenerator(); }
+	int64_t getNumberOfRejectedCandidates() const									{ return Algorithm::getNumberOfRejectedCandidates(); }
 
 	void setAboutToFireAction(PopulationAlgorithmAboutToFireInterface *pAction)		{ m_pOnAboutToFire = pAction; }
 private:
 	bool_t initEventTimes() const;
 	bool_t getNextScheduledEvent(double &dt, EventBase **ppEvt);
 	void advanceEventTimes(EventBase *pScheduledEvent, double dt);
+	void onRejectedCandidate(EventBase *pEvt);
 	void onAboutToFire(EventBase *pEvt);
 	PopulationEvent *getEarliestEvent(const std::vector<PersonBase *> &people);
+	void processUnsortedEventsParallel(double t0);
+	void moveParkingTime(double t);
+	PopulationEvent *getEarliestParkedEvent(const std::vector<PersonBase *> &people);
 	PersonalEventList *personalEventList(PersonBase *pPerson);
 
 	PopulationStateAdvanced &m_popState;
@@ -133,6 +213,8 @@ private:
 
 	// For the parallel version
 	bool m_parallel;
+	int m_minParallelEvents, m_minParallelPeople;
+	int64_t m_pendingEvents; // estimate of the number of events that need a recalculation
 
 	int64_t m_nextEventID;
 #ifndef DISABLEOPENMP
@@ -142,6 +224,37 @@ private:
 	std::vector<PopulationEvent *> m_tmpEarliestEvents;
 	std::vector<double> m_tmpEarliestTimes;
 
+	// Used by onNewEvents in the parallel version: bucket s*numThreads+d contains the
+	// registrations that thread s found for the lists that thread d is responsible for
+	std::vector<std::vector<std::pair<PersonalEventList *, PopulationEvent *> > > m_newEventBuckets;
+	WorkerPool m_workerPool;
+
+	// A long untimed list is divided into several work items in the parallel
+	// version, the earliest events of these parts are combined afterwards
+	class WorkItem
+	{
+	public:
+		WorkItem(PersonalEventList *pList, int start, int end) : m_pList(pList), m_start(start), m_end(end), m_pEarliestEvent(0) { }
+
+		PersonalEventList *m_pList;
+		int m_start, m_end;
+		PopulationEvent *m_pEarliestEvent;
+	};
+
+	int m_parallelChunkSize;
+	std::vector<WorkItem> m_workItems;
+	std::vector<int> m_workListStarts; // index of the first work item of each list, and a final one for the end
+	bool m_measureBusyTime;
+	std::vector<double> m_threadBusyTimes;
+
+	double m_parkingWindow, m_parkingTime, m_runEndTime;
+	int64_t m_numParkingMoves, m_numUnparked;
+
+	// Global events with a fixed fire time are kept here instead of in the
+	// list of the dummy person
+	static bool isFixedTimeEvent(const PopulationEvent *pEvt);
+	FixedTimeEventQueue m_fixedTimeEvents;
+
 #ifndef DISABLEOPENMP
 	mutable std::vector<Mutex> m_eventMutexes;
 #endif // !DISABLEOPENMP
@@ -184,4 +297,10 @@ inline void PopulationAlgorithmAdvanced::onAboutToFire(EventBase *pEvt)
 		m_pOnAboutToFire->onAboutToFire(static_cast<PopulationEvent *>(pEvt)); 
 }
 
+inline bool PopulationAlgorithmAdvanced::isFixedTimeEvent(const PopulationEvent *pEvt)
+{
+	// The global event person must already have been set
+	return pEvt->hasFixedFireTime() && pEvt->getPerson(0)->getGender() == PersonBase::GlobalEventDummy;
+}
+
 #endif // POPULATIONALGORITHMADVANCED_H
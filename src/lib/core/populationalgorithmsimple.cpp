@@ -100,6 +100,25 @@ void PopulationAlgorithmSimple::onNewEvent(PopulationEvent *pEvt)
 	m_allEvents.push_back(pEvt);
 }
 
+void PopulationAlgorithmSimple::onNewEvents(PopulationEvent **ppEvents, int numEvents)
+{
+	assert(numEvents >= 0);
+
+	for (int i = 0 ; i < numEvents ; i++)
+	{
+		PopulationEvent *pEvt = ppEvents[i];
+
+		assert(pEvt != 0);
+		assert(pEvt->getEventID() < 0);
+		assert(pEvt->isInitialized());
+
+		int64_t id = getNextEventID();
+		pEvt->setEventID(id);
+
+		m_allEvents.push_back(pEvt);
+	}
+}
+
 void PopulationAlgorithmSimple::onFiredEvent(EventBase *pEvt, int position)
 {
 	int lastEvent = m_allEvents.size()-1;
@@ -52,6 +52,7 @@ public:
 	bool_t init();
 	bool_t run(double &tMax, int64_t &maxEvents, double startTime = 0);
 	void onNewEvent(PopulationEvent *pEvt);
+	void onNewEvents(PopulationEvent **ppEvents, int numEvents);
 
 	// TODO: shield these from the user somehow? These functions should not be used
 	//       directly by the user, they are used internally by the algorithm
@@ -61,6 +62,7 @@ public:
 
 	void setAboutToFireAction(PopulationAlgorithmAboutToFireInterface *pAction)		{ m_pOnAboutToFire = pAction; }
 	GslRandomNumberGenerator *getRandomNumberGenerator() const						{ return SimpleAlgorithm::getRandomNumberGenerator(); }
+	int64_t getNumberOfRejectedCandidates() const									{ return SimpleAlgorithm::getNumberOfRejectedCandidates(); }
 private:
 	bool_t initEventTimes() const;
 	const std::vector<EventBase *> &getCurrentEvents() const					{ return m_allEvents; }
@@ -6,9 +6,12 @@
 #include "debugwarning.h"
 #include "util.h"
 #include "debugtimer.h"
+#include "eventtracer.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <iostream>
+#include <algorithm>
+#include <limits>
 
 // FOR DEBUGGING
 #include <map>
@@ -22,11 +25,20 @@
 #define POPULATION_ALWAYS_RECALCULATE_FLAG 0
 #endif
 
+// Events that fire more than this time after the current time are parked, can
+// be overridden by MNRM_PARKING_WINDOW (zero disables parking)
+#define POPULATIONALGORITHMTESTING_PARKINGWINDOW 0
+
 PopulationAlgorithmTesting::PopulationAlgorithmTesting(PopulationStateTesting &popState, GslRandomNumberGenerator &rng,
 		                                 bool parallel) : Algorithm(popState, rng), m_popState(popState)
 {
 	m_init = false;
 	m_parallel = parallel; // Just save the setting for now, in 'init' we may change this
+	m_parkingWindow = POPULATIONALGORITHMTESTING_PARKINGWINDOW;
+	m_parkingTime = std::numeric_limits<double>::infinity();
+	m_runEndTime = std::numeric_limits<double>::infinity();
+	m_numParkingMoves = 0;
+	m_numUnparked = 0;
 	m_pOnAboutToFire = 0;
 }
 
@@ -56,6 +68,13 @@ bool_t PopulationAlgorithmTesting::init()
 
 	m_nextEventID = 0;
 
+	char *pParkStr = getenv("MNRM_PARKING_WINDOW");
+	if (pParkStr)
+		m_parkingWindow = strtod(pParkStr, 0);
+
+	if (m_parkingWindow > 0)
+		std::cerr << "# PopulationAlgorithmTesting: parking events more than " << m_parkingWindow << " after the current time" << std::endl;
+
 	m_init = true;
 	return true;
 }
@@ -65,7 +84,25 @@ bool_t PopulationAlgorithmTesting::run(double &tMax, int64_t &maxEvents, double
 	if (!m_init)
 		return "Not initialized";
 
-	return Algorithm::evolve(tMax, maxEvents, startTime, false);
+	if (m_parkingWindow > 0)
+	{
+		m_runEndTime = tMax;
+		moveParkingTime(std::min(startTime + m_parkingWindow, m_runEndTime));
+	}
+
+	bool_t r = Algorithm::evolve(tMax, maxEvents, startTime, false);
+
+	if (m_parkingWindow > 0)
+	{
+		int64_t numParked = 0;
+		for (size_t i = 0 ; i < m_popState.m_people.size() ; i++)
+			numParked += personalEventList(m_popState.m_people[i])->getNumberOfParkedEvents();
+
+		std::cerr << "# PopulationAlgorithmTesting: moved parking time " << m_numParkingMoves << " times, brought back " 
+		          << m_numUnparked << " parked events, " << numParked << " events still parked" << std::endl;
+	}
+
+	return r;
 }
 
 // Each loop we'll delete events that may be deleted
@@ -109,10 +146,20 @@ bool_t PopulationAlgorithmTesting::getNextScheduledEvent(double &dt, EventBase *
 	pProcessTimer->start();
 #endif // ALGORITHM_DEBUG_TIMER
 
+	bool profile = EventProfiler::isEnabled();
+	bool timing = profile || EventTracer::isTracingStep();
+	int64_t tPhase = (timing)?EventProfiler::getTimestamp():0;
+
+	// Bring back the parked events when the time approaches the parking time
+	if (m_parkingWindow > 0 && m_parkingTime < m_runEndTime && curTime > m_parkingTime - 0.5*m_parkingWindow)
+		moveParkingTime(std::min(curTime + m_parkingWindow, m_runEndTime));
+
 	assert(!m_parallel);
 	for (size_t i = 0 ; i < m_people.size() ; i++)
 		personalEventList(m_people[i])->processUnsortedEvents(*this, m_popState, curTime);
 
+	m_fixedTimeEvents.processPendingEvents(&m_popState, curTime);
+
 	// TODO: can this be done in a faster way? 
 	// If we still need to iterate over everyone, perhaps there's
 	// really no point in trying to use an m_firstEventTracker?
@@ -121,6 +168,9 @@ bool_t PopulationAlgorithmTesting::getNextScheduledEvent(double &dt, EventBase *
 	pProcessTimer->stop();
 #endif // ALGORITHM_DEBUG_TIMER
 
+	if (timing)
+		tPhase = EventTracer::endPhase(EventProfiler::ProcessUnsortedEvents, tPhase, profile);
+
 #ifdef ALGORITHM_SHOW_EVENTS
 	showEvents();
 #endif // ALGORITHM_SHOW_EVENTS
@@ -133,17 +183,37 @@ bool_t PopulationAlgorithmTesting::getNextScheduledEvent(double &dt, EventBase *
 	// Then, we should look for the event that happens first
 	PopulationEvent *pEarliestEvent = getEarliestEvent(m_people);
 
+	// If nothing was found, the remaining events are all parked
+	if (pEarliestEvent == 0 && m_parkingWindow > 0)
+		pEarliestEvent = getEarliestParkedEvent(m_people);
+
+	// Compare with the first event that has a fixed fire time. On equal times
+	// this one goes first, just like the global events in the list of the dummy
+	// person do
+	PopulationEvent *pFixedTimeEvent = m_fixedTimeEvents.getFirstEvent();
+	bool isFixedTimeEvent = false;
+
+	if (pFixedTimeEvent && (pEarliestEvent == 0 || pFixedTimeEvent->getEventTime() <= pEarliestEvent->getEventTime()))
+	{
+		m_fixedTimeEvents.removeFirstEvent();
+		pEarliestEvent = pFixedTimeEvent;
+		isFixedTimeEvent = true;
+	}
+
 #ifdef ALGORITHM_DEBUG_TIMER
 	pInternEarliestTimer->stop();
 #endif // ALGORITHM_DEBUG_TIMER
 
+	if (timing)
+		EventTracer::endPhase(EventProfiler::GetEarliestEvent, tPhase, profile);
+
 	// Once we've found the first event, we must remove it from the
 	// relevant Person's lists
 
 	if (pEarliestEvent == 0)
 		return "No event found";
 
-	int numPersons = pEarliestEvent->getNumberOfPersons();
+	int numPersons = (isFixedTimeEvent)?0:pEarliestEvent->getNumberOfPersons();
 	for (int i = 0 ; i < numPersons ; i++)
 	{
 		PersonBase *pPerson = pEarliestEvent->getPerson(i);
@@ -172,6 +242,51 @@ bool_t PopulationAlgorithmTesting::getNextScheduledEvent(double &dt, EventBase *
 	return true;
 }
 
+void PopulationAlgorithmTesting::moveParkingTime(double t)
+{
+	std::vector<PersonBase *> &people = m_popState.m_people;
+
+	m_parkingTime = t;
+	for (size_t i = 0 ; i < people.size() ; i++)
+		m_numUnparked += personalEventList(people[i])->unparkEvents(t);
+
+	m_numParkingMoves++;
+}
+
+PopulationEvent *PopulationAlgorithmTesting::getEarliestParkedEvent(const std::vector<PersonBase *> &people)
+{
+	PopulationEvent *pEarliestEvent = 0;
+
+	// The stored times of the parked events are only lower bounds, but each
+	// time a list is examined they become exact
+	while (pEarliestEvent == 0)
+	{
+		double tMin = std::numeric_limits<double>::infinity();
+		bool foundParked = false;
+
+		for (size_t i = 0 ; i < people.size() ; i++)
+		{
+			PersonalEventListTesting *pList = personalEventList(people[i]);
+
+			if (pList->getNumberOfParkedEvents() > 0)
+			{
+				foundParked = true;
+				tMin = std::min(tMin, pList->getParkedEarliestTime());
+			}
+		}
+
+		if (!foundParked)
+			break;
+
+		// This can be after the end of the simulation, in which case the
+		// simulation will stop after this event
+		moveParkingTime(std::max(tMin, m_parkingTime));
+		pEarliestEvent = getEarliestEvent(people);
+	}
+
+	return pEarliestEvent;
+}
+
 // all affected event times should be recalculated, again note that an event pointer
 // can be present in both the a man's list and a woman's list
 void PopulationAlgorithmTesting::advanceEventTimes(EventBase *pScheduledEvent, double dt)
@@ -251,6 +366,27 @@ void PopulationAlgorithmTesting::advanceEventTimes(EventBase *pScheduledEvent, d
 	}
 }
 
+// The candidate time of this event was rejected, which doesn't change the
+// state. getNextScheduledEvent already removed the event from the lists of
+// the persons involved, so it only needs to be added to those lists again
+// (a new internal time difference has already been generated).
+void PopulationAlgorithmTesting::onRejectedCandidate(EventBase *pScheduledEvent)
+{
+	assert(m_init);
+
+	PopulationEvent *pEvt = static_cast<PopulationEvent *>(pScheduledEvent);
+	int numPersons = pEvt->getNumberOfPersons();
+
+	for (int i = 0 ; i < numPersons ; i++)
+	{
+		PersonBase *pPerson = pEvt->getPerson(i);
+
+		assert(pPerson != 0);
+
+		personalEventList(pPerson)->registerPersonalEvent(pEvt);
+	}
+}
+
 PopulationEvent *PopulationAlgorithmTesting::getEarliestEvent(const std::vector<PersonBase *> &people)
 {
 	if (!m_init)
@@ -296,6 +432,30 @@ void PopulationAlgorithmTesting::onNewEvent(PopulationEvent *pEvt)
 	assert(!pEvt->isInitialized());
 	pEvt->generateNewInternalTimeDifference(getRandomNumberGenerator(), &m_popState);
 
+	registerEvent(pEvt);
+}
+
+void PopulationAlgorithmTesting::onNewEvents(PopulationEvent **ppEvents, int numEvents)
+{
+	assert(numEvents >= 0);
+
+	for (int i = 0 ; i < numEvents ; i++)
+	{
+		PopulationEvent *pEvt = ppEvents[i];
+
+		assert(pEvt != 0);
+		assert(pEvt->getEventID() < 0);
+		assert(pEvt->isInitialized());
+
+		int64_t id = getNextEventID();
+		pEvt->setEventID(id);
+
+		registerEvent(pEvt);
+	}
+}
+
+void PopulationAlgorithmTesting::registerEvent(PopulationEvent *pEvt)
+{
 	int numPersons = pEvt->getNumberOfPersons();
 	std::vector<PersonBase *> &m_people = m_popState.m_people; // TODO: rename m_people
 
@@ -304,8 +464,14 @@ void PopulationAlgorithmTesting::onNewEvent(PopulationEvent *pEvt)
 		PersonBase *pGlobalEventPerson = m_people[0];
 		assert(pGlobalEventPerson->getGender() == PersonBase::GlobalEventDummy);
 
+		// When such an event fires, the global events are still affected since
+		// the dummy person is set as the event's person
 		pEvt->setGlobalEventPerson(pGlobalEventPerson);
-		personalEventList(pGlobalEventPerson)->registerPersonalEvent(pEvt);
+
+		if (pEvt->hasFixedFireTime())
+			m_fixedTimeEvents.addPendingEvent(pEvt);
+		else
+			personalEventList(pGlobalEventPerson)->registerPersonalEvent(pEvt);
 	}
 	else
 	{
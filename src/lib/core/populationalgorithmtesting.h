@@ -12,6 +12,7 @@
 #include "populationinterfaces.h"
 #include "populationevent.h"
 #include "personaleventlisttesting.h"
+#include "fixedtimeeventqueue.h"
 #include <assert.h>
 
 class GslRandomNumberGenerator;
@@ -78,6 +79,11 @@ class PopulationStateTesting;
  * Each person keeps track of which event in his list will fire first. To know which
  * event in the entire simulation will fire first, the algorithm then just needs to
  * check the first event times for all the people.
+ *
+ * Events that fire after PopulationAlgorithmTesting::getParkingTime are parked in the
+ * same way as described for PopulationAlgorithmAdvanced, using the \c MNRM_PARKING_WINDOW
+ * environment variable for the window. Global events with a fixed fire time are kept
+ * in a FixedTimeEventQueue, as is done in that class too.
  */
 class PopulationAlgorithmTesting : public Algorithm, public PopulationAlgorithmInterface
 {
@@ -93,6 +99,7 @@ public:
 	bool isParallel() const							{ return m_parallel; }
 	bool_t run(double &tMax, int64_t &maxEvents, double startTime = 0);
 	void onNewEvent(PopulationEvent *pEvt);
+	void onNewEvents(PopulationEvent **ppEvents, int numEvents);
 
 	// TODO: shield these from the user somehow? These functions should not be used
 	//       directly by the user, they are used internally by the algorithm
@@ -100,15 +107,24 @@ public:
 
 	double getTime() const															{ return Algorithm::getTime(); }
 	GslRandomNumberGenerator *getRandomNumberGenerator() const						{ return Algorithm::getRandomNumberGenerator(); }
+	int64_t getNumberOfRejectedCandidates() const									{ return Algorithm::getNumberOfRejectedCandidates(); }
+
+	/** Events that fire after this time are parked, i.e. kept apart from the events
+	 *  that are examined when looking for the earliest event. */
+	double getParkingTime() const													{ return m_parkingTime; }
 
 	void setAboutToFireAction(PopulationAlgorithmAboutToFireInterface *pAction)		{ m_pOnAboutToFire = pAction; }
 private:
 	bool_t initEventTimes() const;
 	bool_t getNextScheduledEvent(double &dt, EventBase **ppEvt);
 	void advanceEventTimes(EventBase *pScheduledEvent, double dt);
+	void onRejectedCandidate(EventBase *pEvt);
 	void onAboutToFire(EventBase *pEvt)												{ if (m_pOnAboutToFire) m_pOnAboutToFire->onAboutToFire(static_cast<PopulationEvent *>(pEvt)); }
 	PopulationEvent *getEarliestEvent(const std::vector<PersonBase *> &people);
+	void moveParkingTime(double t);
+	PopulationEvent *getEarliestParkedEvent(const std::vector<PersonBase *> &people);
 	PersonalEventListTesting *personalEventList(PersonBase *pPerson);
+	void registerEvent(PopulationEvent *pEvt);
 
 	PopulationStateTesting &m_popState;
 	bool m_init;
@@ -127,6 +143,11 @@ private:
 
 	int64_t m_nextEventID;
 
+	double m_parkingWindow, m_parkingTime, m_runEndTime;
+	int64_t m_numParkingMoves, m_numUnparked;
+
+	FixedTimeEventQueue m_fixedTimeEvents;
+
 	PopulationAlgorithmAboutToFireInterface *m_pOnAboutToFire;
 };
 
@@ -82,10 +82,19 @@ bool PopulationEvent::isNoLongerUseful(const PopulationStateInterface &populatio
 		assert(m_pPersons[i] != 0);
 
 		if (m_pPersons[i]->hasDied())
+		{
+			if (EventProfiler::isEnabled())
+				EventProfiler::getProfile(this)->countDiscarded();
 			return true;
+		}
 	}
 
-	return isUseless(population);
+	if (!isUseless(population))
+		return false;
+
+	if (EventProfiler::isEnabled())
+		EventProfiler::getProfile(this)->countDiscarded();
+	return true;
 }
 
 
@@ -105,6 +105,14 @@ public:
 	 *  can be overridden to indicate this. */
 	virtual bool areGlobalEventsAffected() const						{ return false; }
 
+	/** A global event can override this to return \c true if its fire time does not
+	 *  depend on the simulation state, i.e. if it is completely determined by
+	 *  EventBase::getNewInternalTimeDifference and the event uses the default
+	 *  \f$ \Delta T = dt \f$ mapping. The 'opt' algorithms then keep it in a separate
+	 *  queue instead of in the list of the global 'dummy' person, and its fire time will
+	 *  never be recalculated. For events that involve persons, this is ignored. */
+	virtual bool hasFixedFireTime() const							{ return false; }
+
 	/** Returns a short description of the event, can be useful for logging/debugging
 	 *  purposes. This does not need to be re-implemented if you're using another
 	 *  description for logging purposes, but this description may be helpful when
@@ -208,6 +216,10 @@ inline void PopulationEvent::setEventID(int64_t id)
 	assert(m_eventID < 0); 
 	assert(id >= 0); 
 	m_eventID = id; 
+
+	// Each event gets an ID exactly once, when it's handed to the algorithm
+	if (EventProfiler::isEnabled())
+		EventProfiler::getProfile(this)->countCreated();
 }
 
 inline int64_t PopulationEvent::getEventID() const								
@@ -132,11 +132,24 @@ public:
 	 *  this function. */
 	virtual void onNewEvent(PopulationEvent *pEvt) = 0;
 
+	/** Injects \c numEvents new events into the simulation at once, e.g. the initial
+	 *  events of a simulation. Event IDs are assigned in the order of the array, just
+	 *  as if PopulationAlgorithmInterface::onNewEvent were called for each event, but
+	 *  unlike that function the internal time differences must already have been
+	 *  generated (see EventBase::generateNewInternalTimeDifference). This allows the
+	 *  caller to draw these from several random number generators, for example in
+	 *  parallel. */
+	virtual void onNewEvents(PopulationEvent **ppEvents, int numEvents) = 0;
+
 	/** Must return the simulation tilme of the algorithm. */
 	virtual double getTime() const = 0;
 
 	/** Must return the random number generator used by the algorithm. */
 	virtual GslRandomNumberGenerator *getRandomNumberGenerator() const = 0;
+
+	/** Must return the number of candidate event times that were rejected in the
+	 *  last run (see EventBase::isCandidateAccepted). */
+	virtual int64_t getNumberOfRejectedCandidates() const = 0;
 };
 
 /** Base class to be able to store algorithm-specific information in the
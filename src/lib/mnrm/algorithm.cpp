@@ -3,7 +3,10 @@
 #include "gslrandomnumbergenerator.h"
 #include "debugwarning.h"
 #include "debugtimer.h"
+#include "eventprofiler.h"
+#include "eventtracer.h"
 #include "mutex.h"
+#include "util.h"
 #include <assert.h>
 #include <iostream>
 #include <limits>
@@ -49,6 +52,7 @@ Algorithm::Algorithm(State &state, GslRandomNumberGenerator &rng)
 	m_pRndGen = &rng;
 	m_pState = &state;
 	m_time = 0;
+	m_rejectedCount = 0;
 
 #ifdef ALGORITHM_SHOW_EVENTS
 	DEBUGWARNING("debug code to list events is enabled")
@@ -74,12 +78,20 @@ bool_t Algorithm::evolve(double &tMax, int64_t &maxEvents, double startTime, boo
 	bool done = false;
 	int64_t eventCount = 0;
 
+	m_rejectedCount = 0;
+
 #ifdef ALGORITHM_DEBUG_TIMER
 	DebugTimer *pLoopTimer = DebugTimer::getTimer("loop");
 	DebugTimer *pNextTimer = DebugTimer::getTimer("getNextScheduledEvent");
 	DebugTimer *pAdvanceTimer = DebugTimer::getTimer("advanceEventTimes");
 #endif // ALGORITHM_DEBUG_TIMER
 
+	// Only when profiling or tracing, time stamps are needed to keep track of
+	// the time spent in the different phases
+	bool profile = EventProfiler::isEnabled();
+	bool timing = false;
+	int64_t tPhase = 0;
+
 	// Clear the abort flag
 	m_pState->clearAbort();
 
@@ -101,12 +113,21 @@ bool_t Algorithm::evolve(double &tMax, int64_t &maxEvents, double startTime, boo
 		pNextTimer->start();
 #endif // ALGORITHM_DEBUG_TIMER
 
+		EventTracer::beginStep();
+
+		timing = profile || EventTracer::isTracingStep();
+		if (timing)
+			tPhase = EventProfiler::getTimestamp();
+
 		bool_t r = getNextScheduledEvent(dtMin, &pNextScheduledEvent);
 
 #ifdef ALGORITHM_DEBUG_TIMER
 		pNextTimer->stop();
 #endif // ALGORITHM_DEBUG_TIMER
 
+		if (timing)
+			tPhase = EventTracer::endPhase(EventProfiler::GetNextScheduledEvent, tPhase, profile);
+
 		if (!r)
 		{
 			tMax = m_time;
@@ -117,6 +138,40 @@ bool_t Algorithm::evolve(double &tMax, int64_t &maxEvents, double startTime, boo
 		//std::cerr << "dtMin = " << dtMin << std::endl;
 		assert(dtMin >= 0);
 
+		if (dtMin != dtMin)
+		{
+			tMax = m_time;
+			maxEvents = eventCount;
+			return "Next event takes place after NaN time interval";
+		}
+
+		// When thinning is used, the event may still decide not to fire at this
+		// time. In that case the state doesn't change, so the other events are
+		// not affected and only this one needs a new internal time difference.
+		if (!pNextScheduledEvent->isCandidateAccepted(m_pRndGen, m_pState, m_time + dtMin))
+		{
+			m_time += dtMin;
+			m_pState->setTime(m_time);
+
+			pNextScheduledEvent->generateNewInternalTimeDifference(m_pRndGen, m_pState);
+			onRejectedCandidate(pNextScheduledEvent);
+			m_rejectedCount++;
+
+			if (profile)
+				EventProfiler::getProfile(pNextScheduledEvent)->countRejected();
+
+			if (m_time > tMax)
+				done = true;
+
+			onAlgorithmLoop(done);
+			EventTracer::endStep();
+
+#ifdef ALGORITHM_DEBUG_TIMER
+			pLoopTimer->stop();
+#endif // ALGORITHM_DEBUG_TIMER
+			continue;
+		}
+
 #ifdef ALGORITHM_DEBUG_TIMER
 		pAdvanceTimer->start();
 #endif // ALGORITHM_DEBUG_TIMER
@@ -127,22 +182,33 @@ bool_t Algorithm::evolve(double &tMax, int64_t &maxEvents, double startTime, boo
 #ifdef ALGORITHM_DEBUG_TIMER
 		pAdvanceTimer->stop();
 #endif // ALGORITHM_DEBUG_TIMER
+
+		if (timing)
+			tPhase = EventTracer::endPhase(EventProfiler::AdvanceEventTimes, tPhase, profile);
 	
 		// ok, advance time and fire the event, which may adjust the current state
 		// and generate a new internal time difference
 
-		if (dtMin != dtMin)
-		{
-			tMax = m_time;
-			maxEvents = eventCount;
-			return "Next event takes place after NaN time interval";
-		}
-
 		m_time += dtMin;
 		m_pState->setTime(m_time);
 
 		onAboutToFire(pNextScheduledEvent);
-		pNextScheduledEvent->fire(this, m_pState, m_time);
+
+		if (timing)
+		{
+			// Only the time spent in 'fire' itself is attributed to the event type
+			int64_t tFire = EventProfiler::getTimestamp();
+			pNextScheduledEvent->fire(this, m_pState, m_time);
+			int64_t tFired = EventProfiler::getTimestamp();
+
+			EventTypeProfile *pProfile = EventProfiler::getProfile(pNextScheduledEvent);
+			if (profile)
+				pProfile->countFired(tFired - tFire);
+			if (EventTracer::isTracingStep())
+				EventTracer::addSpan(pProfile->getName(), tFire, tFired, strprintf("\"t\": %.10f", m_time));
+		}
+		else
+			pNextScheduledEvent->fire(this, m_pState, m_time);
 
 		// If the event is still being used (the default) we'll need a new random number
 		if (!pNextScheduledEvent->willBeRemoved())
@@ -156,6 +222,10 @@ bool_t Algorithm::evolve(double &tMax, int64_t &maxEvents, double startTime, boo
 		onFiredEvent(pNextScheduledEvent);
 		onAlgorithmLoop(done);
 
+		if (timing)
+			EventTracer::endPhase(EventProfiler::FireEvent, tPhase, profile);
+		EventTracer::endStep();
+
 #ifdef ALGORITHM_DEBUG_TIMER
 		pLoopTimer->stop();
 #endif // ALGORITHM_DEBUG_TIMER
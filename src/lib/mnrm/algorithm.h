@@ -116,6 +116,21 @@ public:
 	 *  	if (pNextScheduledEvent == 0)
 	 *  		return false;
 	 *  
+	 *  	if (!pNextScheduledEvent->isCandidateAccepted(m_pRndGen, m_pState, m_time + dtMin))
+	 *  	{
+	 *  		// Nothing happens, only the internal clock of this event is reset
+	 *  		m_time += dtMin;
+	 *  		pNextScheduledEvent->generateNewInternalTimeDifference(m_pRndGen, this);
+	 *  		onRejectedCandidate(pNextScheduledEvent);
+	 *  		rejectedCount++;
+	 *  
+	 *  		if (m_time > tMax)
+	 *  			done = true;
+	 *  
+	 *  		onAlgorithmLoop(done);
+	 *  		continue;
+	 *  	}
+	 *  
 	 *  	advanceEventTimes(pNextScheduledEvent, dtMin);
 	 *  
 	 *  	m_time += dtMin;
@@ -148,12 +163,18 @@ public:
 	 *   - onAboutToFire: called right before an event will fire
 	 *   - onFiredEvent: called right after an event fired
 	 *   - onAboutToFire: called when the algoritm is going to loop
+	 *   - onRejectedCandidate: called when an event did not accept its candidate fire time
 	 */
 	bool_t evolve(double &tMax, int64_t &maxEvents, double startTime = 0, bool initEvents = true);
 
 	/** This function returns the current time of the simulation. */
 	double getTime() const										{ return m_time; }
 
+	/** Returns the number of candidate fire times that were rejected during the
+	 *  last call to Algorithm::evolve (see EventBase::isCandidateAccepted). These
+	 *  are not included in the number of events that were executed. */
+	int64_t getNumberOfRejectedCandidates() const							{ return m_rejectedCount; }
+
 	/** Returns the random number generator that was specified in the constructor. */
 	GslRandomNumberGenerator *getRandomNumberGenerator() const					{ return m_pRndGen; }
 protected:
@@ -175,6 +196,13 @@ protected:
 	/** Called right before pEvt is fired. */
 	virtual void onAboutToFire(EventBase *pEvt)							{ }
 
+	/** Called when pEvt did not accept its candidate fire time. The simulation
+	 *  time has already been advanced to that time and a new internal time difference
+	 *  has been generated for the event; since the state did not change, no other
+	 *  event needs to be updated. The event itself must be scheduled again though,
+	 *  for example if Algorithm::getNextScheduledEvent removed it from some list. */
+	virtual void onRejectedCandidate(EventBase *pEvt)						{ }
+
 	/** Called after pEvt is fired. */
 	virtual void onFiredEvent(EventBase *pEvt)							{ }
 
@@ -185,6 +213,7 @@ private:
 	mutable GslRandomNumberGenerator *m_pRndGen;
 	State *m_pState;
 	double m_time;
+	int64_t m_rejectedCount;
 };
 
 #endif // ALGORITHM_H
@@ -13,6 +13,7 @@ EventBase::EventBase()
 	m_tLastCalc = -1;
 	m_tEvent = -2;
 	m_willBeRemoved = false;
+	m_profileSlot = -1;
 
 #ifndef NDEBUG
 	if (s_checkInverse)
@@ -7,12 +7,32 @@
  */
 
 #include "algorithm.h"
+#include "eventprofiler.h"
 #include <assert.h>
 #include <stdlib.h>
 #include <iostream>
 #include <cmath>
 
 class GslRandomNumberGenerator;
+class EventBase;
+
+/** An event can use an instance of this class to calculate its real world fire
+ *  time together with the ones of other events of the same kind, see EventBase::getBatchSolver.
+ */
+class EventBatchSolver
+{
+public:
+	virtual ~EventBatchSolver()									{ }
+
+	/** For each of the \c num events in \c ppEvents, this should store the real world
+	 *  time interval \f$ dt \f$ that corresponds to the internal time interval in
+	 *  \c pTdiff in \c pDt, exactly like EventBase::solveForRealTimeInterval would do
+	 *  for a single event. The events themselves must not be modified, this function
+	 *  can be called for events that are being examined by other threads as well.
+	 */
+	virtual void solveForRealTimeIntervals(const State *pState, EventBase * const *ppEvents, 
+	                                       const double *pTdiff, int num, double t0, double *pDt) = 0;
+};
 
 // IMPORTANT: this is only meant for positive times! we use a negative
 // event time to indicate that a recalculation is necessary
@@ -74,6 +94,23 @@ public:
 	 */
 	virtual void fire(Algorithm *pAlgorithm, State *pState, double t);
 
+	/** This function is called right before the event would fire at time \c t, and
+	 *  allows an event to use thinning to sample its fire times.
+	 *
+	 *  In that case, EventBase::calculateInternalTimeInterval and EventBase::solveForRealTimeInterval
+	 *  do not use the hazard \f$ h(X(t_0), s) \f$ itself, but an upper bound \f$ \bar{h} \f$ for it
+	 *  that's valid from \f$ t_0 \f$ on (as long as the state does not change). This makes
+	 *  these functions trivial to implement, but a candidate fire time obtained this way must
+	 *  then only be accepted with probability \f$ h(X(t_0), t)/\bar{h} \f$, which is what this
+	 *  function should decide using \c pRndGen.
+	 *
+	 *  If the candidate is rejected, the event does not fire and the state is left unchanged;
+	 *  the simulation time is advanced to \c t and a new internal time difference is
+	 *  generated for the event. By default, every candidate is accepted without using the
+	 *  random number generator.
+	 */
+	virtual bool isCandidateAccepted(GslRandomNumberGenerator *pRndGen, const State *pState, double t)	{ return true; }
+
 	// This calls a virtual function so that a derived class can use another distribution for example,
 	// and does not need to limit itself to a poisson process
 	// Normally the state isn't needed, but it may come in handy, especially when
@@ -86,6 +123,19 @@ public:
 	// always calculate with current state
 	double solveForRealTimeInterval(const State *pState, double t0);
 
+	/** If the event's fire time can be calculated by an EventBatchSolver, together with
+	 *  the ones of other events that return the same solver, this function should
+	 *  return that solver. The algorithm then stores the result using EventBase::setRealTimeInterval
+	 *  instead of calling EventBase::solveForRealTimeInterval. By default, null is
+	 *  returned and the event is handled on its own. This is only called when
+	 *  EventBase::needsEventTimeCalculation returns true.
+	 */
+	virtual EventBatchSolver *getBatchSolver(const State *pState)				{ return 0; }
+
+	// Stores the real world time interval dt, calculated at time t0 by the event's
+	// batch solver; EventBase::onBatchRealTimeInterval is called first
+	void setRealTimeInterval(const State *pState, double t0, double dt);
+
 	// Note that this doesn't need to be called if the propensity hasn't changed. It is
 	// for that reason that we also store m_tLastCalc
 	void subtractInternalTimeInterval(const State *pState, double t1);
@@ -145,17 +195,44 @@ protected:
 	 *  corresponding to the trivial mapping \f$ \Delta T = dt \f$.
 	 */
 	virtual double solveForRealTimeInterval(const State *pState, double Tdiff, double t0);
+
+	/** Called by EventBase::setRealTimeInterval before the fire time that was calculated
+	 *  by the event's batch solver is stored. An event that keeps information from its
+	 *  last call to EventBase::solveForRealTimeInterval can reset it here, since that
+	 *  function was not used this time. By default nothing is done.
+	 */
+	virtual void onBatchRealTimeInterval()									{ }
 private:
+	void storeRealTimeInterval(const State *pState, double t0, double dt);
+
 	double m_Tdiff;
 	double m_tLastCalc;
 	double m_tEvent; // we'll also use this as a marker to indicate that recalculation is needed
 
 	bool m_willBeRemoved;
+
+	// The EventProfiler slot of this type of event, -1 until the event is first
+	// counted. An event is only handled by one thread at a time, and every
+	// thread would store the same value
+	mutable int32_t m_profileSlot;
+	friend class EventProfiler;
 #ifndef NDEBUG
 	static bool s_checkInverse;
 #endif // !NDEBUG
 };
 
+inline EventTypeProfile *EventProfiler::getProfile(const EventBase *pEvt)
+{
+	int32_t slot = pEvt->m_profileSlot;
+
+	if (slot < 0)
+	{
+		slot = getProfileSlot(typeid(*pEvt));
+		pEvt->m_profileSlot = slot;
+	}
+	return s_pProfileSlots[slot];
+}
+
 inline double EventBase::solveForRealTimeInterval(const State *pState, double t0)
 {
 	if (!needsEventTimeCalculation())
@@ -166,8 +243,25 @@ inline double EventBase::solveForRealTimeInterval(const State *pState, double t0
 	}
 
 	double dt = solveForRealTimeInterval(pState, m_Tdiff, t0);
+	storeRealTimeInterval(pState, t0, dt);
+
+	return dt;
+}
+
+inline void EventBase::setRealTimeInterval(const State *pState, double t0, double dt)
+{
+	onBatchRealTimeInterval();
+	storeRealTimeInterval(pState, t0, dt);
+}
+
+inline void EventBase::storeRealTimeInterval(const State *pState, double t0, double dt)
+{
+	assert(needsEventTimeCalculation());
 	assert(dt >= 0);
 
+	if (EventProfiler::isEnabled())
+		EventProfiler::getProfile(this)->countRealTimeCalculation();
+
 #ifndef NDEBUG
 	if (s_checkInverse)
 	{
@@ -190,8 +284,6 @@ inline double EventBase::solveForRealTimeInterval(const State *pState, double t0
 #endif // EVENTBASE_ALWAYS_CHECK_NANTIME
 
 	m_tLastCalc = t0;
-
-	return dt;
 }
 
 inline void EventBase::subtractInternalTimeInterval(const State *pState, double t1)
@@ -199,6 +291,9 @@ inline void EventBase::subtractInternalTimeInterval(const State *pState, double
 	assert(m_Tdiff >= 0); // Could be the case for simultaneous events
 	assert(m_tLastCalc >= 0);
 
+	if (EventProfiler::isEnabled())
+		EventProfiler::getProfile(this)->countInternalTimeCalculation();
+
 	double dT = calculateInternalTimeInterval(pState, m_tLastCalc, t1 - m_tLastCalc); 
 
 #ifndef NDEBUG
@@ -0,0 +1,185 @@
+#include "eventprofiler.h"
+#include "eventbase.h"
+#include "mutex.h"
+#include "util.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <map>
+#include <memory>
+#include <vector>
+#ifdef EVENTPROFILER_USE_TSC
+#include <cpuid.h>
+#endif // EVENTPROFILER_USE_TSC
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif // __GNUC__
+
+using namespace std;
+
+EventTypeProfile::EventTypeProfile(const string &name) : m_name(name), m_numCreated(0), m_numFired(0),
+                                                         m_numRejected(0), m_numDiscarded(0),
+							 m_numRealTimeCalculations(0), m_numInternalTimeCalculations(0),
+							 m_fireNanoseconds(0)
+{
+}
+
+EventTypeProfile::~EventTypeProfile()
+{
+}
+
+// The number of different event types that can be profiled
+#define EVENTPROFILER_MAXTYPES 256
+
+bool EventProfiler::s_enabled = false;
+int64_t EventProfiler::s_phaseNanoseconds[EventProfiler::NumberOfPhases] = { 0 };
+int64_t EventProfiler::s_phaseCount[EventProfiler::NumberOfPhases] = { 0 };
+EventTypeProfile *EventProfiler::s_pProfileSlots[EVENTPROFILER_MAXTYPES] = { 0 };
+#ifdef EVENTPROFILER_USE_TSC
+bool EventProfiler::s_useTsc = false;
+uint64_t EventProfiler::s_tscStart = 0;
+int64_t EventProfiler::s_tscStartNanoseconds = 0;
+double EventProfiler::s_nanosecondsPerTick = 0;
+#endif // EVENTPROFILER_USE_TSC
+
+// Keyed on the (mangled) name of the type, which is unique even if the
+// type_info objects themselves are not. A slot is never reused, so the
+// profile it points to can be read without the lock
+static map<string, int> s_profileSlotMap;
+static vector<unique_ptr<EventTypeProfile> > s_profiles;
+static Mutex s_profilesMutex;
+
+static string demangle(const char *pName)
+{
+#ifdef __GNUC__
+	int status = 0;
+	char *pDemangled = abi::__cxa_demangle(pName, 0, 0, &status);
+	if (pDemangled)
+	{
+		string name(pDemangled);
+		free(pDemangled);
+		return name;
+	}
+#endif // __GNUC__
+	return pName;
+}
+
+int EventProfiler::lookupProfileSlot(const type_info &type)
+{
+	s_profilesMutex.lock();
+
+	auto it = s_profileSlotMap.find(type.name());
+	int slot;
+
+	if (it != s_profileSlotMap.end())
+		slot = it->second;
+	else
+	{
+		slot = (int)s_profiles.size();
+		if (slot >= EVENTPROFILER_MAXTYPES)
+			abortWithMessage(strprintf("EventProfiler: more than %d event types", EVENTPROFILER_MAXTYPES));
+
+		s_profiles.push_back(unique_ptr<EventTypeProfile>(new EventTypeProfile(demangle(type.name()))));
+		s_pProfileSlots[slot] = s_profiles.back().get();
+		s_profileSlotMap[type.name()] = slot;
+	}
+
+	s_profilesMutex.unlock();
+	return slot;
+}
+
+// Each thread remembers the slots of the last event types it encountered,
+// so that the shared map (and its lock) is hardly ever needed when a new
+// event is counted for the first time
+#define EVENTPROFILER_CACHESIZE 16
+
+struct EventProfileCacheEntry
+{
+	const type_info *m_pType;
+	int m_slot;
+};
+
+static thread_local EventProfileCacheEntry s_profileCache[EVENTPROFILER_CACHESIZE];
+
+int EventProfiler::getProfileSlot(const type_info &type)
+{
+	EventProfileCacheEntry &entry = s_profileCache[(reinterpret_cast<uintptr_t>(&type) >> 4) % EVENTPROFILER_CACHESIZE];
+
+	if (entry.m_pType != &type)
+	{
+		entry.m_slot = lookupProfileSlot(type);
+		entry.m_pType = &type;
+	}
+	return entry.m_slot;
+}
+
+void EventProfiler::calibrateClock()
+{
+#ifdef EVENTPROFILER_USE_TSC
+	// Only a counter that runs at a constant rate, regardless of power
+	// management, can be used (CPUID leaf 0x80000007, bit 8 of EDX)
+	unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+	if (s_useTsc || !__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1 << 8)))
+		return;
+
+	// Compare the number of ticks to the elapsed time during a few milliseconds
+	int64_t t0 = getClockTimestamp();
+	uint64_t tsc0 = __rdtsc();
+	int64_t t1;
+	uint64_t tsc1;
+
+	do
+	{
+		t1 = getClockTimestamp();
+		tsc1 = __rdtsc();
+	} while (t1 - t0 < 5000000);
+
+	if (tsc1 <= tsc0)
+		return;
+
+	s_nanosecondsPerTick = (double)(t1 - t0)/(double)(tsc1 - tsc0);
+	s_tscStart = tsc1;
+	s_tscStartNanoseconds = t1;
+	s_useTsc = true;
+#endif // EVENTPROFILER_USE_TSC
+}
+
+const char *EventProfiler::getPhaseName(Phase phase)
+{
+	static const char *pPhaseNames[NumberOfPhases] = { "getNextScheduledEvent", "processUnsortedEvents", "getEarliestEvent",
+		                                           "advanceEventTimes", "fire" };
+	assert(phase >= 0 && phase < NumberOfPhases);
+	return pPhaseNames[phase];
+}
+
+string EventProfiler::getJSON()
+{
+	string json = "{\n    \"phases\": {";
+
+	for (int i = 0 ; i < NumberOfPhases ; i++)
+	{
+		json += strprintf("%s\n        \"%s\": { \"count\": %lld, \"nanoseconds\": %lld }", (i == 0)?"":",",
+		                  getPhaseName((Phase)i), (long long)s_phaseCount[i], (long long)s_phaseNanoseconds[i]);
+	}
+	json += "\n    },\n    \"events\": {";
+
+	s_profilesMutex.lock();
+
+	bool first = true;
+	for (auto it = s_profileSlotMap.begin() ; it != s_profileSlotMap.end() ; ++it)
+	{
+		const EventTypeProfile &p = *(s_profiles[it->second]);
+
+		json += strprintf("%s\n        \"%s\": { \"created\": %lld, \"fired\": %lld, \"rejected\": %lld, \"discarded\": %lld, "
+				  "\"solveForRealTimeInterval\": %lld, \"calculateInternalTimeInterval\": %lld, \"fireNanoseconds\": %lld }",
+				  (first)?"":",", p.getName().c_str(), (long long)p.getNumberCreated(), (long long)p.getNumberFired(),
+				  (long long)p.getNumberRejected(), (long long)p.getNumberDiscarded(), (long long)p.getNumberOfRealTimeCalculations(),
+				  (long long)p.getNumberOfInternalTimeCalculations(), (long long)p.getFireNanoseconds());
+		first = false;
+	}
+
+	s_profilesMutex.unlock();
+
+	json += "\n    }\n}";
+	return json;
+}
+
@@ -0,0 +1,157 @@
+#ifndef EVENTPROFILER_H
+
+#define EVENTPROFILER_H
+
+/**
+ * \file eventprofiler.h
+ */
+
+#include <stdint.h>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <typeinfo>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define EVENTPROFILER_USE_TSC
+#endif
+
+class EventBase;
+
+/** Counters for a specific type of event, see EventProfiler. Since time
+ *  calculations and checks for useless events can happen in several threads
+ *  at the same time, atomic counters are used. */
+class EventTypeProfile
+{
+public:
+	EventTypeProfile(const std::string &name);
+	~EventTypeProfile();
+
+	/** The (demangled) name of the class of these events. */
+	const std::string &getName() const								{ return m_name; }
+
+	void countCreated()										{ m_numCreated.fetch_add(1, std::memory_order_relaxed); }
+	void countFired(int64_t nanoseconds)								{ m_numFired.fetch_add(1, std::memory_order_relaxed); m_fireNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed); }
+	void countRejected()										{ m_numRejected.fetch_add(1, std::memory_order_relaxed); }
+	void countDiscarded()										{ m_numDiscarded.fetch_add(1, std::memory_order_relaxed); }
+	void countRealTimeCalculation()									{ m_numRealTimeCalculations.fetch_add(1, std::memory_order_relaxed); }
+	void countInternalTimeCalculation()								{ m_numInternalTimeCalculations.fetch_add(1, std::memory_order_relaxed); }
+
+	int64_t getNumberCreated() const								{ return m_numCreated.load(); }
+	int64_t getNumberFired() const									{ return m_numFired.load(); }
+	int64_t getNumberRejected() const								{ return m_numRejected.load(); }
+	int64_t getNumberDiscarded() const								{ return m_numDiscarded.load(); }
+	int64_t getNumberOfRealTimeCalculations() const							{ return m_numRealTimeCalculations.load(); }
+	int64_t getNumberOfInternalTimeCalculations() const						{ return m_numInternalTimeCalculations.load(); }
+	int64_t getFireNanoseconds() const								{ return m_fireNanoseconds.load(); }
+private:
+	std::string m_name;
+	std::atomic<int64_t> m_numCreated, m_numFired, m_numRejected, m_numDiscarded;
+	std::atomic<int64_t> m_numRealTimeCalculations, m_numInternalTimeCalculations;
+	std::atomic<int64_t> m_fireNanoseconds;
+};
+
+/** Keeps track of what the events in a simulation are costing, for each
+ *  type (class) of event separately, as well as of the time spent in the
+ *  different phases of the algorithm.
+ *
+ *  Unlike the DebugTimer, which needs to be enabled at compile time, this
+ *  is present in release builds as well, but is disabled by default. When
+ *  disabled, the only overhead is a check of EventProfiler::isEnabled at
+ *  each point where something would be counted. When enabled, each event
+ *  object remembers the slot of its type the first time it's counted, so
+ *  that afterwards a counter is found by indexing an array. The following
+ *  is recorded for each event type:
+ *
+ *   - the number of events that were created (in PopulationEvent::setEventID)
+ *   - the number of times such an event fired, and the total time spent
+ *     in EventBase::fire
+ *   - the number of candidate fire times that were rejected when thinning
+ *     is used (see EventBase::isCandidateAccepted)
+ *   - the number of events that were discarded because they were no longer
+ *     useful (see PopulationEvent::isNoLongerUseful)
+ *   - the number of times EventBase::solveForRealTimeInterval and
+ *     EventBase::calculateInternalTimeInterval were called.
+ *
+ *  The time spent in each of the EventProfiler::Phase steps of the algorithm
+ *  is recorded as well. The results can be obtained in JSON format using
+ *  EventProfiler::getJSON.
+ */
+class EventProfiler
+{
+public:
+	/** The phases of the algorithm for which the time is recorded. The
+	 *  EventProfiler::ProcessUnsortedEvents and EventProfiler::GetEarliestEvent
+	 *  phases are part of EventProfiler::GetNextScheduledEvent, and are only
+	 *  recorded separately by the population based 'opt' algorithms. */
+	enum Phase
+	{
+		GetNextScheduledEvent,
+		ProcessUnsortedEvents,
+		GetEarliestEvent,
+		AdvanceEventTimes,
+		FireEvent,
+		NumberOfPhases
+	};
+
+	/** Enables or disables the profiling. */
+	static void setEnabled(bool f)									{ s_enabled = f; if (f) calibrateClock(); }
+	static bool isEnabled()										{ return s_enabled; }
+
+	/** Returns the name that's used for a phase in the output. */
+	static const char *getPhaseName(Phase phase);
+
+	/** Returns the counters for the type of the specified event (defined in
+	 *  eventbase.h). */
+	static EventTypeProfile *getProfile(const EventBase *pEvt);
+
+	/** Returns a time stamp in nanoseconds, the difference of two of these
+	 *  can be passed to EventProfiler::addPhaseTime. Where possible, this is
+	 *  derived from the processor's time stamp counter, which is a lot cheaper
+	 *  to read than the system clock. */
+	static int64_t getTimestamp();
+
+	/** Relates the time stamp counter to the system clock, this needs to
+	 *  be called before EventProfiler::getTimestamp is used, and is done
+	 *  automatically when the profiling is enabled. */
+	static void calibrateClock();
+
+	/** Adds the specified time to a phase of the algorithm, this should
+	 *  only be called from the thread that runs the algorithm. */
+	static void addPhaseTime(Phase phase, int64_t nanoseconds)					{ s_phaseNanoseconds[phase] += nanoseconds; s_phaseCount[phase]++; }
+
+	/** Returns the counters for all event types and the phase times, as a
+	 *  JSON object. */
+	static std::string getJSON();
+private:
+	static int getProfileSlot(const std::type_info &type);
+	static int lookupProfileSlot(const std::type_info &type);
+	static int64_t getClockTimestamp();
+
+	static bool s_enabled;
+	static EventTypeProfile *s_pProfileSlots[];
+#ifdef EVENTPROFILER_USE_TSC
+	static bool s_useTsc;
+	static uint64_t s_tscStart;
+	static int64_t s_tscStartNanoseconds;
+	static double s_nanosecondsPerTick;
+#endif // EVENTPROFILER_USE_TSC
+	static int64_t s_phaseNanoseconds[NumberOfPhases];
+	static int64_t s_phaseCount[NumberOfPhases];
+};
+
+inline int64_t EventProfiler::getClockTimestamp()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline int64_t EventProfiler::getTimestamp()
+{
+#ifdef EVENTPROFILER_USE_TSC
+	if (s_useTsc)
+		return s_tscStartNanoseconds + (int64_t)((double)(int64_t)(__rdtsc() - s_tscStart)*s_nanosecondsPerTick);
+#endif // EVENTPROFILER_USE_TSC
+	return getClockTimestamp();
+}
+
+#endif // EVENTPROFILER_H
@@ -0,0 +1,102 @@
+#include "eventtracer.h"
+#include "logfile.h"
+#include "workerpool.h"
+#include <assert.h>
+#ifndef DISABLEOPENMP
+#include <omp.h>
+#endif // !DISABLEOPENMP
+
+using namespace std;
+
+LogFile *EventTracer::s_pFile = 0;
+int EventTracer::s_stepInterval = 1;
+int64_t EventTracer::s_stepCount = 0;
+bool EventTracer::s_traceStep = false;
+int64_t EventTracer::s_tStart = 0;
+vector<vector<EventTracer::Span> > EventTracer::s_threadSpans;
+
+static int getThreadIndex()
+{
+#ifndef DISABLEOPENMP
+	// Work done by a worker pool uses the index of the thread in that pool
+	int idx = WorkerPool::getCurrentThreadIndex();
+	if (idx >= 0)
+		return idx;
+	return omp_get_thread_num();
+#else
+	return 0;
+#endif // !DISABLEOPENMP
+}
+
+void EventTracer::start(LogFile *pFile, int stepInterval)
+{
+	assert(pFile != 0 && pFile->isOpen());
+	assert(stepInterval > 0);
+
+	s_pFile = pFile;
+	s_stepInterval = stepInterval;
+	s_stepCount = 0;
+	s_traceStep = false;
+	EventProfiler::calibrateClock();
+	s_tStart = EventProfiler::getTimestamp();
+
+#ifndef DISABLEOPENMP
+	int numThreads = omp_get_max_threads();
+#else
+	int numThreads = 1;
+#endif // !DISABLEOPENMP
+	s_threadSpans.resize(numThreads);
+
+	s_pFile->print("[");
+
+	// Name the tracks of the threads
+	for (int i = 0 ; i < numThreads ; i++)
+	{
+		s_pFile->print("%s{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": { \"name\": \"%s %d\" } }",
+		               (i == 0)?"":",", i, (i == 0)?"Main thread":"Thread", i);
+	}
+}
+
+void EventTracer::finish()
+{
+	if (!s_pFile)
+		return;
+
+	flush();
+	s_pFile->print("]");
+
+	s_pFile = 0;
+	s_traceStep = false;
+}
+
+void EventTracer::addSpan(const string &name, int64_t tStart, int64_t tEnd, const string &args)
+{
+	int idx = getThreadIndex();
+
+	// The vectors are only resized in 'start', so each thread can safely
+	// add to its own one
+	if (idx < (int)s_threadSpans.size())
+		s_threadSpans[idx].push_back(Span(name, tStart, tEnd, args));
+}
+
+void EventTracer::flush()
+{
+	assert(s_pFile);
+
+	for (size_t i = 0 ; i < s_threadSpans.size() ; i++)
+	{
+		vector<Span> &spans = s_threadSpans[i];
+
+		for (size_t j = 0 ; j < spans.size() ; j++)
+		{
+			const Span &s = spans[j];
+
+			// Times are in microseconds
+			s_pFile->print(",{ \"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f%s%s%s }",
+			               s.m_name.c_str(), (int)i, (double)(s.m_tStart - s_tStart)/1000.0, (double)(s.m_tEnd - s.m_tStart)/1000.0,
+			               (s.m_args.empty())?"":", \"args\": { ", s.m_args.c_str(), (s.m_args.empty())?"":" }");
+		}
+		spans.clear();
+	}
+}
+
@@ -0,0 +1,108 @@
+#ifndef EVENTTRACER_H
+
+#define EVENTTRACER_H
+
+/**
+ * \file eventtracer.h
+ */
+
+#include "eventprofiler.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class LogFile;
+
+/** Writes the steps of the algorithm as a timeline in the Chrome trace event
+ *  format, which can be inspected using \c chrome://tracing or the Perfetto UI.
+ *
+ *  Each span has a name, a start time and a duration, and belongs to the track
+ *  of the thread that recorded it. This way, the work done by the threads in
+ *  the parallel parts of an algorithm can be compared to each other. To keep
+ *  the output of a long simulation manageable, only every Nth step of the
+ *  algorithm can be traced.
+ *
+ *  Spans are buffered per thread, and written to the log file at the end of each
+ *  traced step by the thread that runs the algorithm. Like the EventProfiler,
+ *  this is disabled by default and then only costs a check of a flag.
+ */
+class EventTracer
+{
+public:
+	/** Starts writing to \c pFile, which must already be opened, tracing only one
+	 *  in \c stepInterval steps of the algorithm. */
+	static void start(LogFile *pFile, int stepInterval);
+
+	/** Writes the remaining spans and the end of the JSON array. */
+	static void finish();
+
+	static bool isEnabled()										{ return s_pFile != 0; }
+
+	/** Called by the algorithm at the start of each step, to decide if this step
+	 *  will be traced. */
+	static void beginStep()										{ if (s_pFile) s_traceStep = ((s_stepCount++ % s_stepInterval) == 0); }
+
+	/** Called by the algorithm at the end of each step. */
+	static void endStep()										{ if (s_traceStep) flush(); }
+
+	/** Returns true if spans should be recorded in the current step. */
+	static bool isTracingStep()									{ return s_traceStep; }
+
+	/** Adds a span for the current thread, \c tStart and \c tEnd are time stamps from
+	 *  EventProfiler::getTimestamp. If not empty, \c args should contain the members
+	 *  of a JSON object which will be shown as extra information. */
+	static void addSpan(const std::string &name, int64_t tStart, int64_t tEnd, const std::string &args = std::string());
+
+	/** Ends a phase of the algorithm that started at time stamp \c tStart: the
+	 *  time is added to the EventProfiler if \c profile is true, and a span is
+	 *  added if the current step is traced. Returns the time stamp at which the
+	 *  next phase starts. */
+	static int64_t endPhase(EventProfiler::Phase phase, int64_t tStart, bool profile);
+private:
+	class Span
+	{
+	public:
+		Span(const std::string &name, int64_t tStart, int64_t tEnd, const std::string &args)
+			: m_name(name), m_args(args), m_tStart(tStart), m_tEnd(tEnd)				{ }
+
+		std::string m_name, m_args;
+		int64_t m_tStart, m_tEnd;
+	};
+
+	static void flush();
+
+	static LogFile *s_pFile;
+	static int s_stepInterval;
+	static int64_t s_stepCount;
+	static bool s_traceStep;
+	static int64_t s_tStart;
+	static std::vector<std::vector<Span> > s_threadSpans;
+};
+
+inline int64_t EventTracer::endPhase(EventProfiler::Phase phase, int64_t tStart, bool profile)
+{
+	int64_t t = EventProfiler::getTimestamp();
+
+	if (profile)
+		EventProfiler::addPhaseTime(phase, t - tStart);
+	if (s_traceStep)
+		addSpan(EventProfiler::getPhaseName(phase), tStart, t);
+
+	return t;
+}
+
+/** Records a span from its construction until it goes out of scope, if the current
+ *  step of the algorithm is being traced. For rare but important actions, \c always
+ *  can be set to record the span in every step. */
+class TraceSpan
+{
+public:
+	TraceSpan(const char *pName, bool always = false)
+		: m_pName(pName), m_tStart(((always)?EventTracer::isEnabled():EventTracer::isTracingStep())?EventProfiler::getTimestamp():-1)	{ }
+	~TraceSpan()											{ if (m_tStart >= 0) EventTracer::addSpan(m_pName, m_tStart, EventProfiler::getTimestamp()); }
+private:
+	const char *m_pName;
+	int64_t m_tStart;
+};
+
+#endif // EVENTTRACER_H
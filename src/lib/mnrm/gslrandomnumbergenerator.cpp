@@ -1,4 +1,5 @@
 #include "gslrandomnumbergenerator.h"
+#include "util.h"
 #include <stdint.h>
 #include <time.h>
 #ifndef WIN32
@@ -13,7 +14,9 @@
 	#include <stdlib.h>
 #endif // WIN32
 #include <gsl/gsl_randist.h>
+#include <gsl/gsl_cdf.h>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -77,13 +80,16 @@ GslRandomNumberGenerator::GslRandomNumberGenerator()
 	m_seed = x;
 }
 
-GslRandomNumberGenerator::GslRandomNumberGenerator(int seed)
+GslRandomNumberGenerator::GslRandomNumberGenerator(int seed, bool showSeed)
 {
 	m_pRng = gsl_rng_alloc(gsl_rng_env_setup());
  	gsl_rng_set(m_pRng, seed);
 
-	std::cerr << "# Rng engine " << gsl_rng_name(m_pRng) << std::endl;
-	std::cerr << "# Using seed " << seed << std::endl;
+	if (showSeed)
+	{
+		std::cerr << "# Rng engine " << gsl_rng_name(m_pRng) << std::endl;
+		std::cerr << "# Using seed " << seed << std::endl;
+	}
 	gsl_rng_set(m_pRng, seed);
 	m_seed = seed;
 }
@@ -100,6 +106,11 @@ double GslRandomNumberGenerator::pickRandomDouble()
 	return x;
 }
 
+int GslRandomNumberGenerator::pickSubstreamSeed()
+{
+	return pickRandomInt(1, 0x7fffffff-1);
+}
+
 int GslRandomNumberGenerator::pickRandomInt(int numMin, int numMax)
 {
 	if (numMax == numMin)
@@ -130,6 +141,108 @@ double GslRandomNumberGenerator::pickGaussianNumber(double mean, double sigma)
 	return result;
 }
 
+// If at least this fraction of the gaussian distribution lies within the bounds,
+// rejection sampling is used, which then needs at most four gaussian numbers on
+// average. This is also what was always used before, so the same numbers are
+// obtained for such bounds.
+#define GSLRANDOMNUMBERGENERATOR_TRUNCATEDGAUSSIAN_MINPROB 0.25
+
+double GslRandomNumberGenerator::pickTruncatedGaussian(double mean, double sigma, double minVal, double maxVal)
+{
+	if (!(minVal <= maxVal))
+		abortWithMessage("GslRandomNumberGenerator::pickTruncatedGaussian: the minimum value must not be larger than the maximum value");
+	if (!(sigma > 0) && !(mean >= minVal && mean <= maxVal))
+		abortWithMessage("GslRandomNumberGenerator::pickTruncatedGaussian: without a spread, the mean must lie within the bounds");
+
+	if (useTruncatedGaussianRejection(mean, sigma, minVal, maxVal))
+	{
+		double x;
+
+		do
+		{
+			x = pickGaussianNumber(mean, sigma);
+		} while (x < minVal || x > maxVal);
+
+		return x;
+	}
+
+	return getTruncatedGaussianInverse(mean, sigma, minVal, maxVal, pickRandomDouble());
+}
+
+double GslRandomNumberGenerator::getGaussianProbability(double mean, double sigma, double minVal, double maxVal)
+{
+	double a = (minVal - mean)/sigma;
+	double b = (maxVal - mean)/sigma;
+
+	// Use the upper tail if the interval lies above the mean, to avoid
+	// subtracting two numbers that are almost one
+	if (a > 0)
+		return gsl_cdf_ugaussian_Q(a) - gsl_cdf_ugaussian_Q(b);
+	return gsl_cdf_ugaussian_P(b) - gsl_cdf_ugaussian_P(a);
+}
+
+bool GslRandomNumberGenerator::useTruncatedGaussianRejection(double mean, double sigma, double minVal, double maxVal)
+{
+	// Without a spread, the mean itself is picked if it lies within the bounds
+	if (!(sigma > 0))
+		return (mean >= minVal && mean <= maxVal);
+
+	// If the interval contains [mean-sigma, mean+sigma], more than 68% of the
+	// distribution lies within it, no need to calculate this exactly
+	if (minVal <= mean - sigma && maxVal >= mean + sigma)
+		return true;
+
+	return getGaussianProbability(mean, sigma, minVal, maxVal) >= GSLRANDOMNUMBERGENERATOR_TRUNCATEDGAUSSIAN_MINPROB;
+}
+
+double GslRandomNumberGenerator::getTruncatedGaussianInverse(double mean, double sigma, double minVal, double maxVal, double u)
+{
+	if (!(sigma > 0))
+		return std::min(std::max(mean, minVal), maxVal);
+
+	double a = (minVal - mean)/sigma;
+	double b = (maxVal - mean)/sigma;
+	double sign = 1;
+
+	// Work with an interval that lies above zero if possible, the upper tail
+	// is then calculated with the most precision
+	if (b < 0)
+	{
+		double tmp = a;
+		a = -b;
+		b = -tmp;
+		sign = -1;
+	}
+
+	double x;
+	if (a > 0)
+	{
+		double qa = gsl_cdf_ugaussian_Q(a);
+		double qb = gsl_cdf_ugaussian_Q(b);
+
+		if (qa > 0)
+			x = gsl_cdf_ugaussian_Qinv(qa - u*(qa - qb));
+		else
+		{
+			// So far in the tail that the probability underflows; there the
+			// distribution is very close to an exponential one with rate a
+			x = a - std::log(1.0 - u*(1.0 - std::exp(-a*(b - a))))/a;
+		}
+	}
+	else
+	{
+		double pa = gsl_cdf_ugaussian_P(a);
+		double pb = gsl_cdf_ugaussian_P(b);
+
+		x = gsl_cdf_ugaussian_Pinv(pa + u*(pb - pa));
+	}
+
+	// Rounding errors should not put the number outside the interval
+	x = std::min(std::max(x, a), b);
+
+	return std::min(std::max(mean + sign*sigma*x, minVal), maxVal);
+}
+
 double GslRandomNumberGenerator::pickBetaNumber(double a, double b)
 {
 	double x = gsl_ran_beta(m_pRng, a, b);
@@ -187,3 +300,35 @@ unsigned int GslRandomNumberGenerator::pickBinomialNumber(double p, unsigned int
 	return gsl_ran_binomial(m_pRng, p, n);
 }
 
+void GslRandomNumberGenerator::pickRandomDoubles(double *pValues, size_t num)
+{
+	for (size_t i = 0 ; i < num ; i++)
+		pValues[i] = gsl_rng_uniform(m_pRng);
+}
+
+void GslRandomNumberGenerator::pickGaussianNumbers(double *pValues, size_t num, double mean, double sigma)
+{
+	for (size_t i = 0 ; i < num ; i++)
+		pValues[i] = gsl_ran_gaussian(m_pRng, sigma);
+
+	for (size_t i = 0 ; i < num ; i++)
+		pValues[i] += mean;
+}
+
+void GslRandomNumberGenerator::pickBetaNumbers(double *pValues, size_t num, double a, double b)
+{
+	for (size_t i = 0 ; i < num ; i++)
+		pValues[i] = gsl_ran_beta(m_pRng, a, b);
+}
+
+void GslRandomNumberGenerator::pickLogNorms(double *pValues, size_t num, double zeta, double sigma)
+{
+	for (size_t i = 0 ; i < num ; i++)
+		pValues[i] = gsl_ran_lognormal(m_pRng, zeta, sigma);
+}
+
+void GslRandomNumberGenerator::pickGammas(double *pValues, size_t num, double a, double b)
+{
+	for (size_t i = 0 ; i < num ; i++)
+		pValues[i] = gsl_ran_gamma(m_pRng, a, b);
+}
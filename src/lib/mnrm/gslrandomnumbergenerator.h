@@ -7,6 +7,7 @@
  */
 
 #include <gsl/gsl_rng.h>
+#include <stddef.h>
 #include <utility>
 
 /**
@@ -21,8 +22,10 @@ public:
 	 *  environment variable (can be useful for testing purposes). */
 	GslRandomNumberGenerator();
 
-	/** Initialize the random number generator with a specific seed. */
-	GslRandomNumberGenerator(int seed);
+	/** Initialize the random number generator with a specific seed. If \c showSeed
+	 *  is false, the seed is not written to the standard error stream, which is
+	 *  useful when creating many generators, e.g. one per thread or per block of work. */
+	GslRandomNumberGenerator(int seed, bool showSeed = true);
 	~GslRandomNumberGenerator();
 
 	/** Returns the seed used for the random number generator. */
@@ -31,6 +34,11 @@ public:
 	/** Generate a random floating point number in the interval [0,1]. */
 	double pickRandomDouble();
 
+	/** Picks a seed for a new GslRandomNumberGenerator instance, to create an
+	 *  independent substream of random numbers which is still fully determined by
+	 *  the seed of this generator. */
+	int pickSubstreamSeed();
+
 	/** Chooses a random number from \c min to \c max (both are included). */
 	int pickRandomInt(int min, int max);
 
@@ -46,6 +54,19 @@ public:
 	 *  \c mean and \c sigma. */
 	double pickGaussianNumber(double mean, double sigma);
 
+	/** Picks a random number from the gaussian distribution with parameters \c mean
+	 *  and \c sigma, restricted to the interval [\c minVal, \c maxVal]. If a large
+	 *  enough part of the distribution lies in this interval, rejection sampling is
+	 *  used. Otherwise, a uniform number is transformed using the inverse of the
+	 *  cumulative distribution function, so that the time needed doesn't depend on
+	 *  how narrow the interval is. The program is aborted if \c minVal is larger
+	 *  than \c maxVal, or if \c sigma is zero and \c mean lies outside the interval. */
+	double pickTruncatedGaussian(double mean, double sigma, double minVal, double maxVal);
+
+	/** Returns the probability that a number from the gaussian distribution with
+	 *  parameters \c mean and \c sigma lies in the interval [\c minVal, \c maxVal]. */
+	static double getGaussianProbability(double mean, double sigma, double minVal, double maxVal);
+
 	/** Pick a random number from a beta distribution with \c a and \c b as
 	 *  values for \f$ \alpha \f$ and \f$ \beta \f$ respectively. */
 	double pickBetaNumber(double a, double b);
@@ -68,7 +89,30 @@ public:
 	/** Picks a random number from a two dimensional gaussian distribution with specified
 	 *  parameters (rho is the correlation coefficient). */
 	std::pair<double,double> pickBivariateGaussian(double muX, double muY, double sigmaX, double sigmaY, double rho);
+
+	/** Stores \c num numbers in \c pValues, which are the same as the ones that
+	 *  \c num calls to pickRandomDouble would return. */
+	void pickRandomDoubles(double *pValues, size_t num);
+
+	/** Stores \c num numbers in \c pValues, which are the same as the ones that
+	 *  \c num calls to pickGaussianNumber would return. */
+	void pickGaussianNumbers(double *pValues, size_t num, double mean, double sigma);
+
+	/** Stores \c num numbers in \c pValues, which are the same as the ones that
+	 *  \c num calls to pickBetaNumber would return. */
+	void pickBetaNumbers(double *pValues, size_t num, double a, double b);
+
+	/** Stores \c num numbers in \c pValues, which are the same as the ones that
+	 *  \c num calls to pickLogNorm would return. */
+	void pickLogNorms(double *pValues, size_t num, double zeta, double sigma);
+
+	/** Stores \c num numbers in \c pValues, which are the same as the ones that
+	 *  \c num calls to pickGamma would return. */
+	void pickGammas(double *pValues, size_t num, double a, double b);
 private:
+	static bool useTruncatedGaussianRejection(double mean, double sigma, double minVal, double maxVal);
+	static double getTruncatedGaussianInverse(double mean, double sigma, double minVal, double maxVal, double u);
+
 	gsl_rng *m_pRng;
 	unsigned long m_seed;
 };
@@ -7,6 +7,7 @@
  */
 
 #include "probabilitydistribution.h"
+#include "gslrandomnumbergenerator.h"
 
 /** This class allows you to return a random number from a beta distribution
  *  with parameters specified in the constructor.
@@ -20,6 +21,8 @@ public:
 	BetaDistribution(double a, double b, double minVal, double maxVal, GslRandomNumberGenerator *pRng) : ProbabilityDistribution(pRng)	{ m_a = a; m_b = b; m_minVal = minVal; m_scale = (maxVal-minVal); }
 
 	double pickNumber() const;
+	bool hasBulkPicking() const									{ return true; }
+	void pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const;
 	double getA() const										{ return m_a; }
 	double getB() const										{ return m_b; }
 	double getMin() const										{ return m_minVal; }
@@ -34,4 +37,12 @@ inline double BetaDistribution::pickNumber() const
 	return x*m_scale + m_minVal;
 }
 
+inline void BetaDistribution::pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const
+{
+	pRndGen->pickBetaNumbers(pValues, num, m_a, m_b);
+
+	for (size_t i = 0 ; i < num ; i++)
+		pValues[i] = pValues[i]*m_scale + m_minVal;
+}
+
 #endif // BETADISTRIBUTION_H
@@ -1,6 +1,8 @@
 #include "binormaldistribution.h"
 #include "gslrandomnumbergenerator.h"
 #include "util.h"
+#include <gsl/gsl_cdf.h>
+#include <algorithm>
 #include <cmath>
 
 BinormalDistribution::BinormalDistribution(double mu, double sigma, double rho, GslRandomNumberGenerator *pRndGen,
@@ -22,6 +24,8 @@ BinormalDistribution::BinormalDistribution(double mu, double sigma, double rho,
 	m_maxY = maxVal;
 
 	m_isSymm = true;
+
+	initDecomposition();
 }
 
 BinormalDistribution::BinormalDistribution(double muX, double muY, double sigmaX, double sigmaY,
@@ -47,6 +51,8 @@ BinormalDistribution::BinormalDistribution(double muX, double muY, double sigmaX
 	m_maxY = maxValY;
 
 	m_isSymm = false;
+
+	initDecomposition();
 }
 
 BinormalDistribution::~BinormalDistribution()
@@ -55,46 +61,410 @@ BinormalDistribution::~BinormalDistribution()
 
 Point2D BinormalDistribution::pickPoint() const
 {
-	GslRandomNumberGenerator *pRndGen = getRandomNumberGenerator();
-	std::pair<double,double> xy = pRndGen->pickBivariateGaussian(m_muX, m_muY, m_sigmaX, m_sigmaY, m_rho);
-	const int maxCount = 10000;
-	int count = 0;
-	
-	// Re-sample if not inside boundaries (rejection sampling)
-	while ((xy.first < m_minX || xy.first > m_maxX || xy.second < m_minY || xy.second > m_maxY) && count++ < maxCount)
-		xy = pRndGen->pickBivariateGaussian(m_muX, m_muY, m_sigmaX, m_sigmaY, m_rho);
+	return pickPoint(getRandomNumberGenerator());
+}
 
-	if (count >= maxCount)
-		abortWithMessage("BinormalDistribution::pickPoint: rejection sampling couldn't find a point within the specified region");
+void BinormalDistribution::pickPoints(GslRandomNumberGenerator *pRndGen, Point2D *pPoints, size_t num) const
+{
+	for (size_t i = 0 ; i < num ; i++)
+		pPoints[i] = pickPoint(pRndGen);
+}
+
+Point2D BinormalDistribution::pickPoint(GslRandomNumberGenerator *pRndGen) const
+{
+	if (!m_useRejection)
+		return pickPointDecomposed(pRndGen);
+
+	// The bounds contain a large enough part of the distribution (see initDecomposition),
+	// so that a point inside them is found after a few attempts
+	std::pair<double,double> xy;
+
+	do
+	{
+		xy = pRndGen->pickBivariateGaussian(m_muX, m_muY, m_sigmaX, m_sigmaY, m_rho);
+	} while (xy.first < m_minX || xy.first > m_maxX || xy.second < m_minY || xy.second > m_maxY);
 
 	return Point2D(xy.first, xy.second);
 }
 
-double BinormalDistribution::pickMarginalX() const
+// If at least this fraction of the distribution lies within the bounds, points
+// are picked from the full distribution until one lies inside them. This is also
+// what was always used before, so the same points are obtained for such bounds.
+#define BINORMALDISTRIBUTION_REJECTION_MINPROB 0.25
+
+void BinormalDistribution::initDecomposition()
 {
-	return pickClippedGaussian(m_muX, m_sigmaX, m_minX, m_maxX);
+	// Start with the coordinate that has the tightest bounds, so that the bounds
+	// of the other one have the least influence
+	double probX = GslRandomNumberGenerator::getGaussianProbability(m_muX, m_sigmaX, m_minX, m_maxX);
+	double probY = GslRandomNumberGenerator::getGaussianProbability(m_muY, m_sigmaY, m_minY, m_maxY);
+
+	m_decomposeYFirst = !(probX <= probY);
+	if (!m_decomposeYFirst)
+	{
+		m_muF = m_muX; m_sigmaF = m_sigmaX; m_minF = m_minX; m_maxF = m_maxX;
+		m_muS = m_muY; m_sigmaS = m_sigmaY; m_minS = m_minY; m_maxS = m_maxY;
+	}
+	else
+	{
+		m_muF = m_muY; m_sigmaF = m_sigmaY; m_minF = m_minY; m_maxF = m_maxY;
+		m_muS = m_muX; m_sigmaS = m_sigmaX; m_minS = m_minX; m_maxS = m_maxX;
+	}
+	m_condSlope = m_rho*m_sigmaS/m_sigmaF;
+	m_condSigma = m_sigmaS*std::sqrt(1.0-m_rho*m_rho);
+
+	m_marginalPoints.clear();
+	m_marginalLower.clear();
+	m_marginalUpper.clear();
+	m_marginalCumulative.clear();
+
+	// The probability of the region is at most that of the tightest bounds, and
+	// is calculated more precisely where needed
+	double prob = std::min(probX, probY);
+
+	if (m_rho == 0)
+		prob = probX*probY;
+	else if (!(m_condSigma > 0))
+	{
+		// The points lie on a line, see pickPointDecomposed
+		double f1 = m_muF + (m_minS - m_muS)/m_condSlope;
+		double f2 = m_muF + (m_maxS - m_muS)/m_condSlope;
+		double lower = std::max(m_minF, std::min(f1, f2));
+		double upper = std::min(m_maxF, std::max(f1, f2));
+
+		prob = (lower <= upper)?GslRandomNumberGenerator::getGaussianProbability(m_muF, m_sigmaF, lower, upper):0;
+	}
+	else if (prob < 1.0)
+		prob = initMarginalEnvelope();
+
+	m_useRejection = (prob >= BINORMALDISTRIBUTION_REJECTION_MINPROB);
+	if (m_useRejection)
+	{
+		m_marginalPoints.clear();
+		m_marginalLower.clear();
+		m_marginalUpper.clear();
+		m_marginalCumulative.clear();
+	}
 }
 
-double BinormalDistribution::pickMarginalY() const
+// Logarithm of the probability that a standard gaussian number is larger than x,
+// also where that probability itself is too small to be stored in a double
+static double getLogUpperTail(double x)
+{
+	if (x == std::numeric_limits<double>::infinity())
+		return -std::numeric_limits<double>::infinity();
+	if (x < 30.0)
+		return std::log(gsl_cdf_ugaussian_Q(x));
+
+	// Asymptotic expansion of the upper tail
+	double x2 = x*x;
+	return -0.5*x2 - std::log(x) - 0.5*std::log(2.0*3.14159265358979323846) + std::log(1.0 - 1.0/x2 + 3.0/(x2*x2));
+}
+
+// Logarithm of GslRandomNumberGenerator::getGaussianProbability, which stays
+// accurate far in the tails
+static double getLogGaussianProbability(double mean, double sigma, double minVal, double maxVal)
+{
+	double a = (minVal - mean)/sigma;
+	double b = (maxVal - mean)/sigma;
+
+	if (b < 0)
+	{
+		double tmp = a;
+		a = -b;
+		b = -tmp;
+	}
+
+	if (a > 0)
+	{
+		double logQa = getLogUpperTail(a);
+		double logQb = getLogUpperTail(b);
+
+		return logQa + std::log(-std::expm1(logQb - logQa));
+	}
+	return std::log(gsl_cdf_ugaussian_P(b) - gsl_cdf_ugaussian_P(a));
+}
+
+// The marginal density of the first coordinate f is proportional to the gaussian
+// factor times the probability that the second coordinate lies within its bounds
+double BinormalDistribution::getMarginalLogDensity(double f) const
+{
+	double z = (f - m_muF)/m_sigmaF;
+	double logDens = -0.5*z*z + getLogGaussianProbability(m_muS + m_condSlope*(f - m_muF), m_condSigma, m_minS, m_maxS);
+
+	return (std::isnan(logDens))?-std::numeric_limits<double>::infinity():logDens;
+}
+
+// Number of intervals in the envelope of the marginal distribution
+#define BINORMALDISTRIBUTION_TABLESIZE 1024
+
+// Outside the part of the marginal distribution where the density is at most this
+// many e-folds smaller than its maximum, the envelope is exponential
+#define BINORMALDISTRIBUTION_LOGRANGE 40.0
+
+// Relative amount by which the envelope is made larger, and the lower bounds
+// smaller, so that rounding errors in the density can't affect the result
+#define BINORMALDISTRIBUTION_ENVELOPEMARGIN 1e-6
+
+// Both factors of the marginal density are log-concave, so the density has a single
+// maximum and its logarithm lies below any line through two of its points, outside
+// of these points. Between two points, the density therefore lies between the values
+// at these points, or below the maximum in the interval that contains it. Below the
+// first point and above the last one, it lies below the exponential defined by the
+// two nearest points. Values picked from this envelope are accepted with probability
+// density/envelope, which gives the exact marginal distribution. Returns the
+// probability that a point of the full distribution lies inside the bounds.
+double BinormalDistribution::initMarginalEnvelope()
+{
+	// The maximum lies near the mean, or near a value for which the conditional
+	// mean lies at one of the bounds of the second coordinate
+	double lower = m_muF, upper = m_muF;
+
+	if (!std::isinf(m_minS))
+	{
+		lower = std::min(lower, m_muF + (m_minS - m_muS)/m_condSlope);
+		upper = std::max(upper, m_muF + (m_minS - m_muS)/m_condSlope);
+	}
+	if (!std::isinf(m_maxS))
+	{
+		lower = std::min(lower, m_muF + (m_maxS - m_muS)/m_condSlope);
+		upper = std::max(upper, m_muF + (m_maxS - m_muS)/m_condSlope);
+	}
+	lower = std::min(std::max(lower - 10.0*m_sigmaF, m_minF), m_maxF);
+	upper = std::min(std::max(upper + 10.0*m_sigmaF, m_minF), m_maxF);
+
+	for (int i = 0 ; i < 200 && upper > lower ; i++)
+	{
+		double f1 = lower + (upper - lower)/3.0;
+		double f2 = upper - (upper - lower)/3.0;
+
+		if (getMarginalLogDensity(f1) < getMarginalLogDensity(f2))
+			lower = f1;
+		else
+			upper = f2;
+	}
+
+	double maxPos = 0.5*(lower + upper);
+	double maxLogDens = getMarginalLogDensity(maxPos);
+
+	// The region has no probability that can be represented, pickFromMarginal
+	// will report this
+	if (!(maxLogDens > -std::numeric_limits<double>::infinity()))
+		return 0;
+
+	// The gaussian factor makes the density drop off at least as fast as
+	// exp(-(f-maxPos)^2/(2 sigmaF^2)), so there's little left outside 9 sigmaF.
+	// Within that range, the points are placed where the density is large enough.
+	double minLogDens = maxLogDens - BINORMALDISTRIBUTION_LOGRANGE;
+	double start = std::max(m_minF, maxPos - 9.0*m_sigmaF);
+	double end = std::min(m_maxF, maxPos + 9.0*m_sigmaF);
+
+	if (getMarginalLogDensity(start) < minLogDens)
+	{
+		double inside = maxPos;
+
+		for (int i = 0 ; i < 100 ; i++)
+		{
+			double f = 0.5*(start + inside);
+			if (getMarginalLogDensity(f) < minLogDens)
+				start = f;
+			else
+				inside = f;
+		}
+	}
+	if (getMarginalLogDensity(end) < minLogDens)
+	{
+		double inside = maxPos;
+
+		for (int i = 0 ; i < 100 ; i++)
+		{
+			double f = 0.5*(end + inside);
+			if (getMarginalLogDensity(f) < minLogDens)
+				end = f;
+			else
+				inside = f;
+		}
+	}
+
+	const int num = BINORMALDISTRIBUTION_TABLESIZE;
+	const double margin = 1.0 + BINORMALDISTRIBUTION_ENVELOPEMARGIN;
+	std::vector<double> logDens(num+1);
+
+	m_marginalMaxLogDens = maxLogDens;
+	m_marginalPoints.resize(num+1);
+	for (int i = 0 ; i <= num ; i++)
+	{
+		m_marginalPoints[i] = (i == num)?end:(start + (end - start)*(double)i/(double)num);
+		logDens[i] = getMarginalLogDensity(m_marginalPoints[i]) - maxLogDens;
+	}
+
+	// Exponential tails, using the slope of the logarithm between the two nearest points
+	double leftLength = start - m_minF;
+	double rightLength = m_maxF - end;
+	double leftMass = 0, rightMass = 0;
+
+	m_marginalLeftDens = std::exp(logDens[0])*margin;
+	m_marginalLeftRate = (logDens[1] - logDens[0])/(m_marginalPoints[1] - m_marginalPoints[0]);
+	if (leftLength > 0 && m_marginalLeftDens > 0)
+	{
+		leftMass = (m_marginalLeftRate*leftLength > 1e-10)?
+		           (-m_marginalLeftDens*std::expm1(-m_marginalLeftRate*leftLength)/m_marginalLeftRate):(m_marginalLeftDens*leftLength);
+	}
+
+	m_marginalRightDens = std::exp(logDens[num])*margin;
+	m_marginalRightRate = (logDens[num-1] - logDens[num])/(m_marginalPoints[num] - m_marginalPoints[num-1]);
+	if (rightLength > 0 && m_marginalRightDens > 0)
+	{
+		rightMass = (m_marginalRightRate*rightLength > 1e-10)?
+		            (-m_marginalRightDens*std::expm1(-m_marginalRightRate*rightLength)/m_marginalRightRate):(m_marginalRightDens*rightLength);
+	}
+
+	if (!std::isfinite(leftMass) || !std::isfinite(rightMass))
+		abortWithMessage("BinormalDistribution: couldn't construct an envelope for the marginal distribution");
+
+	double sum = leftMass;
+	double integral = 0;
+
+	m_marginalLower.resize(num);
+	m_marginalUpper.resize(num);
+	m_marginalCumulative.resize(num+2);
+	m_marginalCumulative[0] = sum;
+	for (int i = 0 ; i < num ; i++)
+	{
+		double d0 = std::exp(logDens[i]);
+		double d1 = std::exp(logDens[i+1]);
+		double width = m_marginalPoints[i+1] - m_marginalPoints[i];
+		double upperDens = std::max(d0, d1);
+
+		if (maxPos >= m_marginalPoints[i] && maxPos <= m_marginalPoints[i+1])
+			upperDens = std::max(upperDens, 1.0);
+
+		m_marginalLower[i] = std::min(d0, d1)/margin;
+		m_marginalUpper[i] = upperDens*margin;
+
+		sum += m_marginalUpper[i]*width;
+		m_marginalCumulative[i+1] = sum;
+
+		integral += 0.5*(d0 + d1)*width;
+	}
+	sum += rightMass;
+	m_marginalCumulative[num+1] = sum;
+
+	return std::exp(maxLogDens)*(integral + leftMass + rightMass)/(std::sqrt(2.0*3.14159265358979323846)*m_sigmaF);
+}
+
+// Number of values picked from the envelope before giving up. On average, much
+// less than two are needed.
+#define BINORMALDISTRIBUTION_MAXENVELOPEATTEMPTS 10000
+
+double BinormalDistribution::pickFromMarginal(GslRandomNumberGenerator *pRndGen) const
 {
-	return pickClippedGaussian(m_muY, m_sigmaY, m_minY, m_maxY);
+	if (m_marginalCumulative.empty() || !(m_marginalCumulative.back() > 0))
+		abortWithMessage("BinormalDistribution::pickPoint: couldn't find a point within the specified region");
+
+	const int num = (int)m_marginalUpper.size();
+
+	for (int attempt = 0 ; attempt < BINORMALDISTRIBUTION_MAXENVELOPEATTEMPTS ; attempt++)
+	{
+		// Select a part of the envelope according to its mass; the remainder of
+		// the random number then determines the position within that part
+		double r = pRndGen->pickRandomDouble()*m_marginalCumulative.back();
+		int part = (int)(std::upper_bound(m_marginalCumulative.begin(), m_marginalCumulative.end(), r) - m_marginalCumulative.begin());
+
+		part = std::min(part, num+1);
+
+		double prevCumulative = (part > 0)?m_marginalCumulative[part-1]:0;
+		double mass = m_marginalCumulative[part] - prevCumulative;
+		double t = (mass > 0)?std::min(std::max((r - prevCumulative)/mass, 0.0), 1.0):0;
+		double f, envelope, lowerDens = 0;
+
+		if (part == 0)
+		{
+			double length = m_marginalPoints[0] - m_minF;
+			double rate = m_marginalLeftRate;
+			double dist = (rate*length > 1e-10)?(-std::log1p(t*std::expm1(-rate*length))/rate):(t*length);
+
+			f = m_marginalPoints[0] - dist;
+			envelope = m_marginalLeftDens*std::exp(-rate*dist);
+		}
+		else if (part == num+1)
+		{
+			double length = m_maxF - m_marginalPoints[num];
+			double rate = m_marginalRightRate;
+			double dist = (rate*length > 1e-10)?(-std::log1p(t*std::expm1(-rate*length))/rate):(t*length);
+
+			f = m_marginalPoints[num] + dist;
+			envelope = m_marginalRightDens*std::exp(-rate*dist);
+		}
+		else
+		{
+			int i = part-1;
+
+			f = m_marginalPoints[i] + t*(m_marginalPoints[i+1] - m_marginalPoints[i]);
+			envelope = m_marginalUpper[i];
+			lowerDens = m_marginalLower[i];
+		}
+
+		f = std::min(std::max(f, m_minF), m_maxF);
+
+		// The lower bound avoids calculating the density most of the time
+		double v = pRndGen->pickRandomDouble()*envelope;
+
+		if (v < lowerDens)
+			return f;
+		if (v < std::exp(getMarginalLogDensity(f) - m_marginalMaxLogDens))
+			return f;
+	}
+
+	abortWithMessage("BinormalDistribution::pickPoint: couldn't pick a value from the marginal distribution");
+	return 0;
 }
 
-// TODO: is there a cleaner way to do this?
-double BinormalDistribution::pickClippedGaussian(double mean, double sigma, double minVal, double maxVal) const
+// The first coordinate f is picked from its marginal distribution, and the second
+// coordinate is then picked from its truncated conditional distribution.
+Point2D BinormalDistribution::pickPointDecomposed(GslRandomNumberGenerator *pRndGen) const
 {
-	GslRandomNumberGenerator *pRndGen = getRandomNumberGenerator();
-	const int maxCount = 10000;
-	int count = 0;
+	double f, s;
+
+	if (m_rho == 0)
+	{
+		f = pRndGen->pickTruncatedGaussian(m_muF, m_sigmaF, m_minF, m_maxF);
+		s = pRndGen->pickTruncatedGaussian(m_muS, m_sigmaS, m_minS, m_maxS);
+	}
+	else if (!(m_condSigma > 0))
+	{
+		// The points lie on the line s = muS + slope*(f - muF), so the bounds on s
+		// just restrict the values of f further
+		double f1 = m_muF + (m_minS - m_muS)/m_condSlope;
+		double f2 = m_muF + (m_maxS - m_muS)/m_condSlope;
+		double lower = std::max(m_minF, std::min(f1, f2));
+		double upper = std::min(m_maxF, std::max(f1, f2));
+
+		if (lower > upper)
+			abortWithMessage("BinormalDistribution::pickPoint: couldn't find a point within the specified region");
 
-	double x = pRndGen->pickGaussianNumber(mean, sigma);
-	while ((x < minVal || x > maxVal) && count++ < maxCount)
-		x = pRndGen->pickGaussianNumber(mean, sigma);
+		f = pRndGen->pickTruncatedGaussian(m_muF, m_sigmaF, lower, upper);
+		s = std::min(std::max(m_muS + m_condSlope*(f - m_muF), m_minS), m_maxS);
+	}
+	else
+	{
+		f = pickFromMarginal(pRndGen);
+		s = pRndGen->pickTruncatedGaussian(m_muS + m_condSlope*(f - m_muF), m_condSigma, m_minS, m_maxS);
+	}
+
+	if (m_decomposeYFirst)
+		return Point2D(s, f);
+	return Point2D(f, s);
+}
 
-	if (count >= maxCount)
-		abortWithMessage("BinormalDistribution::pickClippedGaussian: rejection sampling couldn't find a point within the specified region");
+double BinormalDistribution::pickMarginalX() const
+{
+	return getRandomNumberGenerator()->pickTruncatedGaussian(m_muX, m_sigmaX, m_minX, m_maxX);
+}
 
-	return x;
+double BinormalDistribution::pickMarginalY() const
+{
+	return getRandomNumberGenerator()->pickTruncatedGaussian(m_muY, m_sigmaY, m_minY, m_maxY);
 }
 
 double BinormalDistribution::pickConditionalOnX(double x) const
@@ -113,5 +483,5 @@ double BinormalDistribution::pickConditional(double val, double meanDest, double
 	double sigma = sigmaDest*std::sqrt(1.0-m_rho*m_rho);
 	double mean = meanDest + m_rho * (val-meanCond) * (sigmaDest/sigmaCond);
 
-	return pickClippedGaussian(mean, sigma, minVal, maxVal);
+	return getRandomNumberGenerator()->pickTruncatedGaussian(mean, sigma, minVal, maxVal);
 }
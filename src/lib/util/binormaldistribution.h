@@ -4,8 +4,14 @@
 
 #include "probabilitydistribution2d.h"
 #include <limits>
+#include <vector>
 
-// Uses rejection sampling
+// Points are picked from the full distribution until one lies inside the bounds,
+// unless the bounds contain only a small part of the distribution. In that case
+// one coordinate is picked from its exact marginal distribution using rejection
+// sampling (see initMarginalEnvelope), and the other one from its conditional
+// distribution. Single coordinates are picked using
+// GslRandomNumberGenerator::pickTruncatedGaussian.
 class BinormalDistribution : public ProbabilityDistribution2D
 {
 public:
@@ -22,6 +28,8 @@ public:
 	~BinormalDistribution();
 
 	Point2D pickPoint() const;
+	bool hasBulkPicking() const							{ return true; }
+	void pickPoints(GslRandomNumberGenerator *pRndGen, Point2D *pPoints, size_t num) const;
 	double pickMarginalX() const;
 	double pickMarginalY() const;
 	double pickConditionalOnX(double x) const;
@@ -38,7 +46,12 @@ public:
 	double getMaxY() const								{ return m_maxY; }
 	double getRho() const								{ return m_rho; }
 private:
-	double pickClippedGaussian(double mean, double sigma, double minVal, double maxVal) const;
+	Point2D pickPoint(GslRandomNumberGenerator *pRndGen) const;
+	void initDecomposition();
+	double initMarginalEnvelope();
+	double getMarginalLogDensity(double f) const;
+	double pickFromMarginal(GslRandomNumberGenerator *pRndGen) const;
+	Point2D pickPointDecomposed(GslRandomNumberGenerator *pRndGen) const;
 	double pickConditional(double val, double meanDest, double meanCond, double sigmaDest, double sigmaCond, double minVal, double maxVal) const;
 
 	bool m_isSymm;
@@ -47,6 +60,28 @@ private:
 	double m_muY, m_sigmaY;
 	double m_minY, m_maxY;
 	double m_rho;
+
+	// Set by initDecomposition: whether points are picked from the full distribution
+	// until one lies inside the bounds. If not, the first coordinate f (x, or y if
+	// m_decomposeYFirst is set) is picked from its marginal distribution and the
+	// second coordinate s from its conditional distribution.
+	bool m_useRejection;
+	bool m_decomposeYFirst;
+	double m_muF, m_sigmaF, m_minF, m_maxF;
+	double m_muS, m_sigmaS, m_minS, m_maxS;
+	double m_condSlope, m_condSigma;
+
+	// Envelope of the marginal density of f, relative to its maximum: constant
+	// between two points, and exponential below the first and above the last one.
+	// The cumulative masses are those of the left tail, the intervals and the
+	// right tail.
+	double m_marginalMaxLogDens;
+	std::vector<double> m_marginalPoints;
+	std::vector<double> m_marginalLower;
+	std::vector<double> m_marginalUpper;
+	std::vector<double> m_marginalCumulative;
+	double m_marginalLeftDens, m_marginalLeftRate;
+	double m_marginalRightDens, m_marginalRightRate;
 };
 
 #endif // BINORMALDISTRIBUTION_H
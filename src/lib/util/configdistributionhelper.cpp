@@ -10,6 +10,7 @@
 #include "binormaldistribution.h"
 #include "discretedistribution2d.h"
 #include "discretedistributionwrapper.h"
+#include "discretedistributionalias.h"
 #include "discretedistributionwrapper2d.h"
 #include "tiffdensityfile.h"
 #include "csvfile.h"
@@ -121,18 +122,22 @@ ProbabilityDistribution *getDistributionFromConfig(ConfigSettings &config, GslRa
 		double xMin = 0, xMax = 0;
 		int yCol = 0;
 		bool floor = false;
+		string samplerName;
+		DiscreteDistributionAlias::SamplerType sampler;
 
 		if (!(r = config.getKeyValue(prefix + ".dist.discrete.csv.onecol.file", fileName)) ||
 			!(r = config.getKeyValue(prefix + ".dist.discrete.csv.onecol.xmin", xMin)) ||
 			!(r = config.getKeyValue(prefix + ".dist.discrete.csv.onecol.xmax", xMax, xMin)) ||
 			!(r = config.getKeyValue(prefix + ".dist.discrete.csv.onecol.ycolumn", yCol, 1)) ||
-			!(r = config.getKeyValue(prefix + ".dist.discrete.csv.onecol.floor", floor)) )
+			!(r = config.getKeyValue(prefix + ".dist.discrete.csv.onecol.floor", floor)) ||
+			!(r = config.getKeyValue(prefix + ".dist.discrete.csv.onecol.sampler", samplerName, DiscreteDistributionAlias::getSamplerNames())) ||
+			!(r = DiscreteDistributionAlias::getSamplerType(samplerName, sampler)) )
 			abortWithMessage(r.getErrorString());
 
 		DiscreteDistributionWrapper *pDist0 = new DiscreteDistributionWrapper(pRndGen);
 		pDist = pDist0;
 
-		if (!(r = pDist0->init(fileName, xMin, xMax, yCol, floor)))
+		if (!(r = pDist0->init(fileName, xMin, xMax, yCol, floor, sampler)))
 			abortWithMessage("Unable to initialize 1D distribution for " + prefix + ": " + r.getErrorString());
 	}
 	else if (distName == "discrete.csv.twocol")
@@ -140,18 +145,22 @@ ProbabilityDistribution *getDistributionFromConfig(ConfigSettings &config, GslRa
 		string fileName;
 		int xCol = 0, yCol = 0;
 		bool floor = false;
+		string samplerName;
+		DiscreteDistributionAlias::SamplerType sampler;
 
 		if (!(r = config.getKeyValue(prefix + ".dist.discrete.csv.twocol.file", fileName)) ||
 			!(r = config.getKeyValue(prefix + ".dist.discrete.csv.twocol.xcolumn", xCol, 1)) ||
 			!(r = config.getKeyValue(prefix + ".dist.discrete.csv.twocol.ycolumn", yCol, 1)) ||
-			!(r = config.getKeyValue(prefix + ".dist.discrete.csv.twocol.floor", floor)) 
+			!(r = config.getKeyValue(prefix + ".dist.discrete.csv.twocol.floor", floor)) ||
+			!(r = config.getKeyValue(prefix + ".dist.discrete.csv.twocol.sampler", samplerName, DiscreteDistributionAlias::getSamplerNames())) ||
+			!(r = DiscreteDistributionAlias::getSamplerType(samplerName, sampler))
 			)
 			abortWithMessage(r.getErrorString());
 
 		DiscreteDistributionWrapper *pDist0 = new DiscreteDistributionWrapper(pRndGen);
 		pDist = pDist0;
 
-		if (!(r = pDist0->init(fileName, xCol, yCol, floor)))
+		if (!(r = pDist0->init(fileName, xCol, yCol, floor, sampler)))
 			abortWithMessage("Unable to initialize 1D distribution for " + prefix + ": " + r.getErrorString());
 	}
 	else if (distName == "discrete.inline")
@@ -159,16 +168,20 @@ ProbabilityDistribution *getDistributionFromConfig(ConfigSettings &config, GslRa
 		vector<double> xValues;
 		vector<double> yValues;
 		bool floor = false;
+		string samplerName;
+		DiscreteDistributionAlias::SamplerType sampler;
 
 		if (!(r = config.getKeyValue(prefix + ".dist.discrete.inline.xvalues", xValues)) ||
 			!(r = config.getKeyValue(prefix + ".dist.discrete.inline.yvalues", yValues, 0)) ||
-			!(r = config.getKeyValue(prefix + ".dist.discrete.inline.floor", floor)) )
+			!(r = config.getKeyValue(prefix + ".dist.discrete.inline.floor", floor)) ||
+			!(r = config.getKeyValue(prefix + ".dist.discrete.inline.sampler", samplerName, DiscreteDistributionAlias::getSamplerNames())) ||
+			!(r = DiscreteDistributionAlias::getSamplerType(samplerName, sampler)) )
 			abortWithMessage(r.getErrorString());
 
 		DiscreteDistributionWrapper *pDist0 = new DiscreteDistributionWrapper(pRndGen);
 		pDist = pDist0;
 
-		if (!(r = pDist0->init(xValues, yValues, floor)))
+		if (!(r = pDist0->init(xValues, yValues, floor, sampler)))
 			abortWithMessage("Unable to initialize 1D distribution for " + prefix + ": " + r.getErrorString());
 	}
 	else
@@ -298,6 +311,7 @@ void addDistributionToConfig(ProbabilityDistribution *pSrcDist, ConfigWriter &co
 			int xCol = pDist->getXCol();
 			int yCol = pDist->getYCol();
 			bool floor = pDist->getFloor();
+			string sampler = DiscreteDistributionAlias::getSamplerName(pDist->getSampler());
 
 			if (xCol < 0 && yCol < 0) // inline
 			{
@@ -307,7 +321,8 @@ void addDistributionToConfig(ProbabilityDistribution *pSrcDist, ConfigWriter &co
 				if (!(r = config.addKey(prefix + ".dist.type", "discrete.inline")) ||
 					!(r = config.addKey(prefix + ".dist.discrete.inline.xvalues", xValueStr)) ||
 					!(r = config.addKey(prefix + ".dist.discrete.inline.yvalues", yValueStr)) ||
-					!(r = config.addKey(prefix + ".dist.discrete.inline.floor", floor)) )
+					!(r = config.addKey(prefix + ".dist.discrete.inline.floor", floor)) ||
+					!(r = config.addKey(prefix + ".dist.discrete.inline.sampler", sampler)) )
 					abortWithMessage(r.getErrorString());
 			}
 			else if (yCol > 0 && xCol < 0) // CSV, one column
@@ -317,7 +332,8 @@ void addDistributionToConfig(ProbabilityDistribution *pSrcDist, ConfigWriter &co
 					!(r = config.addKey(prefix + ".dist.discrete.csv.onecol.xmin", pDist->getXMin())) ||
 					!(r = config.addKey(prefix + ".dist.discrete.csv.onecol.xmax", pDist->getXMax())) ||
 					!(r = config.addKey(prefix + ".dist.discrete.csv.onecol.ycolumn", yCol)) ||
-					!(r = config.addKey(prefix + ".dist.discrete.csv.onecol.floor", floor)) )
+					!(r = config.addKey(prefix + ".dist.discrete.csv.onecol.floor", floor)) ||
+					!(r = config.addKey(prefix + ".dist.discrete.csv.onecol.sampler", sampler)) )
 					abortWithMessage(r.getErrorString());
 			}
 			else // CSV, two columns
@@ -326,7 +342,8 @@ void addDistributionToConfig(ProbabilityDistribution *pSrcDist, ConfigWriter &co
 					!(r = config.addKey(prefix + ".dist.discrete.csv.twocol.file", pDist->getFileName())) ||
 					!(r = config.addKey(prefix + ".dist.discrete.csv.twocol.xcolumn", xCol)) ||
 					!(r = config.addKey(prefix + ".dist.discrete.csv.twocol.ycolumn", yCol)) ||
-					!(r = config.addKey(prefix + ".dist.discrete.csv.twocol.floor", floor)) )
+					!(r = config.addKey(prefix + ".dist.discrete.csv.twocol.floor", floor)) ||
+					!(r = config.addKey(prefix + ".dist.discrete.csv.twocol.sampler", sampler)) )
 					abortWithMessage(r.getErrorString());
 			}
 
@@ -414,7 +431,7 @@ ProbabilityDistribution2D *getDistribution2DFromConfig(ConfigSettings &config, G
 	}
 	else if (distName == "discrete")
 	{
-		string densFileName, maskFileName;
+		string densFileName, maskFileName, cacheDir;
 		double xOffset = 0, yOffset = 0, width = 0, height = 0;
 		bool flipy = false, floor = false;
 
@@ -425,14 +442,15 @@ ProbabilityDistribution2D *getDistribution2DFromConfig(ConfigSettings &config, G
 		    !(r = config.getKeyValue(prefix + ".dist2d.discrete.width", width)) ||
 		    !(r = config.getKeyValue(prefix + ".dist2d.discrete.height", height)) ||
 		    !(r = config.getKeyValue(prefix + ".dist2d.discrete.flipy", flipy)) ||
-			!(r = config.getKeyValue(prefix + ".dist2d.discrete.floor", floor)) 
+			!(r = config.getKeyValue(prefix + ".dist2d.discrete.floor", floor)) ||
+			!(r = config.getKeyValue(prefix + ".dist2d.discrete.cachedir", cacheDir))
 		   )
 			abortWithMessage(r.getErrorString());
 
 		DiscreteDistributionWrapper2D *pDist0 = new DiscreteDistributionWrapper2D(pRndGen);
 		pDist = pDist0;
 
-		if (!(r = pDist0->init(densFileName, maskFileName, xOffset, yOffset, width, height, flipy, floor)))
+		if (!(r = pDist0->init(densFileName, maskFileName, xOffset, yOffset, width, height, flipy, floor, cacheDir)))
 			abortWithMessage("Unable to initialize 2D discrete distribution for " + prefix + ": " + r.getErrorString());
 	}
 	else
@@ -533,7 +551,8 @@ void addDistribution2DToConfig(ProbabilityDistribution2D *pSrcDist, ConfigWriter
 			    !(r = config.addKey(prefix + ".dist2d.discrete.width", pDist->getWidth())) ||
 			    !(r = config.addKey(prefix + ".dist2d.discrete.height", pDist->getHeight())) ||
 			    !(r = config.addKey(prefix + ".dist2d.discrete.flipy", pDist->isYFlipped())) ||
-				!(r = config.addKey(prefix + ".dist2d.discrete.floor", pDist->isFloored())) )
+				!(r = config.addKey(prefix + ".dist2d.discrete.floor", pDist->isFloored())) ||
+				!(r = config.addKey(prefix + ".dist2d.discrete.cachedir", pDist->getCacheDirectory())) )
 				abortWithMessage(r.getErrorString());
 
 			return;
@@ -592,19 +611,19 @@ JSONConfig distributionJSONConfig("distTypes", R"JSON(
             ]
         },
 		"discrete.inline": {
-			"params": [ ["xvalues", null ], ["yvalues", null ], [ "floor", "no" ] ],
+			"params": [ ["xvalues", null ], ["yvalues", null ], [ "floor", "no" ], [ "sampler", "auto", [ "auto", "search", "alias" ] ] ],
 			"info": [
 				"TODO"
 			]
 		},
 		"discrete.csv.onecol": {
-			"params": [ ["file", null ], ["xmin", 0 ], [ "xmax", 1 ], [ "ycolumn", 1 ], [ "floor", "no" ] ],
+			"params": [ ["file", null ], ["xmin", 0 ], [ "xmax", 1 ], [ "ycolumn", 1 ], [ "floor", "no" ], [ "sampler", "auto", [ "auto", "search", "alias" ] ] ],
 			"info": [
 				"TODO"
 			]
 		},
 		"discrete.csv.twocol": {
-			"params": [ [ "file", null ], [ "xcolumn", 1 ], [ "ycolumn" , 2 ], [ "floor", "no" ] ],
+			"params": [ [ "file", null ], [ "xcolumn", 1 ], [ "ycolumn" , 2 ], [ "floor", "no" ], [ "sampler", "auto", [ "auto", "search", "alias" ] ] ],
 			"info": [
 				"TODO"
 			]
@@ -674,7 +693,8 @@ JSONConfig distribution2DJSONConfig("distTypes2D", R"JSON(
                 [ "width", 1 ],
                 [ "height", 1 ],
                 [ "flipy", "yes", [ "yes", "no"] ],
-				[ "floor", "no" ]
+				[ "floor", "no" ],
+                [ "cachedir", "" ]
             ],
             "info": [ 
                 "The 'densfile' parameter specifies a TIFF file you want to use to base a",
@@ -691,7 +711,11 @@ JSONConfig distribution2DJSONConfig("distTypes2D", R"JSON(
                 "point down and the (0,0) pixel would be the upper-left pixel. This is what",
                 "is used when 'flipy' is set to 'no'. The default however is 'yes', which",
                 "causes the lower-left pixel to be the (0,0) pixel of the TIFF file, and",
-                "which causes the y-axis to point up, as usually will be desired."
+                "which causes the y-axis to point up, as usually will be desired.",
+                "",
+                "If 'cachedir' is set, the processed distribution is stored in a file in",
+                "that directory, so that subsequent runs with the same input files can",
+                "start faster."
             ]
         })JSON");
 
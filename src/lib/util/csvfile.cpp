@@ -1,135 +1,241 @@
 #include "csvfile.h"
+#include "mappedfile.h"
 #include "util.h"
+#include "mutex.h"
+#include <sys/types.h>
+#include <sys/stat.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <map>
+
+using namespace std;
+
+// A file in the cache, together with the size and modification time it had
+// when it was loaded
+class CSVFileCacheEntry
+{
+public:
+	CSVFileCacheEntry() : m_size(0), m_modTime(0)						{ }
+
+	int64_t m_size;
+	int64_t m_modTime;
+	CSVFile m_contents;
+};
+
+static map<string, CSVFileCacheEntry> s_csvFileCache;
+static Mutex s_csvFileCacheMutex;
+
+bool CSVFile::s_cacheEnabled = false;
 
 CSVFile::CSVFile()
 {
+	m_numRows = 0;
 }
 
 CSVFile::~CSVFile()
 {
 }
 
+void CSVFile::setCacheEnabled(bool enabled)
+{
+	s_csvFileCacheMutex.lock();
+	s_cacheEnabled = enabled;
+	if (!enabled)
+		s_csvFileCache.clear();
+	s_csvFileCacheMutex.unlock();
+}
+
 bool_t CSVFile::load(const std::string &fileName)
 {
-	FILE *pFile = fopen(fileName.c_str(), "rt");
+	if (s_cacheEnabled)
+		return loadCached(fileName);
+	return loadFile(fileName);
+}
+
+bool_t CSVFile::loadCached(const std::string &fileName)
+{
+	struct stat st;
+
+	if (stat(fileName.c_str(), &st) != 0)
+		return loadFile(fileName); // this will report the error
+
+	// Use the full path as key, so that a relative file name that was used
+	// from another working directory refers to the same entry
+	string key = fileName;
+#ifndef WIN32
+	char fullPath[PATH_MAX];
+
+	if (realpath(fileName.c_str(), fullPath) != 0)
+		key = fullPath;
+#endif // !WIN32
+
+	s_csvFileCacheMutex.lock();
+	map<string, CSVFileCacheEntry>::const_iterator it = s_csvFileCache.find(key);
+	if (it != s_csvFileCache.end() && it->second.m_size == (int64_t)st.st_size && 
+	    it->second.m_modTime == (int64_t)st.st_mtime)
+	{
+		*this = it->second.m_contents;
+		s_csvFileCacheMutex.unlock();
+		return true;
+	}
+	s_csvFileCacheMutex.unlock();
+
+	bool_t r = loadFile(fileName);
+	if (!r)
+		return r;
+
+	s_csvFileCacheMutex.lock();
+	CSVFileCacheEntry &entry = s_csvFileCache[key];
+	entry.m_size = (int64_t)st.st_size;
+	entry.m_modTime = (int64_t)st.st_mtime;
+	entry.m_contents = *this;
+	s_csvFileCacheMutex.unlock();
+	return true;
+}
+
+bool_t CSVFile::loadFile(const std::string &fileName)
+{
+	m_headers.clear();
+	m_columns.clear();
+	m_hasValue.clear();
+	m_numRows = 0;
+
+	FILE *pFile = fopen(fileName.c_str(), "rb");
 	if (pFile == 0)
 		return "Unable to open speficied file " + fileName;
-	
-	std::string line;
-	int lineNumber = 0;
-	int numCols = -1;
 
-	m_headers.clear();
-	m_values.clear();
-	m_map.clear();
+	fseek(pFile, 0, SEEK_END);
+	long fileSize = ftell(pFile);
+	fclose(pFile);
+
+	if (fileSize == 0) // nothing to map, just an empty file
+		return true;
+
+	MappedFile file;
+	bool_t r;
+
+	if (!(r = file.open(fileName)))
+		return r;
 
-	while (ReadInputLine(pFile, line))
+	const char *pData = (const char *)file.getData();
+	const char *pDataEnd = pData + file.getSize();
+
+	// Locate the lines that are not empty. As when reading line by line using
+	// ReadInputLine, a '\r' at the end of a line is ignored, as is everything
+	// starting from a 0 character.
+	vector<const char *> lineStarts, lineEnds;
+	const char *pLine = pData;
+
+	while (pLine < pDataEnd)
 	{
-		if (line.length() == 0) // Let's skip empty lines
-			continue;
+		const char *pNewLine = (const char *)memchr(pLine, '\n', pDataEnd - pLine);
+		const char *pNext = (pNewLine)?(pNewLine + 1):pDataEnd;
+		size_t len = ((pNewLine)?pNewLine:pDataEnd) - pLine;
 
-		std::vector<std::string> args;
+		if (len > 0 && pLine[len-1] == '\r')
+			len--;
 
-		lineNumber++;
-		SplitLine(line, args, ",", "\"", "", false);
+		const char *pZero = (const char *)memchr(pLine, 0, len);
+		if (pZero)
+			len = pZero - pLine;
 
-		bool isHeader = false;
+		if (len > 0) // Let's skip empty lines
+		{
+			lineStarts.push_back(pLine);
+			lineEnds.push_back(pLine + len);
+		}
+		pLine = pNext;
+	}
+
+	if (lineStarts.size() == 0)
+		return true;
 
-		if (lineNumber == 1)
+	// Check if the first line contains the headers
+	vector<string> args;
+	size_t firstDataLine = 0;
+	int numCols = 0;
+
+	splitLine(lineStarts[0], lineEnds[0], args);
+	numCols = (int)args.size();
+
+	if (memchr(lineStarts[0], '"', lineEnds[0] - lineStarts[0]) != 0) // assume it's a header line
+		firstDataLine = 1;
+	else
+	{
+		// assume it's a header unless it's all numbers
+		for (size_t i = 0 ; firstDataLine == 0 && i < args.size() ; i++)
 		{
-			if (line.find("\"") != std::string::npos) // assume it's a header line
-			{
-				isHeader = true;
-				m_headers = args;
-				numCols = m_headers.size();
-			}
-			else
-			{
-				bool allNumbers = true;
-
-				for (size_t i = 0 ; allNumbers && i < args.size() ; i++)
-				{
-					double v;
-
-					if (!checkNumber(args[i], v))
-						allNumbers = false;
-				}
-
-				if (!allNumbers) // assume it's a header unless it's all numbers
-				{
-					isHeader = true;
-					m_headers = args;
-					numCols = m_headers.size();
-				}
-			}
+			double v;
+
+			if (!checkNumber(args[i], v))
+				firstDataLine = 1;
 		}
+	}
+
+	if (firstDataLine == 1)
+		m_headers = args;
+
+	// Convert the data lines, in parallel if there are many values
+	int numRows = (int)(lineStarts.size() - firstDataLine);
+	vector<int> fieldCounts(numRows);
+
+	m_columns.resize(numCols);
+	m_hasValue.resize(numCols);
+	for (int i = 0 ; i < numCols ; i++)
+	{
+		m_columns[i].resize(numRows);
+		m_hasValue[i].resize(numRows);
+	}
+
+	#pragma omp parallel for schedule(dynamic, 64) if ((int64_t)numRows*(int64_t)numCols > 100000)
+	for (int row = 0 ; row < numRows ; row++)
+		fieldCounts[row] = parseLine(lineStarts[row + firstDataLine], lineEnds[row + firstDataLine], numCols, row, m_columns, m_hasValue);
 
-		if (!isHeader)
+	for (int row = 0 ; row < numRows ; row++)
+	{
+		if (fieldCounts[row] != numCols)
 		{
-			if (numCols < 0)
-				numCols = args.size();
-
-			if (numCols != (int)args.size())
-			{
-				fclose(pFile);
-				return strprintf("Number of columns changed from %d to %d on line %d", numCols, (int)args.size(), lineNumber);
-			}
-
-			std::vector<bool> mapLine(numCols);
-			std::vector<double> valueLine(numCols);
-
-			for (int i = 0 ; i < numCols ; i++)
-			{
-				double value;
-				bool f = checkNumber(args[i], value);
-
-				if (f)
-				{
-					mapLine[i] = true;
-					valueLine[i] = value;
-				}
-				else
-				{
-					mapLine[i] = false;
-					valueLine[i] = 0;
-				}
-			}
-
-			m_values.push_back(valueLine);
-			m_map.push_back(mapLine);
+			// Line numbers count the non-empty lines, including the header
+			int lineNumber = row + (int)firstDataLine + 1;
+
+			m_headers.clear();
+			m_columns.clear();
+			m_hasValue.clear();
+			return strprintf("Number of columns changed from %d to %d on line %d", numCols, fieldCounts[row], lineNumber);
 		}
 	}
 
-	fclose(pFile);
+	m_numRows = numRows;
 	return true;
 }
 
 int CSVFile::getNumberOfColumns()
 {
-	if (m_values.size() > 0)
-		return m_values[0].size();
+	if (m_numRows > 0)
+		return m_columns.size();
 	return 0;
 }
 
 int CSVFile::getNumberOfRows()
 {
-	return m_values.size();
+	return m_numRows;
 }
 
 bool CSVFile::hasValue(int row, int column)
 {
-	if (row >= (int)m_map.size() || row < 0)
+	if (row >= m_numRows || row < 0)
 		return false;
-	if (column >= (int)m_map[row].size() || column < 0)
+	if (column >= (int)m_hasValue.size() || column < 0)
 		return false;
-	return m_map[row][column];
+	return m_hasValue[column][row] != 0;
 }
 
 double CSVFile::getValue(int row, int column)
 {
-	return m_values[row][column];
+	return m_columns[column][row];
 }
 
 const std::string CSVFile::getColumnName(int col) const
@@ -141,38 +247,147 @@ const std::string CSVFile::getColumnName(int col) const
 	return m_headers[col];
 }
 
-bool CSVFile::checkNumber(const std::string &s, double &value)
+void CSVFile::splitLine(const char *pStart, const char *pEnd, vector<string> &args)
 {
-	if (s.length() == 0)
-		return false;
+	SplitLine(string(pStart, pEnd - pStart), args, ",", "\"", "", false);
+}
 
-	const char *pStart = s.c_str();
-	const char *pEnd = pStart + (s.length()-1);
+// Stores the values of the line in the specified row, and returns the number of
+// fields that were found. For lines without quotes, which is what's normally
+// used for the data, the fields are converted without creating strings first.
+int CSVFile::parseLine(const char *pStart, const char *pEnd, int numCols, size_t row, 
+                       vector<vector<double> > &columns, vector<vector<char> > &hasValue)
+{
+	if (memchr(pStart, '"', pEnd - pStart) != 0)
+	{
+		vector<string> args;
 
-	while ((*pStart == ' ' || *pStart == '\t') && pStart <= pEnd)
-		pStart++;
+		splitLine(pStart, pEnd, args);
+		for (int i = 0 ; i < numCols && i < (int)args.size() ; i++)
+		{
+			double value = 0;
+
+			hasValue[i][row] = (checkNumber(args[i], value))?1:0;
+			columns[i][row] = (hasValue[i][row])?value:0;
+		}
+		return (int)args.size();
+	}
+
+	int numFields = 0;
+	const char *pField = pStart;
+
+	while (true)
+	{
+		const char *pComma = (const char *)memchr(pField, ',', pEnd - pField);
+		const char *pFieldEnd = (pComma)?pComma:pEnd;
+
+		if (numFields < numCols)
+		{
+			double value = 0;
+
+			hasValue[numFields][row] = (checkNumber(pField, pFieldEnd, value))?1:0;
+			columns[numFields][row] = (hasValue[numFields][row])?value:0;
+		}
+		numFields++;
+
+		if (!pComma)
+			break;
+		pField = pComma + 1;
+	}
+	return numFields;
+}
+
+// Converts numbers like -12.345 that have at most 15 digits and no exponent. The
+// digits then form an integer that's exactly representable as a double, as is
+// the power of ten to divide by, so a single division gives the correctly rounded
+// result, which is exactly what strtod would give. For anything else, false is
+// returned and strtod is used.
+bool CSVFile::parseSimpleNumber(const char *pStart, const char *pEnd, double &value)
+{
+	static const double powersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+	const char *p = pStart;
+	bool negative = false;
+
+	if (*p == '-')
+	{
+		negative = true;
+		p++;
+	}
+
+	int64_t mantissa = 0;
+	int numDigits = 0;
+	int numFractionDigits = 0;
+	bool gotPoint = false;
 
-	if (pStart > pEnd)
+	for ( ; p < pEnd ; p++)
+	{
+		char c = *p;
+
+		if (c >= '0' && c <= '9')
+		{
+			if (++numDigits > 15)
+				return false;
+
+			mantissa = mantissa*10 + (c - '0');
+			if (gotPoint)
+				numFractionDigits++;
+		}
+		else if (c == '.' && !gotPoint)
+			gotPoint = true;
+		else
+			return false;
+	}
+
+	if (numDigits == 0)
 		return false;
 
-	while ((*pEnd == ' ' || *pEnd == '\t') && pEnd >= pStart)
+	double v = (double)mantissa/powersOfTen[numFractionDigits];
+	value = (negative)?-v:v;
+	return true;
+}
+
+bool CSVFile::checkNumber(const std::string &s, double &value)
+{
+	return checkNumber(s.c_str(), s.c_str() + s.length(), value);
+}
+
+bool CSVFile::checkNumber(const char *pStart, const char *pEnd, double &value)
+{
+	while (pStart < pEnd && (*pStart == ' ' || *pStart == '\t'))
+		pStart++;
+
+	while (pEnd > pStart && (pEnd[-1] == ' ' || pEnd[-1] == '\t'))
 		pEnd--;
 
-	if (pStart > pEnd)
+	if (pStart == pEnd)
 		return false;
 
-	pEnd++;
+	if (parseSimpleNumber(pStart, pEnd, value))
+		return true;
 
-	double v = 0;
-	const char *nptr = pStart;
-	char *endptr;
+	// strtod needs a null-terminated string, the mapped data may not contain one
+	char buf[64];
+	string longField;
+	size_t len = pEnd - pStart;
+	const char *pStr = buf;
+
+	if (len < sizeof(buf))
+	{
+		memcpy(buf, pStart, len);
+		buf[len] = 0;
+	}
+	else
+	{
+		longField.assign(pStart, len);
+		pStr = longField.c_str();
+	}
 
-	v = strtod(nptr, &endptr);
+	char *endptr;
+	double v = strtod(pStr, &endptr);
 
-	if (endptr != pEnd)
+	if (endptr != pStr + len)
 		return false;
 
 	value = v;
 	return true;
 }
-
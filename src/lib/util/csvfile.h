@@ -7,6 +7,7 @@
  */
 
 #include "booltype.h"
+#include <string>
 #include <vector>
 
 /** This is a helper class for reading CSV files, which are assumed to hold numbers.
@@ -28,6 +29,13 @@
  * 
  *  If the first line does not contain double quotes and all entries are numerical values,
  *  the CSV file is assumed to not have a header, only containing data.
+ *
+ *  The file is memory mapped, and the lines are converted to numbers in parallel,
+ *  directly from the mapped data. The values are stored per column.
+ *
+ *  When the cache is enabled using setCacheEnabled, the contents of each file that
+ *  was loaded successfully are kept, and loading the same file again just copies
+ *  these, as long as the size and modification time of the file did not change.
  */
 class CSVFile
 {
@@ -38,6 +46,10 @@ public:
 	/** Try to load the specified file, setting the error string if failed. */
 	bool_t load(const std::string &fileName);
 
+	/** Enables or disables the cache of loaded files; disabling it also clears
+	 *  the stored contents. */
+	static void setCacheEnabled(bool enabled);
+
 	/** Returns the number of columns in the loaded file. */
 	int getNumberOfColumns();
 
@@ -50,14 +62,29 @@ public:
 	/** Returns the stored value for the specified position. */
 	double getValue(int row, int column);
 
+	/** Returns the values of the specified column, which must exist. For positions
+	 *  without a numerical value, the value is zero. */
+	const std::vector<double> &getColumn(int column) const					{ return m_columns[column]; }
+
 	/** Returns the name of the specified column (from the header). */
 	const std::string getColumnName(int col) const;
 private:
-	bool checkNumber(const std::string &s, double &value);
+	bool_t loadFile(const std::string &fileName);
+	bool_t loadCached(const std::string &fileName);
+
+	static bool checkNumber(const std::string &s, double &value);
+	static bool checkNumber(const char *pStart, const char *pEnd, double &value);
+	static bool parseSimpleNumber(const char *pStart, const char *pEnd, double &value);
+	static void splitLine(const char *pStart, const char *pEnd, std::vector<std::string> &args);
+	static int parseLine(const char *pStart, const char *pEnd, int numCols, size_t row,
+	                     std::vector<std::vector<double> > &columns, std::vector<std::vector<char> > &hasValue);
 
 	std::vector<std::string> m_headers;
-	std::vector<std::vector<double> > m_values;
-	std::vector<std::vector<bool> > m_map;
+	std::vector<std::vector<double> > m_columns;
+	std::vector<std::vector<char> > m_hasValue;
+	int m_numRows;
+
+	static bool s_cacheEnabled;
 };
 
 #endif // CSVFILE_H
@@ -49,7 +49,20 @@ DiscreteDistribution::~DiscreteDistribution()
 
 double DiscreteDistribution::pickNumber() const
 {
-	double r = getRandomNumberGenerator()->pickRandomDouble() * m_totalSum;
+	return getValue(getRandomNumberGenerator()->pickRandomDouble());
+}
+
+void DiscreteDistribution::pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const
+{
+	pRndGen->pickRandomDoubles(pValues, num);
+
+	for (size_t i = 0 ; i < num ; i++)
+		pValues[i] = getValue(pValues[i]);
+}
+
+double DiscreteDistribution::getValue(double u) const
+{
+	double r = u * m_totalSum;
 	int foundBin = -1;
 
 	for (size_t i = 0 ; i < m_histSums.size() ; i++)
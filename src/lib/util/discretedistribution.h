@@ -40,7 +40,12 @@ public:
 	~DiscreteDistribution();
 
 	double pickNumber() const;
+	bool hasBulkPicking() const									{ return true; }
+	void pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const;
 private:
+	// Transforms the uniform random number u into a number from the distribution
+	double getValue(double u) const;
+
 	std::vector<double> m_histSums;
 	std::vector<double> m_binStarts;
 	double m_totalSum;
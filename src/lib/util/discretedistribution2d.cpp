@@ -1,49 +1,335 @@
 #include "discretedistribution2d.h"
 #include "gridvalues.h"
+#include "gslrandomnumbergenerator.h"
+#include "mappedfile.h"
 #include "util.h"
-#include <iostream>
+#include <string.h>
+#include <stdio.h>
+#ifndef WIN32
+#include <unistd.h>
+#else
+#include <process.h>
+#endif // !WIN32
+#include <algorithm>
 #include <limits>
+#include <memory>
 
 using namespace std;
 
+// Increase this when the layout of the cache file changes
+#define DISCRETEDISTRIBUTION2D_CACHEVERSION 1
+
+// The header of a cache file, followed by the tables as stored in Tables::m_values.
+// The file is written in the native byte order, it's only meant to be reused on the
+// same kind of machine.
+struct DiscreteDistribution2DCacheHeader
+{
+	char m_magic[8];
+	uint32_t m_version;
+	uint32_t m_flippedY;
+	uint64_t m_key;
+	int32_t m_width;
+	int32_t m_height;
+};
+
+static const char s_cacheMagic[8] = { 'S', 'I', 'M', 'P', 'D', '2', 'D', 0 };
+
+// Holds the filtered density, the cumulative sums of each row and the cumulative
+// sums of the X and Y marginals, either in m_values or in a cache file
+class DiscreteDistribution2D::Tables
+{
+public:
+	Tables() : m_pData(0), m_width(0), m_height(0), m_flippedY(false)			{ }
+
+	std::vector<double> m_values;
+	MappedFile m_cacheFile;
+	const double *m_pData;
+	int m_width, m_height; // discrete size (pixels)
+	bool m_flippedY;
+};
+
 DiscreteDistribution2D::DiscreteDistribution2D(double xOffset, double yOffset, double xSize, double ySize,
 			       		       const GridValues &density, bool floor, GslRandomNumberGenerator *pRngGen,
 					       const Polygon2D &filter) : ProbabilityDistribution2D(pRngGen, true)
 {
-	m_pMarginalXDist = 0;
-	m_pMarginalYDist = 0;
+	shared_ptr<const Tables> tables;
+	bool_t r;
+
+	if (!(r = createTables(density, filter, xOffset, yOffset, xSize, ySize, tables)))
+		abortWithMessage(r.getErrorString());
+
+	init(xOffset, yOffset, xSize, ySize, tables, floor);
+}
+
+DiscreteDistribution2D::DiscreteDistribution2D(double xOffset, double yOffset, double xSize, double ySize,
+					       const shared_ptr<const Tables> &tables, bool floor,
+					       GslRandomNumberGenerator *pRngGen) : ProbabilityDistribution2D(pRngGen, true)
+{
+	assert(tables.get() != 0);
+	init(xOffset, yOffset, xSize, ySize, tables, floor);
+}
+
+DiscreteDistribution2D::~DiscreteDistribution2D()
+{
+}
+
+void DiscreteDistribution2D::init(double xOffset, double yOffset, double xSize, double ySize,
+                                  const shared_ptr<const Tables> &tables, bool floor)
+{
 	m_xSize = xSize;
 	m_ySize = ySize;
 	m_xOffset = xOffset;
 	m_yOffset = yOffset;
+	m_floor = floor;
 
-	m_width = density.getWidth();
-	m_height = density.getHeight();
+	m_pTables = tables;
+	m_width = tables->m_width;
+	m_height = tables->m_height;
+	m_flippedY = tables->m_flippedY;
 
-	generateConditionalsAndMarginal(xOffset, yOffset, xSize, ySize, density, pRngGen, filter, false, m_conditionalXDists, &m_pMarginalYDist);
-	generateConditionalsAndMarginal(xOffset, yOffset, xSize, ySize, density, pRngGen, filter, true, m_conditionalYDists, &m_pMarginalXDist);
+	const double *pTables = tables->m_pData;
 
-	m_flippedY = density.isYFlipped();
-	m_floor = floor;
+	m_pValues = pTables;
+	m_pRowCumulative = m_pValues + (size_t)m_width*m_height;
+	m_pMarginalXCumulative = m_pRowCumulative + (size_t)m_width*m_height;
+	m_pMarginalYCumulative = m_pMarginalXCumulative + m_width;
+
+	allocateColumnTables();
 }
 
-DiscreteDistribution2D::~DiscreteDistribution2D()
+bool_t DiscreteDistribution2D::createTables(const GridValues &density, const Polygon2D &filter,
+                                            double xOffset, double yOffset, double xSize, double ySize,
+                                            shared_ptr<const Tables> &tables)
+{
+	shared_ptr<Tables> pTables = make_shared<Tables>();
+	int width = density.getWidth();
+	int height = density.getHeight();
+
+	pTables->m_values.resize(getNumberOfTableValues(width, height), 0);
+
+	double *pAllValues = &pTables->m_values[0];
+	double *pAllRowCumulative = pAllValues + (size_t)width*height;
+	double *pMarginalXCumulative = pAllRowCumulative + (size_t)width*height;
+	double *pMarginalYCumulative = pMarginalXCumulative + width;
+
+	// pMarginalXCumulative holds the column sums at first, these are made cumulative afterwards
+
+	bool hasFilter = (filter.getNumberOfPoints() > 0);
+	vector<char> filterMask;
+
+	if (hasFilter)
+		filter.getInsideMask(xOffset, yOffset, xSize/(double)width, ySize/(double)height, width, height, filterMask);
+
+	bool hasValue = false;
+	double marginalYSum = 0;
+
+	for (int y = 0 ; y < height ; y++)
+	{
+		double *pValues = pAllValues + (size_t)y*width;
+		double *pCumulative = pAllRowCumulative + (size_t)y*width;
+		double sum = 0;
+
+		for (int x = 0 ; x < width ; x++)
+		{
+			double val = 0;
+			bool pass = true;
+
+			if (hasFilter && !filterMask[(size_t)y*width + x])
+				pass = false;
+
+			if (pass)
+			{
+				val = density.getValue(x, y);
+				if (val != 0)
+					hasValue = true;
+			}
+
+			assert(val >= 0);
+
+			pValues[x] = val;
+			sum += val;
+			pCumulative[x] = sum;
+			pMarginalXCumulative[x] += val;
+		}
+
+		marginalYSum += sum;
+		pMarginalYCumulative[y] = marginalYSum;
+	}
+
+	if (!hasValue)
+		return "No non-zero value found in DiscreteDistribution2D. Bad data file.";
+
+	double marginalXSum = 0;
+	for (int x = 0 ; x < width ; x++)
+	{
+		marginalXSum += pMarginalXCumulative[x];
+		pMarginalXCumulative[x] = marginalXSum;
+	}
+
+	pTables->m_pData = pAllValues;
+	pTables->m_width = width;
+	pTables->m_height = height;
+	pTables->m_flippedY = density.isYFlipped();
+
+	tables = pTables;
+	return true;
+}
+
+bool_t DiscreteDistribution2D::writeCacheFile(const string &fileName, uint64_t key, const Tables &tables)
+{
+	DiscreteDistribution2DCacheHeader hdr;
+
+	memset(&hdr, 0, sizeof(DiscreteDistribution2DCacheHeader));
+	memcpy(hdr.m_magic, s_cacheMagic, sizeof(s_cacheMagic));
+	hdr.m_version = DISCRETEDISTRIBUTION2D_CACHEVERSION;
+	hdr.m_flippedY = (tables.m_flippedY)?1:0;
+	hdr.m_key = key;
+	hdr.m_width = tables.m_width;
+	hdr.m_height = tables.m_height;
+
+	// Write to a temporary file first, and rename it when complete, so that other
+	// processes never see a partially written file
+#ifndef WIN32
+	string tmpFileName = fileName + strprintf(".%d.tmp", (int)getpid());
+#else
+	string tmpFileName = fileName + strprintf(".%d.tmp", (int)_getpid());
+#endif // !WIN32
+
+	FILE *pFile = fopen(tmpFileName.c_str(), "wb");
+	if (!pFile)
+		return "Unable to create file '" + tmpFileName + "'";
+
+	size_t num = getNumberOfTableValues(tables.m_width, tables.m_height);
+	bool ok = (fwrite(&hdr, sizeof(DiscreteDistribution2DCacheHeader), 1, pFile) == 1 &&
+		   fwrite(tables.m_pData, sizeof(double), num, pFile) == num);
+
+	if (fclose(pFile) != 0)
+		ok = false;
+
+	if (!ok || rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+	{
+		remove(tmpFileName.c_str());
+		return "Unable to write cache file '" + fileName + "'";
+	}
+	return true;
+}
+
+bool_t DiscreteDistribution2D::readCacheFile(const string &fileName, uint64_t key, shared_ptr<const Tables> &tables)
+{
+	shared_ptr<Tables> pTables = make_shared<Tables>();
+	MappedFile &f = pTables->m_cacheFile;
+	bool_t r;
+
+	if (!(r = f.open(fileName)))
+		return r;
+
+	if (f.getSize() < sizeof(DiscreteDistribution2DCacheHeader))
+		return "Cache file '" + fileName + "' is too small";
+
+	DiscreteDistribution2DCacheHeader hdr;
+	memcpy(&hdr, f.getData(), sizeof(DiscreteDistribution2DCacheHeader));
+
+	if (memcmp(hdr.m_magic, s_cacheMagic, sizeof(s_cacheMagic)) != 0)
+		return "File '" + fileName + "' is not a density cache file";
+	if (hdr.m_version != DISCRETEDISTRIBUTION2D_CACHEVERSION)
+		return "Cache file '" + fileName + "' has an unsupported version";
+	if (hdr.m_key != key)
+		return "Cache file '" + fileName + "' was created for different input";
+	if (hdr.m_width <= 0 || hdr.m_height <= 0)
+		return "Cache file '" + fileName + "' contains invalid dimensions";
+
+	size_t expectedSize = sizeof(DiscreteDistribution2DCacheHeader) + getNumberOfTableValues(hdr.m_width, hdr.m_height)*sizeof(double);
+	if (f.getSize() != expectedSize)
+		return "Cache file '" + fileName + "' does not have the expected size";
+
+	pTables->m_pData = reinterpret_cast<const double *>(reinterpret_cast<const char *>(f.getData()) + sizeof(DiscreteDistribution2DCacheHeader));
+	pTables->m_width = hdr.m_width;
+	pTables->m_height = hdr.m_height;
+	pTables->m_flippedY = (hdr.m_flippedY != 0);
+
+	tables = pTables;
+	return true;
+}
+
+double DiscreteDistribution2D::pickFromCumulative(GslRandomNumberGenerator *pRndGen, const double *pCumulative, int num) const
+{
+	assert(num > 0);
+
+	double x = pRndGen->pickRandomDouble() * pCumulative[num-1];
+
+	// The first bin for which the cumulative sum is not smaller than x
+	int foundBin = (int)(lower_bound(pCumulative, pCumulative + num, x) - pCumulative);
+
+	assert(foundBin >= 0 && foundBin < num);
+	assert(x < pCumulative[foundBin] && (foundBin == 0 || x >= pCumulative[foundBin-1]));
+
+	double d = 0;
+	if (foundBin > 0)
+		d = pCumulative[foundBin-1];
+
+	double binFrac = (x-d)/(pCumulative[foundBin]-d);
+	return (double)foundBin + binFrac;
+}
+
+void DiscreteDistribution2D::allocateColumnTables()
+{
+	m_columnCumulative.resize(m_width);
+	m_pColumnCumulative.reset(new atomic<const double *>[m_width]);
+
+	for (int x = 0 ; x < m_width ; x++)
+		m_pColumnCumulative[x].store(0, memory_order_relaxed);
+}
+
+const double *DiscreteDistribution2D::getColumnCumulative(int x) const
 {
-	delete m_pMarginalXDist;
-	delete m_pMarginalYDist;
-	for (size_t i = 0 ; i < m_conditionalXDists.size() ; i++)
-		delete m_conditionalXDists[i];
-	for (size_t i = 0 ; i < m_conditionalYDists.size() ; i++)
-		delete m_conditionalYDists[i];
+	assert(x >= 0 && x < m_width);
+
+	const double *pCumulative = m_pColumnCumulative[x].load(memory_order_acquire);
+	if (pCumulative)
+		return pCumulative;
+
+	m_columnMutex.lock();
+
+	// Another thread may have built it in the mean time
+	pCumulative = m_pColumnCumulative[x].load(memory_order_relaxed);
+	if (!pCumulative)
+	{
+		vector<double> &cumulative = m_columnCumulative[x];
+		cumulative.resize(m_height);
+
+		double sum = 0;
+		for (int y = 0 ; y < m_height ; y++)
+		{
+			sum += m_pValues[(size_t)y*m_width + x];
+			cumulative[y] = sum;
+		}
+
+		pCumulative = &cumulative[0];
+		m_pColumnCumulative[x].store(pCumulative, memory_order_release);
+	}
+
+	m_columnMutex.unlock();
+	return pCumulative;
 }
 
 Point2D DiscreteDistribution2D::pickPoint() const
 {
-	double y = m_pMarginalYDist->pickNumber();
+	return pickPoint(getRandomNumberGenerator());
+}
+
+void DiscreteDistribution2D::pickPoints(GslRandomNumberGenerator *pRndGen, Point2D *pPoints, size_t num) const
+{
+	for (size_t i = 0 ; i < num ; i++)
+		pPoints[i] = pickPoint(pRndGen);
+}
+
+Point2D DiscreteDistribution2D::pickPoint(GslRandomNumberGenerator *pRndGen) const
+{
+	double y = pickFromCumulative(pRndGen, m_pMarginalYCumulative, m_height);
 	int yi = (int)y;
-	assert(yi >= 0 && yi < (int)m_conditionalXDists.size());
+	assert(yi >= 0 && yi < m_height);
 	
-	double x = m_conditionalXDists[yi]->pickNumber();
+	double x = pickFromCumulative(pRndGen, m_pRowCumulative + (size_t)yi*m_width, m_width);
 
 	x = (x/(double)m_width)*m_xSize;
 	y = (y/(double)m_height)*m_ySize;
@@ -66,7 +352,7 @@ Point2D DiscreteDistribution2D::pickPoint() const
 
 double DiscreteDistribution2D::pickMarginalX() const
 {
-	double x = m_pMarginalXDist->pickNumber();
+	double x = pickFromCumulative(getRandomNumberGenerator(), m_pMarginalXCumulative, m_width);
 
 	x = (x/(double)m_width)*m_xSize;
 
@@ -83,7 +369,7 @@ double DiscreteDistribution2D::pickMarginalX() const
 
 double DiscreteDistribution2D::pickMarginalY() const
 {
-	double y = m_pMarginalYDist->pickNumber();
+	double y = pickFromCumulative(getRandomNumberGenerator(), m_pMarginalYCumulative, m_height);
 
 	y = (y/(double)m_height)*m_ySize;
 	
@@ -103,10 +389,10 @@ double DiscreteDistribution2D::pickConditionalOnX(double x) const
 	x = (x - m_xOffset)/m_xSize * (double)m_width;
 
 	int xi = (int)x;
-	if (xi < 0 || xi >= (int)m_conditionalYDists.size())
+	if (xi < 0 || xi >= m_width)
 		return numeric_limits<double>::quiet_NaN();
 
-	double y = m_conditionalYDists[xi]->pickNumber();
+	double y = pickFromCumulative(getRandomNumberGenerator(), getColumnCumulative(xi), m_height);
 
 	y = (y/(double)m_height)*m_ySize;
 	
@@ -126,10 +412,10 @@ double DiscreteDistribution2D::pickConditionalOnY(double y) const
 	y = (y - m_yOffset)/m_ySize * (double)m_height;
 	
 	int yi = (int)y;
-	if (yi < 0 || yi >= (int)m_conditionalXDists.size())
+	if (yi < 0 || yi >= m_height)
 		return numeric_limits<double>::quiet_NaN();
 
-	double x = m_conditionalXDists[yi]->pickNumber();
+	double x = pickFromCumulative(getRandomNumberGenerator(), m_pRowCumulative + (size_t)yi*m_width, m_width);
 
 	x = (x/(double)m_width)*m_xSize; 
 	
@@ -143,119 +429,3 @@ double DiscreteDistribution2D::pickConditionalOnY(double y) const
 	x += m_xOffset;
 	return x;
 }
-
-void DiscreteDistribution2D::generateConditionalsAndMarginal(double xOffset, double yOffset, double xSize, double ySize,
-		                                             const GridValues &density, GslRandomNumberGenerator *pRngGen,
-		                                             const Polygon2D &filter, bool transpose,
-#ifdef OLDTEST
-							     vector<DiscreteDistribution *> &conditionals,
-							     DiscreteDistribution **ppMarginal
-#else
-							     vector<DiscreteDistributionFast *> &conditionals,
-							     DiscreteDistributionFast **ppMarginal
-#endif
-							     )
-{
-	assert(conditionals.size() == 0);
-	assert(*ppMarginal == 0);
-
-	int dim1, dim2;
-	
-	if (!transpose)
-	{
-		dim1 = density.getWidth();
-		dim2 = density.getHeight();
-	}
-	else
-	{
-		dim1 = density.getHeight();
-		dim2 = density.getWidth();
-	}
-
-	vector<double> margValues(dim2);
-	vector<double> condValues(dim1);
-
-	bool hasFilter = (filter.getNumberOfPoints() > 0);
-	double pixelWidth = xSize/(double)density.getWidth();
-	double pixelHeight = ySize/(double)density.getHeight();
-	bool hasValue = false;
-
-	for (int v = 0 ; v < dim2 ; v++)
-	{
-		double sum = 0;
-
-		for (int u = 0 ; u < dim1 ; u++)
-		{
-			double val = 0;
-			bool pass = true;
-			int x, y;
-
-			if (!transpose)
-			{
-				x = u;
-				y = v;
-			}
-			else
-			{
-				x = v;
-				y = u;
-			}
-			
-			if (hasFilter)
-			{
-				double xCoord = xOffset + pixelWidth*(0.5+(double)x);
-				double yCoord = yOffset + pixelHeight*(0.5+(double)y);
-
-				if (!filter.isInside(xCoord, yCoord))
-					pass = false;
-			}
-
-			if (pass)
-			{
-				val = density.getValue(x, y);
-				if (val != 0)
-					hasValue = true;
-			}
-
-			assert(val >= 0);
-
-			condValues[u] = val;
-			sum += val;
-		}
-
-#ifdef OLDTEST
-		std::vector<double> binStarts, histValues;
-		for (size_t i = 0 ; i < condValues.size() ; i++)
-		{
-			binStarts.push_back((double)i);
-			histValues.push_back(condValues[i]);
-		}
-		binStarts.push_back(dim1);
-		histValues.push_back(0);
-
-		conditionals.push_back(new DiscreteDistribution(binStarts, histValues, false, pRngGen));
-#else
-		conditionals.push_back(new DiscreteDistributionFast(0, dim1, condValues, false, pRngGen));
-#endif
-		margValues[v] = sum;
-	}
-
-	if (!hasValue)
-		abortWithMessage("No non-zero value found in DiscreteDistribution2D::generateConditionalsAndMarginal. Bad data file.");
-
-#ifdef OLDTEST
-	std::vector<double> binStarts, histValues;
-	for (int i = 0 ; i < margValues.size() ; i++)
-	{
-		binStarts.push_back((double)i);
-		histValues.push_back(margValues[i]);
-	}
-	binStarts.push_back(dim2);
-	histValues.push_back(0);
-
-	*ppMarginal = new DiscreteDistribution(binStarts, histValues, false, pRngGen);
-#else
-	*ppMarginal = new DiscreteDistributionFast(0, dim2, margValues, false, pRngGen);
-#endif
-}
-
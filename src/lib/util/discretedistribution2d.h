@@ -3,25 +3,55 @@
 #define DISCRETEDISTRIBUTION2D_H
 
 #include "probabilitydistribution2d.h"
-#include "discretedistribution.h"
-#include "discretedistributionfast.h"
 #include "polygon2d.h"
+#include "mutex.h"
+#include "booltype.h"
+#include <stdint.h>
+#include <string>
 #include <vector>
+#include <atomic>
+#include <memory>
 
 class GridValues;
 
-//#define OLDTEST
-
+/** Samples points from a 2D grid of (relative) densities.
+ *
+ *  To pick a point, a row is chosen from the marginal distribution of Y, and
+ *  then a position in that row from the conditional distribution of X. For
+ *  this, the cumulative sums of all rows are stored in a single flattened
+ *  array, which is also used by pickConditionalOnY. The cumulative sums of
+ *  the columns, needed for pickConditionalOnX, are only built the first time
+ *  a specific column is used; only then a lock is needed. Within a bin, a position is chosen uniformly,
+ *  as in DiscreteDistributionFast.
+ *
+ *  Since building these tables for a large grid takes some time, they can be
+ *  stored in a cache file using writeCacheFile, and read again using
+ *  readCacheFile. The file is memory mapped when read, so a large cache file
+ *  that is used by many simulations running at the same time only needs to be
+ *  in memory once. The tables don't depend on the position of the area or on the
+ *  random number generator, several distributions can share them (see getTables).
+ */
 class DiscreteDistribution2D : public ProbabilityDistribution2D
 {
 public:
+	/** The sampling tables for a density, which can be shared by several distributions. */
+	class Tables;
+
 	DiscreteDistribution2D(double xOffset, double yOffset, double xSize, double ySize,
 			       const GridValues &density, bool floor, GslRandomNumberGenerator *pRngGen,
 			       const Polygon2D &filter = Polygon2D()
 			       );
+
+	/** Creates a distribution that uses tables obtained from createTables, readCacheFile
+	 *  or getTables, the other parameters have the same meaning as in the other constructor. */
+	DiscreteDistribution2D(double xOffset, double yOffset, double xSize, double ySize,
+			       const std::shared_ptr<const Tables> &tables, bool floor,
+			       GslRandomNumberGenerator *pRngGen);
 	~DiscreteDistribution2D();
 
 	Point2D pickPoint() const;
+	bool hasBulkPicking() const								{ return true; }
+	void pickPoints(GslRandomNumberGenerator *pRndGen, Point2D *pPoints, size_t num) const;
 
 	double pickMarginalX() const;
 	double pickMarginalY() const;
@@ -35,29 +65,49 @@ public:
 
 	bool isYFlipped() const									{ return m_flippedY; }
 	bool getFloor() const									{ return m_floor; }
+
+	/** Returns the sampling tables that this distribution uses. */
+	std::shared_ptr<const Tables> getTables() const						{ return m_pTables; }
+
+	/** Builds the sampling tables for \c density. If \c filter has points, the values
+	 *  outside of it are set to zero, for which the grid is placed at the area with the
+	 *  specified offset and size. */
+	static bool_t createTables(const GridValues &density, const Polygon2D &filter,
+	                           double xOffset, double yOffset, double xSize, double ySize,
+				   std::shared_ptr<const Tables> &tables);
+
+	/** Writes the sampling tables to the cache file \c fileName, together with
+	 *  \c key, which should identify the density and filter that were used. */
+	static bool_t writeCacheFile(const std::string &fileName, uint64_t key, const Tables &tables);
+
+	/** Reads the sampling tables from a file written by writeCacheFile, if it exists
+	 *  and its key matches \c key. */
+	static bool_t readCacheFile(const std::string &fileName, uint64_t key, std::shared_ptr<const Tables> &tables);
 private:
-	static void generateConditionalsAndMarginal(double xOffset, double yOffset, double xSize, double ySize,
-		                                             const GridValues &density, GslRandomNumberGenerator *pRngGen,
-		                                             const Polygon2D &filter, bool transpose,
-#ifdef OLDTEST
-							     std::vector<DiscreteDistribution *> &conditionals,
-							     DiscreteDistribution **ppMarginal
-#else
-							     std::vector<DiscreteDistributionFast *> &conditionals,
-							     DiscreteDistributionFast **ppMarginal
-#endif
-							     );
-#ifdef OLDTEST
-	DiscreteDistribution *m_pMarginalXDist;
-	DiscreteDistribution *m_pMarginalYDist;
-	std::vector<DiscreteDistribution *> m_conditionalXDists;
-	std::vector<DiscreteDistribution *> m_conditionalYDists;
-#else
-	DiscreteDistributionFast *m_pMarginalXDist;
-	DiscreteDistributionFast *m_pMarginalYDist;
-	std::vector<DiscreteDistributionFast *> m_conditionalXDists;
-	std::vector<DiscreteDistributionFast *> m_conditionalYDists;
-#endif
+	void init(double xOffset, double yOffset, double xSize, double ySize,
+	          const std::shared_ptr<const Tables> &tables, bool floor);
+	static size_t getNumberOfTableValues(int width, int height)				{ return (size_t)width*(size_t)height*2 + (size_t)width + (size_t)height; }
+
+	Point2D pickPoint(GslRandomNumberGenerator *pRndGen) const;
+
+	// Returns the (fractional) bin position in the cumulative sums pCumulative[0..num-1]
+	double pickFromCumulative(GslRandomNumberGenerator *pRndGen, const double *pCumulative, int num) const;
+	const double *getColumnCumulative(int x) const;
+	void allocateColumnTables();
+
+	std::shared_ptr<const Tables> m_pTables;
+
+	const double *m_pValues;
+	const double *m_pRowCumulative;
+	const double *m_pMarginalXCumulative;
+	const double *m_pMarginalYCumulative;
+
+	// The column tables are built when first needed, after which the pointer to it
+	// is set, so that the lock is only needed if the pointer is still null
+	mutable std::vector<std::vector<double> > m_columnCumulative;
+	mutable std::unique_ptr<std::atomic<const double *>[]> m_pColumnCumulative;
+	mutable Mutex m_columnMutex;
+
 	double m_xOffset, m_yOffset;
 	double m_xSize, m_ySize;
 	int m_width, m_height; // discrete size (pixels)
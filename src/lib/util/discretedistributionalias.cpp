@@ -0,0 +1,188 @@
+#include "discretedistributionalias.h"
+#include "discretedistribution.h"
+#include "gslrandomnumbergenerator.h"
+#include "util.h"
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+// The alias method is faster even for a few bins (see the samplerbench program),
+// but picks different values from the same random numbers. To keep the results
+// of existing simulations, which use small distributions like the age
+// distribution (89 bins in sa_2003.csv), it's only used automatically from
+// this number of bins on.
+const size_t DiscreteDistributionAlias::s_autoMinimumBins = 256;
+
+DiscreteDistributionAlias::DiscreteDistributionAlias(const vector<double> &binEdges, const vector<double> &weights,
+                                                     bool floor, GslRandomNumberGenerator *pRndGen) : ProbabilityDistribution(pRndGen)
+{
+	const int num = (int)weights.size();
+
+	if (num < 1 || binEdges.size() != weights.size() + 1)
+		abortWithMessage("DiscreteDistributionAlias: the number of bin edges must be one more than the number of weights");
+
+	double totalSum = 0;
+	for (int i = 0 ; i < num ; i++)
+	{
+		if (!(binEdges[i+1] > binEdges[i]))
+			abortWithMessage("DiscreteDistributionAlias: bin start values must be increasing!");
+		if (!(weights[i] >= 0 && weights[i] < numeric_limits<double>::infinity()))
+			abortWithMessage("DiscreteDistributionAlias: weights must be positive or zero, and finite");
+
+		totalSum += weights[i];
+	}
+
+	if (!(totalSum > 0))
+		abortWithMessage("DiscreteDistributionAlias: at least one weight must be larger than zero");
+
+	// Vose's method: columns that are too full donate the remainder of their
+	// probability to columns that are not full enough
+	vector<double> prob(num);
+	vector<int> small, large;
+
+	for (int i = 0 ; i < num ; i++)
+	{
+		prob[i] = weights[i]*(double)num/totalSum;
+		if (prob[i] < 1.0)
+			small.push_back(i);
+		else
+			large.push_back(i);
+	}
+
+	m_columns.resize(num);
+
+	while (small.size() > 0 && large.size() > 0)
+	{
+		int s = small.back();
+		int l = large.back();
+
+		small.pop_back();
+
+		m_columns[s].m_prob = prob[s];
+		m_columns[s].m_alias = l;
+
+		prob[l] = (prob[l] + prob[s]) - 1.0;
+		if (prob[l] < 1.0)
+		{
+			large.pop_back();
+			small.push_back(l);
+		}
+	}
+
+	// Because of round-off, some entries can remain; they should be (nearly) full
+	for (size_t i = 0 ; i < large.size() ; i++)
+	{
+		m_columns[large[i]].m_prob = 1.0;
+		m_columns[large[i]].m_alias = large[i];
+	}
+	for (size_t i = 0 ; i < small.size() ; i++)
+	{
+		m_columns[small[i]].m_prob = 1.0;
+		m_columns[small[i]].m_alias = small[i];
+	}
+
+	m_binEdges = binEdges;
+	m_floor = floor;
+}
+
+DiscreteDistributionAlias::~DiscreteDistributionAlias()
+{
+}
+
+double DiscreteDistributionAlias::pickNumber() const
+{
+	return getValue(getRandomNumberGenerator()->pickRandomDouble());
+}
+
+void DiscreteDistributionAlias::pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const
+{
+	pRndGen->pickRandomDoubles(pValues, num);
+
+	for (size_t i = 0 ; i < num ; i++)
+		pValues[i] = getValue(pValues[i]);
+}
+
+double DiscreteDistributionAlias::getValue(double u) const
+{
+	const int num = (int)m_columns.size();
+	double x = u * (double)num;
+	int col = (int)x;
+
+	if (col >= num) // shouldn't happen, but just to be safe
+		col = num-1;
+
+	const Column &c = m_columns[col];
+	double frac = x - (double)col;
+	int bin;
+	double binFrac;
+
+	if (frac < c.m_prob)
+	{
+		bin = col;
+		binFrac = frac/c.m_prob;
+	}
+	else
+	{
+		bin = c.m_alias;
+		binFrac = (frac - c.m_prob)/(1.0 - c.m_prob);
+	}
+
+	double binStart = m_binEdges[bin];
+	if (m_floor)
+		return binStart;
+
+	return binStart + binFrac*(m_binEdges[bin+1] - binStart);
+}
+
+ProbabilityDistribution *DiscreteDistributionAlias::createHistogramDistribution(const vector<double> &binStarts, const vector<double> &histValues,
+                                                                               bool floor, SamplerType type, GslRandomNumberGenerator *pRndGen)
+{
+	// The last bin should have a zero weight, so it doesn't count here
+	if (binStarts.size() < 2 || !useAliasMethod(type, histValues.size()-1))
+		return new DiscreteDistribution(binStarts, histValues, floor, pRndGen);
+
+	const size_t num = binStarts.size();
+	double lastValue = histValues[num-1];
+
+	if (std::abs(lastValue) > 1e-7) // same check as in DiscreteDistribution
+		abortWithMessage("DiscreteDistributionAlias: last value should be nearly zero, but is " + doubleToString(lastValue));
+
+	// The end of the last bin is chosen in the same way as in DiscreteDistribution
+	vector<double> binEdges(binStarts);
+	binEdges.push_back(binStarts[num-1] + (binStarts[num-1] - binStarts[num-2]));
+
+	return new DiscreteDistributionAlias(binEdges, histValues, floor, pRndGen);
+}
+
+bool_t DiscreteDistributionAlias::getSamplerType(const string &name, SamplerType &type)
+{
+	if (name == "auto")
+		type = Auto;
+	else if (name == "search")
+		type = Search;
+	else if (name == "alias")
+		type = Alias;
+	else
+		return "Unknown sampler type '" + name + "'";
+	return true;
+}
+
+string DiscreteDistributionAlias::getSamplerName(SamplerType type)
+{
+	if (type == Search)
+		return "search";
+	if (type == Alias)
+		return "alias";
+	return "auto";
+}
+
+vector<string> DiscreteDistributionAlias::getSamplerNames()
+{
+	vector<string> names;
+
+	names.push_back("auto");
+	names.push_back("search");
+	names.push_back("alias");
+	return names;
+}
@@ -0,0 +1,91 @@
+#ifndef DISCRETEDISTRIBUTIONALIAS_H
+
+#define DISCRETEDISTRIBUTIONALIAS_H
+
+/**
+ * \file discretedistributionalias.h
+ */
+
+#include "probabilitydistribution.h"
+#include "booltype.h"
+#include <string>
+#include <vector>
+
+/** Picks numbers from a histogram using Walker's alias method (as constructed
+ *  by Vose), so that each number takes constant time, regardless of the number
+ *  of bins. This is especially useful for distributions with many bins, where
+ *  the search in DiscreteDistribution or DiscreteDistributionFast takes longer.
+ *
+ *  Like these classes, only one random number is used for each value: its
+ *  integer part (after scaling) selects a column of the alias table, and the
+ *  remaining fraction decides between the column's own bin and its alias, and
+ *  then also sets the position within that bin.
+ */
+class DiscreteDistributionAlias : public ProbabilityDistribution
+{
+public:
+	/** Determines which implementation is used for a discrete distribution. */
+	enum SamplerType
+	{
+		/** Use the alias method only if there are many bins. */
+		Auto,
+		/** Use the search based implementations DiscreteDistribution or DiscreteDistributionFast. */
+		Search,
+		/** Always use the alias method. */
+		Alias
+	};
+
+	/** Constructor of the class.
+	 *  \param binEdges The start of each bin, followed by the end of the last bin;
+	 *                  these must be increasing.
+	 *  \param weights Measures of the integrated probability in each bin, this
+	 *                 vector must contain one element less than \c binEdges.
+	 *  \param floor If set to true, only the bin start values will be returned,
+	 *               otherwise a constant probability is assumed within a bin.
+	 *  \param pRndGen The random number generator to use.
+	 */
+	DiscreteDistributionAlias(const std::vector<double> &binEdges, const std::vector<double> &weights,
+	                          bool floor, GslRandomNumberGenerator *pRndGen);
+	~DiscreteDistributionAlias();
+
+	double pickNumber() const;
+	bool hasBulkPicking() const									{ return true; }
+	void pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const;
+
+	/** Creates a distribution from bins that start at \c binStarts and have weights
+	 *  \c histValues, as described for the DiscreteDistribution constructor. Depending
+	 *  on \c type and the number of bins, this is either a DiscreteDistribution or
+	 *  a DiscreteDistributionAlias instance. */
+	static ProbabilityDistribution *createHistogramDistribution(const std::vector<double> &binStarts, const std::vector<double> &histValues,
+	                                                            bool floor, SamplerType type, GslRandomNumberGenerator *pRndGen);
+
+	/** Returns true if the alias method should be used for a distribution with
+	 *  \c numBins bins, when \c type is requested. */
+	static bool useAliasMethod(SamplerType type, size_t numBins)				{ return type == Alias || (type == Auto && numBins >= s_autoMinimumBins); }
+
+	/** Converts one of the names "auto", "search" or "alias" to a SamplerType. */
+	static bool_t getSamplerType(const std::string &name, SamplerType &type);
+
+	/** Returns the name for a SamplerType, as used in the config file. */
+	static std::string getSamplerName(SamplerType type);
+
+	/** The names that can be used in the config file. */
+	static std::vector<std::string> getSamplerNames();
+private:
+	// Transforms the uniform random number u into a number from the distribution
+	double getValue(double u) const;
+
+	struct Column
+	{
+		double m_prob;
+		int m_alias;
+	};
+
+	static const size_t s_autoMinimumBins;
+
+	std::vector<Column> m_columns;
+	std::vector<double> m_binEdges;
+	bool m_floor;
+};
+
+#endif // DISCRETEDISTRIBUTIONALIAS_H
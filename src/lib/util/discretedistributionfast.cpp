@@ -65,8 +65,20 @@ DiscreteDistributionFast::~DiscreteDistributionFast()
 
 double DiscreteDistributionFast::pickNumber() const
 {
-	GslRandomNumberGenerator *pRndGen = getRandomNumberGenerator();
-	double x = pRndGen->pickRandomDouble() * m_totalSum;
+	return getValue(getRandomNumberGenerator()->pickRandomDouble());
+}
+
+void DiscreteDistributionFast::pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const
+{
+	pRndGen->pickRandomDoubles(pValues, num);
+
+	for (size_t i = 0 ; i < num ; i++)
+		pValues[i] = getValue(pValues[i]);
+}
+
+double DiscreteDistributionFast::getValue(double u) const
+{
+	double x = u * m_totalSum;
 	//cout << "x = " << x << endl;
 
 	const int numLevels = m_probLevels.size();
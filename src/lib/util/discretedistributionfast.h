@@ -13,7 +13,11 @@ public:
 	~DiscreteDistributionFast();
 
 	double pickNumber() const;
+	bool hasBulkPicking() const									{ return true; }
+	void pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const;
 private:
+	// Transforms the uniform random number u into a number from the distribution
+	double getValue(double u) const;
 	static int getLargerPowerOfTwo(const int s0, int *pLevels);
 
 	std::vector<std::vector<double> > m_probLevels;
@@ -1,6 +1,7 @@
 #include "discretedistributionwrapper.h"
 #include "discretedistribution.h"
 #include "discretedistributionfast.h"
+#include "discretedistributionalias.h"
 #include "csvfile.h"
 #include "util.h"
 
@@ -14,6 +15,7 @@ DiscreteDistributionWrapper::DiscreteDistributionWrapper(GslRandomNumberGenerato
 	m_xMin = numeric_limits<double>::quiet_NaN();
 	m_xMax = numeric_limits<double>::quiet_NaN();
 	m_floor = false;
+	m_sampler = DiscreteDistributionAlias::Auto;
 }
 
 DiscreteDistributionWrapper::~DiscreteDistributionWrapper()
@@ -21,7 +23,8 @@ DiscreteDistributionWrapper::~DiscreteDistributionWrapper()
 	delete m_pDist;
 }
 
-bool_t DiscreteDistributionWrapper::init(const std::string &csvFileName, double xMin, double xMax, int yCol, bool floor)
+bool_t DiscreteDistributionWrapper::init(const std::string &csvFileName, double xMin, double xMax, int yCol, bool floor,
+                                         DiscreteDistributionAlias::SamplerType sampler)
 {
 	if (m_pDist)
 		return "Already initialized";
@@ -58,17 +61,29 @@ bool_t DiscreteDistributionWrapper::init(const std::string &csvFileName, double
 			return "The y-entry at row " + intToString(y+1) + " should be positive and smaller than infinity";
 	}
 
-	m_pDist = new DiscreteDistributionFast(xMin, xMax, yValues, floor, getRandomNumberGenerator());
+	if (DiscreteDistributionAlias::useAliasMethod(sampler, yValues.size()))
+	{
+		vector<double> binEdges(numRows+1);
+		for (int i = 0 ; i <= numRows ; i++)
+			binEdges[i] = xMin + (double)i*((xMax-xMin)/(double)numRows);
+
+		m_pDist = new DiscreteDistributionAlias(binEdges, yValues, floor, getRandomNumberGenerator());
+	}
+	else
+		m_pDist = new DiscreteDistributionFast(xMin, xMax, yValues, floor, getRandomNumberGenerator());
+
 	m_fileName = csvFileName;
 	m_xMin = xMin;
 	m_xMax = xMax;
 	m_yCol = yCol;
 	m_floor = floor;
+	m_sampler = sampler;
 
 	return true;
 }
 
-bool_t DiscreteDistributionWrapper::init(const std::string &csvFileName, int xCol, int yCol, bool floor)
+bool_t DiscreteDistributionWrapper::init(const std::string &csvFileName, int xCol, int yCol, bool floor,
+                                         DiscreteDistributionAlias::SamplerType sampler)
 {
 	if (m_pDist)
 		return "Already initialized";
@@ -116,16 +131,18 @@ bool_t DiscreteDistributionWrapper::init(const std::string &csvFileName, int xCo
 	if (yValues[numRows-1] != 0)
 		return "The final y value must be zero";
 
-	m_pDist = new DiscreteDistribution(xValues, yValues, floor, getRandomNumberGenerator());
+	m_pDist = DiscreteDistributionAlias::createHistogramDistribution(xValues, yValues, floor, sampler, getRandomNumberGenerator());
 	m_fileName = csvFileName;
 	m_xCol = xCol;
 	m_yCol = yCol;
 	m_floor = floor;
+	m_sampler = sampler;
 
 	return true;
 }
 
-bool_t DiscreteDistributionWrapper::init(const std::vector<double> &xValues, const std::vector<double> &yValues, bool floor)
+bool_t DiscreteDistributionWrapper::init(const std::vector<double> &xValues, const std::vector<double> &yValues, bool floor,
+                                         DiscreteDistributionAlias::SamplerType sampler)
 {
 	if (m_pDist)
 		return "Already initialized";
@@ -152,10 +169,10 @@ bool_t DiscreteDistributionWrapper::init(const std::vector<double> &xValues, con
 			return "The y-entry at position " + intToString(i+1) + " should be positive and smaller than infinity";
 	}
 
-	m_pDist = new DiscreteDistribution(xValues, yValues, floor, getRandomNumberGenerator());
+	m_pDist = DiscreteDistributionAlias::createHistogramDistribution(xValues, yValues, floor, sampler, getRandomNumberGenerator());
 	m_xValues = xValues;
 	m_yValues = yValues;
 	m_floor = floor;
+	m_sampler = sampler;
 	return true;
 }
-
@@ -3,6 +3,7 @@
 #define DISCRETEDISTRIBUTIONWRAPPER_H
 
 #include "probabilitydistribution.h"
+#include "discretedistributionalias.h"
 #include "booltype.h"
 #include <string>
 #include <vector>
@@ -17,11 +18,16 @@ public:
 	DiscreteDistributionWrapper(GslRandomNumberGenerator *pRng);
 	~DiscreteDistributionWrapper();
 
-	bool_t init(const std::string &csvFileName, double xMin, double xMax, int yCol, bool floor);
-	bool_t init(const std::string &csvFileName, int xCol, int yCol, bool floor);
-	bool_t init(const std::vector<double> &xValues, const std::vector<double> &yValues, bool floor);
+	bool_t init(const std::string &csvFileName, double xMin, double xMax, int yCol, bool floor,
+	            DiscreteDistributionAlias::SamplerType sampler = DiscreteDistributionAlias::Auto);
+	bool_t init(const std::string &csvFileName, int xCol, int yCol, bool floor,
+	            DiscreteDistributionAlias::SamplerType sampler = DiscreteDistributionAlias::Auto);
+	bool_t init(const std::vector<double> &xValues, const std::vector<double> &yValues, bool floor,
+	            DiscreteDistributionAlias::SamplerType sampler = DiscreteDistributionAlias::Auto);
 
 	double pickNumber() const														{ if (m_pDist == 0)	return std::numeric_limits<double>::quiet_NaN(); return m_pDist->pickNumber(); }
+	bool hasBulkPicking() const														{ return m_pDist != 0 && m_pDist->hasBulkPicking(); }
+	void pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const		{ assert(m_pDist != 0); m_pDist->pickNumbers(pRndGen, pValues, num); }
 
 	int getXCol() const																{ return m_xCol; }
 	int getYCol() const																{ return m_yCol; }
@@ -29,6 +35,7 @@ public:
 	double getXMax() const															{ return m_xMax; }
 	std::string getFileName() const													{ return m_fileName; }
 	bool getFloor() const															{ return m_floor; }
+	DiscreteDistributionAlias::SamplerType getSampler() const						{ return m_sampler; }
 
 	const std::vector<double> &getXValues() const									{ return m_xValues; }
 	const std::vector<double> &getYValues() const									{ return m_yValues; }
@@ -38,6 +45,7 @@ private:
 	double m_xMin, m_xMax;
 	std::string m_fileName;
 	bool m_floor;
+	DiscreteDistributionAlias::SamplerType m_sampler;
 
 	std::vector<double> m_xValues;
 	std::vector<double> m_yValues;
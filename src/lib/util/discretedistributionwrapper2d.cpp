@@ -2,10 +2,30 @@
 #include "tiffdensityfile.h"
 #include "gridvaluescsv.h"
 #include "util.h"
+#include "mutex.h"
+#include <stdio.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <unistd.h>
+#else
+#include <process.h>
+#endif // !WIN32
+#include <iostream>
+#include <map>
 #include <memory>
+#include <vector>
 
 using namespace std;
 
+// The sampling tables that were loaded before, by the key from getFileKey
+static map<uint64_t, shared_ptr<const DiscreteDistribution2D::Tables> > s_densityCache;
+static Mutex s_densityCacheMutex;
+
+bool DiscreteDistributionWrapper2D::s_cacheEnabled = false;
+
 DiscreteDistributionWrapper2D::DiscreteDistributionWrapper2D(GslRandomNumberGenerator *pRndGen) : ProbabilityDistribution2D(pRndGen, true)
 {
 	m_pDist = 0;
@@ -16,13 +36,143 @@ DiscreteDistributionWrapper2D::~DiscreteDistributionWrapper2D()
 	delete m_pDist;
 }
 
+void DiscreteDistributionWrapper2D::setCacheEnabled(bool enabled)
+{
+	s_densityCacheMutex.lock();
+	s_cacheEnabled = enabled;
+	if (!enabled)
+		s_densityCache.clear();
+	s_densityCacheMutex.unlock();
+}
+
 bool_t DiscreteDistributionWrapper2D::init(const std::string &densFile, const std::string &maskFile, 
 		                                   double xOffset, double yOffset, double width, double height, 
-										   bool flipY, bool floor)
+										   bool flipY, bool floor, const std::string &cacheDir)
 {
 	if (m_pDist)
 		return "Already initialized";
 
+	shared_ptr<const DiscreteDistribution2D::Tables> tables;
+	bool_t r;
+
+	if (!(r = loadTables(densFile, maskFile, flipY, floor, cacheDir, tables)))
+		return r;
+
+	m_pDist = new DiscreteDistribution2D(xOffset, yOffset, width, height, tables, floor, getRandomNumberGenerator());
+
+	m_densFileName = densFile;
+	m_maskFileName = maskFile;
+	m_cacheDir = cacheDir;
+	m_xOffset = xOffset;
+	m_yOffset = yOffset;
+	m_xSize = width;
+	m_ySize = height;
+	m_flipY = flipY;
+	m_floor = floor;
+
+	return true;
+}
+
+bool_t DiscreteDistributionWrapper2D::preload(const std::string &densFile, const std::string &maskFile, 
+                                              bool flipY, bool floor, const std::string &cacheDir)
+{
+	shared_ptr<const DiscreteDistribution2D::Tables> tables;
+
+	return loadTables(densFile, maskFile, flipY, floor, cacheDir, tables);
+}
+
+bool_t DiscreteDistributionWrapper2D::loadTables(const std::string &densFile, const std::string &maskFile, 
+                                                 bool flipY, bool floor, const std::string &cacheDir,
+                                                 shared_ptr<const DiscreteDistribution2D::Tables> &tables)
+{
+	// The path, size and modification time of the input files identify the tables,
+	// both in memory and in the cache directory
+	uint64_t fileKey = 0;
+	bool hasFileKey = getFileKey(densFile, maskFile, flipY, floor, fileKey);
+	bool useMemoryCache = s_cacheEnabled && hasFileKey;
+
+	if (useMemoryCache)
+	{
+		s_densityCacheMutex.lock();
+		map<uint64_t, shared_ptr<const DiscreteDistribution2D::Tables> >::const_iterator it = s_densityCache.find(fileKey);
+		if (it != s_densityCache.end())
+		{
+			tables = it->second;
+			s_densityCacheMutex.unlock();
+			return true;
+		}
+		s_densityCacheMutex.unlock();
+	}
+
+	bool_t r;
+	string cacheFile;
+	uint64_t key = 0;
+
+	string indexFile;
+	bool indexValid = false;
+
+	if (cacheDir.length() > 0 && hasFileKey)
+	{
+		// The index file contains the key of the cache file that was used for
+		// these input files before. Only if there's no such file, or the cache file
+		// it refers to can't be used, the contents of the input files need to be
+		// hashed.
+		indexFile = createFullPath(cacheDir, strprintf("simpact-density-%016" PRIx64 ".index", fileKey));
+
+		if (readIndexFile(indexFile, fileKey, key))
+		{
+			cacheFile = createFullPath(cacheDir, strprintf("simpact-density-%016" PRIx64 ".cache", key));
+			DiscreteDistribution2D::readCacheFile(cacheFile, key, tables);
+			indexValid = (tables.get() != 0);
+		}
+	}
+
+	if (cacheDir.length() > 0 && !tables)
+	{
+		// The cache file is identified by the contents of the input files and the
+		// settings that affect the sampling tables
+		uint64_t maskHash = 0;
+
+		if (!(r = hashFile(densFile, key)))
+			return "Unable to process '" + densFile + "': " + r.getErrorString();
+		if (maskFile.length() > 0 && !(r = hashFile(maskFile, maskHash)))
+			return "Unable to process '" + maskFile + "': " + r.getErrorString();
+
+		key ^= maskHash*1099511628211ULL + ((flipY)?2:0) + ((floor)?1:0);
+		cacheFile = createFullPath(cacheDir, strprintf("simpact-density-%016" PRIx64 ".cache", key));
+
+		// If the file doesn't exist yet or can't be used, we'll just (re)create it
+		DiscreteDistribution2D::readCacheFile(cacheFile, key, tables);
+	}
+
+	if (!tables)
+	{
+		if (!(r = createTables(densFile, maskFile, flipY, tables)))
+			return r;
+
+		if (cacheFile.length() > 0 && !(r = DiscreteDistribution2D::writeCacheFile(cacheFile, key, *tables)))
+		{
+			cerr << "# WARNING! " << r.getErrorString() << endl;
+			indexFile = "";
+		}
+	}
+
+	if (indexFile.length() > 0 && !indexValid && !(r = writeIndexFile(indexFile, fileKey, key)))
+		cerr << "# WARNING! " << r.getErrorString() << endl;
+
+	if (useMemoryCache)
+	{
+		s_densityCacheMutex.lock();
+		s_densityCache[fileKey] = tables;
+		s_densityCacheMutex.unlock();
+	}
+
+	return true;
+}
+
+bool_t DiscreteDistributionWrapper2D::createTables(const std::string &densFile, const std::string &maskFile, bool flipY,
+                                                   shared_ptr<const DiscreteDistribution2D::Tables> &tables)
+{
 	GridValues *pDens = 0;
 	GridValues *pMask = 0;
 	bool_t r;
@@ -68,17 +218,8 @@ bool_t DiscreteDistributionWrapper2D::init(const std::string &densFile, const st
 		}
 	}
 
-	m_pDist = new DiscreteDistribution2D(xOffset, yOffset, width, height, *pDens, floor, getRandomNumberGenerator());
-
-	m_densFileName = densFile;
-	m_maskFileName = maskFile;
-	m_xOffset = xOffset;
-	m_yOffset = yOffset;
-	m_xSize = width;
-	m_ySize = height;
-	m_flipY = flipY;
-	m_floor = floor;
-
+	if (!(r = DiscreteDistribution2D::createTables(*pDens, Polygon2D(), 0, 0, 1, 1, tables)))
+		return "Unable to process density file '" + densFile + "': " + r.getErrorString();
 	return true;
 }
 
@@ -97,3 +238,124 @@ bool_t DiscreteDistributionWrapper2D::allocateGridFunction(const std::string &fi
 
 	return "Can't determine file reader based on extension (only TIFF and CSV are supported)";
 }
+
+// 64-bit FNV-1a hash of the file contents
+bool_t DiscreteDistributionWrapper2D::hashFile(const std::string &fileName, uint64_t &hash)
+{
+	FILE *pFile = fopen(fileName.c_str(), "rb");
+	if (!pFile)
+		return "Unable to open file";
+
+	vector<unsigned char> buffer(1024*1024);
+	uint64_t h = 14695981039346656037ULL;
+	size_t num;
+
+	while ((num = fread(&buffer[0], 1, buffer.size(), pFile)) > 0)
+	{
+		for (size_t i = 0 ; i < num ; i++)
+		{
+			h ^= buffer[i];
+			h *= 1099511628211ULL;
+		}
+	}
+
+	bool ok = (ferror(pFile) == 0);
+	fclose(pFile);
+
+	if (!ok)
+		return "Error while reading file";
+
+	hash = h;
+	return true;
+}
+
+// Combines the full paths, sizes and modification times of the input files
+// with the settings, using the same FNV-1a hash as for the contents
+bool DiscreteDistributionWrapper2D::getFileKey(const std::string &densFile, const std::string &maskFile, bool flipY, bool floor, uint64_t &key)
+{
+	uint64_t h = 14695981039346656037ULL;
+	auto addBytes = [&h](const void *pData, size_t num)
+	{
+		const unsigned char *pBytes = reinterpret_cast<const unsigned char *>(pData);
+		for (size_t i = 0 ; i < num ; i++)
+		{
+			h ^= pBytes[i];
+			h *= 1099511628211ULL;
+		}
+	};
+
+	string fileNames[2] = { densFile, maskFile };
+	for (int i = 0 ; i < 2 ; i++)
+	{
+		string fileName = fileNames[i];
+		if (fileName.length() == 0)
+			continue;
+
+		struct stat st;
+		if (stat(fileName.c_str(), &st) != 0)
+			return false;
+
+#ifndef WIN32
+		char fullPath[PATH_MAX];
+		if (realpath(fileName.c_str(), fullPath) != 0)
+			fileName = fullPath;
+#endif // !WIN32
+
+		int64_t values[3] = { (int64_t)st.st_size, (int64_t)st.st_mtime, 0 };
+#ifdef __linux__
+		values[2] = (int64_t)st.st_mtim.tv_nsec;
+#endif // __linux__
+
+		addBytes(fileName.c_str(), fileName.length() + 1);
+		addBytes(values, sizeof(values));
+	}
+
+	unsigned char flags = ((flipY)?2:0) + ((floor)?1:0);
+	addBytes(&flags, 1);
+
+	key = h;
+	return true;
+}
+
+// The index file just contains both keys, in hexadecimal notation
+bool DiscreteDistributionWrapper2D::readIndexFile(const std::string &fileName, uint64_t fileKey, uint64_t &key)
+{
+	FILE *pFile = fopen(fileName.c_str(), "rt");
+	if (!pFile)
+		return false;
+
+	uint64_t k1 = 0, k2 = 0;
+	bool ok = (fscanf(pFile, "%" SCNx64 " %" SCNx64, &k1, &k2) == 2 && k1 == fileKey);
+	fclose(pFile);
+
+	if (!ok)
+		return false;
+
+	key = k2;
+	return true;
+}
+
+bool_t DiscreteDistributionWrapper2D::writeIndexFile(const std::string &fileName, uint64_t fileKey, uint64_t key)
+{
+	// Like the cache file itself, write to a temporary file first and rename
+	// it when complete
+#ifndef WIN32
+	string tmpFileName = fileName + strprintf(".%d.tmp", (int)getpid());
+#else
+	string tmpFileName = fileName + strprintf(".%d.tmp", (int)_getpid());
+#endif // !WIN32
+
+	FILE *pFile = fopen(tmpFileName.c_str(), "wt");
+	if (!pFile)
+		return "Unable to create file '" + tmpFileName + "'";
+
+	bool ok = (fprintf(pFile, "%016" PRIx64 " %016" PRIx64 "\n", fileKey, key) > 0);
+	ok = (fclose(pFile) == 0) && ok;
+
+	if (!ok || rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+	{
+		remove(tmpFileName.c_str());
+		return "Unable to write index file '" + fileName + "'";
+	}
+	return true;
+}
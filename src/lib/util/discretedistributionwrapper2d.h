@@ -5,8 +5,10 @@
 #include "probabilitydistribution2d.h"
 #include "discretedistribution2d.h"
 #include "booltype.h"
+#include <stdint.h>
 #include <string>
 #include <limits>
+#include <memory>
 
 class DiscreteDistributionWrapper2D : public ProbabilityDistribution2D
 {
@@ -15,9 +17,23 @@ public:
 	~DiscreteDistributionWrapper2D();
 
 	bool_t init(const std::string &densFile, const std::string &maskFile, double xOffset, double yOffset, 
-			    double width, double height, bool flipY, bool floor);
+			    double width, double height, bool flipY, bool floor,
+			    const std::string &cacheDir = std::string());
+
+	/** Enables or disables keeping the sampling tables of each density that was
+	 *  loaded in memory, so that another distribution for the same files (with the
+	 *  same size and modification time) can use them without reading the files
+	 *  again. Disabling it also clears the stored tables. */
+	static void setCacheEnabled(bool enabled);
+
+	/** Loads the sampling tables for these settings like init does, which only
+	 *  has an effect if the cache is enabled. */
+	static bool_t preload(const std::string &densFile, const std::string &maskFile,
+	                      bool flipY, bool floor, const std::string &cacheDir = std::string());
 
 	Point2D pickPoint() const;
+	bool hasBulkPicking() const																	{ return m_pDist != 0; }
+	void pickPoints(GslRandomNumberGenerator *pRndGen, Point2D *pPoints, size_t num) const		{ assert(m_pDist != 0); m_pDist->pickPoints(pRndGen, pPoints, num); }
 	double pickMarginalX() const;
 	double pickMarginalY() const;
 	double pickConditionalOnX(double x) const;
@@ -25,6 +41,7 @@ public:
 
 	std::string getDensFileName() const															{ return m_densFileName; }
 	std::string getMaskFileName() const															{ return m_maskFileName; }
+	std::string getCacheDirectory() const														{ return m_cacheDir; }
 	double getXOffset() const																	{ return m_xOffset; }
 	double getYOffset() const																	{ return m_yOffset; }
 	double getWidth() const																		{ return m_xSize; }
@@ -33,12 +50,22 @@ public:
 	bool isFloored() const																		{ return m_floor; }
 private:
 	static bool_t allocateGridFunction(const std::string &fileName, GridValues **pGf);
+	static bool_t hashFile(const std::string &fileName, uint64_t &hash);
+	static bool getFileKey(const std::string &densFile, const std::string &maskFile, bool flipY, bool floor, uint64_t &key);
+	static bool readIndexFile(const std::string &fileName, uint64_t fileKey, uint64_t &key);
+	static bool_t writeIndexFile(const std::string &fileName, uint64_t fileKey, uint64_t key);
+	static bool_t loadTables(const std::string &densFile, const std::string &maskFile, bool flipY, bool floor,
+	                         const std::string &cacheDir, std::shared_ptr<const DiscreteDistribution2D::Tables> &tables);
+	static bool_t createTables(const std::string &densFile, const std::string &maskFile, bool flipY,
+	                           std::shared_ptr<const DiscreteDistribution2D::Tables> &tables);
 
 	DiscreteDistribution2D *m_pDist;
-	std::string m_densFileName, m_maskFileName;
+	std::string m_densFileName, m_maskFileName, m_cacheDir;
 	double m_xOffset, m_yOffset;
 	double m_xSize, m_ySize;
 	bool m_flipY, m_floor;
+
+	static bool s_cacheEnabled;
 };
 
 inline Point2D DiscreteDistributionWrapper2D::pickPoint() const
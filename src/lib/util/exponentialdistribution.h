@@ -7,6 +7,7 @@
  */
 
 #include "probabilitydistribution.h"
+#include "gslrandomnumbergenerator.h"
 #include <cmath>
 
 /** This class allows you to return a random number picked from an exponential
@@ -21,6 +22,8 @@ public:
 	ExponentialDistribution(double a, GslRandomNumberGenerator *pRng) : ProbabilityDistribution(pRng) 	{ assert(a > 0); m_a = a; }
 
 	double pickNumber() const;
+	bool hasBulkPicking() const										{ return true; }
+	void pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const;
 	double getA() const											{ return m_a; }
 private:
 	double m_a;
@@ -35,4 +38,12 @@ inline double ExponentialDistribution::pickNumber() const
 	return x;
 }
 
+inline void ExponentialDistribution::pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const
+{
+	pRndGen->pickRandomDoubles(pValues, num);
+
+	for (size_t i = 0 ; i < num ; i++)
+		pValues[i] = -std::log(pValues[i])/m_a;
+}
+
 #endif // EXPONENTIALDISTRIBUTION_H
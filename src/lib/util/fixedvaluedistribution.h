@@ -20,6 +20,8 @@ public:
 	~FixedValueDistribution()							{ }
 
 	double pickNumber() const							{ return m_value; }
+	bool hasBulkPicking() const							{ return true; }
+	void pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const	{ for (size_t i = 0 ; i < num ; i++) pValues[i] = m_value; }
 	double getValue() const								{ return m_value; }
 private:
 	double m_value;
@@ -21,6 +21,8 @@ public:
 
 
 	Point2D pickPoint() const							{ return Point2D(m_xValue, m_yValue); }
+	bool hasBulkPicking() const							{ return true; }
+	void pickPoints(GslRandomNumberGenerator *pRndGen, Point2D *pPoints, size_t num) const	{ for (size_t i = 0 ; i < num ; i++) pPoints[i] = Point2D(m_xValue, m_yValue); }
 	double pickMarginalX() const							{ return m_xValue; }
 	double pickMarginalY() const							{ return m_yValue; }
 	double pickConditionalOnX(double x) const					{ return m_yValue; }
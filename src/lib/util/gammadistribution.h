@@ -7,6 +7,7 @@
  */
 
 #include "probabilitydistribution.h"
+#include "gslrandomnumbergenerator.h"
 
 /** This class allows you to return a random number picked from a gamma
  *  distribution with parameters specified in the constructor.
@@ -20,6 +21,8 @@ public:
 	GammaDistribution(double a, double b, GslRandomNumberGenerator *pRng) : ProbabilityDistribution(pRng) 	{ m_a = a; m_b = b; }
 
 	double pickNumber() const										{ return getRandomNumberGenerator()->pickGamma(m_a, m_b); }
+	bool hasBulkPicking() const										{ return true; }
+	void pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const		{ pRndGen->pickGammas(pValues, num, m_a, m_b); }
 	double getA() const											{ return m_a; }
 	double getB() const											{ return m_b; }
 private:
@@ -20,36 +20,38 @@ bool_t GridValuesCSV::init(const string &csvFile, bool noNegativeValues, bool fl
 	if (m_values.size() > 0)
 		return "Already initialized";
 
-	CSVFile *pCSVFile = new CSVFile();
+	CSVFile csv;
 	bool_t r;
-	if (!(r = pCSVFile->load(csvFile)))
-	{
-		delete pCSVFile;
+	if (!(r = csv.load(csvFile)))
 		return "Unable to load CSV file '" + csvFile + "': " + r.getErrorString();
-	}
 
-	int numX = pCSVFile->getNumberOfColumns();
-	int numY = pCSVFile->getNumberOfRows();
+	int numX = csv.getNumberOfColumns();
+	int numY = csv.getNumberOfRows();
 	if (numX <= 0 || numY <= 0)
 		return "Read invalid number of rows or columns in the CSV file (should both be larger than zero)";
 
-	m_values.resize(numX*numY);
-
-	// Check the contents of the file
+	// Check the contents of the file, row first
 	for (int y = 0 ; y < numY ; y++)
 	{
-		int y2 = (flipY)?(numY-1-y):y;
-
 		for (int x = 0 ; x < numX ; x++)
 		{
-			if (!pCSVFile->hasValue(y, x)) // row first!
-			{
-				delete pCSVFile;
-				m_values.resize(0);
+			if (!csv.hasValue(y, x))
 				return "No value for column " + intToString(x+1) + " at row " + intToString(y+1) + " is present";
-			}
+		}
+	}
+
+	m_values.resize(numX*numY);
+
+	// The CSV file stores the values per column
+	for (int x = 0 ; x < numX ; x++)
+	{
+		const vector<double> &column = csv.getColumn(x);
+
+		for (int y = 0 ; y < numY ; y++)
+		{
+			int y2 = (flipY)?(numY-1-y):y;
+			double val = column[y];
 
-			double val = pCSVFile->getValue(y, x); // row first!
 			if (noNegativeValues && val < 0)
 				val = 0;
 
@@ -62,8 +64,6 @@ bool_t GridValuesCSV::init(const string &csvFile, bool noNegativeValues, bool fl
 	m_height = numY;
 	m_fileName = csvFile;
 
-	delete pCSVFile;
-
 	return true;
 }
 
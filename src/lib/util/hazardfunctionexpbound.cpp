@@ -0,0 +1,133 @@
+#include "hazardfunctionexpbound.h"
+#include <assert.h>
+
+HazardFunctionExpBound::HazardFunctionExpBound(double h0, double t0, double B, double tMax)
+	: m_h0(h0), m_t0(t0), m_B(B), m_tMax(tMax)
+{
+	assert(h0 > 0);
+	assert(B > 0);
+
+	const double ln2 = 0.69314718055994530942;
+	m_stepWidth = ln2/B;
+
+	// The step that contains tMax is the first one in which the bound is constant
+	double xMax = tMax - t0;
+	double numSteps = (xMax > 0) ? std::ceil(xMax/m_stepWidth) - 1.0 : 0;
+
+	// Don't let the number of steps overflow the int, in that case the
+	// constant part can't be reached anyway
+	if (numSteps > 1000)
+		numSteps = 1000;
+
+	m_numSteps = (int)numSteps;
+	m_xConst = m_stepWidth*(double)m_numSteps;
+	m_hConst = -1;
+	m_TConst = getStepStartIntegral(m_numSteps);
+}
+
+HazardFunctionExpBound::~HazardFunctionExpBound()
+{
+}
+
+double HazardFunctionExpBound::evaluate(double t)
+{
+	double x = t - m_t0;
+	assert(x > -1e-10);
+
+	if (x >= m_xConst)
+		return getConstantValue();
+
+	int n = (x > 0) ? (int)(x/m_stepWidth) : 0;
+	if (n >= m_numSteps)
+		n = m_numSteps-1;
+
+	return std::ldexp(m_h0, n+1);
+}
+
+// Integral of the bound from m_t0 to m_t0 + x
+double HazardFunctionExpBound::getIntegral(double x) const
+{
+	if (x <= 0)
+		return 0;
+
+	if (x >= m_xConst)
+		return m_TConst + getConstantValue()*(x - m_xConst);
+
+	int n = (int)(x/m_stepWidth);
+	if (n >= m_numSteps)
+		n = m_numSteps-1;
+
+	return getStepStartIntegral(n) + std::ldexp(m_h0, n+1)*(x - m_stepWidth*(double)n);
+}
+
+double HazardFunctionExpBound::calculateInternalTimeInterval(double t0, double dt)
+{
+	double x0 = t0 - m_t0;
+
+	assert(x0 > -1e-10);
+	assert(dt >= 0);
+
+	// Most of the time both times will lie in the first step
+	if (x0 + dt < m_stepWidth && m_numSteps > 0)
+		return 2.0*m_h0*dt;
+
+	return getIntegral(x0 + dt) - getIntegral(x0);
+}
+
+double HazardFunctionExpBound::solveForRealTimeInterval(double t0, double Tdiff)
+{
+	double x0 = t0 - m_t0;
+
+	assert(x0 > -1e-10);
+	assert(Tdiff >= 0);
+
+	double T = getIntegral(x0) + Tdiff;
+	double x = 0;
+
+	if (T >= m_TConst)
+		x = m_xConst + (T - m_TConst)/getConstantValue();
+	else
+	{
+		// The integral up to the start of step n is h0*w*(2^(n+1)-2), look
+		// for the step in which it exceeds T
+		double h0w = m_h0*m_stepWidth;
+		int n = 0;
+
+		if (T >= 2.0*h0w)
+		{
+			n = (int)std::floor(std::log2(T/h0w + 2.0)) - 1;
+
+			// Correct for rounding errors
+			if (n < 0)
+				n = 0;
+			if (n > m_numSteps-1)
+				n = m_numSteps-1;
+			while (n > 0 && getStepStartIntegral(n) > T)
+				n--;
+			while (n < m_numSteps-1 && getStepStartIntegral(n+1) <= T)
+				n++;
+		}
+
+		x = m_stepWidth*(double)n + (T - getStepStartIntegral(n))/std::ldexp(m_h0, n+1);
+	}
+
+	double dt = x - x0;
+	if (dt < 0) // only possible due to rounding errors
+		dt = 0;
+
+	return dt;
+}
+
+double HazardFunctionExpBound::evaluateHazard(double t) const
+{
+	double tLimited = (t < m_tMax) ? t : m_tMax;
+	return m_h0*std::exp(m_B*(tLimited - m_t0));
+}
+
+double HazardFunctionExpBound::getAcceptanceProbability(double t)
+{
+	double p = evaluateHazard(t)/evaluate(t);
+
+	assert(p <= 1.0 + 1e-10);
+	return p;
+}
@@ -0,0 +1,71 @@
+#ifndef HAZARDFUNCTIONEXPBOUND_H
+
+#define HAZARDFUNCTIONEXPBOUND_H
+
+/**
+ * \file hazardfunctionexpbound.h
+ */
+
+#include "hazardfunction.h"
+#include <cmath>
+
+/** Upper bound for an increasing, time limited exponential hazard, to be able
+ *  to sample event times by thinning.
+ *
+ *  The hazard that's bounded is \f$ h(t) = h_0 \exp(B (\min(t, t_{max}) - t_0)) \f$ for
+ *  \f$ t \geq t_0 \f$, with \f$ B > 0 \f$, i.e. the same hazard as an exp(A+Bt) one that's
+ *  wrapped in a TimeLimitedHazardFunction, but specified by its value \f$ h_0 \f$ in
+ *  \f$ t_0 \f$. The bound is a step function: the interval from \f$ t_0 \f$ on is divided
+ *  into steps of width \f$ \ln(2)/B \f$, in which the hazard doubles, and on each step the
+ *  bound is the value of the hazard at the end of that step. From the step that contains
+ *  \f$ t_{max} \f$ on, the bound is the constant \f$ h(t_{max}) \f$. This way, the bound
+ *  is never more than twice the hazard itself, so at least half of the candidate times
+ *  will be accepted, and both time mappings of the bound only require a logarithm if the
+ *  candidate time doesn't lie in the first step.
+ *
+ *  The bound itself is a hazard function as well, so the candidate times are obtained by
+ *  the usual time mappings of this class; a candidate time \f$ t \f$ must then be accepted
+ *  with probability HazardFunctionExpBound::getAcceptanceProbability.
+ */
+class HazardFunctionExpBound : public HazardFunction
+{
+public:
+	/** Creates the bound for the hazard with value \c h0 at time \c t0, that increases
+	 *  as exp(Bt) until \c tMax and stays constant afterwards; \c B must be positive and
+	 *  \c h0 must be positive and finite. */
+	HazardFunctionExpBound(double h0, double t0, double B, double tMax);
+	~HazardFunctionExpBound();
+
+	/** Returns the value of the bound at time \c t (which must not be smaller than the
+	 *  time \c t0 from the constructor). */
+	double evaluate(double t);
+	double calculateInternalTimeInterval(double t0, double dt);
+	double solveForRealTimeInterval(double t0, double Tdiff);
+
+	/** Returns the value of the hazard that's bounded at time \c t. */
+	double evaluateHazard(double t) const;
+
+	/** Returns the ratio of the hazard and the bound at time \c t, the probability
+	 *  with which a candidate time \c t should be accepted. */
+	double getAcceptanceProbability(double t);
+private:
+	double getIntegral(double x) const;
+	double getStepStartIntegral(int n) const				{ return m_h0*m_stepWidth*(std::ldexp(1.0, n+1) - 2.0); }
+	double getConstantValue() const;
+
+	double m_h0, m_t0, m_B, m_tMax;
+	double m_stepWidth;
+	int m_numSteps;		// number of steps before the constant part
+	double m_xConst;	// start of the constant part, relative to m_t0
+	mutable double m_hConst;	// value of the bound in the constant part, only calculated when needed
+	double m_TConst;	// integral of the bound up to the constant part
+};
+
+inline double HazardFunctionExpBound::getConstantValue() const
+{
+	if (m_hConst < 0)
+		m_hConst = (m_tMax > m_t0) ? m_h0*std::exp(m_B*(m_tMax - m_t0)) : m_h0;
+	return m_hConst;
+}
+
+#endif // HAZARDFUNCTIONEXPBOUND_H
@@ -21,6 +21,8 @@ public:
 	LogNormalDistribution(double zeta, double sigma, GslRandomNumberGenerator *pRng);
 	
 	double pickNumber() const;
+	bool hasBulkPicking() const								{ return true; }
+	void pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const	{ pRndGen->pickLogNorms(pValues, num, m_zeta, m_sigma); }
 	double getZeta() const									{ return m_zeta; }
 	double getSigma() const									{ return m_sigma; }
 private:
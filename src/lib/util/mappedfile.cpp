@@ -0,0 +1,96 @@
+#include "mappedfile.h"
+#include <stdio.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // !WIN32
+
+using namespace std;
+
+MappedFile::MappedFile()
+{
+	m_pData = 0;
+	m_size = 0;
+	m_mapped = false;
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool_t MappedFile::open(const string &fileName)
+{
+	if (m_pData)
+		return "A file is already opened";
+
+#ifndef WIN32
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return "Unable to open file '" + fileName + "'";
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0)
+	{
+		::close(fd);
+		return "Unable to determine the size of '" + fileName + "', or file is empty";
+	}
+
+	void *pData = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd); // the mapping remains valid
+
+	if (pData == MAP_FAILED)
+		return "Unable to map file '" + fileName + "' into memory";
+
+	m_pData = pData;
+	m_size = (size_t)st.st_size;
+	m_mapped = true;
+#else
+	FILE *pFile = fopen(fileName.c_str(), "rb");
+	if (!pFile)
+		return "Unable to open file '" + fileName + "'";
+
+	fseek(pFile, 0, SEEK_END);
+	long size = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+
+	if (size <= 0)
+	{
+		fclose(pFile);
+		return "Unable to determine the size of '" + fileName + "', or file is empty";
+	}
+
+	m_buffer.resize(((size_t)size + sizeof(double) - 1)/sizeof(double));
+	size_t num = fread(&m_buffer[0], 1, (size_t)size, pFile);
+	fclose(pFile);
+
+	if (num != (size_t)size)
+	{
+		m_buffer.clear();
+		return "Unable to read file '" + fileName + "'";
+	}
+
+	m_pData = &m_buffer[0];
+	m_size = (size_t)size;
+	m_mapped = false;
+#endif // !WIN32
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (!m_pData)
+		return;
+
+#ifndef WIN32
+	if (m_mapped)
+		munmap(const_cast<void *>(m_pData), m_size);
+#endif // !WIN32
+
+	m_buffer.clear();
+	m_pData = 0;
+	m_size = 0;
+	m_mapped = false;
+}
@@ -0,0 +1,36 @@
+#ifndef MAPPEDFILE_H
+
+#define MAPPEDFILE_H
+
+#include "booltype.h"
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// Gives read-only access to the contents of a file. On systems that support
+// it, the file is memory mapped so that only the parts that are actually used
+// are read from disk, and so that the operating system can share the pages
+// between processes using the same file. Otherwise, the file is read into
+// memory.
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool_t open(const std::string &fileName);
+	void close();
+
+	const void *getData() const								{ return m_pData; }
+	size_t getSize() const									{ return m_size; }
+private:
+	MappedFile(const MappedFile &)								{ }
+	void operator=(const MappedFile &)							{ }
+
+	const void *m_pData;
+	size_t m_size;
+	bool m_mapped;
+	std::vector<double> m_buffer; // doubles to get a suitable alignment
+};
+
+#endif // MAPPEDFILE_H
@@ -1,5 +1,4 @@
 #include "normaldistribution.h"
-#include "util.h"
 
 NormalDistribution::NormalDistribution(double mu, double sigma, GslRandomNumberGenerator *pRng, double minValue, double maxValue) : ProbabilityDistribution(pRng)
 {
@@ -11,17 +10,18 @@ NormalDistribution::NormalDistribution(double mu, double sigma, GslRandomNumberG
 
 double NormalDistribution::pickNumber() const
 {
-	const int maxCount = 100000;
-	GslRandomNumberGenerator *pRndGen = getRandomNumberGenerator();
+	return getRandomNumberGenerator()->pickTruncatedGaussian(m_mu, m_sigma, m_minValue, m_maxValue);
+}
 
-	for (int i = 0 ; i < maxCount ; i++)
+void NormalDistribution::pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const
+{
+	// Without bounds, pickTruncatedGaussian uses a single gaussian number
+	if (m_minValue == -std::numeric_limits<double>::infinity() && m_maxValue == std::numeric_limits<double>::infinity())
 	{
-		double x = pRndGen->pickGaussianNumber(m_mu, m_sigma);
-		if (x >= m_minValue && x <= m_maxValue)
-			return x;
+		pRndGen->pickGaussianNumbers(pValues, num, m_mu, m_sigma);
+		return;
 	}
-	abortWithMessage("Rejection sampling took too long for clipped normal distribution");
-	return 0;
-}
-
 
+	for (size_t i = 0 ; i < num ; i++)
+		pValues[i] = pRndGen->pickTruncatedGaussian(m_mu, m_sigma, m_minValue, m_maxValue);
+}
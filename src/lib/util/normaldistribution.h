@@ -14,8 +14,8 @@
  *  with parameters specified in the constructor.
  *
  *  The probability density is based on the following: \f[ \textrm{prob}(x) = \frac{1}{\sigma \sqrt{2 \pi} }  \exp\left(-\frac{(x-\mu)^2}{2 \sigma^2}\right) \f]
- *  The range is restricted to the specified [min,max] range by using
- *  rejection sampling.
+ *  The range is restricted to the specified [min,max] range, see
+ *  GslRandomNumberGenerator::pickTruncatedGaussian.
  */
 class NormalDistribution : public ProbabilityDistribution
 {
@@ -26,6 +26,8 @@ public:
 			   double maxValue = std::numeric_limits<double>::infinity());
 	
 	double pickNumber() const;
+	bool hasBulkPicking() const								{ return true; }
+	void pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const;
 	double getMu() const									{ return m_mu; }
 	double getSigma() const									{ return m_sigma; }
 	double getMin() const									{ return m_minValue; }
@@ -1,6 +1,8 @@
 #include "piecewiselinearfunction.h"
 #include "util.h"
 #include <assert.h>
+#include <algorithm>
+#include <cmath>
 
 using namespace std;
 
@@ -18,12 +20,76 @@ PieceWiseLinearFunction::PieceWiseLinearFunction(const vector<Point2D> &points,
 	m_leftValue = leftValue;
 	m_rightValue = rightValue;
 	m_points = points;
+
+	m_x.resize(points.size());
+	for (size_t i = 0 ; i < points.size() ; i++)
+		m_x[i] = points[i].x;
+
+	// If the points are (nearly) equally spaced, the interval can be calculated
+	// from the x value directly. Since findInterval still checks this against
+	// the actual x-coordinates, small deviations don't matter.
+	m_equallySpaced = false;
+	m_invSpacing = 0;
+
+	size_t num = m_x.size() - 1;
+	if (num > 1)
+	{
+		double spacing = (m_x[num] - m_x[0])/(double)num;
+
+		if (spacing > 0)
+		{
+			m_equallySpaced = true;
+			for (size_t i = 1 ; i < num && m_equallySpaced ; i++)
+			{
+				if (std::abs(m_x[i] - (m_x[0] + spacing*(double)i)) > 1e-6*spacing)
+					m_equallySpaced = false;
+			}
+			m_invSpacing = 1.0/spacing;
+		}
+	}
 }
 
 PieceWiseLinearFunction::~PieceWiseLinearFunction()
 {
 }
 
+size_t PieceWiseLinearFunction::findInterval(double x) const
+{
+	size_t num = m_x.size() - 1;
+	assert(num > 0 && x >= m_x[0] && x < m_x[num]);
+
+	if (m_equallySpaced)
+	{
+		double pos = (x - m_x[0])*m_invSpacing;
+		size_t i = (pos < (double)num)?(size_t)pos:num-1;
+
+		// Correct for rounding errors
+		while (i > 0 && x < m_x[i])
+			i--;
+		while (x >= m_x[i+1])
+			i++;
+
+		return i;
+	}
+
+	// The first x-coordinate that's larger than x ends the interval
+	size_t i1 = std::upper_bound(m_x.begin(), m_x.end(), x) - m_x.begin();
+	assert(i1 > 0 && i1 <= num);
+
+	return i1 - 1;
+}
+
+inline double PieceWiseLinearFunction::interpolate(size_t i, double x) const
+{
+	double x0 = m_points[i].x;
+	double x1 = m_points[i+1].x;
+	double frac = (x-x0)/(x1-x0);
+	double y0 = m_points[i].y;
+	double y1 = m_points[i+1].y;
+
+	return (y1-y0)*frac + y0;
+}
+
 double PieceWiseLinearFunction::evaluate(double x)
 {
 	assert(m_points.size() != 0);
@@ -31,24 +97,12 @@ double PieceWiseLinearFunction::evaluate(double x)
 
 	if (num > 0)
 	{
-		if (x < m_points[0].x)
+		if (x < m_x[0])
 			return m_leftValue;
+		if (!(x < m_x[num])) // also for NaN
+			return m_rightValue;
 
-		for (size_t i = 0 ; i < num ; i++)
-		{
-			double x0 = m_points[i].x;
-			double x1 = m_points[i+1].x;
-
-			if (x >= x0 && x < x1)
-			{
-				double frac = (x-x0)/(x1-x0);
-				double y0 = m_points[i].y;
-				double y1 = m_points[i+1].y;
-				
-				return (y1-y0)*frac + y0;
-			}
-		}
-		return m_rightValue;
+		return interpolate(findInterval(x), x);
 	}
 
 	assert(num == 0);
@@ -61,3 +115,40 @@ double PieceWiseLinearFunction::evaluate(double x)
 	return m_points[0].y;
 }
 
+void PieceWiseLinearFunction::evaluate(const double *pX, double *pValues, size_t num)
+{
+	size_t numIntervals = m_points.size() - 1;
+
+	if (numIntervals == 0)
+	{
+		for (size_t j = 0 ; j < num ; j++)
+			pValues[j] = evaluate(pX[j]);
+		return;
+	}
+
+	size_t i = 0;
+	for (size_t j = 0 ; j < num ; j++)
+	{
+		double x = pX[j];
+
+		if (x < m_x[0])
+			pValues[j] = m_leftValue;
+		else if (!(x < m_x[numIntervals]))
+			pValues[j] = m_rightValue;
+		else
+		{
+			// Unless the interval can be calculated directly, try the previous
+			// interval and the next one first
+			if (m_equallySpaced)
+				i = findInterval(x);
+			else if (!(x >= m_x[i] && x < m_x[i+1]))
+			{
+				if (i+2 <= numIntervals && x >= m_x[i+1] && x < m_x[i+2])
+					i++;
+				else
+					i = findInterval(x);
+			}
+			pValues[j] = interpolate(i, x);
+		}
+	}
+}
@@ -4,12 +4,15 @@
 
 #include "function.h"
 #include "point2d.h"
+#include <stddef.h>
 #include <vector>
 #include <limits>
 
-// TODO: this is a slow, trivial implementation for now. Not suited for a large
-//       number of points since at every evaluation all points will be scanned
-//       to find the right interval
+// To find the interval that contains an x value, a binary search is done in the
+// x-coordinates of the points. If these are equally spaced, the interval is
+// calculated directly instead. Otherwise, when evaluating the function for an
+// array of x values, the previous interval is checked first, which makes this
+// fast when the x values are sorted.
 class PieceWiseLinearFunction : public Function
 {
 public:
@@ -20,13 +23,26 @@ public:
 
 	double evaluate(double x);
 
+	// Stores the function values for the num x values in pX in pValues, these
+	// are the same as for separate calls to evaluate
+	void evaluate(const double *pX, double *pValues, size_t num);
+
 	double getLeftValue() const									{ return m_leftValue; }
 	double getRightValue() const									{ return m_rightValue; }
 	const std::vector<Point2D> &getPoints() const							{ return m_points; }
+	bool isEquallySpaced() const									{ return m_equallySpaced; }
 private:
+	// Returns the index i for which x lies in [x_i, x_{i+1}), which must exist
+	size_t findInterval(double x) const;
+	double interpolate(size_t i, double x) const;
+
 	std::vector<Point2D> m_points;
+	std::vector<double> m_x;
 	double m_leftValue;
 	double m_rightValue;
+
+	bool m_equallySpaced;
+	double m_invSpacing;
 };
 
 #endif // PIECEWISELINEARFUNCTION_H
@@ -0,0 +1,58 @@
+#include "polygon2d.h"
+
+using namespace std;
+
+void Polygon2D::getInsideMask(double xOffset, double yOffset, double pixelWidth, double pixelHeight,
+	                      int width, int height, vector<char> &mask) const
+{
+	mask.assign((size_t)width*(size_t)height, 0);
+	if (m_numCoords == 0)
+		return;
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int y = 0 ; y < height ; y++)
+	{
+		double yCoord = yOffset + pixelHeight*(0.5+(double)y);
+		vector<double> crossings;
+
+		// Same criteria as in isInside: the pixel center at x is inside if it is
+		// not to the right of an odd number of these crossings
+		for (int i = 0 ; i < m_numCoords ; i++)
+		{
+			double y1 = m_xyCoords[i].second;
+			double y2 = m_xyCoords[i+1].second;
+			double Y1 = std::min(y1, y2);
+			double Y2 = std::max(y1, y2);
+
+			if (Y1 < yCoord && yCoord <= Y2)
+			{
+				double x1 = m_xyCoords[i].first;
+				double x2 = m_xyCoords[i+1].first;
+
+				// Limiting this to the largest x also takes the x <= max(x1, x2) test
+				// into account, which can differ from x <= x0 due to round-off
+				if (x1 == x2)
+					crossings.push_back(x1);
+				else
+					crossings.push_back(std::min(((yCoord - y1)*(x2 - x1))/(y2 - y1) + x1, std::max(x1, x2)));
+			}
+		}
+
+		if (crossings.size() == 0)
+			continue;
+
+		sort(crossings.begin(), crossings.end());
+
+		char *pRow = &mask[(size_t)y*width];
+		const int numCrossings = (int)crossings.size();
+
+		for (int x = 0 ; x < width ; x++)
+		{
+			double xCoord = xOffset + pixelWidth*(0.5+(double)x);
+			int numBefore = (int)(lower_bound(crossings.begin(), crossings.end(), xCoord) - crossings.begin());
+
+			if ((numCrossings - numBefore)&1)
+				pRow[x] = 1;
+		}
+	}
+}
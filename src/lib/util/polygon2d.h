@@ -3,6 +3,7 @@
 #define POLYGON2D_H
 
 #include "booltype.h"
+#include "point2d.h"
 #include <algorithm>
 #include <vector>
 
@@ -18,6 +19,16 @@ public:
 	bool_t init(const std::vector<Point2D> &points);
 	bool isInside(double x, double y) const;
 	int getNumberOfPoints() const								{ return m_numCoords; }
+
+	/** Determines for each pixel of a \c width by \c height grid whether its center
+	 *  is inside the polygon, in the same way as isInside. The center of pixel (x,y)
+	 *  is at (xOffset + pixelWidth*(x+0.5), yOffset + pixelHeight*(y+0.5)), and
+	 *  \c mask is set to 1 for that pixel at position y*width+x if it's inside.
+	 *  Instead of testing every pixel against every edge, the crossings of the
+	 *  edges with each row of pixel centers are calculated once, and the rows are
+	 *  processed in parallel. */
+	void getInsideMask(double xOffset, double yOffset, double pixelWidth, double pixelHeight,
+	                   int width, int height, std::vector<char> &mask) const;
 private:
 	std::vector<std::pair<double, double> > m_xyCoords;
 	int m_numCoords;
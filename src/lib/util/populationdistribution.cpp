@@ -1,6 +1,7 @@
 #include "populationdistribution.h"
 #include "discretedistribution.h"
 #include "csvfile.h"
+#include "util.h"
 #include <iostream>
 
 PopulationDistribution::PopulationDistribution(GslRandomNumberGenerator *pRndGen)
@@ -12,3 +13,8 @@ PopulationDistribution::~PopulationDistribution()
 {
 }
 
+void PopulationDistribution::pickAges(GslRandomNumberGenerator *pRndGen, bool male, double *pAges, size_t num) const
+{
+	abortWithMessage("PopulationDistribution::pickAges: not supported for this age distribution");
+}
+
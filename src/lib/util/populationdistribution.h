@@ -6,6 +6,8 @@
  * \file populationdistribution.h 
  */
 
+#include <stddef.h>
+
 class GslRandomNumberGenerator;
 
 /** Base class for picking random numbers according to some kind
@@ -20,6 +22,15 @@ public:
 
 	/** This function generates the random age, for either a man or a woman. */
 	virtual double pickAge(bool male) const = 0;
+
+	/** Returns true if pickAges can be used. */
+	virtual bool hasBulkPicking() const									{ return false; }
+
+	/** Picks \c num ages at once, for either men or women, and stores them in
+	 *  \c pAges. The random number generator \c pRndGen is used instead of
+	 *  the one from the constructor, see ProbabilityDistribution::pickNumbers.
+	 *  This can only be used if hasBulkPicking returns true. */
+	virtual void pickAges(GslRandomNumberGenerator *pRndGen, bool male, double *pAges, size_t num) const;
 protected:
 	/** This function can be used to obtain the random number generator
 	 *  specified in the constructor. */
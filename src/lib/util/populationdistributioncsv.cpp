@@ -7,6 +7,7 @@ PopulationDistributionCSV::PopulationDistributionCSV(GslRandomNumberGenerator *p
 {
 	m_pMaleDist = 0;
 	m_pFemaleDist = 0;
+	m_sampler = DiscreteDistributionAlias::Auto;
 }
 
 PopulationDistributionCSV::~PopulationDistributionCSV()
@@ -14,7 +15,7 @@ PopulationDistributionCSV::~PopulationDistributionCSV()
 	clear();
 }
 
-bool_t PopulationDistributionCSV::load(const std::string &csvFileName)
+bool_t PopulationDistributionCSV::load(const std::string &csvFileName, DiscreteDistributionAlias::SamplerType sampler)
 {
 	CSVFile csvFile;
 	bool_t r = csvFile.load(csvFileName);
@@ -25,20 +26,15 @@ bool_t PopulationDistributionCSV::load(const std::string &csvFileName)
 	if (csvFile.getNumberOfColumns() < 3)
 		return "The file should contain at least three columns";
 
-	std::vector<double> binStarts;
-	std::vector<double> maleValues, femaleValues;
-
-	for (int r = 0 ; r < csvFile.getNumberOfRows() ; r++)
-	{
-		binStarts.push_back(csvFile.getValue(r, 0));
-		maleValues.push_back(csvFile.getValue(r, 1));
-		femaleValues.push_back(csvFile.getValue(r, 2));
-	}
+	const std::vector<double> &binStarts = csvFile.getColumn(0);
+	const std::vector<double> &maleValues = csvFile.getColumn(1);
+	const std::vector<double> &femaleValues = csvFile.getColumn(2);
 
 	clear();
 
-	m_pMaleDist = new DiscreteDistribution(binStarts, maleValues, false, getRandomNumberGenerator());
-	m_pFemaleDist = new DiscreteDistribution(binStarts, femaleValues, false, getRandomNumberGenerator());
+	m_pMaleDist = DiscreteDistributionAlias::createHistogramDistribution(binStarts, maleValues, false, sampler, getRandomNumberGenerator());
+	m_pFemaleDist = DiscreteDistributionAlias::createHistogramDistribution(binStarts, femaleValues, false, sampler, getRandomNumberGenerator());
+	m_sampler = sampler;
 
 	return true;
 }
@@ -56,7 +52,7 @@ void PopulationDistributionCSV::clear()
 
 double PopulationDistributionCSV::pickAge(bool male) const
 {
-	DiscreteDistribution *pDist = (male)?m_pMaleDist:m_pFemaleDist;
+	ProbabilityDistribution *pDist = (male)?m_pMaleDist:m_pFemaleDist;
 
 	if (!pDist)
 	{
@@ -67,3 +63,16 @@ double PopulationDistributionCSV::pickAge(bool male) const
 	return pDist->pickNumber();
 }
 
+bool PopulationDistributionCSV::hasBulkPicking() const
+{
+	return m_pMaleDist && m_pMaleDist->hasBulkPicking() && m_pFemaleDist && m_pFemaleDist->hasBulkPicking();
+}
+
+void PopulationDistributionCSV::pickAges(GslRandomNumberGenerator *pRndGen, bool male, double *pAges, size_t num) const
+{
+	ProbabilityDistribution *pDist = (male)?m_pMaleDist:m_pFemaleDist;
+
+	assert(pDist != 0);
+	pDist->pickNumbers(pRndGen, pAges, num);
+}
+
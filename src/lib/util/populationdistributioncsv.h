@@ -7,9 +7,10 @@
  */
 
 #include "populationdistribution.h"
+#include "discretedistributionalias.h"
 #include "booltype.h"
 
-class DiscreteDistribution;
+class ProbabilityDistribution;
 
 /** This class allows you to pick random ages according to the data
  *  loaded from a CSV file.
@@ -27,16 +28,25 @@ public:
 	 *
 	 * 	"Start of age bin", "Number of men in bin", "Number of women in bin"
 	 *	..., ..., ...
+	 *
+	 *  The \c sampler parameter determines if a DiscreteDistribution or a
+	 *  DiscreteDistributionAlias is used to pick the ages.
 	 */
-	bool_t load(const std::string &csvFile);
+	bool_t load(const std::string &csvFile, DiscreteDistributionAlias::SamplerType sampler = DiscreteDistributionAlias::Auto);
 
 	/** Clears the previously loaded data. */
 	void clear();
 
 	double pickAge(bool male) const;
+	bool hasBulkPicking() const;
+	void pickAges(GslRandomNumberGenerator *pRndGen, bool male, double *pAges, size_t num) const;
+
+	/** Returns the sampler type that was specified when loading the data. */
+	DiscreteDistributionAlias::SamplerType getSampler() const					{ return m_sampler; }
 private:
-	DiscreteDistribution *m_pMaleDist;
-	DiscreteDistribution *m_pFemaleDist;
+	ProbabilityDistribution *m_pMaleDist;
+	ProbabilityDistribution *m_pFemaleDist;
+	DiscreteDistributionAlias::SamplerType m_sampler;
 };
 
 #endif // POPULATIONDISTRIBUTIONCSV_H
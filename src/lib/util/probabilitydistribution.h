@@ -6,7 +6,9 @@
  * \file probabilitydistribution.h
  */
 
+#include "util.h"
 #include <assert.h>
+#include <stddef.h>
 
 class GslRandomNumberGenerator;
 
@@ -21,6 +23,18 @@ public:
 	/** Pick a number according to a specific distrubution, specified in a subclass 
 	 *  of ProbabilityDistribution . */
 	virtual double pickNumber() const = 0;
+
+	/** Returns true if pickNumbers can be used for this distribution. */
+	virtual bool hasBulkPicking() const						{ return false; }
+
+	/** Picks \c num numbers at once and stores them in \c pValues. Instead of the
+	 *  random number generator from the constructor, \c pRndGen is used, so that
+	 *  several threads can pick numbers from the same distribution at the same time,
+	 *  each with its own generator. For a generator in the same state, the numbers
+	 *  are the same as those of \c num calls to pickNumber. This can only be used
+	 *  if hasBulkPicking returns true. */
+	virtual void pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const
+											{ abortWithMessage("ProbabilityDistribution::pickNumbers: not supported for this distribution"); }
 	GslRandomNumberGenerator *getRandomNumberGenerator() const			{ return m_pRng; }
 private:
 	mutable GslRandomNumberGenerator *m_pRng;
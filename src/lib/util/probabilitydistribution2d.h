@@ -7,7 +7,9 @@
  */
 
 #include "point2d.h"
+#include "util.h"
 #include <assert.h>
+#include <stddef.h>
 #include <limits>
 
 class GslRandomNumberGenerator;
@@ -25,6 +27,16 @@ public:
 	 *  of ProbabilityDistribution2D . */
 	virtual Point2D pickPoint() const = 0;
 
+	/** Returns true if pickPoints can be used for this distribution. */
+	virtual bool hasBulkPicking() const						{ return false; }
+
+	/** Picks \c num points at once and stores them in \c pPoints, using \c pRndGen
+	 *  instead of the random number generator from the constructor, like
+	 *  ProbabilityDistribution::pickNumbers. This can only be used if hasBulkPicking
+	 *  returns true. */
+	virtual void pickPoints(GslRandomNumberGenerator *pRndGen, Point2D *pPoints, size_t num) const
+											{ abortWithMessage("ProbabilityDistribution2D::pickPoints: not supported for this distribution"); }
+
 	bool hasMarginalsAndConditionals() const					{ return m_supportsMarginalsAndConditionals; }
 	virtual double pickMarginalX() const						{ return std::numeric_limits<double>::quiet_NaN(); }
 	virtual double pickMarginalY() const						{ return std::numeric_limits<double>::quiet_NaN(); }
@@ -0,0 +1,272 @@
+#include "tabulatedhazardfunction.h"
+#include "util.h"
+#include <algorithm>
+#include <assert.h>
+
+using namespace std;
+
+#define TABULATEDHAZARDFUNCTION_INITIALSEGMENTS 32
+#define TABULATEDHAZARDFUNCTION_MAXDEPTH 50
+
+TabulatedHazardFunction::TabulatedHazardFunction()
+{
+}
+
+TabulatedHazardFunction::TabulatedHazardFunction(HazardFunction &h, double tStart, double tEnd, double relTol, double absTol)
+{
+	build(h, tStart, tEnd, relTol, absTol);
+}
+
+TabulatedHazardFunction::~TabulatedHazardFunction()
+{
+}
+
+void TabulatedHazardFunction::build(HazardFunction &h, double tStart, double tEnd, double relTol, double absTol)
+{
+	if (!(tEnd > tStart))
+		abortWithMessage(strprintf("TabulatedHazardFunction: end of interval (%g) must be larger than the start (%g)", tEnd, tStart));
+	if (relTol < 0 || absTol < 0 || (relTol == 0 && absTol == 0))
+		abortWithMessage("TabulatedHazardFunction: tolerances must not be negative and can't both be zero");
+
+	m_t.clear();
+	m_h.clear();
+	m_k.clear();
+	m_isLinear.clear();
+	m_C.clear();
+	m_S.clear();
+
+	double ha = h.evaluate(tStart);
+	if (!(ha >= 0))
+		abortWithMessage(strprintf("TabulatedHazardFunction: hazard is negative or NaN at %g", tStart));
+
+	m_t.push_back(tStart);
+	m_h.push_back(ha);
+
+	const int numInitial = TABULATEDHAZARDFUNCTION_INITIALSEGMENTS;
+	const double minWidth = (tEnd - tStart)*1e-12;
+	double a = tStart;
+
+	for (int i = 0 ; i < numInitial ; i++)
+	{
+		double b = (i == numInitial-1) ? tEnd : tStart + ((tEnd - tStart)*(double)(i+1))/(double)numInitial;
+		double hb = h.evaluate(b);
+
+		if (!(hb >= 0))
+			abortWithMessage(strprintf("TabulatedHazardFunction: hazard is negative or NaN at %g", b));
+
+		refine(h, a, ha, b, hb, minWidth, 0, relTol, absTol);
+
+		a = b;
+		ha = hb;
+	}
+
+	// Cumulative integrals in both directions, see getIntegralBetweenNodes
+
+	int numNodes = m_t.size();
+
+	m_C.resize(numNodes);
+	m_S.resize(numNodes);
+
+	m_C[0] = 0;
+	for (int i = 1 ; i < numNodes ; i++)
+		m_C[i] = m_C[i-1] + getSegmentIntegral(i-1, 0, m_t[i]-m_t[i-1]);
+
+	m_S[numNodes-1] = 0;
+	for (int i = numNodes-2 ; i >= 0 ; i--)
+		m_S[i] = m_S[i+1] + getSegmentIntegral(i, 0, m_t[i+1]-m_t[i]);
+}
+
+void TabulatedHazardFunction::refine(HazardFunction &h, double a, double ha, double b, double hb, double minWidth, int depth,
+                                     double relTol, double absTol)
+{
+	const double m = 0.5*(a+b);
+	const double hm = h.evaluate(m);
+
+	if (!(hm >= 0))
+		abortWithMessage(strprintf("TabulatedHazardFunction: hazard is negative or NaN at %g", m));
+
+	// Approximation in the middle of the segment
+	const bool linear = (ha == 0 || hb == 0);
+	const double approxMid = (linear) ? 0.5*(ha+hb) : std::sqrt(ha)*std::sqrt(hb);
+	const double width = b-a;
+	const double simpson = width/6.0*(ha + 4.0*hm + hb);
+	const double err = std::abs(hm - approxMid)*width;
+
+	if (err <= relTol*simpson + absTol || width <= minWidth || depth >= TABULATEDHAZARDFUNCTION_MAXDEPTH)
+	{
+		addSegment(a, ha, b, hb);
+		return;
+	}
+
+	refine(h, a, ha, m, hm, minWidth, depth+1, relTol, absTol);
+	refine(h, m, hm, b, hb, minWidth, depth+1, relTol, absTol);
+}
+
+void TabulatedHazardFunction::addSegment(double a, double ha, double b, double hb)
+{
+	assert(m_t.size() > 0 && m_t.back() == a);
+	assert(m_h.back() == ha);
+
+	const double width = b-a;
+
+	if (ha == 0 || hb == 0)
+	{
+		m_isLinear.push_back(true);
+		m_k.push_back((hb - ha)/width);
+	}
+	else
+	{
+		m_isLinear.push_back(false);
+		m_k.push_back((std::log(hb) - std::log(ha))/width);
+	}
+
+	m_t.push_back(b);
+	m_h.push_back(hb);
+}
+
+// Returns the segment that contains t, which must lie inside the table
+int TabulatedHazardFunction::findSegment(double t) const
+{
+	assert(isBuilt());
+
+	int seg = (int)(std::upper_bound(m_t.begin(), m_t.end(), t) - m_t.begin()) - 1;
+
+	if (seg < 0)
+		seg = 0;
+	else if (seg > (int)m_t.size()-2)
+		seg = (int)m_t.size()-2;
+
+	return seg;
+}
+
+// Both m_C and m_S can be used to calculate this integral; the one in which the
+// values are smallest will be the least affected by rounding errors
+double TabulatedHazardFunction::getIntegralBetweenNodes(int node1, int node2) const
+{
+	assert(node1 <= node2);
+
+	if (m_C[node2] <= m_S[node1])
+		return m_C[node2] - m_C[node1];
+
+	return m_S[node1] - m_S[node2];
+}
+
+double TabulatedHazardFunction::evaluate(double t)
+{
+	assert(isBuilt());
+
+	if (t <= m_t.front())
+		return m_h.front();
+	if (t >= m_t.back())
+		return m_h.back();
+
+	int seg = findSegment(t);
+	return getSegmentValue(seg, t - m_t[seg]);
+}
+
+double TabulatedHazardFunction::calculateInternalTimeInterval(double t0, double dt)
+{
+	assert(isBuilt());
+	assert(dt >= 0);
+
+	const double tStart = m_t.front();
+	const double tEnd = m_t.back();
+	double t1 = t0 + dt;
+	double dT = 0;
+
+	if (t0 < tStart) // constant part before the table
+	{
+		double tLimit = std::min(t1, tStart);
+
+		dT += getEdgeValue(m_h.front())*(tLimit - t0);
+		t0 = tLimit;
+	}
+
+	if (t1 > tEnd) // constant part after the table
+	{
+		double tLimit = std::max(t0, tEnd);
+
+		dT += getEdgeValue(m_h.back())*(t1 - tLimit);
+		t1 = tLimit;
+	}
+
+	if (t1 <= t0)
+		return dT;
+
+	int seg0 = findSegment(t0);
+	int seg1 = findSegment(t1);
+	double x0 = t0 - m_t[seg0];
+
+	if (seg0 == seg1)
+		return dT + getSegmentIntegral(seg0, x0, t1-t0);
+
+	dT += getSegmentIntegral(seg0, x0, m_t[seg0+1]-t0);
+	dT += getIntegralBetweenNodes(seg0+1, seg1);
+	dT += getSegmentIntegral(seg1, 0, t1-m_t[seg1]);
+
+	return dT;
+}
+
+double TabulatedHazardFunction::solveForRealTimeInterval(double t0, double Tdiff)
+{
+	assert(isBuilt());
+	assert(Tdiff >= 0);
+
+	const double tStart = m_t.front();
+	const double tEnd = m_t.back();
+	double dt = 0;
+
+	if (t0 < tStart) // constant part before the table
+	{
+		double hStart = getEdgeValue(m_h.front());
+		double T = hStart*(tStart - t0);
+
+		if (Tdiff <= T)
+			return Tdiff/hStart;
+
+		Tdiff -= T;
+		dt = tStart - t0;
+		t0 = tStart;
+	}
+
+	if (t0 >= tEnd) // constant part after the table
+		return dt + Tdiff/getEdgeValue(m_h.back());
+
+	const int lastNode = (int)m_t.size()-1;
+	const int seg0 = findSegment(t0);
+	const double x0 = t0 - m_t[seg0];
+	const double T0 = getSegmentIntegral(seg0, x0, m_t[seg0+1]-t0);
+
+	if (Tdiff <= T0)
+		return dt + solveInSegment(seg0, x0, Tdiff);
+
+	Tdiff -= T0;
+	dt += m_t[seg0+1] - t0;
+
+	const int node0 = seg0+1;
+	const double TRest = getIntegralBetweenNodes(node0, lastNode);
+
+	if (Tdiff > TRest) // we'll end up in the constant part after the table
+		return dt + (tEnd - m_t[node0]) + (Tdiff - TRest)/getEdgeValue(m_h.back());
+
+	// Look for the first node for which the integral exceeds Tdiff, the
+	// previous one is the start of the segment we need
+
+	int low = node0+1, high = lastNode;
+	while (low < high)
+	{
+		int mid = (low+high)/2;
+
+		if (getIntegralBetweenNodes(node0, mid) >= Tdiff)
+			high = mid;
+		else
+			low = mid+1;
+	}
+
+	const int seg = low-1;
+
+	Tdiff -= getIntegralBetweenNodes(node0, seg);
+	dt += m_t[seg] - m_t[node0];
+
+	return dt + solveInSegment(seg, 0, Tdiff);
+}
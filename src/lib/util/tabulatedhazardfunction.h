@@ -0,0 +1,165 @@
+#ifndef TABULATEDHAZARDFUNCTION_H
+
+#define TABULATEDHAZARDFUNCTION_H
+
+/**
+ * \file tabulatedhazardfunction.h
+ */
+
+#include "hazardfunction.h"
+#include <vector>
+#include <cmath>
+
+/** Hazard that is based on a tabulation of another hazard, for which only the
+ *  HazardFunction::evaluate function needs to be implemented.
+ *
+ *  When a new hazard does not have a cheap closed form solution for its integral
+ *  (or for the inverse of it), the HazardFunction::calculateInternalTimeInterval
+ *  and HazardFunction::solveForRealTimeInterval functions can be implemented by
+ *  wrapping it in an instance of this class. On construction (or by calling
+ *  TabulatedHazardFunction::build), the interval \f$ [t_{start}, t_{end}] \f$ is
+ *  divided adaptively into segments on which the hazard is approximated by an
+ *  exponential function (or a linear one, if the hazard becomes zero at one of
+ *  the end points). A segment is split in half as long as the difference between
+ *  the hazard and its approximation in the middle of the segment, multiplied by
+ *  the segment width, exceeds \f$ {\rm relTol} \times I + {\rm absTol} \f$,
+ *  where \f$ I \f$ is the integral of the hazard over the segment.
+ *
+ *  Both directions of the time mapping are then calculated from the same
+ *  approximation, by looking up the relevant segments and inverting the
+ *  approximation locally. Because of this, the results of
+ *  TabulatedHazardFunction::calculateInternalTimeInterval and
+ *  TabulatedHazardFunction::solveForRealTimeInterval are each other's inverse up
+ *  to rounding errors, as is verified by EventBase::setCheckInverse; the tolerances
+ *  only determine how closely the original hazard is followed.
+ *
+ *  For times larger than \f$ t_{end} \f$ the hazard is taken to be constant with
+ *  value \f$ h(t_{end}) \f$, as in TimeLimitedHazardFunction, and for times smaller
+ *  than \f$ t_{start} \f$ the constant value \f$ h(t_{start}) \f$ is used.
+ *
+ *  Building the table requires a number of evaluations of the hazard, so to
+ *  be useful, an instance should be kept (e.g. as a member of an event) for as
+ *  long as the parameters of the hazard remain the same.
+ */
+class TabulatedHazardFunction : public HazardFunction
+{
+public:
+	/** Creates an instance without a table, TabulatedHazardFunction::build must be
+	 *  called before it can be used. */
+	TabulatedHazardFunction();
+
+	/** Creates the table for hazard \c h on the interval \c tStart to \c tEnd, see
+	 *  TabulatedHazardFunction::build. */
+	TabulatedHazardFunction(HazardFunction &h, double tStart, double tEnd, double relTol = 1e-6, double absTol = 1e-12);
+	~TabulatedHazardFunction();
+
+	/** Tabulates the hazard \c h on the interval \c tStart to \c tEnd; the hazard
+	 *  must not be negative on this interval. The hazard \c h itself is not used
+	 *  anymore afterwards, only the table. */
+	void build(HazardFunction &h, double tStart, double tEnd, double relTol = 1e-6, double absTol = 1e-12);
+
+	/** Returns \c true if a table has been built. */
+	bool isBuilt() const										{ return m_t.size() > 1; }
+
+	/** Returns the number of segments in the table. */
+	int getNumberOfSegments() const									{ return (int)m_t.size() - 1; }
+
+	double evaluate(double t);
+	double calculateInternalTimeInterval(double t0, double dt);
+	double solveForRealTimeInterval(double t0, double Tdiff);
+private:
+	void refine(HazardFunction &h, double a, double ha, double b, double hb, double minWidth, int depth,
+	            double relTol, double absTol);
+	void addSegment(double a, double ha, double b, double hb);
+	int findSegment(double t) const;
+	double getSegmentValue(int seg, double x) const;
+	double getSegmentIntegral(int seg, double x0, double dx) const;
+	double solveInSegment(int seg, double x0, double T) const;
+	double getIntegralBetweenNodes(int node1, int node2) const;
+
+	static double getEdgeValue(double h);
+
+	std::vector<double> m_t;	// node positions
+	std::vector<double> m_h;	// hazard values at the nodes
+	std::vector<double> m_k;	// per segment: log slope, or slope if m_isLinear is set
+	std::vector<bool> m_isLinear;
+	std::vector<double> m_C;	// integral from the first node to node i
+	std::vector<double> m_S;	// integral from node i to the last node
+};
+
+// Same small number as in TimeLimitedHazardFunction, to avoid a division by zero
+// in the constant parts outside the table
+inline double TabulatedHazardFunction::getEdgeValue(double h)
+{
+	return h + TIMELIMITEDHAZARDFUNCTION_SMALLNUMBER;
+}
+
+// Value of the approximation at a distance x from the start of the segment
+inline double TabulatedHazardFunction::getSegmentValue(int seg, double x) const
+{
+	if (m_isLinear[seg])
+		return m_h[seg] + m_k[seg]*x;
+
+	return m_h[seg]*std::exp(m_k[seg]*x);
+}
+
+// Integral of the approximation from x0 to x0+dx, both relative to the start of the segment
+inline double TabulatedHazardFunction::getSegmentIntegral(int seg, double x0, double dx) const
+{
+	const double h0 = getSegmentValue(seg, x0);
+	const double k = m_k[seg];
+
+	if (m_isLinear[seg])
+		return h0*dx + 0.5*k*dx*dx;
+
+	if (k == 0)
+		return h0*dx;
+
+	return h0*std::expm1(k*dx)/k;
+}
+
+// Solves getSegmentIntegral(seg, x0, dx) = T for dx
+inline double TabulatedHazardFunction::solveInSegment(int seg, double x0, double T) const
+{
+	const double h0 = getSegmentValue(seg, x0);
+	const double k = m_k[seg];
+	const double maxDx = (m_t[seg+1] - m_t[seg]) - x0;
+	double dx = 0;
+
+	if (T <= 0)
+		return 0;
+
+	if (m_isLinear[seg])
+	{
+		if (k == 0)
+			dx = (h0 > 0) ? T/h0 : maxDx;
+		else
+		{
+			double disc = h0*h0 + 2.0*k*T;
+			if (disc < 0) // can only be due to rounding errors
+				disc = 0;
+
+			double denom = h0 + std::sqrt(disc);
+			dx = (denom > 0) ? 2.0*T/denom : maxDx;
+		}
+	}
+	else
+	{
+		if (k == 0)
+			dx = T/h0;
+		else
+		{
+			double arg = k*T/h0;
+			dx = (arg > -1.0) ? std::log1p(arg)/k : maxDx;
+		}
+	}
+
+	if (dx > maxDx)
+		dx = maxDx;
+	if (dx < 0)
+		dx = 0;
+
+	return dx;
+}
+
+#endif // TABULATEDHAZARDFUNCTION_H
@@ -19,6 +19,8 @@ public:
 	UniformDistribution(double minValue, double maxValue, GslRandomNumberGenerator *pRng);
 	
 	double pickNumber() const;
+	bool hasBulkPicking() const									{ return true; }
+	void pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const;
 	double getMin() const										{ return m_offset; }
 	double getRange() const										{ return m_range; }
 	double getMax() const										{ return m_maxValue; }
@@ -39,5 +41,13 @@ inline double UniformDistribution::pickNumber() const
 	return x*m_range + m_offset;
 }
 
+inline void UniformDistribution::pickNumbers(GslRandomNumberGenerator *pRndGen, double *pValues, size_t num) const
+{
+	pRndGen->pickRandomDoubles(pValues, num);
+
+	for (size_t i = 0 ; i < num ; i++)
+		pValues[i] = pValues[i]*m_range + m_offset;
+}
+
 #endif // UNIFORMDISTRIBUTION_H
 
@@ -20,6 +20,8 @@ public:
 			      GslRandomNumberGenerator *pRng);
 	
 	Point2D pickPoint() const;
+	bool hasBulkPicking() const							{ return true; }
+	void pickPoints(GslRandomNumberGenerator *pRndGen, Point2D *pPoints, size_t num) const;
 	double pickMarginalX() const							{ return m_xDist.pickNumber(); }
 	double pickMarginalY() const							{ return m_yDist.pickNumber(); }
 	double pickConditionalOnX(double x) const					{ return m_yDist.pickNumber(); }
@@ -49,5 +51,15 @@ inline Point2D UniformDistribution2D::pickPoint() const
 	return Point2D(x, y);
 }
 
+inline void UniformDistribution2D::pickPoints(GslRandomNumberGenerator *pRndGen, Point2D *pPoints, size_t num) const
+{
+	for (size_t i = 0 ; i < num ; i++)
+	{
+		double x = pRndGen->pickRandomDouble()*m_xDist.getRange() + m_xDist.getMin();
+		double y = pRndGen->pickRandomDouble()*m_yDist.getRange() + m_yDist.getMin();
+		pPoints[i] = Point2D(x, y);
+	}
+}
+
 #endif // UNIFORMDISTRIBUTION_H
 
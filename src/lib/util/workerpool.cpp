@@ -0,0 +1,216 @@
+#include "workerpool.h"
+#include <assert.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif // __linux__
+
+#ifndef DISABLEOPENMP
+static thread_local int s_currentThreadIndex = -1;
+#endif // !DISABLEOPENMP
+
+WorkerPool::WorkerPool()
+{
+	m_init = false;
+	m_numThreads = 1;
+	m_spinCount = 0;
+	m_pinThreads = false;
+	m_pTask = 0;
+
+#ifndef DISABLEOPENMP
+	m_generation = 0;
+	m_remaining = 0;
+	m_numParked = 0;
+	m_stop = false;
+	m_barrierCount = 0;
+	m_barrierGeneration = 0;
+#endif // !DISABLEOPENMP
+}
+
+WorkerPool::~WorkerPool()
+{
+#ifndef DISABLEOPENMP
+	if (m_threads.size() > 0)
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_parkMutex);
+			m_stop = true;
+		}
+		m_parkCondition.notify_all();
+
+		for (size_t i = 0 ; i < m_threads.size() ; i++)
+			m_threads[i].join();
+	}
+#endif // !DISABLEOPENMP
+}
+
+bool_t WorkerPool::init(int numThreads, int spinCount, bool pinThreads)
+{
+	if (m_init)
+		return "Worker pool was already initialized";
+	if (numThreads < 1)
+		return "The number of threads must be at least one";
+	if (spinCount < 0)
+		return "The spin count can't be negative";
+
+	m_spinCount = spinCount;
+	m_pinThreads = pinThreads;
+
+#ifndef DISABLEOPENMP
+	m_numThreads = numThreads;
+
+	if (m_pinThreads)
+		pinThread(0);
+
+	for (int i = 1 ; i < numThreads ; i++)
+		m_threads.push_back(std::thread(&WorkerPool::workerThread, this, i));
+#else
+	if (numThreads > 1)
+		return "Can't use more than one thread, support for OpenMP was not available when creating the program";
+#endif // !DISABLEOPENMP
+	m_init = true;
+	return true;
+}
+
+int WorkerPool::getCurrentThreadIndex()
+{
+#ifndef DISABLEOPENMP
+	return s_currentThreadIndex;
+#else
+	return -1;
+#endif // !DISABLEOPENMP
+}
+
+void WorkerPool::execute(const std::function<void(int threadIdx)> &f)
+{
+	assert(m_pTask == 0);
+	m_pTask = &f;
+
+#ifndef DISABLEOPENMP
+	if (m_numThreads > 1)
+	{
+		m_remaining = m_numThreads-1;
+		m_generation++; // this publishes the new task
+
+		// Threads that were already parked need to be woken up; a thread that
+		// is about to park checks the generation while holding the mutex
+		if (m_numParked > 0)
+		{
+			{
+				std::lock_guard<std::mutex> guard(m_parkMutex);
+			}
+			m_parkCondition.notify_all();
+		}
+
+		runTask(0);
+
+		int count = 0;
+		while (m_remaining > 0)
+			spinPause(count);
+	}
+	else
+		runTask(0);
+#else
+	f(0);
+#endif // !DISABLEOPENMP
+
+	m_pTask = 0;
+}
+
+void WorkerPool::runTask(int threadIdx)
+{
+#ifndef DISABLEOPENMP
+	s_currentThreadIndex = threadIdx;
+	(*m_pTask)(threadIdx);
+	s_currentThreadIndex = -1;
+#endif // !DISABLEOPENMP
+}
+
+void WorkerPool::barrier()
+{
+#ifndef DISABLEOPENMP
+	if (m_numThreads == 1)
+		return;
+
+	// The last thread to arrive resets the counter and starts a new barrier
+	// generation, the others wait until this happens
+	int generation = m_barrierGeneration;
+
+	if (m_barrierCount.fetch_add(1) == m_numThreads-1)
+	{
+		m_barrierCount = 0;
+		m_barrierGeneration++;
+	}
+	else
+	{
+		int count = 0;
+		while (m_barrierGeneration == generation)
+			spinPause(count);
+	}
+#endif // !DISABLEOPENMP
+}
+
+// Busy waiting, but after the first iterations the processor is given to
+// other threads, which is important if there are more threads than cores
+void WorkerPool::spinPause(int &count)
+{
+#ifndef DISABLEOPENMP
+	if (count < 64)
+		count++;
+	else
+		std::this_thread::yield();
+#endif // !DISABLEOPENMP
+}
+
+void WorkerPool::workerThread(int threadIdx)
+{
+#ifndef DISABLEOPENMP
+	if (m_pinThreads)
+		pinThread(threadIdx);
+
+	int lastGeneration = 0;
+
+	while (true)
+	{
+		// Spin for a while, new work may arrive soon
+		int count = 0;
+		int spins = 0;
+
+		while (m_generation == lastGeneration && !m_stop && spins < m_spinCount)
+		{
+			spinPause(count);
+			spins++;
+		}
+
+		if (m_generation == lastGeneration && !m_stop)
+		{
+			std::unique_lock<std::mutex> lock(m_parkMutex);
+
+			m_numParked++;
+			m_parkCondition.wait(lock, [this, lastGeneration] { return m_generation != lastGeneration || m_stop; });
+			m_numParked--;
+		}
+
+		if (m_stop)
+			break;
+
+		lastGeneration = m_generation;
+		runTask(threadIdx);
+		m_remaining--;
+	}
+#endif // !DISABLEOPENMP
+}
+
+void WorkerPool::pinThread(int threadIdx)
+{
+#if defined(__linux__) && !defined(DISABLEOPENMP)
+	int numCpus = (int)std::thread::hardware_concurrency();
+	if (numCpus <= 0)
+		return;
+
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	CPU_SET(threadIdx % numCpus, &cpuSet);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+#endif // __linux__ && !DISABLEOPENMP
+}
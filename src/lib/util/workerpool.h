@@ -0,0 +1,88 @@
+#ifndef WORKERPOOL_H
+
+#define WORKERPOOL_H
+
+/**
+ * \file workerpool.h
+ */
+
+#include "booltype.h"
+#include <functional>
+#include <vector>
+#ifndef DISABLEOPENMP
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif // !DISABLEOPENMP
+
+/** A set of threads that stay alive for the duration of a simulation, to run
+ *  short pieces of work on several threads without the cost of starting a new
+ *  parallel region each time.
+ *
+ *  The thread that calls WorkerPool::execute takes part in the work as thread 0,
+ *  the other threads are created by WorkerPool::init. Between two calls to
+ *  WorkerPool::execute the worker threads first spin for a while, checking if new
+ *  work has arrived, so that a step that follows shortly after the previous one
+ *  can start without having to wake up the threads. If no new work arrives during
+ *  this time, the threads park themselves on a condition variable and no longer
+ *  use any processor time. Optionally, each thread can be bound to a single
+ *  processor core.
+ *
+ *  If the program was compiled without OpenMP support, the pool never has more than
+ *  one thread and the work is simply done by the calling thread.
+ */
+class WorkerPool
+{
+public:
+	WorkerPool();
+	~WorkerPool();
+
+	/** Starts the threads so that \c numThreads threads in total (including
+	 *  the calling one) will take part in the work. A thread keeps checking for
+	 *  new work for \c spinCount iterations before it parks; if \c pinThreads
+	 *  is set, thread \c i is bound to processor core \c i (only on Linux). */
+	bool_t init(int numThreads, int spinCount, bool pinThreads);
+
+	/** Returns the number of threads that take part in each WorkerPool::execute call. */
+	int getNumberOfThreads() const									{ return m_numThreads; }
+
+	/** Calls \c f on each of the threads of the pool, with the index of the thread
+	 *  (0 for the calling thread) as argument, and returns once all of them have
+	 *  finished. */
+	void execute(const std::function<void(int threadIdx)> &f);
+
+	/** Can be called from within the function that's passed to WorkerPool::execute,
+	 *  it only returns once every thread of the pool has called it. */
+	void barrier();
+
+	/** Returns the index of the calling thread in the pool that it's currently
+	 *  working for, or -1 if it's not executing work of a pool. */
+	static int getCurrentThreadIndex();
+private:
+	void workerThread(int threadIdx);
+	void runTask(int threadIdx);
+	void spinPause(int &count);
+	void pinThread(int threadIdx);
+
+	bool m_init;
+	int m_numThreads;
+	int m_spinCount;
+	bool m_pinThreads;
+	const std::function<void(int)> *m_pTask;
+
+#ifndef DISABLEOPENMP
+	std::vector<std::thread> m_threads;
+	std::atomic<int> m_generation;
+	std::atomic<int> m_remaining;
+	std::atomic<int> m_numParked;
+	std::atomic<bool> m_stop;
+	std::mutex m_parkMutex;
+	std::condition_variable m_parkCondition;
+
+	std::atomic<int> m_barrierCount;
+	std::atomic<int> m_barrierGeneration;
+#endif // !DISABLEOPENMP
+};
+
+#endif // WORKERPOOL_H
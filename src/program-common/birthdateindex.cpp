@@ -0,0 +1,143 @@
+#include "birthdateindex.h"
+#include <algorithm>
+#include <utility>
+
+// The positions of removed persons are only dropped if there are at least this
+// many of them, so that a small population isn't rebuilt at every death
+#define BIRTHDATEINDEX_MINREMOVED 1024
+
+BirthDateIndex::BirthDateIndex()
+{
+	m_numRemoved = 0;
+	m_sorted = true;
+}
+
+BirthDateIndex::~BirthDateIndex()
+{
+}
+
+int BirthDateIndex::add(double dateOfBirth)
+{
+	int pos = (int)m_datesOfBirth.size();
+
+	if (pos > 0 && dateOfBirth < m_datesOfBirth[pos-1])
+		m_sorted = false;
+
+	int handle;
+
+	if (m_freeHandles.size() > 0)
+	{
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+		assert(m_handlePositions[handle] < 0);
+		m_handlePositions[handle] = pos;
+	}
+	else
+	{
+		handle = (int)m_handlePositions.size();
+		m_handlePositions.push_back(pos);
+	}
+
+	m_datesOfBirth.push_back(dateOfBirth);
+	m_positionHandles.push_back(handle);
+
+	// The new tree node covers the range (i-lowbit(i), i] (one-based), of which
+	// all but the new person are already counted in the existing nodes
+	int i = pos+1;
+	int count = 1;
+	int j = pos;
+	int start = i - (i & (-i));
+
+	while (j > start)
+	{
+		count += m_tree[j-1];
+		j -= (j & (-j));
+	}
+	m_tree.push_back(count);
+
+	return handle;
+}
+
+void BirthDateIndex::remove(int handle)
+{
+	assert(handle >= 0 && handle < (int)m_handlePositions.size());
+
+	int pos = m_handlePositions[handle];
+
+	assert(pos >= 0 && pos < (int)m_positionHandles.size());
+	assert(m_positionHandles[pos] == handle);
+
+	m_positionHandles[pos] = -1;
+	m_handlePositions[handle] = -1;
+	m_freeHandles.push_back(handle);
+	m_numRemoved++;
+
+	for (int i = pos+1 ; i <= (int)m_tree.size() ; i += (i & (-i)))
+		m_tree[i-1]--;
+
+	if (m_numRemoved >= BIRTHDATEINDEX_MINREMOVED && m_numRemoved > getNumberOfLivingPersons())
+		sort();
+}
+
+int BirthDateIndex::countUpTo(double dateOfBirth) const
+{
+	assert(m_sorted);
+
+	int i = (int)(std::upper_bound(m_datesOfBirth.begin(), m_datesOfBirth.end(), dateOfBirth) - m_datesOfBirth.begin());
+	int count = 0;
+
+	for ( ; i > 0 ; i -= (i & (-i)))
+		count += m_tree[i-1];
+
+	return count;
+}
+
+static bool hasEarlierDateOfBirth(const std::pair<double, int> &p1, const std::pair<double, int> &p2)
+{
+	return p1.first < p2.first;
+}
+
+// Only keeps the living persons, and assigns them their new positions
+void BirthDateIndex::sort()
+{
+	std::vector<std::pair<double, int> > persons;
+
+	persons.reserve(getNumberOfLivingPersons());
+	for (size_t i = 0 ; i < m_positionHandles.size() ; i++)
+	{
+		if (m_positionHandles[i] >= 0)
+			persons.push_back(std::make_pair(m_datesOfBirth[i], m_positionHandles[i]));
+	}
+
+	if (!m_sorted)
+		std::stable_sort(persons.begin(), persons.end(), hasEarlierDateOfBirth);
+
+	m_datesOfBirth.resize(persons.size());
+	m_positionHandles.resize(persons.size());
+	for (size_t i = 0 ; i < persons.size() ; i++)
+	{
+		m_datesOfBirth[i] = persons[i].first;
+		m_positionHandles[i] = persons[i].second;
+		m_handlePositions[persons[i].second] = (int)i;
+	}
+
+	m_numRemoved = 0;
+	rebuildTree();
+	m_sorted = true;
+}
+
+void BirthDateIndex::rebuildTree()
+{
+	int num = (int)m_positionHandles.size();
+
+	m_tree.resize(num);
+	for (int i = 0 ; i < num ; i++)
+		m_tree[i] = (m_positionHandles[i] >= 0)?1:0;
+
+	for (int i = 1 ; i <= num ; i++)
+	{
+		int parent = i + (i & (-i));
+		if (parent <= num)
+			m_tree[parent-1] += m_tree[i-1];
+	}
+}
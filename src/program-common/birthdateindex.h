@@ -0,0 +1,45 @@
+#ifndef BIRTHDATEINDEX_H
+
+#define BIRTHDATEINDEX_H
+
+#include <assert.h>
+#include <vector>
+
+// Dates of birth in increasing order, with a Fenwick tree that counts the
+// persons that are still alive, so that the number of living persons born in
+// some interval takes logarithmic time. A birth adds a date after all others,
+// only when the initial population is added the order needs to be restored.
+//
+// Each person is identified by the handle that 'add' returns. The handle of a
+// person that was removed is given to the next person that's added, and the
+// positions of persons that were removed are dropped again once there are more
+// of them than living persons, so the memory and the time of a count depend on
+// the living population and not on the total number of births.
+class BirthDateIndex
+{
+public:
+	BirthDateIndex();
+	~BirthDateIndex();
+
+	int add(double dateOfBirth);
+	void remove(int handle);
+	int countUpTo(double dateOfBirth) const;	// number of living persons with a date of birth <= the one specified
+	void sort();								// also drops the positions of the persons that were removed
+	bool isSorted() const															{ return m_sorted; }
+
+	int getNumberOfLivingPersons() const											{ return (int)m_datesOfBirth.size() - m_numRemoved; }
+	int getNumberOfPositions() const												{ return (int)m_datesOfBirth.size(); }
+	int getNumberOfHandles() const													{ return (int)m_handlePositions.size(); }
+private:
+	void rebuildTree();
+
+	std::vector<double> m_datesOfBirth;		// per position
+	std::vector<int> m_positionHandles;		// per position, -1 if the person was removed
+	std::vector<int> m_handlePositions;		// per handle, -1 if the handle is free
+	std::vector<int> m_freeHandles;
+	std::vector<int> m_tree;
+	int m_numRemoved;
+	bool m_sorted;
+};
+
+#endif // BIRTHDATEINDEX_H
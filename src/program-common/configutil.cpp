@@ -13,8 +13,8 @@
 
 using namespace std;
 
-void checkConfiguration(const ConfigSettings &loadedConfig, const SimpactPopulationConfig &populationConfig, double tMax,
-		        int64_t maxEvents);
+void checkConfiguration(const ConfigSettings &loadedConfig, const SimpactPopulationConfig &populationConfig,
+		        const PopulationDistributionCSV &ageDist, double tMax, int64_t maxEvents);
 
 bool_t configure(ConfigSettings &config, SimpactPopulationConfig &populationConfig, PopulationDistributionCSV &ageDist,
 	       GslRandomNumberGenerator *pRndGen, double &tMax, int64_t &maxEvents)
@@ -25,17 +25,24 @@ bool_t configure(ConfigSettings &config, SimpactPopulationConfig &populationConf
 
 	int numMen = 0, numWomen = 0;
 	double eyecapFraction = 1;
-	string ageDistFile;
+	string ageDistFile, ageDistSamplerName;
+	DiscreteDistributionAlias::SamplerType ageDistSampler;
 	bool msm = false;
+	bool parallelInit = false;
+	bool attributeTable = true;
 	bool_t r;
 
 	if (!(r = config.getKeyValue("population.nummen", numMen, 0)) ||
 	    !(r = config.getKeyValue("population.numwomen", numWomen, 0)) ||
 	    !(r = config.getKeyValue("population.agedistfile", ageDistFile)) ||
+	    !(r = config.getKeyValue("population.agedistsampler", ageDistSamplerName, DiscreteDistributionAlias::getSamplerNames())) ||
+	    !(r = DiscreteDistributionAlias::getSamplerType(ageDistSamplerName, ageDistSampler)) ||
 	    !(r = config.getKeyValue("population.simtime", tMax)) ||
 	    !(r = config.getKeyValue("population.maxevents", maxEvents)) ||
 	    !(r = config.getKeyValue("population.eyecap.fraction", eyecapFraction, 0, 1)) ||
-		!(r = config.getKeyValue("population.msm", msm)) 
+		!(r = config.getKeyValue("population.msm", msm)) ||
+		!(r = config.getKeyValue("population.parallelinit", parallelInit)) ||
+		!(r = config.getKeyValue("population.attributetable", attributeTable))
 		)
 		abortWithMessage(r.getErrorString());
 
@@ -43,8 +50,10 @@ bool_t configure(ConfigSettings &config, SimpactPopulationConfig &populationConf
 	populationConfig.setInitialWomen(numWomen);
 	populationConfig.setEyeCapsFraction(eyecapFraction);
 	populationConfig.setMSM(msm);
+	populationConfig.setParallelInitialization(parallelInit);
+	populationConfig.setUseAttributeTable(attributeTable);
 
-	if (!(r = ageDist.load(ageDistFile)))
+	if (!(r = ageDist.load(ageDistFile, ageDistSampler)))
 	{
 		cerr << "Can't load age distribution data: " << r.getErrorString() << endl;
 		return false;
@@ -66,7 +75,7 @@ bool_t configure(ConfigSettings &config, SimpactPopulationConfig &populationConf
 	
 	// Sanity check on configuration parameters
 	cerr << "# Performing extra check on read configuration parameters" << endl;
-	checkConfiguration(config, populationConfig, tMax, maxEvents);
+	checkConfiguration(config, populationConfig, ageDist, tMax, maxEvents);
 
 	ConfigSettingsLog::addConfigSettings(0, config);
 
@@ -150,8 +159,8 @@ bool areValuesCompatible(const string &key, const std::string &A, const std::str
 	return true;
 }
 
-void checkConfiguration(const ConfigSettings &loadedConfig, const SimpactPopulationConfig &populationConfig, double tMax,
-		        int64_t maxEvents)
+void checkConfiguration(const ConfigSettings &loadedConfig, const SimpactPopulationConfig &populationConfig,
+		        const PopulationDistributionCSV &ageDist, double tMax, int64_t maxEvents)
 {
 	ConfigWriter config;
 	bool_t r;
@@ -163,10 +172,13 @@ void checkConfiguration(const ConfigSettings &loadedConfig, const SimpactPopulat
 	if (!(r = config.addKey("population.nummen", populationConfig.getInitialMen())) ||
 	    !(r = config.addKey("population.numwomen", populationConfig.getInitialWomen())) ||
 	    !(r = config.addKey("population.agedistfile", "IGNORE")) || // not going to check file contents
+	    !(r = config.addKey("population.agedistsampler", DiscreteDistributionAlias::getSamplerName(ageDist.getSampler()))) ||
 	    !(r = config.addKey("population.simtime", tMax)) ||
 	    !(r = config.addKey("population.maxevents", maxEvents)) ||
 	    !(r = config.addKey("population.eyecap.fraction", populationConfig.getEyeCapsFraction())) ||
-		!(r = config.addKey("population.msm", populationConfig.getMSM()))
+		!(r = config.addKey("population.msm", populationConfig.getMSM())) ||
+		!(r = config.addKey("population.parallelinit", populationConfig.getParallelInitialization())) ||
+		!(r = config.addKey("population.attributetable", populationConfig.getUseAttributeTable()))
 		)
 		abortWithMessage(r.getErrorString());
 
@@ -11,6 +11,7 @@
 #include "eventconception.h"
 #include "jsonconfig.h"
 #include "configfunctions.h"
+#include "gslrandomnumbergenerator.h"
 #include "util.h"
 #include <cmath>
 #include <algorithm>
@@ -21,7 +22,9 @@ using namespace std;
 EventFormation::EventFormation(Person *pPerson1, Person *pPerson2, double lastDissTime, double formationScheduleTime) 
 	: SimpactEvent(pPerson1, pPerson2),
 	  m_lastDissolutionTime(lastDissTime),
-	  m_formationScheduleTime(formationScheduleTime)
+	  m_formationScheduleTime(formationScheduleTime),
+	  m_thinningValue(-1),
+	  m_thinningStart(-1)
 {
 	assert(pPerson1->isMan());
 	assert(pPerson1 != pPerson2); // Never form a relationship with ourselves
@@ -168,11 +171,22 @@ void EventFormation::fire(Algorithm *pAlgorithm, State *pState, double t)
 	}
 }
 
-double EventFormation::calculateInternalTimeInterval(const State *pState, double t0, double dt)
+EvtHazard *EventFormation::getEventHazard() const
 {
 	Person *pPerson2 = getPerson(1);
 	EvtHazard *pHazard = (pPerson2->isWoman()) ? m_pHazard : m_pHazardMSM; 
 	assert(pHazard != 0);
+	return pHazard;
+}
+
+double EventFormation::calculateInternalTimeInterval(const State *pState, double t0, double dt)
+{
+	EvtHazard *pHazard = getEventHazard();
+
+	// With thinning, the bound that follows from the hazard at the last
+	// recalculation is used; the state hasn't changed since then
+	if (m_thinningValue > 0)
+		return pHazard->calculateBoundInternalTimeInterval(*this, m_thinningValue, m_thinningStart, t0, dt);
 
 	const SimpactPopulation &population = SIMPACTPOPULATION(pState);
 	return pHazard->calculateInternalTimeInterval(population, *this, t0, dt);
@@ -180,16 +194,56 @@ double EventFormation::calculateInternalTimeInterval(const State *pState, double
 
 double EventFormation::solveForRealTimeInterval(const State *pState, double Tdiff, double t0)
 {
-	Person *pPerson2 = getPerson(1);
-	EvtHazard *pHazard = (pPerson2->isWoman()) ? m_pHazard : m_pHazardMSM; 
-	assert(pHazard != 0);
-
+	EvtHazard *pHazard = getEventHazard();
 	const SimpactPopulation &population = SIMPACTPOPULATION(pState);
+
+	// The bound is only refreshed when the event time really needs to be
+	// recalculated, not when this is called to check the inverse mapping
+	if (needsEventTimeCalculation())
+	{
+		m_thinningValue = (pHazard->isThinningEnabled()) ? pHazard->getThinningStartValue(population, *this, t0) : -1;
+		m_thinningStart = t0;
+	}
+
+	if (m_thinningValue > 0)
+		return pHazard->solveBoundRealTimeInterval(*this, m_thinningValue, m_thinningStart, Tdiff, t0);
+
 	return pHazard->solveForRealTimeInterval(population, *this, Tdiff, t0);
 }
 
+bool EventFormation::isCandidateAccepted(GslRandomNumberGenerator *pRndGen, const State *pState, double t)
+{
+	if (m_thinningValue <= 0) // the candidate time was obtained using the hazard itself
+		return true;
+
+	EvtHazard *pHazard = getEventHazard();
+	double p = pHazard->getAcceptanceProbability(*this, m_thinningValue, m_thinningStart, t);
+
+	return pRndGen->pickRandomDouble() < p;
+}
+
+EventBatchSolver *EventFormation::getBatchSolver(const State *pState)
+{
+	EvtHazard *pHazard = getEventHazard();
+	const SimpactPopulation &population = SIMPACTPOPULATION(pState);
+
+	if (pHazard->isThinningEnabled() || !population.getAttributeTable().isEnabled())
+		return 0;
+
+	return pHazard->getBatchSolver();
+}
+
+// The batch solver uses the normal mapping, as in solveForRealTimeInterval
+// without a bound
+void EventFormation::onBatchRealTimeInterval()
+{
+	m_thinningValue = -1;
+}
+
 EvtHazard *EventFormation::m_pHazard = 0;
 EvtHazard *EventFormation::m_pHazardMSM = 0;
+int EventFormation::s_hazardGeneration = 0;
+bool EventFormation::s_hazardCacheEnabled = true;
 
 EvtHazard *EventFormation::getHazard(ConfigSettings &config, const string &prefix, bool msm)
 {
@@ -222,6 +276,10 @@ EvtHazard *EventFormation::getHazard(ConfigSettings &config, const string &prefi
 
 void EventFormation::processConfig(ConfigSettings &config, GslRandomNumberGenerator *pRndGen)
 {
+	// This is also called when an intervention is executed, in which case
+	// the hazard parameters or the debut age may have changed
+	s_hazardGeneration++;
+
 	delete m_pHazard;
 	m_pHazard = getHazard(config, "formation.hazard", false);
 
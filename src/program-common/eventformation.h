@@ -3,6 +3,7 @@
 #define EVENTFORMATION_H
 
 #include "simpactevent.h"
+#include "hazardfunctionformationagegap.h"
 
 class ConfigSettings;
 class EvtHazard;
@@ -22,6 +23,39 @@ public:
 
 	double getLastDissolutionTime() const								{ return m_lastDissolutionTime; }
 
+	// Terms of the formation hazards that only depend on the pair of persons
+	// and on the hazard parameters, and that all formation hazards use: the
+	// constant term a0, the reference time tr and the time tMax at which the
+	// hazard becomes constant. The hazard fills these in when they're first
+	// needed, and only needs to recalculate them if the configuration was
+	// changed (by an intervention), if the population size was synchronized
+	// or if one of the persons relocated. Since each of these increases a
+	// counter, it's enough to store the sum of these counters. The hazard
+	// calculations for a single event are never done by two threads at the
+	// same time, so it's safe for a hazard to refresh this while it only has
+	// a const reference to the event.
+	class HazardCache
+	{
+	public:
+		HazardCache() : m_stamp(-1) { }
+
+		bool isValid(const SimpactPopulation &population, const Person *pPerson1, const Person *pPerson2) const;
+		void setValid(const SimpactPopulation &population, const Person *pPerson1, const Person *pPerson2);
+
+		double m_a0, m_tr, m_tMax;
+	private:
+		static int getStamp(const SimpactPopulation &population, const Person *pPerson1, const Person *pPerson2);
+
+		int m_stamp;
+	};
+
+	const HazardCache &getHazardCache() const							{ return m_hazardCache; }
+	HazardCache &getHazardCache()										{ return m_hazardCache; }
+
+	// Mainly to be able to benchmark the hazards with and without the cache
+	static void setHazardCacheEnabled(bool f)							{ s_hazardCacheEnabled = f; }
+	static bool isHazardCacheEnabled()									{ return s_hazardCacheEnabled; }
+
 	static void processConfig(ConfigSettings &config, GslRandomNumberGenerator *pRndGen);
 	static void obtainConfig(ConfigWriter &config);
 protected:
@@ -29,14 +63,38 @@ protected:
 
 	double calculateInternalTimeInterval(const State *pState, double t0, double dt);
 	double solveForRealTimeInterval(const State *pState, double Tdiff, double t0);
+	bool isCandidateAccepted(GslRandomNumberGenerator *pRndGen, const State *pState, double t) override;
+	EventBatchSolver *getBatchSolver(const State *pState) override;
+	void onBatchRealTimeInterval() override;
 	bool isUseless(const PopulationStateInterface &population) override;
+	EvtHazard *getEventHazard() const;
 
 	const double m_lastDissolutionTime;
 	const double m_formationScheduleTime;
+	HazardCache m_hazardCache;
+	double m_thinningValue; // hazard at m_thinningStart, negative if the normal mapping was used at the last recalculation
+	double m_thinningStart;
 
 	static EvtHazard *m_pHazard;
 	static EvtHazard *m_pHazardMSM;
+	static int s_hazardGeneration;
+	static bool s_hazardCacheEnabled;
 };
 
+inline int EventFormation::HazardCache::getStamp(const SimpactPopulation &population, const Person *pPerson1, const Person *pPerson2)
+{
+	return s_hazardGeneration + population.getPopulationSizeVersion() + pPerson1->getLocationVersion() + pPerson2->getLocationVersion();
+}
+
+inline bool EventFormation::HazardCache::isValid(const SimpactPopulation &population, const Person *pPerson1, const Person *pPerson2) const
+{
+	return s_hazardCacheEnabled && m_stamp == getStamp(population, pPerson1, pPerson2);
+}
+
+inline void EventFormation::HazardCache::setValid(const SimpactPopulation &population, const Person *pPerson1, const Person *pPerson2)
+{
+	m_stamp = getStamp(population, pPerson1, pPerson2);
+}
+
 #endif // EVENTFORMATION_H
 
@@ -16,6 +16,9 @@ public:
 	void writeLogs(const SimpactPopulation &pop, double tNow) const;
 
 	void fire(Algorithm *pAlgorithm, State *pState, double t);
+
+	// The fire time is set when the event is created
+	bool hasFixedFireTime() const														{ return true; }
 	
 	static void processConfig(ConfigSettings &config, GslRandomNumberGenerator *pRndGen);
 	static void obtainConfig(ConfigWriter &config);
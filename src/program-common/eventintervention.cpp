@@ -5,6 +5,7 @@
 #include "jsonconfig.h"
 #include "configfunctions.h"
 #include "configsettingslog.h"
+#include "eventtracer.h"
 #include <iostream>
 
 using namespace std;
@@ -54,8 +55,12 @@ void EventIntervention::fire(Algorithm *pAlgorithm, State *pState, double t)
 	GslRandomNumberGenerator *pRndGen = population.getRandomNumberGenerator();
 	
 	// Re-read the configurations, excluding the ones in the "initonce" category
-	vector<string> excludes { "initonce", "__first__" };
-	ConfigFunctions::processConfigurations(interventionConfig, pRndGen, excludes);
+	{
+		TraceSpan span("intervention", true);
+
+		vector<string> excludes { "initonce", "__first__" };
+		ConfigFunctions::processConfigurations(interventionConfig, pRndGen, excludes);
+	}
 
 	ConfigSettingsLog::addConfigSettings(t, interventionConfig);
 
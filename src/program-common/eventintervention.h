@@ -16,6 +16,9 @@ public:
 	void writeLogs(const SimpactPopulation &pop, double tNow) const;
 
 	void fire(Algorithm *pAlgorithm, State *pState, double t);
+
+	// The fire time is set when the event is created
+	bool hasFixedFireTime() const														{ return true; }
 	
 	// We don't know which parameters are going to change in a very general
 	// intervention event, so everyone must be assumed to be (possibly) affected
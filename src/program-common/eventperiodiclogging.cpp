@@ -40,19 +40,24 @@ void EventPeriodicLogging::fire(Algorithm *pAlgorithm, State *pState, double t)
 {
 	SimpactPopulation &population = SIMPACTPOPULATION(pState);
 
-	// Count number of people currently in treatment
-	Person **ppPeople = population.getAllPeople();
+	// The number of people currently in treatment is kept up to date in
+	// the population's aggregates
 	int numPeople = population.getNumberOfPeople();
+	int inTreatmentCount = population.getAggregates().getNumberOnTreatment();
 
-	int inTreatmentCount = 0;
+#ifndef NDEBUG
+	Person **ppPeople = population.getAllPeople();
+	int checkCount = 0;
 	for (int i = 0 ; i < numPeople ; i++)
 	{
 		Person *pPerson = ppPeople[i];
 		assert(pPerson);
 
 		if (pPerson->hiv().isInfected() && pPerson->hiv().hasLoweredViralLoad())
-			inTreatmentCount++;
+			checkCount++;
 	}
+	assert(checkCount == inTreatmentCount);
+#endif // NDEBUG
 
 	s_logFile.print("%10.10f,%d,%d", t, numPeople, inTreatmentCount);
 
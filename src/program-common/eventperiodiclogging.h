@@ -20,6 +20,9 @@ public:
 
 	void fire(Algorithm *pAlgorithm, State *pState, double t);
 
+	// The fire time is set when the event is created
+	bool hasFixedFireTime() const														{ return true; }
+
 	static void processConfig(ConfigSettings &config, GslRandomNumberGenerator *pRndGen);
 	static void obtainConfig(ConfigWriter &config);
 
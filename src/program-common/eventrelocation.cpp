@@ -5,6 +5,7 @@
 #include "hazardfunctionexp.h"
 #include "util.h"
 #include <iostream>
+#include <cmath>
 
 using namespace std;
 
@@ -61,6 +62,10 @@ void EventRelocation::fire(Algorithm *pAlgorithm, State *pState, double t)
 double EventRelocation::calculateInternalTimeInterval(const State *pState, double t0, double dt)
 {
 	Person *pPerson = getPerson(0);
+
+	if (s_tabulated)
+		return s_tabulatedHazard.calculateInternalTimeInterval(t0 - pPerson->getDateOfBirth(), dt);
+
 	double tMax = getTMax(pPerson);
 
 	HazardFunctionRelocation h0(pPerson);
@@ -72,6 +77,10 @@ double EventRelocation::calculateInternalTimeInterval(const State *pState, doubl
 double EventRelocation::solveForRealTimeInterval(const State *pState, double Tdiff, double t0)
 {
 	Person *pPerson = getPerson(0);
+
+	if (s_tabulated)
+		return s_tabulatedHazard.solveForRealTimeInterval(t0 - pPerson->getDateOfBirth(), Tdiff);
+
 	double tMax = getTMax(pPerson);
 
 	HazardFunctionRelocation h0(pPerson);
@@ -82,6 +91,8 @@ double EventRelocation::solveForRealTimeInterval(const State *pState, double Tdi
 
 bool EventRelocation::s_enabled = false;
 double EventRelocation::s_tMax = 200;
+bool EventRelocation::s_tabulated = false;
+TabulatedHazardFunction EventRelocation::s_tabulatedHazard;
 
 double EventRelocation::HazardFunctionRelocation::s_a = 0;
 double EventRelocation::HazardFunctionRelocation::s_b = 0;
@@ -97,9 +108,13 @@ void EventRelocation::processConfig(ConfigSettings &config, GslRandomNumberGener
 	{
 		if (!(r = config.getKeyValue("relocation.hazard.a", HazardFunctionRelocation::s_a)) ||
 			!(r = config.getKeyValue("relocation.hazard.b", HazardFunctionRelocation::s_b)) ||
-			!(r = config.getKeyValue("relocation.hazard.t_max", s_tMax))
+			!(r = config.getKeyValue("relocation.hazard.t_max", s_tMax)) ||
+			!(r = config.getKeyValue("relocation.hazard.tabulated", s_tabulated))
 			)
 			abortWithMessage(r.getErrorString());
+
+		if (s_tabulated)
+			buildTabulatedHazard();
 	}
 }
 
@@ -114,7 +129,8 @@ void EventRelocation::obtainConfig(ConfigWriter &config)
 	{
 		if (!(r = config.addKey("relocation.hazard.a", HazardFunctionRelocation::s_a)) ||
 			!(r = config.addKey("relocation.hazard.b", HazardFunctionRelocation::s_b)) ||
-			!(r = config.addKey("relocation.hazard.t_max", s_tMax)) 
+			!(r = config.addKey("relocation.hazard.t_max", s_tMax)) ||
+			!(r = config.addKey("relocation.hazard.tabulated", s_tabulated))
 		    )
 			abortWithMessage(r.getErrorString());
 	}
@@ -132,6 +148,45 @@ double EventRelocation::getTMax(const Person *pPerson)
 	return tMax;
 }
 
+// Tabulates exp(a + b*age) on the age interval [0, t_max], after which the
+// hazard stays constant in the same way as in the analytic TimeLimitedHazardFunction
+// version. Because the tabulated hazard is of the exponential form on each
+// segment, the time mappings should be the same up to rounding errors; this is
+// checked on a fixed grid of ages and intervals, so that the random number
+// generator is not affected.
+void EventRelocation::buildTabulatedHazard()
+{
+	if (s_tMax <= 0)
+		abortWithMessage("EventRelocation: relocation.hazard.t_max must be positive when the hazard is tabulated");
+
+	HazardFunctionExp h0(HazardFunctionRelocation::s_a, HazardFunctionRelocation::s_b);
+	TimeLimitedHazardFunction h(h0, s_tMax);
+
+	s_tabulatedHazard.build(h0, 0, s_tMax);
+
+	const int numAges = 50;
+	const int numIntervals = 20;
+	const double tol = 1e-8;
+
+	for (int i = 0 ; i < numAges ; i++)
+	{
+		double age0 = (1.2*s_tMax*(double)i)/(double)numAges;
+
+		for (int j = 1 ; j <= numIntervals ; j++)
+		{
+			double dt = (0.5*s_tMax*(double)j)/(double)numIntervals;
+			double Tdiff = h.calculateInternalTimeInterval(age0, dt);
+			double TdiffTab = s_tabulatedHazard.calculateInternalTimeInterval(age0, dt);
+			double dtTab = s_tabulatedHazard.solveForRealTimeInterval(age0, Tdiff);
+
+			if (!(std::abs(TdiffTab - Tdiff) <= tol*Tdiff) || !(std::abs(dtTab - dt) <= tol*dt))
+				abortWithMessage(strprintf("EventRelocation: tabulated hazard differs from the analytic one for age %g and interval %g "
+				                           "(internal interval %g instead of %g, real interval %g instead of %g)",
+							   age0, dt, TdiffTab, Tdiff, dtTab, dt));
+		}
+	}
+}
+
 EventRelocation::HazardFunctionRelocation::HazardFunctionRelocation(const Person *pPerson)
 	: HazardFunctionExp(getA(pPerson), s_b)
 {
@@ -162,7 +217,8 @@ JSONConfig relocationJSONConfig(R"JSON(
 			"params": [ 
 						[ "relocation.hazard.a", null ],
 						[ "relocation.hazard.b", null ],
-						[ "relocation.hazard.t_max", 200 ]
+						[ "relocation.hazard.t_max", 200 ],
+						[ "relocation.hazard.tabulated", "no" ]
 			],
 			"info": [
 				"TODO"
@@ -4,6 +4,7 @@
 
 #include "simpactevent.h"
 #include "hazardfunctionexp.h"
+#include "tabulatedhazardfunction.h"
 
 class ConfigSettings;
 
@@ -30,6 +31,7 @@ private:
 	double calculateInternalTimeInterval(const State *pState, double t0, double dt);
 	double solveForRealTimeInterval(const State *pState, double Tdiff, double t0);
 	static double getTMax(const Person *pPerson);
+	static void buildTabulatedHazard();
 
 	class HazardFunctionRelocation : public HazardFunctionExp
 	{
@@ -43,6 +45,11 @@ private:
 
 	static bool s_enabled;
 	static double s_tMax;
+
+	// If enabled, the hazard as a function of the age of the person is tabulated
+	// once and shared by all relocation events, instead of using the analytic form
+	static bool s_tabulated;
+	static TabulatedHazardFunction s_tabulatedHazard;
 };
 
 #endif // EVENTRELOCATION_H
@@ -15,6 +15,9 @@ public:
 
 	void fire(Algorithm *pAlgorithm, State *pState, double t);
 
+	// The fire time is set when the event is created
+	bool hasFixedFireTime() const														{ return true; }
+
 	// Everything needs to be recalculated after this
 	bool isEveryoneAffected() const														{ return true; }
 
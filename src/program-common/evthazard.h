@@ -7,6 +7,7 @@
 class SimpactPopulation;
 class SimpactEvent;
 class ConfigWriter;
+class EventBatchSolver;
 
 // WARNING: the same instance can be called from multiple threads
 class EvtHazard
@@ -23,6 +24,26 @@ public:
 			                        const SimpactEvent &evt, double Tdiff, double t0) = 0;
 
 	virtual void obtainConfig(ConfigWriter &config, const std::string &prefix) = 0;
+
+	// A hazard can allow its event to sample the fire times by thinning. When the
+	// event time is recalculated at t0, getThinningStartValue returns the value h0
+	// of the hazard at t0, or a negative value if thinning isn't useful at that
+	// time, in which case the normal mapping is used until the next recalculation.
+	// As long as the state stays the same, the internal time is then mapped using
+	// an upper bound for the hazard that only depends on h0, t0 and the persons of
+	// the event, and a candidate fire time t is accepted with the probability that
+	// getAcceptanceProbability returns. The tStart arguments are the times at
+	// which the h0 values were obtained.
+	virtual bool isThinningEnabled() const																{ return false; }
+	virtual double getThinningStartValue(const SimpactPopulation &population, const SimpactEvent &evt, double t0)	{ return -1; }
+	virtual double calculateBoundInternalTimeInterval(const SimpactEvent &evt, double h0, double tStart, double t0, double dt)	{ return -1; }
+	virtual double solveBoundRealTimeInterval(const SimpactEvent &evt, double h0, double tStart, double Tdiff, double t0)		{ return -1; }
+	virtual double getAcceptanceProbability(const SimpactEvent &evt, double h0, double tStart, double t)						{ return 1; }
+
+	// A hazard that can calculate the fire times of several of its events at once,
+	// using the population's PersonAttributeTable, can return the solver for this
+	// here. It's only used if thinning is not enabled and the table is enabled.
+	virtual EventBatchSolver *getBatchSolver()															{ return 0; }
 private:
 	const std::string m_name;
 };
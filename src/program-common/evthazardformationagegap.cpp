@@ -40,17 +40,12 @@ EvtHazardFormationAgeGap::~EvtHazardFormationAgeGap()
 {
 }
 
-double EvtHazardFormationAgeGap::getTMax(Person *pPerson1, Person *pPerson2)
+double EvtHazardFormationAgeGap::getTMax(double tBi, double tBj) const
 {
-	assert(pPerson1 != 0 && pPerson2 != 0);
+	double tMax = tBi;
 
-	double tb1 = pPerson1->getDateOfBirth();
-	double tb2 = pPerson2->getDateOfBirth();
-
-	double tMax = tb1;
-
-	if (tb2 < tMax)
-		tMax = tb2;
+	if (tBj < tMax)
+		tMax = tBj;
 
 	assert(m_tMax > 0);
 	tMax += m_tMax;
@@ -63,18 +58,16 @@ double EvtHazardFormationAgeGap::calculateInternalTimeInterval(const SimpactPopu
 {
 	Person *pPerson1 = event.getPerson(0);
 	Person *pPerson2 = event.getPerson(1);
+	const EventFormation::HazardCache &cache = getPairCache(population, event, t0);
+	double Pi, Pj, tBi, tBj, Dpi, Dpj;
+	FormationAgeGapPairTerms pairTerms;
 
-	double tMax = getTMax(pPerson1, pPerson2);
-
-	const EventFormation &eventFormation = static_cast<const EventFormation &>(event);
-	double lastDissTime = eventFormation.getLastDissolutionTime();
+	Person::getFormationPairValues(pPerson1, pPerson2, m_msm, Pi, Pj, tBi, tBj, Dpi, Dpj);
+	HazardFunctionFormationAgeGap::getPairTerms(tBi, tBj, Dpi, Dpj, m_a8, m_a10, m_msm, pairTerms);
 
-	double a0 = getA0(population, pPerson1, pPerson2);
-	double tr = getTr(population, pPerson1, pPerson2, t0, lastDissTime);
-
-	// Note: we need to use a0 here, not m_a0
-	HazardFunctionFormationAgeGap h0(pPerson1, pPerson2, tr, a0, m_a1, m_a2, m_a3, m_a4, m_a5, m_a8, m_a9, m_a10, m_b, m_msm);
-	TimeLimitedHazardFunction h(h0, tMax);
+	// Note: we need to use the cached a0 here, not m_a0
+	HazardFunctionFormationAgeGap h0(pPerson1, pPerson2, pairTerms, Pi, Pj, cache.m_tr, cache.m_a0, m_a1, m_a2, m_a3, m_a4, m_a5, m_a8, m_a9, m_a10, m_b, m_msm);
+	TimeLimitedHazardFunction h(h0, cache.m_tMax);
 
 	return h.calculateInternalTimeInterval(t0, dt);
 }
@@ -84,53 +77,137 @@ double EvtHazardFormationAgeGap::solveForRealTimeInterval(const SimpactPopulatio
 {
 	Person *pPerson1 = event.getPerson(0);
 	Person *pPerson2 = event.getPerson(1);
+	const EventFormation::HazardCache &cache = getPairCache(population, event, t0);
+	double Pi, Pj, tBi, tBj, Dpi, Dpj;
+	FormationAgeGapPairTerms pairTerms;
 
-	double tMax = getTMax(pPerson1, pPerson2);
-
-	const EventFormation &eventFormation = static_cast<const EventFormation &>(event);
-	double lastDissTime = eventFormation.getLastDissolutionTime();
-
-	double a0 = getA0(population, pPerson1, pPerson2);
-	double tr = getTr(population, pPerson1, pPerson2, t0, lastDissTime);
+	Person::getFormationPairValues(pPerson1, pPerson2, m_msm, Pi, Pj, tBi, tBj, Dpi, Dpj);
+	HazardFunctionFormationAgeGap::getPairTerms(tBi, tBj, Dpi, Dpj, m_a8, m_a10, m_msm, pairTerms);
 
-	// Note: we need to use a0 here, not m_a0
-	HazardFunctionFormationAgeGap h0(pPerson1, pPerson2, tr, a0, m_a1, m_a2, m_a3, m_a4, m_a5, m_a8, m_a9, m_a10, m_b, m_msm);
-	TimeLimitedHazardFunction h(h0, tMax);
+	// Note: we need to use the cached a0 here, not m_a0
+	HazardFunctionFormationAgeGap h0(pPerson1, pPerson2, pairTerms, Pi, Pj, cache.m_tr, cache.m_a0, m_a1, m_a2, m_a3, m_a4, m_a5, m_a8, m_a9, m_a10, m_b, m_msm);
+	TimeLimitedHazardFunction h(h0, cache.m_tMax);
 
 	return h.solveForRealTimeInterval(t0, Tdiff);
 }
 
-double EvtHazardFormationAgeGap::getA0(const SimpactPopulation &population, Person *pPerson1, Person *pPerson2)
+// This does the same as solveForRealTimeInterval for each event, but the person
+// attributes are gathered from the attribute table for a block of events first,
+// and the pair terms are calculated in a separate loop over this block. The
+// per-event hazard cache is not used here, since other threads may be examining
+// the same events.
+void EvtHazardFormationAgeGap::solveForRealTimeIntervals(const State *pState, EventBase * const *ppEvents, 
+                                                         const double *pTdiff, int num, double t0, double *pDt)
 {
-	double lastPopSizeTime = 0;
-	double n = population.getLastKnownPopulationSize(lastPopSizeTime);
-	double a0i, a0j;
-	
-	if (m_msm)
+	const int blockSize = 64;
+	const SimpactPopulation &population = SIMPACTPOPULATION(pState);
+	const PersonAttributeTable &table = population.getAttributeTable();
+	const double populationTerm = getPopulationTerm(population);
+
+	assert(table.isEnabled());
+
+	double Pi[blockSize], Pj[blockSize], tBi[blockSize], tBj[blockSize], Dpi[blockSize], Dpj[blockSize];
+	double a0i[blockSize], a0j[blockSize], distance[blockSize], lastDissTime[blockSize];
+	FormationAgeGapPairTerms pairTerms[blockSize];
+	double a0[blockSize], tr[blockSize], tMax[blockSize];
+
+	for (int offset = 0 ; offset < num ; offset += blockSize)
 	{
-		a0i = pPerson1->getFormationEagernessParameterMSM();
-		a0j = pPerson2->getFormationEagernessParameterMSM();
+		const int n = std::min(blockSize, num - offset);
+		EventBase * const *ppBlock = ppEvents + offset;
+
+		for (int i = 0 ; i < n ; i++)
+		{
+			const EventFormation *pEvt = static_cast<const EventFormation *>(ppBlock[i]);
+			Person *pPerson1 = pEvt->getPerson(0);
+			Person *pPerson2 = pEvt->getPerson(1);
+			const int slot1 = pPerson1->getAttributeSlot();
+			const int slot2 = pPerson2->getAttributeSlot();
+
+			assert(pPerson1->getAttributeTable() == &table && pPerson2->getAttributeTable() == &table);
+
+			table.getFormationPairValues(slot1, slot2, m_msm, Pi[i], Pj[i], tBi[i], tBj[i], Dpi[i], Dpj[i]);
+			table.getFormationPairEagerness(slot1, slot2, m_msm, a0i[i], a0j[i]);
+			distance[i] = pPerson1->getDistanceTo(pPerson2);
+			lastDissTime[i] = pEvt->getLastDissolutionTime();
+		}
+
+		for (int i = 0 ; i < n ; i++)
+		{
+			a0[i] = getA0Base(a0i[i], a0j[i], distance[i]) - populationTerm;
+			tr[i] = getTr(tBi[i], tBj[i], t0, lastDissTime[i]);
+			tMax[i] = getTMax(tBi[i], tBj[i]);
+			HazardFunctionFormationAgeGap::getPairTerms(tBi[i], tBj[i], Dpi[i], Dpj[i], m_a8, m_a10, m_msm, pairTerms[i]);
+		}
+
+		for (int i = 0 ; i < n ; i++)
+		{
+			const EventFormation *pEvt = static_cast<const EventFormation *>(ppBlock[i]);
+
+			HazardFunctionFormationAgeGap h0(pEvt->getPerson(0), pEvt->getPerson(1), pairTerms[i], Pi[i], Pj[i], 
+			                                 tr[i], a0[i], m_a1, m_a2, m_a3, m_a4, m_a5, m_a8, m_a9, m_a10, m_b, m_msm);
+			TimeLimitedHazardFunction h(h0, tMax[i]);
+
+			pDt[offset + i] = h.solveForRealTimeInterval(t0, pTdiff[offset + i]);
+		}
 	}
-	else
+}
+
+const EventFormation::HazardCache &EvtHazardFormationAgeGap::getPairCache(const SimpactPopulation &population, const SimpactEvent &event, double t0)
+{
+	// The cache of the event is refreshed here, see EventFormation::HazardCache
+	EventFormation &eventFormation = const_cast<EventFormation &>(static_cast<const EventFormation &>(event));
+	EventFormation::HazardCache &cache = eventFormation.getHazardCache();
+	Person *pPerson1 = event.getPerson(0);
+	Person *pPerson2 = event.getPerson(1);
+
+	if (!cache.isValid(population, pPerson1, pPerson2))
 	{
-		a0i = pPerson1->getFormationEagernessParameter();
-		a0j = pPerson2->getFormationEagernessParameter();
+		const double tBi = pPerson1->getDateOfBirth();
+		const double tBj = pPerson2->getDateOfBirth();
+
+		cache.m_a0 = getA0(population, pPerson1, pPerson2);
+		cache.m_tr = getTr(tBi, tBj, t0, eventFormation.getLastDissolutionTime());
+		cache.m_tMax = getTMax(tBi, tBj);
+		cache.setValid(population, pPerson1, pPerson2);
 	}
+
+	return cache;
+}
+
+double EvtHazardFormationAgeGap::getA0(const SimpactPopulation &population, Person *pPerson1, Person *pPerson2)
+{
+	double a0i, a0j;
+	
+	Person::getFormationPairEagerness(pPerson1, pPerson2, m_msm, a0i, a0j);
+
+	double a0_base = getA0Base(a0i, a0j, pPerson1->getDistanceTo(pPerson2));
+	double a0_total = a0_base - getPopulationTerm(population);
+	
+	return a0_total;
+}
+
+double EvtHazardFormationAgeGap::getA0Base(double a0i, double a0j, double distance) const
+{
 	double a0_base = m_a0 + (a0i + a0j)*m_a6 + std::abs(a0i-a0j)*m_a7;
-	a0_base += m_aDist * pPerson1->getDistanceTo(pPerson2);
+	a0_base += m_aDist * distance;
 
+	return a0_base;
+}
+
+double EvtHazardFormationAgeGap::getPopulationTerm(const SimpactPopulation &population)
+{
+	double lastPopSizeTime = 0;
+	double n = population.getLastKnownPopulationSize(lastPopSizeTime);
 	double eyeCapsFraction = population.getEyeCapsFraction();
+
 	// reduces to old code if eyeCapsFraction == 1
-	double a0_total = a0_base - std::log((n/2.0)*eyeCapsFraction); // log(x/(n/2)) = log(x) - log(n/2) = a0_base - log(n/2)
-	
-	return a0_total;
+	return std::log((n/2.0)*eyeCapsFraction); // log(x/(n/2)) = log(x) - log(n/2) = a0_base - log(n/2)
 }
 
-double EvtHazardFormationAgeGap::getTr(const SimpactPopulation &population, Person *pPerson1, Person *pPerson2, double t0, double lastDissTime)
+double EvtHazardFormationAgeGap::getTr(double tBi, double tBj, double t0, double lastDissTime) const
 {
 	double tr = lastDissTime;
-	double tBi = pPerson1->getDateOfBirth();
-	double tBj = pPerson2->getDateOfBirth();
 	
 	if (tr < 0) // did not have a relationship before, use 
 	{
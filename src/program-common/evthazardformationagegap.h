@@ -3,13 +3,16 @@
 #define EVTHAZARDFORMATIONAGEGAP_H
 
 #include "evthazard.h"
+#include "eventformation.h"
 
 class Person;
 class ConfigSettings;
 
 // WARNING: the same instance can be called from multiple threads
 
-class EvtHazardFormationAgeGap : public EvtHazard
+// This hazard can calculate the fire times of several formation events at
+// once, reading the person attributes from the population's attribute table.
+class EvtHazardFormationAgeGap : public EvtHazard, public EventBatchSolver
 {
 public:
 	EvtHazardFormationAgeGap(const std::string &hazName, bool msm,
@@ -23,12 +26,19 @@ public:
 	double solveForRealTimeInterval(const SimpactPopulation &population,
 			                const SimpactEvent &event, double Tdiff, double t0);
 
+	EventBatchSolver *getBatchSolver()																{ return this; }
+	void solveForRealTimeIntervals(const State *pState, EventBase * const *ppEvents, 
+	                               const double *pTdiff, int num, double t0, double *pDt);
+
 	static EvtHazard *processConfig(ConfigSettings &config, const std::string &prefix, const std::string &hazName, bool msm);
 	void obtainConfig(ConfigWriter &writer, const std::string &prefix);
 private:
+	const EventFormation::HazardCache &getPairCache(const SimpactPopulation &population, const SimpactEvent &event, double t0);
 	double getA0(const SimpactPopulation &population, Person *pPerson1, Person *pPerson2);
-	double getTr(const SimpactPopulation &population, Person *pPerson1, Person *pPerson2, double t0, double lastDissTime);
-	double getTMax(Person *pPerson1, Person *pPerson2);
+	double getA0Base(double a0i, double a0j, double distance) const;
+	static double getPopulationTerm(const SimpactPopulation &population);
+	double getTr(double tBi, double tBj, double t0, double lastDissTime) const;
+	double getTMax(double tBi, double tBj) const;
 
 	double m_a0;		// baseline_factor
 	double m_a1;		// male_current_relations_factor   -> just current_relations_factor ?
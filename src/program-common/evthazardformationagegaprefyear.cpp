@@ -3,8 +3,10 @@
 #include "eventdebut.h"
 #include "configsettings.h"
 #include "hazardfunctionformationagegaprefyear.h"
+#include "hazardfunctionexpbound.h"
 #include "jsonconfig.h"
 #include <algorithm>
+#include <cmath>
 
 using namespace std;
 
@@ -21,7 +23,7 @@ EvtHazardFormationAgeGapRefYear::EvtHazardFormationAgeGapRefYear(const string &h
 				   double agfwConst, double agfwExp, double agfwAge,
 				   double numRelScaleMan, double numRelScaleWoman,
 				   double b, double tMax,
-				   double maxAgeRefDiff) : EvtHazard(hazName)
+				   double maxAgeRefDiff, bool thinning) : EvtHazard(hazName)
 {
 	m_msm = msm;
 	m_a0 = a0;
@@ -48,6 +50,7 @@ EvtHazardFormationAgeGapRefYear::EvtHazardFormationAgeGapRefYear(const string &h
 	m_b = b;
 	m_tMax = tMax;
 	m_tMaxAgeRefDiff = maxAgeRefDiff;
+	m_thinning = thinning;
 }
 
 EvtHazardFormationAgeGapRefYear::~EvtHazardFormationAgeGapRefYear()
@@ -77,14 +80,7 @@ double EvtHazardFormationAgeGapRefYear::calculateInternalTimeInterval(const Simp
 {
 	Person *pPerson1 = event.getPerson(0);
 	Person *pPerson2 = event.getPerson(1);
-
-	double tMax = getTMax(pPerson1, pPerson2);
-
-	const EventFormation &eventFormation = static_cast<const EventFormation &>(event);
-	double lastDissTime = eventFormation.getLastDissolutionTime();
-
-	double a0 = getA0(population, pPerson1, pPerson2);
-	double tr = getTr(population, pPerson1, pPerson2, t0, lastDissTime);
+	const EventFormation::HazardCache &cache = getPairCache(population, event, t0);
 	double ageRefYear = population.getReferenceYear();
 
 	if (t0 - ageRefYear < -1e-8)
@@ -92,12 +88,12 @@ double EvtHazardFormationAgeGapRefYear::calculateInternalTimeInterval(const Simp
 	if (t0 - ageRefYear > m_tMaxAgeRefDiff+1e-8)
 		abortWithMessage("EvtHazardFormationAgeGapRefYear: t0 - ageRefYear exceeds maximum specified difference (1)");
 
-	// Note: we need to use a0 here, not m_a0
-	HazardFunctionFormationAgeGapRefYear h0(pPerson1, pPerson2, tr, a0, m_a1, m_a2, m_a3, m_a4, m_a8, m_a10, 
+	// Note: we need to use the cached a0 here, not m_a0
+	HazardFunctionFormationAgeGapRefYear h0(pPerson1, pPerson2, cache.m_tr, cache.m_a0, m_a1, m_a2, m_a3, m_a4, m_a8, m_a10, 
 			                                m_agfmConst, m_agfmExp, m_agfmAge, m_agfwConst, m_agfwExp, m_agfwAge,
 											m_numRelScaleMan, m_numRelScaleWoman,
 											m_b, ageRefYear, m_msm);
-	TimeLimitedHazardFunction h(h0, tMax);
+	TimeLimitedHazardFunction h(h0, cache.m_tMax);
 
 	return h.calculateInternalTimeInterval(t0, dt);
 }
@@ -107,47 +103,107 @@ double EvtHazardFormationAgeGapRefYear::solveForRealTimeInterval(const SimpactPo
 {
 	Person *pPerson1 = event.getPerson(0);
 	Person *pPerson2 = event.getPerson(1);
+	const EventFormation::HazardCache &cache = getPairCache(population, event, t0);
+	double ageRefYear = population.getReferenceYear();
+
+	if (t0 - ageRefYear < -1e-8)
+		abortWithMessage("EvtHazardFormationAgeGapRefYear: t0 is smaller than ageRefYear (2)");
+	if (t0 - ageRefYear > m_tMaxAgeRefDiff+1e-8)
+		abortWithMessage("EvtHazardFormationAgeGapRefYear: t0 - ageRefYear exceeds maximum specified difference (2)");
+
+	// Note: we need to use the cached a0 here, not m_a0
+	HazardFunctionFormationAgeGapRefYear h0(pPerson1, pPerson2, cache.m_tr, cache.m_a0, m_a1, m_a2, m_a3, m_a4, m_a8, m_a10, 
+			                                m_agfmConst, m_agfmExp, m_agfmAge, m_agfwConst, m_agfwExp, m_agfwAge,
+											m_numRelScaleMan, m_numRelScaleWoman,
+											m_b, ageRefYear, m_msm);
+	TimeLimitedHazardFunction h(h0, cache.m_tMax);
 
-	double tMax = getTMax(pPerson1, pPerson2);
+	return h.solveForRealTimeInterval(t0, Tdiff);
+}
 
-	const EventFormation &eventFormation = static_cast<const EventFormation &>(event);
-	double lastDissTime = eventFormation.getLastDissolutionTime();
+// Thinning is only used while the hazard exp(A+Bt) increases, with B = a4 + b.
+// Otherwise, the hazard is either constant or the exact mapping is closed-form
+// and cheap, since exp(A+Bt0) is a bound itself. Only A needs to be calculated
+// here, the bound itself only depends on the value h0 in t0 and on tMax, see
+// HazardFunctionExpBound.
+double EvtHazardFormationAgeGapRefYear::getThinningStartValue(const SimpactPopulation &population, const SimpactEvent &event, double t0)
+{
+	double B = m_a4 + m_b;
+	if (B <= 0)
+		return -1;
 
-	double a0 = getA0(population, pPerson1, pPerson2);
-	double tr = getTr(population, pPerson1, pPerson2, t0, lastDissTime);
+	Person *pPerson1 = event.getPerson(0);
+	Person *pPerson2 = event.getPerson(1);
+	const EventFormation::HazardCache &cache = getPairCache(population, event, t0);
 	double ageRefYear = population.getReferenceYear();
 
 	if (t0 - ageRefYear < -1e-8)
-		abortWithMessage("EvtHazardFormationAgeGapRefYear: t0 is smaller than ageRefYear (2)");
+		abortWithMessage("EvtHazardFormationAgeGapRefYear: t0 is smaller than ageRefYear (3)");
 	if (t0 - ageRefYear > m_tMaxAgeRefDiff+1e-8)
-		abortWithMessage("EvtHazardFormationAgeGapRefYear: t0 - ageRefYear exceeds maximum specified difference (2)");
+		abortWithMessage("EvtHazardFormationAgeGapRefYear: t0 - ageRefYear exceeds maximum specified difference (3)");
+
+	if (t0 >= cache.m_tMax) // the hazard has become constant
+		return -1;
 
-	// Note: we need to use a0 here, not m_a0
-	HazardFunctionFormationAgeGapRefYear h0(pPerson1, pPerson2, tr, a0, m_a1, m_a2, m_a3, m_a4, m_a8, m_a10, 
+	double A = HazardFunctionFormationAgeGapRefYear::getA(pPerson1, pPerson2, cache.m_tr, cache.m_a0, m_a1, m_a2, m_a3, m_a4, m_a8, m_a10, 
 			                                m_agfmConst, m_agfmExp, m_agfmAge, m_agfwConst, m_agfwExp, m_agfwAge,
 											m_numRelScaleMan, m_numRelScaleWoman,
 											m_b, ageRefYear, m_msm);
-	TimeLimitedHazardFunction h(h0, tMax);
+	double h0 = std::exp(A + B*t0);
+
+	// Can't use the bound if this over- or underflows, the normal mapping will
+	// then report the problem
+	if (!(h0 > 0) || std::isinf(h0))
+		return -1;
+
+	return h0;
+}
 
+double EvtHazardFormationAgeGapRefYear::calculateBoundInternalTimeInterval(const SimpactEvent &event, double h0, double tStart, double t0, double dt)
+{
+	HazardFunctionExpBound h(h0, tStart, m_a4 + m_b, getTMax(event.getPerson(0), event.getPerson(1)));
+	return h.calculateInternalTimeInterval(t0, dt);
+}
+
+double EvtHazardFormationAgeGapRefYear::solveBoundRealTimeInterval(const SimpactEvent &event, double h0, double tStart, double Tdiff, double t0)
+{
+	HazardFunctionExpBound h(h0, tStart, m_a4 + m_b, getTMax(event.getPerson(0), event.getPerson(1)));
 	return h.solveForRealTimeInterval(t0, Tdiff);
 }
 
+double EvtHazardFormationAgeGapRefYear::getAcceptanceProbability(const SimpactEvent &event, double h0, double tStart, double t)
+{
+	HazardFunctionExpBound h(h0, tStart, m_a4 + m_b, getTMax(event.getPerson(0), event.getPerson(1)));
+	return h.getAcceptanceProbability(t);
+}
+
+const EventFormation::HazardCache &EvtHazardFormationAgeGapRefYear::getPairCache(const SimpactPopulation &population, const SimpactEvent &event, double t0)
+{
+	// The cache of the event is refreshed here, see EventFormation::HazardCache
+	EventFormation &eventFormation = const_cast<EventFormation &>(static_cast<const EventFormation &>(event));
+	EventFormation::HazardCache &cache = eventFormation.getHazardCache();
+	Person *pPerson1 = event.getPerson(0);
+	Person *pPerson2 = event.getPerson(1);
+
+	if (!cache.isValid(population, pPerson1, pPerson2))
+	{
+		cache.m_a0 = getA0(population, pPerson1, pPerson2);
+		cache.m_tr = getTr(population, pPerson1, pPerson2, t0, eventFormation.getLastDissolutionTime());
+		cache.m_tMax = getTMax(pPerson1, pPerson2);
+		cache.setValid(population, pPerson1, pPerson2);
+	}
+
+	return cache;
+}
+
 double EvtHazardFormationAgeGapRefYear::getA0(const SimpactPopulation &population, Person *pPerson1, Person *pPerson2)
 {
 	double lastPopSizeTime = 0;
 	double n = population.getLastKnownPopulationSize(lastPopSizeTime);
 	double a0i, a0j;
 	
-	if (m_msm)
-	{
-		a0i = pPerson1->getFormationEagernessParameterMSM();
-		a0j = pPerson2->getFormationEagernessParameterMSM();
-	}
-	else
-	{
-		a0i = pPerson1->getFormationEagernessParameter();
-		a0j = pPerson2->getFormationEagernessParameter();
-	}
+	Person::getFormationPairEagerness(pPerson1, pPerson2, m_msm, a0i, a0j);
+
 	double a0_base = m_a0 + (a0i + a0j)*m_a6 + std::abs(a0i-a0j)*m_a7;
 	a0_base += m_aDist * pPerson1->getDistanceTo(pPerson2);
 
@@ -184,6 +240,7 @@ EvtHazard *EvtHazardFormationAgeGapRefYear::processConfig(ConfigSettings &config
 		   a8 = 0, a10 = 0, aDist = 0, b = 0, tMax = 0, tMaxAgeRefDiff = 0;
 	double agfmConst = 0, agfmExp = 0, agfmAge = 0, agfwConst = 0, agfwExp = 0, agfwAge = 0;
 	double numRelScaleMan = 0, numRelScaleWoman = 0;
+	bool thinning = false;
 	bool_t r;
 
 	if (!msm)
@@ -208,7 +265,8 @@ EvtHazard *EvtHazardFormationAgeGapRefYear::processConfig(ConfigSettings &config
 			!(r = config.getKeyValue(prefix + "." + hazName + ".distance", aDist)) ||
 			!(r = config.getKeyValue(prefix + "." + hazName + ".beta", b)) ||
 			!(r = config.getKeyValue(prefix + "." + hazName + ".t_max", tMax, 0)) ||
-			!(r = config.getKeyValue(prefix + "." + hazName + ".maxageref.diff", tMaxAgeRefDiff, 0))
+			!(r = config.getKeyValue(prefix + "." + hazName + ".maxageref.diff", tMaxAgeRefDiff, 0)) ||
+			!(r = config.getKeyValue(prefix + "." + hazName + ".thinning", thinning))
 			)
 			abortWithMessage(r.getErrorString());
 	}
@@ -228,7 +286,8 @@ EvtHazard *EvtHazardFormationAgeGapRefYear::processConfig(ConfigSettings &config
 			!(r = config.getKeyValue(prefix + "." + hazName + ".distance", aDist)) ||
 			!(r = config.getKeyValue(prefix + "." + hazName + ".beta", b)) ||
 			!(r = config.getKeyValue(prefix + "." + hazName + ".t_max", tMax, 0)) ||
-			!(r = config.getKeyValue(prefix + "." + hazName + ".maxageref.diff", tMaxAgeRefDiff, 0))
+			!(r = config.getKeyValue(prefix + "." + hazName + ".maxageref.diff", tMaxAgeRefDiff, 0)) ||
+			!(r = config.getKeyValue(prefix + "." + hazName + ".thinning", thinning))
 			)
 			abortWithMessage(r.getErrorString());
 
@@ -244,7 +303,7 @@ EvtHazard *EvtHazardFormationAgeGapRefYear::processConfig(ConfigSettings &config
 	return new EvtHazardFormationAgeGapRefYear(hazName, msm, a0,a1,a2,a3,a4,a6,a7,a8,a10,aDist,
 	                                           agfmConst, agfmExp, agfmAge, agfwConst, agfwExp, agfwAge,
 											   numRelScaleMan, numRelScaleWoman,
-			                                   b,tMax,tMaxAgeRefDiff);
+			                                   b,tMax,tMaxAgeRefDiff,thinning);
 }
 
 void EvtHazardFormationAgeGapRefYear::obtainConfig(ConfigWriter &config, const string &prefix)
@@ -275,7 +334,8 @@ void EvtHazardFormationAgeGapRefYear::obtainConfig(ConfigWriter &config, const s
 			!(r = config.addKey(prefix + "." + hazName + ".distance", m_aDist)) ||
 			!(r = config.addKey(prefix + "." + hazName + ".beta", m_b)) ||
 			!(r = config.addKey(prefix + "." + hazName + ".t_max", m_tMax)) ||
-			!(r = config.addKey(prefix + "." + hazName + ".maxageref.diff", m_tMaxAgeRefDiff))
+			!(r = config.addKey(prefix + "." + hazName + ".maxageref.diff", m_tMaxAgeRefDiff)) ||
+			!(r = config.addKey(prefix + "." + hazName + ".thinning", m_thinning))
 			)
 			abortWithMessage(r.getErrorString());
 	}
@@ -296,7 +356,8 @@ void EvtHazardFormationAgeGapRefYear::obtainConfig(ConfigWriter &config, const s
 			!(r = config.addKey(prefix + "." + hazName + ".distance", m_aDist)) ||
 			!(r = config.addKey(prefix + "." + hazName + ".beta", m_b)) ||
 			!(r = config.addKey(prefix + "." + hazName + ".t_max", m_tMax)) ||
-			!(r = config.addKey(prefix + "." + hazName + ".maxageref.diff", m_tMaxAgeRefDiff))
+			!(r = config.addKey(prefix + "." + hazName + ".maxageref.diff", m_tMaxAgeRefDiff)) ||
+			!(r = config.addKey(prefix + "." + hazName + ".thinning", m_thinning))
 			)
 			abortWithMessage(r.getErrorString());
 
@@ -334,7 +395,8 @@ JSONConfig agegapRefYearFormationJSONConfig(R"JSON(
                 ["formation.hazard.agegapry.distance", 0],
                 ["formation.hazard.agegapry.beta", 0],
                 ["formation.hazard.agegapry.t_max", 200],
-				["formation.hazard.agegapry.maxageref.diff", 1]
+				["formation.hazard.agegapry.maxageref.diff", 1],
+                ["formation.hazard.agegapry.thinning", "no"]
 			],
             "info": [ 
                 "These are the parameters for the hazard in the 'agegapry' formation event.",
@@ -361,7 +423,8 @@ JSONConfig agegapRefYearFormationMSMJSONConfig(R"JSON(
                 ["formationmsm.hazard.agegapry.distance", 0],
                 ["formationmsm.hazard.agegapry.beta", 0],
                 ["formationmsm.hazard.agegapry.t_max", 200],
-				["formationmsm.hazard.agegapry.maxageref.diff", 1]
+				["formationmsm.hazard.agegapry.maxageref.diff", 1],
+                ["formationmsm.hazard.agegapry.thinning", "no"]
 			],
             "info": [ 
                 "These are the parameters for the hazard in the 'agegapry' formation event.",
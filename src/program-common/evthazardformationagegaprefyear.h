@@ -3,6 +3,7 @@
 #define EVTHAZARDFORMATIONAGEGAPREFYEAR_H
 
 #include "evthazard.h"
+#include "eventformation.h"
 
 class Person;
 class ConfigSettings;
@@ -19,7 +20,7 @@ public:
 				   double agfwConst, double agfwExp, double agfwAge,
 				   double numRelScaleMan, double numRelScaleWoman,
 				   double b, double tMax,
-				   double maxRefYearDiff);
+				   double maxRefYearDiff, bool thinning);
 	~EvtHazardFormationAgeGapRefYear();
 
 	double calculateInternalTimeInterval(const SimpactPopulation &population, 
@@ -27,9 +28,16 @@ public:
 	double solveForRealTimeInterval(const SimpactPopulation &population,
 			                const SimpactEvent &event, double Tdiff, double t0);
 
+	bool isThinningEnabled() const															{ return m_thinning; }
+	double getThinningStartValue(const SimpactPopulation &population, const SimpactEvent &event, double t0);
+	double calculateBoundInternalTimeInterval(const SimpactEvent &event, double h0, double tStart, double t0, double dt);
+	double solveBoundRealTimeInterval(const SimpactEvent &event, double h0, double tStart, double Tdiff, double t0);
+	double getAcceptanceProbability(const SimpactEvent &event, double h0, double tStart, double t);
+
 	static EvtHazard *processConfig(ConfigSettings &config, const std::string &prefix, const std::string &hazName, bool msm);
 	void obtainConfig(ConfigWriter &writer, const std::string &prefix);
 private:
+	const EventFormation::HazardCache &getPairCache(const SimpactPopulation &population, const SimpactEvent &event, double t0);
 	double getA0(const SimpactPopulation &population, Person *pPerson1, Person *pPerson2);
 	double getTr(const SimpactPopulation &population, Person *pPerson1, Person *pPerson2, double t0, double lastDissTime);
 	double getTMax(Person *pPerson1, Person *pPerson2);
@@ -60,6 +68,7 @@ private:
 	double m_tMaxAgeRefDiff;
 
 	bool m_msm;
+	bool m_thinning;
 };
 
 #endif // EVTHAZARDFORMATIONAGEGAPREFYEAR_H
@@ -61,18 +61,11 @@ double EvtHazardFormationSimple::calculateInternalTimeInterval(const SimpactPopu
 {
 	Person *pPerson1 = event.getPerson(0);
 	Person *pPerson2 = event.getPerson(1);
+	const EventFormation::HazardCache &cache = getPairCache(population, event, t0);
 
-	double tMax = getTMax(pPerson1, pPerson2);
-
-	const EventFormation &eventFormation = static_cast<const EventFormation &>(event);
-	double lastDissTime = eventFormation.getLastDissolutionTime();
-
-	double a0 = getA0(population, pPerson1, pPerson2);
-	double tr = getTr(population, pPerson1, pPerson2, t0, lastDissTime);
-
-	// Note: we need to use a0 here, not m_a0
-	HazardFunctionFormationSimple h0(pPerson1, pPerson2, tr, a0, m_a1, m_a2, m_a3, m_a4, m_a5, m_Dp, m_b);
-	TimeLimitedHazardFunction h(h0, tMax);
+	// Note: we need to use the cached a0 here, not m_a0
+	HazardFunctionFormationSimple h0(pPerson1, pPerson2, cache.m_tr, cache.m_a0, m_a1, m_a2, m_a3, m_a4, m_a5, m_Dp, m_b);
+	TimeLimitedHazardFunction h(h0, cache.m_tMax);
 
 	return h.calculateInternalTimeInterval(t0, dt);
 
@@ -84,29 +77,41 @@ double EvtHazardFormationSimple::solveForRealTimeInterval(const SimpactPopulatio
 {
 	Person *pPerson1 = event.getPerson(0);
 	Person *pPerson2 = event.getPerson(1);
+	const EventFormation::HazardCache &cache = getPairCache(population, event, t0);
 
-	double tMax = getTMax(pPerson1, pPerson2);
+	// Note: we need to use the cached a0 here, not m_a0
+	HazardFunctionFormationSimple h0(pPerson1, pPerson2, cache.m_tr, cache.m_a0, m_a1, m_a2, m_a3, m_a4, m_a5, m_Dp, m_b);
+	TimeLimitedHazardFunction h(h0, cache.m_tMax);
 
-	const EventFormation &eventFormation = static_cast<const EventFormation &>(event);
-	double lastDissTime = eventFormation.getLastDissolutionTime();
+	return h.solveForRealTimeInterval(t0, Tdiff);
+	//return ExponentialHazardToRealTime(pPerson1, pPerson2, t0, Tdiff, tr, a0, m_a1, m_a2, m_a3, m_a4, m_a5, m_Dp, m_b, true, tMax);
+}
 
-	double a0 = getA0(population, pPerson1, pPerson2);
-	double tr = getTr(population, pPerson1, pPerson2, t0, lastDissTime);
+const EventFormation::HazardCache &EvtHazardFormationSimple::getPairCache(const SimpactPopulation &population, const SimpactEvent &event, double t0)
+{
+	// The cache of the event is refreshed here, see EventFormation::HazardCache
+	EventFormation &eventFormation = const_cast<EventFormation &>(static_cast<const EventFormation &>(event));
+	EventFormation::HazardCache &cache = eventFormation.getHazardCache();
+	Person *pPerson1 = event.getPerson(0);
+	Person *pPerson2 = event.getPerson(1);
 
-	// Note: we need to use a0 here, not m_a0
-	HazardFunctionFormationSimple h0(pPerson1, pPerson2, tr, a0, m_a1, m_a2, m_a3, m_a4, m_a5, m_Dp, m_b);
-	TimeLimitedHazardFunction h(h0, tMax);
+	if (!cache.isValid(population, pPerson1, pPerson2))
+	{
+		cache.m_a0 = getA0(population, pPerson1, pPerson2);
+		cache.m_tr = getTr(population, pPerson1, pPerson2, t0, eventFormation.getLastDissolutionTime());
+		cache.m_tMax = getTMax(pPerson1, pPerson2);
+		cache.setValid(population, pPerson1, pPerson2);
+	}
 
-	return h.solveForRealTimeInterval(t0, Tdiff);
-	//return ExponentialHazardToRealTime(pPerson1, pPerson2, t0, Tdiff, tr, a0, m_a1, m_a2, m_a3, m_a4, m_a5, m_Dp, m_b, true, tMax);
+	return cache;
 }
 
 double EvtHazardFormationSimple::getA0(const SimpactPopulation &population, Person *pPerson1, Person *pPerson2)
 {
 	double lastKnownPopSizeTime = 0;
 	double n = population.getLastKnownPopulationSize(lastKnownPopSizeTime);
-	double a0i = pPerson1->getFormationEagernessParameter();
-	double a0j = pPerson2->getFormationEagernessParameter();
+	double a0i, a0j;
+	Person::getFormationPairEagerness(pPerson1, pPerson2, false, a0i, a0j);
 	double a0_base = m_a0 + (a0i + a0j)*m_a6 * std::abs(a0i-a0j)*m_a7;
 	a0_base += m_aDist * pPerson1->getDistanceTo(pPerson2);
 
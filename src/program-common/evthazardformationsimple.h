@@ -3,6 +3,7 @@
 #define EVTHAZARDFORMATIONSIMPLE_H
 
 #include "evthazard.h"
+#include "eventformation.h"
 
 class Person;
 class ConfigSettings;
@@ -24,6 +25,7 @@ public:
 	static EvtHazard *processConfig(ConfigSettings &config, const std::string &prefix, const std::string &hazName, bool msm);
 	void obtainConfig(ConfigWriter &writer, const std::string &prefix);
 private:
+	const EventFormation::HazardCache &getPairCache(const SimpactPopulation &population, const SimpactEvent &event, double t0);
 	double getA0(const SimpactPopulation &population, Person *pPerson1, Person *pPerson2);
 	double getTr(const SimpactPopulation &population, Person *pPerson1, Person *pPerson2, double t0, double lastDissTime);
 	double getTMax(Person *pPerson1, Person *pPerson2);
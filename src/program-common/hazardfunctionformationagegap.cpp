@@ -1,6 +1,7 @@
 #include "hazardfunctionformationagegap.h"
 #include "hazardfunctionformationsimple.h"
 #include <iostream>
+#include <algorithm>
 #include <assert.h>
 
 using namespace std;
@@ -25,6 +26,98 @@ HazardFunctionFormationAgeGap::HazardFunctionFormationAgeGap(const Person *pPers
 {
 	assert((!msm && (pPerson1->isMan() && pPerson2->isWoman())) || 
 		    (msm && (pPerson1->isMan() && pPerson2->isMan())) );
+
+	getPairTerms(pPerson1, pPerson2, a8, a10, msm, m_pairTerms);
+
+	m_Pi = pPerson1->getNumberOfRelationships();
+	m_Pj = pPerson2->getNumberOfRelationships();
+}
+
+HazardFunctionFormationAgeGap::HazardFunctionFormationAgeGap(const Person *pPerson1, const Person *pPerson2,
+		                   const FormationAgeGapPairTerms &pairTerms, double Pi, double Pj, double tr,
+		                   double a0, double a1, double a2, double a3, double a4, 
+						   double a5, double a8, double a9, double a10, double b, bool msm) : 
+					m_pPerson1(pPerson1),
+					m_pPerson2(pPerson2),
+					m_tr(tr),
+					m_a0(a0),
+					m_a1(a1),
+					m_a2(a2),
+					m_a3(a3),
+					m_a4(a4),
+					m_a5(a5),
+					m_a8(a8),
+					m_a9(a9),
+					m_a10(getA10(msm, a10)),
+					m_b(b),
+					m_msm(msm),
+					m_pairTerms(pairTerms)
+{
+	assert((!msm && (pPerson1->isMan() && pPerson2->isWoman())) || 
+		    (msm && (pPerson1->isMan() && pPerson2->isMan())) );
+	assert(Pi == pPerson1->getNumberOfRelationships() && Pj == pPerson2->getNumberOfRelationships());
+
+	m_Pi = Pi;
+	m_Pj = Pj;
+}
+
+void HazardFunctionFormationAgeGap::getPairTerms(const Person *pPerson1, const Person *pPerson2, double a8, double a10, bool msm,
+                                                 FormationAgeGapPairTerms &pairTerms)
+{
+	double Pi, Pj, tBi, tBj, Dpi, Dpj;
+
+	Person::getFormationPairValues(pPerson1, pPerson2, msm, Pi, Pj, tBi, tBj, Dpi, Dpj);
+	getPairTerms(tBi, tBj, Dpi, Dpj, a8, a10, msm, pairTerms);
+}
+
+void HazardFunctionFormationAgeGap::getPairTerms(double tBi, double tBj, double Dpi, double Dpj, double a8, double a10, bool msm,
+                                                 FormationAgeGapPairTerms &pairTerms)
+{
+	// Sign change for MSM, to be able to use the old hazard code
+	if (msm)
+		Dpj = -Dpj;
+
+	a10 = getA10(msm, a10);
+
+	const double C = (a8-1.0)*tBi + tBj - Dpi;
+	const double D = (a10+1.0)*tBj - tBi - Dpj;
+	double t1, t2;
+
+	if (a8 == 0 || a10 == 0)
+	{
+		if (a8 != 0)
+		{
+			t1 = C/a8;
+			t2 = -1e200;
+		}
+		else if (a10 != 0)
+		{
+			t1 = D/a10;
+			t2 = -1e200;
+		}
+		else // both are zero, this case should never happen, should already be handled
+		{
+			t1 = -1e200;
+			t2 = -1e200;
+		}
+	}
+	else
+	{
+		t1 = C/a8;
+		t2 = D/a10;
+
+		if (t1 > t2)
+			std::swap(t1, t2);
+	}
+
+	pairTerms.tBi = tBi;
+	pairTerms.tBj = tBj;
+	pairTerms.Dpi = Dpi;
+	pairTerms.Dpj = Dpj;
+	pairTerms.C = C;
+	pairTerms.D = D;
+	pairTerms.tp1 = t1;
+	pairTerms.tp2 = t2;
 }
 
 HazardFunctionFormationAgeGap::~HazardFunctionFormationAgeGap()
@@ -33,13 +126,12 @@ HazardFunctionFormationAgeGap::~HazardFunctionFormationAgeGap()
 
 double HazardFunctionFormationAgeGap::evaluate(double t)
 {
-	double Pi = m_pPerson1->getNumberOfRelationships();
-	double Pj = m_pPerson2->getNumberOfRelationships();
-	double tBi = m_pPerson1->getDateOfBirth();
-	double tBj = m_pPerson2->getDateOfBirth();
-
-	double Dpi, Dpj;
-	getPreferredAgeDifferences(m_msm, m_pPerson1, m_pPerson2, Dpi, Dpj);
+	const double Pi = m_Pi;
+	const double Pj = m_Pj;
+	const double tBi = m_pairTerms.tBi;
+	const double tBj = m_pairTerms.tBj;
+	const double Dpi = m_pairTerms.Dpi;
+	const double Dpj = m_pairTerms.Dpj;
 
 	return std::exp(m_a0 + m_a1*Pi + m_a2*Pj + m_a3*std::abs(Pi-Pj) + m_a4*(t-(tBi + tBj)/2.0)
             + m_a5*std::abs( (m_a8-1.0)*tBi+tBj-Dpi-m_a8*t )
@@ -52,14 +144,9 @@ double HazardFunctionFormationAgeGap::calculateInternalTimeInterval(double t0, d
 	if (m_a8 == 0 && m_a10 == 0)
 	{
 		double a0 = m_a0; // we'll be adding some things to this constant term
-		double tBi = m_pPerson1->getDateOfBirth();
-		double tBj = m_pPerson2->getDateOfBirth();
-		
-		double Dpi, Dpj;
-		getPreferredAgeDifferences(m_msm, m_pPerson1, m_pPerson2, Dpi, Dpj);
 
-		a0 += m_a5*std::abs(tBj-tBi-Dpi);
-		a0 += m_a9*std::abs(tBj-tBi-Dpj);
+		a0 += m_a5*std::abs(m_pairTerms.tBj-m_pairTerms.tBi-m_pairTerms.Dpi);
+		a0 += m_a9*std::abs(m_pairTerms.tBj-m_pairTerms.tBi-m_pairTerms.Dpj);
 
 		HazardFunctionFormationSimple h(m_pPerson1, m_pPerson2, m_tr,
 						a0 /* modified m_a0 !! */, m_a1, m_a2, m_a3, m_a4, 
@@ -161,14 +248,9 @@ double HazardFunctionFormationAgeGap::solveForRealTimeInterval(double t0, double
 	if (m_a8 == 0 && m_a10 == 0)
 	{
 		double a0 = m_a0; // we'll be adding some things to this constant term
-		double tBi = m_pPerson1->getDateOfBirth();
-		double tBj = m_pPerson2->getDateOfBirth();
-		
-		double Dpi, Dpj;
-		getPreferredAgeDifferences(m_msm, m_pPerson1, m_pPerson2, Dpi, Dpj);
 
-		a0 += m_a5*std::abs(tBj-tBi-Dpi);
-		a0 += m_a9*std::abs(tBj-tBi-Dpj);
+		a0 += m_a5*std::abs(m_pairTerms.tBj-m_pairTerms.tBi-m_pairTerms.Dpi);
+		a0 += m_a9*std::abs(m_pairTerms.tBj-m_pairTerms.tBi-m_pairTerms.Dpj);
 
 		HazardFunctionFormationSimple h(m_pPerson1, m_pPerson2, m_tr,
 						a0 /* modified m_a0 !! */, m_a1, m_a2, m_a3, m_a4, 
@@ -7,29 +7,54 @@
 #include <assert.h>
 #include <cmath>
 
+// The part of the hazard that only depends on the pair of persons and on
+// the hazard parameters: birth dates, preferred age differences (with the
+// MSM sign change already applied) and the tipping points of the piecewise
+// exponential function
+struct FormationAgeGapPairTerms
+{
+	double tBi, tBj, Dpi, Dpj;
+	double C, D, tp1, tp2;
+};
+
 class HazardFunctionFormationAgeGap : public HazardFunction
 {
 public:
 	HazardFunctionFormationAgeGap(const Person *pPerson1, const Person *pPerson2, double tr,
 		                   double a0, double a1, double a2, double a3, double a4, 
                            double a5, double a8, double a9, double a10, double b, bool msm);
+	// Same, but with the pair terms previously calculated by getPairTerms and
+	// the numbers of relationships Pi and Pj of both persons
+	HazardFunctionFormationAgeGap(const Person *pPerson1, const Person *pPerson2,
+	                       const FormationAgeGapPairTerms &pairTerms, double Pi, double Pj, double tr,
+		                   double a0, double a1, double a2, double a3, double a4, 
+                           double a5, double a8, double a9, double a10, double b, bool msm);
 	~HazardFunctionFormationAgeGap();
 
 	double evaluate(double t);
 	double calculateInternalTimeInterval(double t0, double dt);
 	double solveForRealTimeInterval(double t0, double Tdiff);
+
+	static void getPairTerms(const Person *pPerson1, const Person *pPerson2, double a8, double a10, bool msm,
+	                         FormationAgeGapPairTerms &pairTerms);
+	// Same, for the birth dates and preferred age differences of the persons
+	static void getPairTerms(double tBi, double tBj, double Dpi, double Dpj, double a8, double a10, bool msm,
+	                         FormationAgeGapPairTerms &pairTerms);
 private:
 	void getTippingPoints(double &t1, double &t2, double &B, double &C, double &D);
 	void getEFValues(double t, double B, double C, double D, double &E, double &F);
 	static double calculateIntegral(double t0, double dt, double E, double F);
 	static double solveIntegral(double t0, double Tdiff, double E, double F);
 	static double getA10(bool msm, double a10);
-	static void getPreferredAgeDifferences(bool msm, const Person *pPerson1, const Person *pPerson2, double &Dpi, double &Dpj);
 
 	const Person *m_pPerson1;
 	const Person *m_pPerson2;
 	const double m_tr, m_a0, m_a1, m_a2, m_a3, m_a4, m_a5, m_a8, m_a9, m_a10, m_b;
 	const bool m_msm;
+
+	// Person dependent values, gathered once at construction
+	double m_Pi, m_Pj;
+	FormationAgeGapPairTerms m_pairTerms;
 };
 
 // Sign change for MSM, to be able to use the old hazard code
@@ -40,68 +65,18 @@ inline double HazardFunctionFormationAgeGap::getA10(bool msm, double a10)
 	return a10;
 }
 
-// Sign change for MSM, to be able to use the old hazard code
-inline void HazardFunctionFormationAgeGap::getPreferredAgeDifferences(bool msm, const Person *pPerson1, 
-		                                                              const Person *pPerson2, double &Dpi, double &Dpj)
-{
-	assert(pPerson1 && pPerson2);
-
-	if (msm)
-	{
-		assert(pPerson1->isMan() && pPerson2->isMan());
-
-		Dpi = pPerson1->getPreferredAgeDifferenceMSM();
-		Dpj = - pPerson2->getPreferredAgeDifferenceMSM(); // sign change to be able to use the same hazard code
-	}
-	else
-	{
-		assert(pPerson1->isMan() && pPerson2->isWoman());
-
-		Dpi = pPerson1->getPreferredAgeDifference();
-		Dpj = pPerson2->getPreferredAgeDifference();
-	}
-}
-
 inline void HazardFunctionFormationAgeGap::getTippingPoints(double &t1, double &t2, double &B, double &C, double &D)
 {
-	double Pi = m_pPerson1->getNumberOfRelationships();
-	double Pj = m_pPerson2->getNumberOfRelationships();
-	double tBi = m_pPerson1->getDateOfBirth();
-	double tBj = m_pPerson2->getDateOfBirth();
-
-	double Dpi, Dpj;
-	getPreferredAgeDifferences(m_msm, m_pPerson1, m_pPerson2, Dpi, Dpj);
+	const double Pi = m_Pi;
+	const double Pj = m_Pj;
+	const double tBi = m_pairTerms.tBi;
+	const double tBj = m_pairTerms.tBj;
 
 	B = m_a0 + m_a1*Pi + m_a2*Pj + m_a3*std::abs(Pi-Pj) - m_a4*(tBi+tBj)/2.0 - m_b*m_tr;
-	C = (m_a8-1.0)*tBi + tBj - Dpi;
-	D = (m_a10+1.0)*tBj - tBi - Dpj;
-
-	if (m_a8 == 0 || m_a10 == 0)
-	{
-		if (m_a8 != 0)
-		{
-			t1 = C/m_a8;
-			t2 = -1e200;
-		}
-		else if (m_a10 != 0)
-		{
-			t1 = D/m_a10;
-			t2 = -1e200;
-		}
-		else // both are zero, this case should never happen, should already be handled
-		{
-			t1 = -1e200;
-			t2 = -1e200;
-		}
-	}
-	else
-	{
-		t1 = C/m_a8;
-		t2 = D/m_a10;
-
-		if (t1 > t2)
-			std::swap(t1, t2);
-	}
+	C = m_pairTerms.C;
+	D = m_pairTerms.D;
+	t1 = m_pairTerms.tp1;
+	t2 = m_pairTerms.tp2;
 }
 
 inline void HazardFunctionFormationAgeGap::getEFValues(double t, double B, double C, double D, double &E, double &F)
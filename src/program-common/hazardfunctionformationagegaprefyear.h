@@ -19,6 +19,19 @@ public:
 				   double ageRefYear,
 				   bool msm);
 	~HazardFunctionFormationAgeGapRefYear();
+
+	// Returns the value of A in exp(A+Bt), the value of B is a4 + b. This is
+	// what the constructor uses, but it can also be called directly when only
+	// these parameters are needed
+	static double getA(const Person *pPerson1, const Person *pPerson2, double tr,
+		           double a0, double a1, double a2, double a3, double a4, 
+				   double a8, double a10, 
+				   double agfmConst, double agfmExp, double agfmAge,
+				   double agfwConst, double agfwExp, double agfwAge,
+				   double numRelScaleMan, double numRelScaleWoman,
+				   double b,
+				   double ageRefYear,
+				   bool msm);
 };
 
 #endif // HAZARDFUNCTIONFORMATIONAGEGAPREFYEAR_H
@@ -16,6 +16,8 @@ HazardFunctionFormationSimple::HazardFunctionFormationSimple(const Person *pPers
 					m_Dp(Dp),
 					m_b(b)
 {
+	double Dpi, Dpj; // not used by this hazard, which has a single preference m_Dp
+	Person::getFormationPairValues(pPerson1, pPerson2, false, m_Pi, m_Pj, m_tBi, m_tBj, Dpi, Dpj);
 }
 
 HazardFunctionFormationSimple::~HazardFunctionFormationSimple()
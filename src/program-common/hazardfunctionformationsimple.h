@@ -26,14 +26,17 @@ private:
 	const Person *m_pPerson1;
 	const Person *m_pPerson2;
 	const double m_tr, m_a0, m_a1, m_a2, m_a3, m_a4, m_a5, m_Dp, m_b;
+
+	// Person dependent values, gathered once at construction
+	double m_Pi, m_Pj, m_tBi, m_tBj;
 };
 
 inline double HazardFunctionFormationSimple::getLnB() const
 {
-	double Pi = m_pPerson1->getNumberOfRelationships();
-	double Pj = m_pPerson2->getNumberOfRelationships();
-	double tBi = m_pPerson1->getDateOfBirth();
-	double tBj = m_pPerson2->getDateOfBirth();
+	const double Pi = m_Pi;
+	const double Pj = m_Pj;
+	const double tBi = m_tBi;
+	const double tBj = m_tBj;
 
 	double lnB = m_a0 + m_a1*Pi + m_a2*Pj + m_a3*std::abs(Pi-Pj) - m_a4*(tBi + tBj)/2.0
 		   +m_a5*std::abs(-tBi+tBj-m_Dp) - m_b*m_tr;
@@ -55,10 +58,10 @@ inline double HazardFunctionFormationSimple::getC() const
 
 inline double HazardFunctionFormationSimple::getE(double t0) const
 {
-	double Pi = m_pPerson1->getNumberOfRelationships();
-	double Pj = m_pPerson2->getNumberOfRelationships();
-	double tBi = m_pPerson1->getDateOfBirth();
-	double tBj = m_pPerson2->getDateOfBirth();
+	const double Pi = m_Pi;
+	const double Pj = m_Pj;
+	const double tBi = m_tBi;
+	const double tBj = m_tBj;
 
 	double E = std::exp(m_a0 + m_a1*Pi + m_a2*Pj + m_a3*std::abs(Pi-Pj) + m_a4*(t0 - (tBi + tBj)/2.0)
 		   +m_a5*std::abs(-tBi+tBj-m_Dp) + m_b*(t0-m_tr));
@@ -3,13 +3,15 @@
 #include "configwriter.h"
 #include "jsonconfig.h"
 #include "configfunctions.h"
+#include "eventprofiler.h"
+#include "eventtracer.h"
 
 using namespace std;
 
 void LogSystem::processConfig(ConfigSettings &config, GslRandomNumberGenerator *pRndGen)
 {
 	string eventLogFile, personLogFile, relationLogFile, treatmentLogFile, settingsLogFile;
-	string locationLogFile, hivVLLogFile;
+	string locationLogFile, hivVLLogFile, profileLogFile, traceLogFile;
 	bool_t r;
 
 	if (!(r = config.getKeyValue("logsystem.outfile.logevents", eventLogFile)) ||
@@ -18,7 +20,10 @@ void LogSystem::processConfig(ConfigSettings &config, GslRandomNumberGenerator *
 	    !(r = config.getKeyValue("logsystem.outfile.logtreatments", treatmentLogFile)) ||
 		!(r = config.getKeyValue("logsystem.outfile.logsettings", settingsLogFile)) ||
 		!(r = config.getKeyValue("logsystem.outfile.loglocation", locationLogFile)) ||
-		!(r = config.getKeyValue("logsystem.outfile.logviralloadhiv", hivVLLogFile)) 
+		!(r = config.getKeyValue("logsystem.outfile.logviralloadhiv", hivVLLogFile)) ||
+		!(r = config.getKeyValue("logsystem.outfile.logprofile", profileLogFile)) ||
+		!(r = config.getKeyValue("logsystem.outfile.logtrace", traceLogFile)) ||
+		!(r = config.getKeyValue("logsystem.trace.interval", traceInterval, 1))
 	    )
 		abortWithMessage(r.getErrorString());
 
@@ -64,6 +69,22 @@ void LogSystem::processConfig(ConfigSettings &config, GslRandomNumberGenerator *
 			abortWithMessage("Unable to open HIV viral load log file: " + r.getErrorString());
 	}
 
+	// The event profiling results are only written when the simulation has finished
+	if (profileLogFile.length() > 0)
+	{
+		if (!(r = logProfile.open(profileLogFile)))
+			abortWithMessage("Unable to open event profiling log file: " + r.getErrorString());
+		EventProfiler::setEnabled(true);
+	}
+
+	// Only one in 'traceInterval' steps of the algorithm is written to the trace
+	if (traceLogFile.length() > 0)
+	{
+		if (!(r = logTrace.open(traceLogFile)))
+			abortWithMessage("Unable to open trace log file: " + r.getErrorString());
+		EventTracer::start(&logTrace, traceInterval);
+	}
+
 	logPersons.print("\"ID\",\"Gender\",\"TOB\",\"TOD\",\"IDF\",\"IDM\",\"TODebut\",\"FormEag\",\"FormEagMSM\",\"InfectTime\",\"InfectOrigID\",\"InfectType\",\"log10SPVL\",\"TreatTime\",\"XCoord\",\"YCoord\",\"AIDSDeath\",\"HSV2InfectTime\",\"HSV2InfectOriginID\",\"CD4atInfection\",\"CD4atDeath\"");
 	logRelations.print("\"ID1\",\"ID2\",\"FormTime\",\"DisTime\",\"AgeGap\",\"MSM\"");
 	logTreatment.print("\"ID\",\"Gender\",\"TStart\",\"TEnd\",\"DiedNow\",\"CD4atARTstart\"");
@@ -81,7 +102,10 @@ void LogSystem::obtainConfig(ConfigWriter &config)
 	    !(r = config.addKey("logsystem.outfile.logtreatments", logTreatment.getFileName())) ||
 		!(r = config.addKey("logsystem.outfile.logsettings", logSettings.getFileName())) ||
 		!(r = config.addKey("logsystem.outfile.loglocation", logLocation.getFileName())) ||
-		!(r = config.addKey("logsystem.outfile.logviralloadhiv", logViralLoadHIV.getFileName()))
+		!(r = config.addKey("logsystem.outfile.logviralloadhiv", logViralLoadHIV.getFileName())) ||
+		!(r = config.addKey("logsystem.outfile.logprofile", logProfile.getFileName())) ||
+		!(r = config.addKey("logsystem.outfile.logtrace", logTrace.getFileName())) ||
+		!(r = config.addKey("logsystem.trace.interval", traceInterval))
 	    )
 		abortWithMessage(r.getErrorString());
 }
@@ -93,6 +117,9 @@ LogFile LogSystem::logTreatment;
 LogFile LogSystem::logSettings;
 LogFile LogSystem::logLocation;
 LogFile LogSystem::logViralLoadHIV;
+LogFile LogSystem::logProfile;
+LogFile LogSystem::logTrace;
+int LogSystem::traceInterval = 1;
 
 ConfigFunctions logSystemConfigFunctions(LogSystem::processConfig, LogSystem::obtainConfig, "00_LogSystem", "__first__");
 
@@ -106,7 +133,10 @@ JSONConfig logSystemJSONConfig(R"JSON(
                 ["logsystem.outfile.logtreatments", "${SIMPACT_OUTPUT_PREFIX}treatmentlog.csv" ],
 				["logsystem.outfile.logsettings", "${SIMPACT_OUTPUT_PREFIX}settingslog.csv" ],
 				["logsystem.outfile.loglocation", "${SIMPACT_OUTPUT_PREFIX}locationlog.csv" ],
-				["logsystem.outfile.logviralloadhiv", "${SIMPACT_OUTPUT_PREFIX}hivviralloadlog.csv" ]
+				["logsystem.outfile.logviralloadhiv", "${SIMPACT_OUTPUT_PREFIX}hivviralloadlog.csv" ],
+				["logsystem.outfile.logprofile", "" ],
+				["logsystem.outfile.logtrace", "" ],
+				["logsystem.trace.interval", 1 ]
             ],
             "info": null                          
         })JSON");
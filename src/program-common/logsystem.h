@@ -13,7 +13,8 @@ class LogSystem
 public: 
 	static void processConfig(ConfigSettings &config, GslRandomNumberGenerator *pRndGen);
 	static void obtainConfig(ConfigWriter &config);
-	static LogFile logEvents, logPersons, logRelations, logTreatment, logSettings, logLocation, logViralLoadHIV;
+	static LogFile logEvents, logPersons, logRelations, logTreatment, logSettings, logLocation, logViralLoadHIV, logProfile, logTrace;
+	static int traceInterval;
 };
 
 #define LogEvent LogSystem::logEvents
@@ -23,5 +24,7 @@ public:
 #define LogSettings LogSystem::logSettings
 #define LogLocation LogSystem::logLocation
 #define LogViralLoadHIV LogSystem::logViralLoadHIV
+#define LogProfile LogSystem::logProfile
+#define LogTrace LogSystem::logTrace
 
 #endif // LOGSYSTEM_H
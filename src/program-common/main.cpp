@@ -12,6 +12,10 @@
 #include "populationutil.h"
 #include "logsystem.h"
 #include "configsettingslog.h"
+#include "eventprofiler.h"
+#include "eventtracer.h"
+#include "simpactserver.h"
+#include "summarystatistics.h"
 #include <assert.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -34,12 +38,16 @@ void usage(const string &progName)
 	cerr << "Usage: " << progName << " configfile.txt parallel algo(opt/simple)" << endl << endl;;
 	cerr << "or" << endl;
 	cerr << "Usage: " << progName << " --showconfigoptions" << endl << endl;;
+	cerr << "or" << endl;
+	cerr << "Usage: " << progName << " --serve maxruns [socketpath]" << endl << endl;;
 	cerr << endl;
 	cerr << "Version:  " << SIMPACT_CYAN_VERSION << endl;
 	cerr << "Compiler: " << SIMPACT_CYAN_COMPILER << endl;
 	exit(-1);
 }
 
+int runSimulation(const string &confFileName, bool parallel, const string &algo);
+
 int real_main(int argc, char **argv)
 {
 	if (argc == 2)
@@ -51,6 +59,16 @@ int real_main(int argc, char **argv)
 			return 0;
 		}
 	}
+	if ((argc == 3 || argc == 4) && string(argv[1]) == "--serve")
+	{
+		int maxRuns = atoi(argv[2]);
+		string socketPath = (argc == 4)?string(argv[3]):string();
+
+		if (maxRuns < 1)
+			usage(argv[0]);
+
+		return runSimpactServer(maxRuns, socketPath, runSimulation);
+	}
 	if (argc != 4)
 		usage(argv[0]);
 
@@ -58,6 +76,14 @@ int real_main(int argc, char **argv)
 	int intParallel = atoi(argv[2]);
 	bool parallel = (intParallel == 1);
 	std::string algo(argv[3]);
+
+	return runSimulation(confFileName, parallel, algo);
+}
+
+// Performs a single simulation, this is also used by the server mode for each
+// run request
+int runSimulation(const string &confFileName, bool parallel, const string &algo)
+{
 	ConfigSettings config;
 	bool_t r;
 
@@ -131,9 +157,16 @@ int real_main(int argc, char **argv)
 
 	cerr << "# Current simulation time is " << pPop->getTime() << endl;
 
+	// The rows of the summary log are written when an event is about to fire,
+	// the last bin still needs to be written, also if the simulation was aborted
+	if (SummaryStatistics::isEnabled())
+		SummaryStatistics::onSimulationEnd(*pPop, pPop->getTime());
+
 	int numEndPeople = pPop->getNumberOfPeople();
 
 	cerr << "# Number of events executed is " << maxEvents << endl;
+	if (pPop->getNumberOfRejectedCandidates() > 0)
+		cerr << "# Number of rejected candidate event times is " << pPop->getNumberOfRejectedCandidates() << endl;
 	cerr << "# Started with " << numInitPeople << " people, ending with " << numEndPeople << " (difference is " << numEndPeople-numInitPeople << ")" << endl;
 
 	// Log ongoing relationships
@@ -145,6 +178,13 @@ int real_main(int argc, char **argv)
 	// Log config file
 	ConfigSettingsLog::writeConfigSettings(LogSettings);	
 
+	// Write the event profiling results, if requested
+	if (LogProfile.isOpen())
+		LogProfile.print("%s", EventProfiler::getJSON().c_str());
+
+	// Close the JSON array of the trace, if one is being written
+	EventTracer::finish();
+
 	return 0;
 }
 
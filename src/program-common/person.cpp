@@ -20,12 +20,31 @@ Person::Person(double dateOfBirth, Gender g) : PersonBase(g, dateOfBirth), m_rel
 	assert(g == Male || g == Female);
 
 	assert(m_pPopDist);
+	init(m_pPopDist->pickPoint());
+}
+
+Person::Person(double dateOfBirth, Gender g, const PersonInitialValues &values, size_t idx)
+	: PersonBase(g, dateOfBirth), m_relations(this, values, idx), m_hiv(this, values, idx), m_hsv2(this, values, idx)
+{
+	assert(g == Male || g == Female);
+	assert(idx < values.m_location.size());
+
+	init(values.m_location[idx]);
+}
 
-	Point2D loc = m_pPopDist->pickPoint();
+void Person::init(Point2D loc)
+{
 	assert(loc.x == loc.x && loc.y == loc.y); // check for NaN
+	m_locationVersion = 0;
 	setLocation(loc, 0);
 
 	m_pPersonImpl = new PersonImpl(*this);
+
+	m_pAttrTable = 0;
+	m_attrSlot = -1;
+
+	m_pAggregates = 0;
+	m_aggregatesIndex = -1;
 }
 
 Person::~Person()
@@ -33,6 +52,70 @@ Person::~Person()
 	delete m_pPersonImpl;
 }
 
+bool Person::hasBulkPicking(Gender g)
+{
+	assert(m_pPopDist);
+
+	return m_pPopDist->hasBulkPicking() && Person_Relations::hasBulkPicking(g == Male) &&
+	       Person_HIV::hasBulkPicking() && Person_HSV2::hasBulkPicking();
+}
+
+// The values are picked in the order in which the constructor picks them, but
+// each one for the whole block at once
+void Person::pickInitialValues(Gender g, GslRandomNumberGenerator *pRndGen, size_t num, PersonInitialValues &values)
+{
+	assert(g == Male || g == Female);
+	assert(num > 0);
+
+	values.resize(num);
+
+	Person_Relations::pickInitialValues(g == Male, pRndGen, num, values);
+	Person_HIV::pickInitialValues(pRndGen, num, values);
+	Person_HSV2::pickInitialValues(pRndGen, num, values);
+	m_pPopDist->pickPoints(pRndGen, &(values.m_location[0]), num);
+}
+
+void Person::registerInAttributeTable(PersonAttributeTable *pTable)
+{
+	assert(pTable != 0);
+	assert(m_pAttrTable == 0);
+
+	// Store the values as they are kept in m_relations, the MSM values are only
+	// meaningful for men
+	m_attrSlot = pTable->allocateSlot(getDateOfBirth(), m_relations.getNumberOfRelationships(),
+	                                  m_relations.getFormationEagernessParameter(), m_relations.getFormationEagernessParameterMSM(),
+	                                  m_relations.getPreferredAgeDifference(), m_relations.getPreferredAgeDifferenceMSM());
+	m_pAttrTable = pTable;
+}
+
+void Person::unregisterFromAttributeTable()
+{
+	if (!m_pAttrTable)
+		return;
+
+	m_pAttrTable->releaseSlot(m_attrSlot);
+	m_pAttrTable = 0;
+	m_attrSlot = -1;
+}
+
+void Person::registerInAggregates(PopulationAggregates *pAggregates)
+{
+	assert(pAggregates != 0);
+	assert(m_pAggregates == 0);
+
+	m_pAggregates = pAggregates;
+	m_pAggregates->addPerson(this);
+}
+
+void Person::unregisterFromAggregates()
+{
+	if (!m_pAggregates)
+		return;
+
+	m_pAggregates->removePerson(this);
+	m_pAggregates = 0;
+}
+
 ProbabilityDistribution2D *Person::m_pPopDist = 0;
 double Person::m_popDistWidth = 0;
 double Person::m_popDistHeight = 0;
@@ -146,6 +229,10 @@ Man::Man(double dateOfBirth) : Person(dateOfBirth, Male)
 {
 }
 
+Man::Man(double dateOfBirth, const PersonInitialValues &values, size_t idx) : Person(dateOfBirth, Male, values, idx)
+{
+}
+
 Man::~Man()
 {
 }
@@ -155,6 +242,11 @@ Woman::Woman(double dateOfBirth) : Person(dateOfBirth, Female)
 	m_pregnant = false;
 }
 
+Woman::Woman(double dateOfBirth, const PersonInitialValues &values, size_t idx) : Person(dateOfBirth, Female, values, idx)
+{
+	m_pregnant = false;
+}
+
 Woman::~Woman()
 {
 }
@@ -7,6 +7,9 @@
 #include "person_relations.h"
 #include "person_hiv.h"
 #include "person_hsv2.h"
+#include "personattributetable.h"
+#include "personinitialvalues.h"
+#include "populationaggregates.h"
 #include "probabilitydistribution2d.h"
 #include "util.h"
 #include <stdlib.h>
@@ -33,6 +36,8 @@ class Person : public PersonBase
 {
 public:
 	Person(double dateOfBirth, Gender g);
+	// Creates a person from the values at position idx, see pickInitialValues
+	Person(double dateOfBirth, Gender g, const PersonInitialValues &values, size_t idx);
 	~Person();
 
 	PersonImpl *getImplementationSpecificPart()										{ return m_pPersonImpl; }
@@ -61,8 +66,8 @@ public:
 	bool hasRelationshipWith(Person *pPerson) const									{ return m_relations.hasRelationshipWith(pPerson); }
 
 	// WARNING: do not use these during relationship iteration
-	void addRelationship(Person *pPerson, double t)									{ m_relations.addRelationship(pPerson, t); }
-	void removeRelationship(Person *pPerson, double t, bool deathBased)				{ m_relations.removeRelationship(pPerson, t, deathBased); }
+	void addRelationship(Person *pPerson, double t)									{ m_relations.addRelationship(pPerson, t); syncNumberOfRelationships(); if (m_pAggregates) m_pAggregates->onRelationshipAdded(); }
+	void removeRelationship(Person *pPerson, double t, bool deathBased)				{ m_relations.removeRelationship(pPerson, t, deathBased); syncNumberOfRelationships(); if (m_pAggregates) m_pAggregates->onRelationshipRemoved(); }
 	
 	// result is negative if no relations formed yet
 	double getLastRelationshipChangeTime() const									{ return m_relations.getLastRelationshipChangeTime(); }
@@ -102,12 +107,47 @@ public:
 	void writeToLocationLog(double tNow);
 
 	Point2D getLocation() const														{ return m_location; }
-	void setLocation(Point2D loc, double tNow)										{ m_location = loc; m_locationTime = tNow; }
+	void setLocation(Point2D loc, double tNow)										{ m_location = loc; m_locationTime = tNow; m_locationVersion++; }
 	double getLocationTime() const													{ return m_locationTime; }
+	// Is increased every time the location is set
+	int getLocationVersion() const													{ return m_locationVersion; }
 
 	double getDistanceTo(Person *pPerson);
 	static ProbabilityDistribution2D *getPopulationDistribution()					{ return m_pPopDist; }
+
+	// Picks the random values that are needed to create num people of gender g,
+	// using pRndGen, and stores them in values. This can only be used if
+	// hasBulkPicking returns true, i.e. if all distributions involved support
+	// picking values in blocks. It is safe to call this from several threads at
+	// once, each with its own generator.
+	static bool hasBulkPicking(Gender g);
+	static void pickInitialValues(Gender g, GslRandomNumberGenerator *pRndGen, size_t num, PersonInitialValues &values);
+
+	// Slot in the population's table of frequently used attributes, see PersonAttributeTable
+	void registerInAttributeTable(PersonAttributeTable *pTable);
+	void unregisterFromAttributeTable();
+	const PersonAttributeTable *getAttributeTable() const							{ return m_pAttrTable; }
+	int getAttributeSlot() const													{ return m_attrSlot; }
+
+	// The population counts that this person contributes to, see PopulationAggregates
+	void registerInAggregates(PopulationAggregates *pAggregates);
+	void unregisterFromAggregates();
+	PopulationAggregates *getAggregates() const										{ return m_pAggregates; }
+	int getAggregatesIndex() const													{ return m_aggregatesIndex; }
+	void setAggregatesIndex(int idx)												{ m_aggregatesIndex = idx; }
+
+	// These read from the attribute table if both persons are registered in it,
+	// and from the person instances themselves otherwise. No MSM sign changes
+	// are applied, the preferred age differences are the ones stored for the
+	// person.
+	static void getFormationPairValues(const Person *pPerson1, const Person *pPerson2, bool msm,
+	                                   double &Pi, double &Pj, double &tBi, double &tBj, double &Dpi, double &Dpj);
+	static void getFormationPairEagerness(const Person *pPerson1, const Person *pPerson2, bool msm, double &a0i, double &a0j);
 private:
+	void init(Point2D location);
+	void syncNumberOfRelationships();
+	static const PersonAttributeTable *getSharedAttributeTable(const Person *pPerson1, const Person *pPerson2);
+
 	Person_Family m_family;
 	Person_Relations m_relations;
 	Person_HIV m_hiv;
@@ -115,9 +155,16 @@ private:
 
 	Point2D m_location;
 	double m_locationTime;
+	int m_locationVersion;
 
 	PersonImpl *m_pPersonImpl;
 
+	PersonAttributeTable *m_pAttrTable;
+	int m_attrSlot;
+
+	PopulationAggregates *m_pAggregates;
+	int m_aggregatesIndex;
+
 	static ProbabilityDistribution2D *m_pPopDist;
 	static double m_popDistWidth;
 	static double m_popDistHeight;
@@ -127,6 +174,7 @@ class Man : public Person
 {
 public:
 	Man(double dateOfBirth);
+	Man(double dateOfBirth, const PersonInitialValues &values, size_t idx);
 	~Man();
 };
 
@@ -134,6 +182,7 @@ class Woman : public Person
 {
 public:
 	Woman(double dateOfBirth);
+	Woman(double dateOfBirth, const PersonInitialValues &values, size_t idx);
 	~Woman();
 
 	void setPregnant(bool f)							{ m_pregnant = f; }
@@ -176,5 +225,71 @@ inline double Person::getDistanceTo(Person *pPerson)
 	return std::sqrt(dx*dx+dy*dy);
 }
 
+inline void Person::syncNumberOfRelationships()
+{
+	if (m_pAttrTable)
+		m_pAttrTable->setNumberOfRelationships(m_attrSlot, m_relations.getNumberOfRelationships());
+}
+
+inline const PersonAttributeTable *Person::getSharedAttributeTable(const Person *pPerson1, const Person *pPerson2)
+{
+	const PersonAttributeTable *pTable = pPerson1->m_pAttrTable;
+	if (pTable == 0 || pTable != pPerson2->m_pAttrTable || !pTable->isEnabled())
+		return 0;
+	return pTable;
+}
+
+inline void Person::getFormationPairValues(const Person *pPerson1, const Person *pPerson2, bool msm,
+                                           double &Pi, double &Pj, double &tBi, double &tBj, double &Dpi, double &Dpj)
+{
+	assert(pPerson1 && pPerson2);
+
+	const PersonAttributeTable *pTable = getSharedAttributeTable(pPerson1, pPerson2);
+	if (pTable)
+	{
+		pTable->getFormationPairValues(pPerson1->m_attrSlot, pPerson2->m_attrSlot, msm, Pi, Pj, tBi, tBj, Dpi, Dpj);
+		return;
+	}
+
+	Pi = pPerson1->getNumberOfRelationships();
+	Pj = pPerson2->getNumberOfRelationships();
+	tBi = pPerson1->getDateOfBirth();
+	tBj = pPerson2->getDateOfBirth();
+
+	if (msm)
+	{
+		Dpi = pPerson1->getPreferredAgeDifferenceMSM();
+		Dpj = pPerson2->getPreferredAgeDifferenceMSM();
+	}
+	else
+	{
+		Dpi = pPerson1->getPreferredAgeDifference();
+		Dpj = pPerson2->getPreferredAgeDifference();
+	}
+}
+
+inline void Person::getFormationPairEagerness(const Person *pPerson1, const Person *pPerson2, bool msm, double &a0i, double &a0j)
+{
+	assert(pPerson1 && pPerson2);
+
+	const PersonAttributeTable *pTable = getSharedAttributeTable(pPerson1, pPerson2);
+	if (pTable)
+	{
+		pTable->getFormationPairEagerness(pPerson1->m_attrSlot, pPerson2->m_attrSlot, msm, a0i, a0j);
+		return;
+	}
+
+	if (msm)
+	{
+		a0i = pPerson1->getFormationEagernessParameterMSM();
+		a0j = pPerson2->getFormationEagernessParameterMSM();
+	}
+	else
+	{
+		a0i = pPerson1->getFormationEagernessParameter();
+		a0j = pPerson2->getFormationEagernessParameter();
+	}
+}
+
 #endif // PERSON_H
 
@@ -1,4 +1,5 @@
 #include "person_hiv.h"
+#include "person.h"
 #include "vspmodellogweibullwithnoise.h"
 #include "vspmodellogdist.h"
 #include "configsettings.h"
@@ -17,6 +18,32 @@ Person_HIV::Person_HIV(Person *pSelf) : m_pSelf(pSelf)
 {
 	assert(pSelf);
 
+	initInfectionState();
+
+	assert(m_pARTAcceptDistribution);
+	m_artAcceptanceThreshold = m_pARTAcceptDistribution->pickNumber();
+
+	assert(m_pLogSurvTimeOffsetDistribution);
+	m_log10SurvTimeOffset = m_pLogSurvTimeOffsetDistribution->pickNumber();
+	m_hazardB0Param = m_pB0Dist->pickNumber();
+	m_hazardB1Param = m_pB1Dist->pickNumber();
+}
+
+Person_HIV::Person_HIV(Person *pSelf, const PersonInitialValues &values, size_t idx) : m_pSelf(pSelf)
+{
+	assert(pSelf);
+	assert(idx < values.m_artAcceptanceThreshold.size());
+
+	initInfectionState();
+
+	m_artAcceptanceThreshold = values.m_artAcceptanceThreshold[idx];
+	m_log10SurvTimeOffset = values.m_log10SurvTimeOffset[idx];
+	m_hazardB0Param = values.m_hazardB0Param[idx];
+	m_hazardB1Param = values.m_hazardB1Param[idx];
+}
+
+void Person_HIV::initInfectionState()
+{
 	m_infectionTime = -1e200; // not set
 	m_pInfectionOrigin = 0;
 	m_infectionType = None;
@@ -33,15 +60,23 @@ Person_HIV::Person_HIV(Person *pSelf) : m_pSelf(pSelf)
 	m_cd4AtDeath = -1;
 	m_lastCD4AtTreatmentStart = -1;
 
-	assert(m_pARTAcceptDistribution);
-	m_artAcceptanceThreshold = m_pARTAcceptDistribution->pickNumber();
-
 	m_aidsDeath = false;
+}
 
-	assert(m_pLogSurvTimeOffsetDistribution);
-	m_log10SurvTimeOffset = m_pLogSurvTimeOffsetDistribution->pickNumber();
-	m_hazardB0Param = m_pB0Dist->pickNumber();
-	m_hazardB1Param = m_pB1Dist->pickNumber();
+bool Person_HIV::hasBulkPicking()
+{
+	return m_pARTAcceptDistribution->hasBulkPicking() && m_pLogSurvTimeOffsetDistribution->hasBulkPicking() &&
+	       m_pB0Dist->hasBulkPicking() && m_pB1Dist->hasBulkPicking();
+}
+
+void Person_HIV::pickInitialValues(GslRandomNumberGenerator *pRndGen, size_t num, PersonInitialValues &values)
+{
+	assert(num > 0 && values.m_artAcceptanceThreshold.size() >= num);
+
+	m_pARTAcceptDistribution->pickNumbers(pRndGen, &(values.m_artAcceptanceThreshold[0]), num);
+	m_pLogSurvTimeOffsetDistribution->pickNumbers(pRndGen, &(values.m_log10SurvTimeOffset[0]), num);
+	m_pB0Dist->pickNumbers(pRndGen, &(values.m_hazardB0Param[0]), num);
+	m_pB1Dist->pickNumbers(pRndGen, &(values.m_hazardB1Param[0]), num);
 }
 
 Person_HIV::~Person_HIV()
@@ -92,6 +127,47 @@ void Person_HIV::setInfected(double t, Person *pOrigin, InfectionType iType)
 
 	assert(logDescription.length() > 0);
 	writeToViralLoadLog(t, logDescription);
+
+	if (m_pSelf->getAggregates())
+		m_pSelf->getAggregates()->onHIVStageChange(NoInfection, Acute);
+}
+
+void Person_HIV::setInChronicStage(double tNow)
+{ 
+	assert(m_infectionStage == Acute); 
+	m_infectionStage = Chronic; 
+	writeToViralLoadLog(tNow, "Chronic stage"); 
+
+	if (m_pSelf->getAggregates())
+		m_pSelf->getAggregates()->onHIVStageChange(Acute, Chronic);
+}
+
+void Person_HIV::setInAIDSStage(double tNow)
+{ 
+	assert(m_infectionStage == Chronic); 
+	m_infectionStage = AIDS; 
+	writeToViralLoadLog(tNow, "AIDS stage"); 
+
+	if (m_pSelf->getAggregates())
+		m_pSelf->getAggregates()->onHIVStageChange(Chronic, AIDS);
+}
+
+void Person_HIV::setInFinalAIDSStage(double tNow)
+{ 
+	assert(m_infectionStage == AIDS); 
+	m_infectionStage = AIDSFinal; 
+	writeToViralLoadLog(tNow, "Final AIDS stage");
+
+	if (m_pSelf->getAggregates())
+		m_pSelf->getAggregates()->onHIVStageChange(AIDS, AIDSFinal);
+}
+
+void Person_HIV::increaseDiagnoseCount()
+{
+	m_diagnoseCount++;
+
+	if (m_diagnoseCount == 1 && m_pSelf->getAggregates())
+		m_pSelf->getAggregates()->onHIVDiagnosis();
 }
 
 void Person_HIV::lowerViralLoad(double fractionOnLogscale, double treatmentTime)
@@ -118,6 +194,9 @@ void Person_HIV::lowerViralLoad(double fractionOnLogscale, double treatmentTime)
 	m_treatmentCount++;
 
 	writeToViralLoadLog(treatmentTime, "Started ART");
+
+	if (m_pSelf->getAggregates())
+		m_pSelf->getAggregates()->onTreatmentStart();
 }
 
 void Person_HIV::resetViralLoad(double dropoutTime)
@@ -134,6 +213,9 @@ void Person_HIV::resetViralLoad(double dropoutTime)
 	m_aidsTodUtil.changeTimeOfDeath(dropoutTime, m_pSelf);
 
 	writeToViralLoadLog(dropoutTime, "Dropped out of ART");
+
+	if (m_pSelf->getAggregates())
+		m_pSelf->getAggregates()->onTreatmentStop();
 }
 
 double Person_HIV::getCD4Count(double t) const
@@ -11,6 +11,7 @@ class VspModel;
 class ConfigSettings;
 class ConfigWriter;
 class GslRandomNumberGenerator;
+struct PersonInitialValues;
 
 class Person_HIV
 {
@@ -19,6 +20,8 @@ public:
 	enum InfectionStage { NoInfection, Acute, Chronic, AIDS, AIDSFinal };
 
 	Person_HIV(Person *pSelf);
+	// Uses the values at position idx instead of picking them, see Person::pickInitialValues
+	Person_HIV(Person *pSelf, const PersonInitialValues &values, size_t idx);
 	~Person_HIV();
 
 	InfectionType getInfectionType() const											{ return m_infectionType; }
@@ -33,7 +36,7 @@ public:
 	double getAIDSMortalityTime() const												{ return m_aidsTodUtil.getTimeOfDeath(); }
 
 	bool isDiagnosed() const														{ return (m_diagnoseCount > 0); }
-	void increaseDiagnoseCount()													{ m_diagnoseCount++; }
+	void increaseDiagnoseCount();
 	int getDiagnoseCount() const													{ return m_diagnoseCount; }
 
 	double getSetPointViralLoad() const												{ assert(m_infectionStage != NoInfection); return m_Vsp; }
@@ -63,7 +66,12 @@ public:
 
 	static void processConfig(ConfigSettings &config, GslRandomNumberGenerator *pRndGen);
 	static void obtainConfig(ConfigWriter &config);
+
+	// Used by Person::pickInitialValues
+	static bool hasBulkPicking();
+	static void pickInitialValues(GslRandomNumberGenerator *pRndGen, size_t num, PersonInitialValues &values);
 private:
+	void initInfectionState();
 	double getViralLoadFromSetPointViralLoad(double x) const;
 	void initializeCD4Counts();
 	static double pickSeedSetPointViralLoad();
@@ -126,25 +134,4 @@ inline double Person_HIV::getViralLoad() const
 	return -1;
 }
 
-inline void Person_HIV::setInChronicStage(double tNow)
-{ 
-	assert(m_infectionStage == Acute); 
-	m_infectionStage = Chronic; 
-	writeToViralLoadLog(tNow, "Chronic stage"); 
-}
-
-inline void Person_HIV::setInAIDSStage(double tNow)
-{ 
-	assert(m_infectionStage == Chronic); 
-	m_infectionStage = AIDS; 
-	writeToViralLoadLog(tNow, "AIDS stage"); 
-}
-
-inline void Person_HIV::setInFinalAIDSStage(double tNow)
-{ 
-	assert(m_infectionStage == AIDS); 
-	m_infectionStage = AIDSFinal; 
-	writeToViralLoadLog(tNow, "Final AIDS stage");
-}
-
 #endif // PERSON_HIV_H
@@ -14,12 +14,41 @@ Person_HSV2::Person_HSV2(Person *pSelf) : m_pSelf(pSelf)
 {
 	assert(pSelf);
 
+	initInfectionState();
+
+	m_hazardAParam = m_pADist->pickNumber();
+	m_hazardB2Param = m_pB2Dist->pickNumber();
+}
+
+Person_HSV2::Person_HSV2(Person *pSelf, const PersonInitialValues &values, size_t idx) : m_pSelf(pSelf)
+{
+	assert(pSelf);
+	assert(idx < values.m_hsv2AParam.size());
+
+	initInfectionState();
+
+	m_hazardAParam = values.m_hsv2AParam[idx];
+	m_hazardB2Param = values.m_hsv2B2Param[idx];
+}
+
+void Person_HSV2::initInfectionState()
+{
 	m_infectionTime = -1e200; // not set
 	m_pInfectionOrigin = 0;
 	m_infectionType = None;
+}
 
-	m_hazardAParam = m_pADist->pickNumber();
-	m_hazardB2Param = m_pB2Dist->pickNumber();
+bool Person_HSV2::hasBulkPicking()
+{
+	return m_pADist->hasBulkPicking() && m_pB2Dist->hasBulkPicking();
+}
+
+void Person_HSV2::pickInitialValues(GslRandomNumberGenerator *pRndGen, size_t num, PersonInitialValues &values)
+{
+	assert(num > 0 && values.m_hsv2AParam.size() >= num);
+
+	m_pADist->pickNumbers(pRndGen, &(values.m_hsv2AParam[0]), num);
+	m_pB2Dist->pickNumbers(pRndGen, &(values.m_hsv2B2Param[0]), num);
 }
 
 Person_HSV2::~Person_HSV2()
@@ -31,6 +60,9 @@ void Person_HSV2::setInfected(double t, Person *pOrigin, InfectionType iType)
 	assert(iType != None);
 	assert(!(pOrigin == 0 && iType != Seed));
 
+	if (!isInfected() && m_pSelf->getAggregates())
+		m_pSelf->getAggregates()->onHSV2Infection();
+
 	m_infectionTime = t; 
 	m_pInfectionOrigin = pOrigin;
 	m_infectionType = iType;
@@ -10,6 +10,7 @@ class ProbabilityDistribution;
 class ConfigSettings;
 class ConfigWriter;
 class GslRandomNumberGenerator;
+struct PersonInitialValues;
 
 class Person_HSV2
 {
@@ -17,6 +18,8 @@ public:
 	enum InfectionType { None, Partner, Seed };
 
 	Person_HSV2(Person *pSelf);
+	// Uses the values at position idx instead of picking them, see Person::pickInitialValues
+	Person_HSV2(Person *pSelf, const PersonInitialValues &values, size_t idx);
 	~Person_HSV2();
 
 	InfectionType getInfectionType() const											{ return m_infectionType; }
@@ -31,7 +34,13 @@ public:
 
 	static void processConfig(ConfigSettings &config, GslRandomNumberGenerator *pRndGen);
 	static void obtainConfig(ConfigWriter &config);
+
+	// Used by Person::pickInitialValues
+	static bool hasBulkPicking();
+	static void pickInitialValues(GslRandomNumberGenerator *pRndGen, size_t num, PersonInitialValues &values);
 private:
+	void initInfectionState();
+
 	const Person *m_pSelf;
 
 	double m_infectionTime;
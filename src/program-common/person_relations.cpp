@@ -15,6 +15,31 @@ Person_Relations::Person_Relations(const Person *pSelf) : m_pSelf(pSelf)
 {
 	assert(pSelf);
 
+	initRelationState();
+
+	if (pSelf->isMan())
+		pickEagernessAndGap(m_eagAgeMan);
+	else if (pSelf->isWoman())
+		pickEagernessAndGap(m_eagAgeWoman);
+	else
+		abortWithMessage("Person_Relations::Person_Relations: unknown gender!");
+}
+
+Person_Relations::Person_Relations(const Person *pSelf, const PersonInitialValues &values, size_t idx) : m_pSelf(pSelf)
+{
+	assert(pSelf);
+	assert(idx < values.m_eagernessHetero.size());
+
+	initRelationState();
+
+	m_formationEagernessHetero = values.m_eagernessHetero[idx];
+	m_formationEagernessHomo = values.m_eagernessHomo[idx];
+	m_preferredAgeDiffHetero = values.m_ageGapHetero[idx];
+	m_preferredAgeDiffHomo = values.m_ageGapHomo[idx];
+}
+
+void Person_Relations::initRelationState()
+{
 	m_lastRelationChangeTime = -1; // not set yet
 	m_sexuallyActive = false;
 	m_debutTime = -1;
@@ -23,13 +48,6 @@ Person_Relations::Person_Relations(const Person *pSelf) : m_pSelf(pSelf)
 #ifndef NDEBUG
 	m_relIterationBusy = false;
 #endif // NDEBUG
-
-	if (pSelf->isMan())
-		pickEagernessAndGap(m_eagAgeMan);
-	else if (pSelf->isWoman())
-		pickEagernessAndGap(m_eagAgeWoman);
-	else
-		abortWithMessage("Person_Relations::Person_Relations: unknown gender!");
 }
 
 Person_Relations::~Person_Relations()
@@ -61,6 +79,52 @@ void Person_Relations::pickEagernessAndGap(const EagernessAndAgegap &e)
 		m_preferredAgeDiffHomo = e.m_pGapHomo->pickNumber();
 }
 
+bool Person_Relations::hasBulkPicking(bool man)
+{
+	const EagernessAndAgegap &e = (man)?m_eagAgeMan:m_eagAgeWoman;
+
+	if (e.m_independentEagerness)
+	{
+		if (!e.m_pEagHetero->hasBulkPicking() || !e.m_pEagHomo->hasBulkPicking())
+			return false;
+	}
+	else
+	{
+		if (!e.m_pEagJoint->hasBulkPicking())
+			return false;
+	}
+	return e.m_pGapHetero->hasBulkPicking() && e.m_pGapHomo->hasBulkPicking();
+}
+
+// The values are picked in the same order as in pickEagernessAndGap, but each
+// one for the whole block at once
+void Person_Relations::pickInitialValues(bool man, GslRandomNumberGenerator *pRndGen, size_t num, PersonInitialValues &values)
+{
+	const EagernessAndAgegap &e = (man)?m_eagAgeMan:m_eagAgeWoman;
+
+	assert(num > 0 && values.m_eagernessHetero.size() >= num);
+
+	if (e.m_independentEagerness)
+	{
+		e.m_pEagHetero->pickNumbers(pRndGen, &(values.m_eagernessHetero[0]), num);
+		e.m_pEagHomo->pickNumbers(pRndGen, &(values.m_eagernessHomo[0]), num);
+	}
+	else
+	{
+		vector<Point2D> points(num);
+
+		e.m_pEagJoint->pickPoints(pRndGen, &(points[0]), num);
+		for (size_t i = 0 ; i < num ; i++)
+		{
+			values.m_eagernessHetero[i] = points[i].x;
+			values.m_eagernessHomo[i] = points[i].y;
+		}
+	}
+
+	e.m_pGapHetero->pickNumbers(pRndGen, &(values.m_ageGapHetero[0]), num);
+	e.m_pGapHomo->pickNumbers(pRndGen, &(values.m_ageGapHomo[0]), num);
+}
+
 void Person_Relations::startRelationshipIteration()
 {
 	assert(!m_relIterationBusy);
@@ -13,11 +13,14 @@ class ConfigWriter;
 class GslRandomNumberGenerator;
 class ProbabilityDistribution;
 class ProbabilityDistribution2D;
+struct PersonInitialValues;
 
 class Person_Relations
 {
 public:
 	Person_Relations(const Person *pSelf);
+	// Uses the values at position idx instead of picking them, see Person::pickInitialValues
+	Person_Relations(const Person *pSelf, const PersonInitialValues &values, size_t idx);
 	~Person_Relations();
 
 	// This also resets the iterator for getNextRelationshipPartner
@@ -55,6 +58,10 @@ public:
 	static void writeToRelationLog(const Person *pMan, const Person *pWoman, double formationTime, double dissolutionTime);
 	static void processConfig(ConfigSettings &config, GslRandomNumberGenerator *pRndGen);
 	static void obtainConfig(ConfigWriter &config);
+
+	// Used by Person::pickInitialValues
+	static bool hasBulkPicking(bool man);
+	static void pickInitialValues(bool man, GslRandomNumberGenerator *pRndGen, size_t num, PersonInitialValues &values);
 private:
 	class Relationship
 	{
@@ -119,6 +126,7 @@ private:
 		                           const std::string &prefixGap, const std::string &homSuff);
 	};
 
+	void initRelationState();
 	void pickEagernessAndGap(const EagernessAndAgegap &e);
 
 	static EagernessAndAgegap m_eagAgeMan;
@@ -0,0 +1,64 @@
+#include "personattributetable.h"
+
+PersonAttributeTable::PersonAttributeTable()
+{
+	m_enabled = true;
+}
+
+PersonAttributeTable::~PersonAttributeTable()
+{
+}
+
+void PersonAttributeTable::reserve(int numSlots)
+{
+	assert(numSlots >= 0);
+
+	m_dateOfBirth.reserve(numSlots);
+	m_numRelations.reserve(numSlots);
+	m_eagerness.reserve(numSlots);
+	m_eagernessMSM.reserve(numSlots);
+	m_preferredAgeDiff.reserve(numSlots);
+	m_preferredAgeDiffMSM.reserve(numSlots);
+}
+
+int PersonAttributeTable::allocateSlot(double dateOfBirth, int numRelations, double eagerness, double eagernessMSM,
+	                                   double preferredAgeDiff, double preferredAgeDiffMSM)
+{
+	int slot;
+
+	// Reuse the slots of deceased persons so that the columns stay compact
+	if (m_freeSlots.size() > 0)
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		slot = (int)m_dateOfBirth.size();
+
+		m_dateOfBirth.resize(slot+1);
+		m_numRelations.resize(slot+1);
+		m_eagerness.resize(slot+1);
+		m_eagernessMSM.resize(slot+1);
+		m_preferredAgeDiff.resize(slot+1);
+		m_preferredAgeDiffMSM.resize(slot+1);
+	}
+
+	m_dateOfBirth[slot] = dateOfBirth;
+	m_numRelations[slot] = numRelations;
+	m_eagerness[slot] = eagerness;
+	m_eagernessMSM[slot] = eagernessMSM;
+	m_preferredAgeDiff[slot] = preferredAgeDiff;
+	m_preferredAgeDiffMSM[slot] = preferredAgeDiffMSM;
+
+	return slot;
+}
+
+void PersonAttributeTable::releaseSlot(int slot)
+{
+	assert(isValid(slot));
+	assert(m_freeSlots.size() < m_dateOfBirth.size());
+
+	m_freeSlots.push_back(slot);
+}
+
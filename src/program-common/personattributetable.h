@@ -0,0 +1,98 @@
+#ifndef PERSONATTRIBUTETABLE_H
+
+#define PERSONATTRIBUTETABLE_H
+
+#include <assert.h>
+#include <vector>
+
+// Structure-of-arrays copy of the person attributes that are read over and
+// over again by the formation hazards: date of birth, number of relationships,
+// formation eagerness and preferred age difference (both hetero and MSM).
+// A living person gets a slot in the population's table when it is added to
+// the population, and the slot is released again when the person dies. The
+// relationship count is kept in sync by Person::addRelationship and
+// Person::removeRelationship, the other values never change during a person's
+// lifetime.
+//
+// While the simulation is running, the table is only modified from within
+// an event's 'fire' function, so hazard calculations in several threads
+// may read from it concurrently.
+//
+// The table is always kept up to date, but the hazards only read from it
+// when it's enabled (see the 'population.attributetable' config setting),
+// otherwise the values are taken from the Person instances.
+class PersonAttributeTable
+{
+public:
+	PersonAttributeTable();
+	~PersonAttributeTable();
+
+	void reserve(int numSlots);
+
+	int allocateSlot(double dateOfBirth, int numRelations, double eagerness, double eagernessMSM,
+	                 double preferredAgeDiff, double preferredAgeDiffMSM);
+	void releaseSlot(int slot);
+
+	int getNumberOfSlots() const											{ return (int)m_dateOfBirth.size(); }
+	int getNumberOfUsedSlots() const										{ return (int)(m_dateOfBirth.size() - m_freeSlots.size()); }
+
+	double getDateOfBirth(int slot) const									{ assert(isValid(slot)); return m_dateOfBirth[slot]; }
+	int getNumberOfRelationships(int slot) const							{ assert(isValid(slot)); return m_numRelations[slot]; }
+	double getFormationEagerness(int slot) const							{ assert(isValid(slot)); return m_eagerness[slot]; }
+	double getFormationEagernessMSM(int slot) const							{ assert(isValid(slot)); return m_eagernessMSM[slot]; }
+	double getPreferredAgeDifference(int slot) const						{ assert(isValid(slot)); return m_preferredAgeDiff[slot]; }
+	double getPreferredAgeDifferenceMSM(int slot) const						{ assert(isValid(slot)); return m_preferredAgeDiffMSM[slot]; }
+
+	void setNumberOfRelationships(int slot, int n)							{ assert(isValid(slot)); assert(n >= 0); m_numRelations[slot] = n; }
+
+	// Retrieves the values needed by the formation hazards for the pair of
+	// persons in slots 'slot1' and 'slot2'; the MSM sign conventions of the
+	// hazards are not applied here
+	void getFormationPairValues(int slot1, int slot2, bool msm, double &Pi, double &Pj,
+	                            double &tBi, double &tBj, double &Dpi, double &Dpj) const;
+	void getFormationPairEagerness(int slot1, int slot2, bool msm, double &a0i, double &a0j) const;
+
+	void setEnabled(bool f)													{ m_enabled = f; }
+	bool isEnabled() const													{ return m_enabled; }
+private:
+	bool isValid(int slot) const											{ return slot >= 0 && slot < (int)m_dateOfBirth.size(); }
+
+	std::vector<double> m_dateOfBirth;
+	std::vector<int> m_numRelations;
+	std::vector<double> m_eagerness;
+	std::vector<double> m_eagernessMSM;
+	std::vector<double> m_preferredAgeDiff;
+	std::vector<double> m_preferredAgeDiffMSM;
+
+	std::vector<int> m_freeSlots;
+
+	bool m_enabled;
+};
+
+inline void PersonAttributeTable::getFormationPairValues(int slot1, int slot2, bool msm, double &Pi, double &Pj,
+                                                         double &tBi, double &tBj, double &Dpi, double &Dpj) const
+{
+	assert(isValid(slot1) && isValid(slot2));
+
+	Pi = m_numRelations[slot1];
+	Pj = m_numRelations[slot2];
+	tBi = m_dateOfBirth[slot1];
+	tBj = m_dateOfBirth[slot2];
+
+	const std::vector<double> &gaps = (msm) ? m_preferredAgeDiffMSM : m_preferredAgeDiff;
+
+	Dpi = gaps[slot1];
+	Dpj = gaps[slot2];
+}
+
+inline void PersonAttributeTable::getFormationPairEagerness(int slot1, int slot2, bool msm, double &a0i, double &a0j) const
+{
+	assert(isValid(slot1) && isValid(slot2));
+
+	const std::vector<double> &eagerness = (msm) ? m_eagernessMSM : m_eagerness;
+
+	a0i = eagerness[slot1];
+	a0j = eagerness[slot2];
+}
+
+#endif // PERSONATTRIBUTETABLE_H
@@ -0,0 +1,46 @@
+#ifndef PERSONINITIALVALUES_H
+
+#define PERSONINITIALVALUES_H
+
+#include "point2d.h"
+#include <vector>
+
+// The values that are picked at random when a person is created, stored per
+// value for a block of people. When the initial population is created in
+// parallel, these arrays are filled in by Person::pickInitialValues, using
+// the random number generator of the block, and a person is then created from
+// an entry of them.
+struct PersonInitialValues
+{
+	void resize(size_t num)
+	{
+		m_location.resize(num);
+		m_eagernessHetero.resize(num);
+		m_eagernessHomo.resize(num);
+		m_ageGapHetero.resize(num);
+		m_ageGapHomo.resize(num);
+		m_artAcceptanceThreshold.resize(num);
+		m_log10SurvTimeOffset.resize(num);
+		m_hazardB0Param.resize(num);
+		m_hazardB1Param.resize(num);
+		m_hsv2AParam.resize(num);
+		m_hsv2B2Param.resize(num);
+	}
+
+	std::vector<Point2D> m_location;
+
+	std::vector<double> m_eagernessHetero;
+	std::vector<double> m_eagernessHomo;
+	std::vector<double> m_ageGapHetero;
+	std::vector<double> m_ageGapHomo;
+
+	std::vector<double> m_artAcceptanceThreshold;
+	std::vector<double> m_log10SurvTimeOffset;
+	std::vector<double> m_hazardB0Param;
+	std::vector<double> m_hazardB1Param;
+
+	std::vector<double> m_hsv2AParam;
+	std::vector<double> m_hsv2B2Param;
+};
+
+#endif // PERSONINITIALVALUES_H
@@ -0,0 +1,105 @@
+#include "populationaggregates.h"
+#include "person.h"
+
+PopulationAggregates::PopulationAggregates()
+{
+	for (int i = 0 ; i <= Person_HIV::AIDSFinal ; i++)
+		m_numInStage[i] = 0;
+
+	m_numDiagnosed = 0;
+	m_numOnTreatment = 0;
+	m_numHSV2Infected = 0;
+	m_numRelationshipEnds = 0;
+	m_totalHIVInfections = 0;
+	m_totalHSV2Infections = 0;
+	m_totalRelationshipEnds = 0;
+}
+
+PopulationAggregates::~PopulationAggregates()
+{
+}
+
+void PopulationAggregates::addPerson(Person *pPerson)
+{
+	assert(pPerson != 0);
+	assert(!pPerson->hasDied());
+
+	int idx = getBirthDateIndex(pPerson->getGender()).add(pPerson->getDateOfBirth());
+	pPerson->setAggregatesIndex(idx);
+
+	// Usually a new person won't be infected yet, but let's not assume anything
+	const Person_HIV &hiv = pPerson->hiv();
+
+	if (hiv.isInfected())
+	{
+		onHIVStageChange(Person_HIV::NoInfection, hiv.getInfectionStage());
+		if (hiv.isDiagnosed())
+			onHIVDiagnosis();
+		if (hiv.hasLoweredViralLoad())
+			onTreatmentStart();
+	}
+
+	if (pPerson->hsv2().isInfected())
+		onHSV2Infection();
+
+	m_numRelationshipEnds += pPerson->getNumberOfRelationships();
+}
+
+void PopulationAggregates::removePerson(Person *pPerson)
+{
+	assert(pPerson != 0);
+
+	getBirthDateIndex(pPerson->getGender()).remove(pPerson->getAggregatesIndex());
+	pPerson->setAggregatesIndex(-1);
+
+	const Person_HIV &hiv = pPerson->hiv();
+
+	if (hiv.isInfected())
+	{
+		m_numInStage[hiv.getInfectionStage()]--;
+		assert(m_numInStage[hiv.getInfectionStage()] >= 0);
+
+		if (hiv.isDiagnosed())
+			m_numDiagnosed--;
+		if (hiv.hasLoweredViralLoad())
+			onTreatmentStop();
+	}
+
+	if (pPerson->hsv2().isInfected())
+		m_numHSV2Infected--;
+
+	// The partners have already removed the relationships with this person,
+	// but this person's own relationship list isn't cleared
+	m_numRelationshipEnds -= pPerson->getNumberOfRelationships();
+
+	assert(m_numDiagnosed >= 0 && m_numHSV2Infected >= 0 && m_numRelationshipEnds >= 0);
+}
+
+void PopulationAggregates::onHIVStageChange(Person_HIV::InfectionStage oldStage, Person_HIV::InfectionStage newStage)
+{
+	assert(newStage != Person_HIV::NoInfection);
+
+	if (oldStage == Person_HIV::NoInfection)
+		m_totalHIVInfections++;
+	else
+	{
+		m_numInStage[oldStage]--;
+		assert(m_numInStage[oldStage] >= 0);
+	}
+
+	m_numInStage[newStage]++;
+}
+
+int PopulationAggregates::getNumberOfPeople(PersonBase::Gender g, double minAge, double maxAge, double t) const
+{
+	assert(minAge <= maxAge);
+
+	// Restoring the order doesn't change the counts, so this is still
+	// conceptually a const function
+	BirthDateIndex &index = const_cast<PopulationAggregates *>(this)->getBirthDateIndex(g);
+	if (!index.isSorted())
+		index.sort();
+
+	// An age in [minAge, maxAge) means a date of birth in (t-maxAge, t-minAge]
+	return index.countUpTo(t - minAge) - index.countUpTo(t - maxAge);
+}
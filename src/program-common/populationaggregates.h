@@ -0,0 +1,80 @@
+#ifndef POPULATIONAGGREGATES_H
+
+#define POPULATIONAGGREGATES_H
+
+#include "personbase.h"
+#include "person_hiv.h"
+#include "birthdateindex.h"
+#include <assert.h>
+#include <vector>
+
+class Person;
+
+// Counts of the living population that are kept up to date during the
+// simulation, so that they never need to be obtained by walking over all
+// persons. A person is added when it becomes part of the population and
+// removed again when it dies. In between, Person_HIV, Person_HSV2 and Person
+// report the changes to the infection stage, diagnosis, treatment and
+// relationships, each in constant time.
+//
+// The number of persons in an age band changes as time passes without any
+// event taking place, so for each gender the dates of birth are kept in a
+// BirthDateIndex. Such a count then takes logarithmic time.
+//
+// Like PersonAttributeTable, this is only modified from within an event's
+// 'fire' function.
+class PopulationAggregates
+{
+public:
+	PopulationAggregates();
+	~PopulationAggregates();
+
+	void addPerson(Person *pPerson);
+	void removePerson(Person *pPerson);
+
+	// Called by Person_HIV, Person_HSV2 and Person
+	void onHIVStageChange(Person_HIV::InfectionStage oldStage, Person_HIV::InfectionStage newStage);
+	void onHIVDiagnosis()															{ m_numDiagnosed++; }
+	void onTreatmentStart()															{ m_numOnTreatment++; }
+	void onTreatmentStop()															{ m_numOnTreatment--; assert(m_numOnTreatment >= 0); }
+	void onHSV2Infection()															{ m_numHSV2Infected++; m_totalHSV2Infections++; }
+	void onRelationshipAdded()														{ m_numRelationshipEnds++; m_totalRelationshipEnds++; }
+	void onRelationshipRemoved()													{ m_numRelationshipEnds--; assert(m_numRelationshipEnds >= 0); }
+
+	// Number of living men or women with an age in [minAge, maxAge) at time t
+	int getNumberOfPeople(PersonBase::Gender g, double minAge, double maxAge, double t) const;
+
+	int getNumberOfHIVInfected() const;
+	int getNumberOfHIVInfected(Person_HIV::InfectionStage stage) const				{ assert(stage != Person_HIV::NoInfection); return m_numInStage[stage]; }
+	int getNumberOfDiagnosed() const												{ return m_numDiagnosed; }
+	int getNumberOnTreatment() const												{ return m_numOnTreatment; }
+	int getNumberOfHSV2Infected() const												{ return m_numHSV2Infected; }
+	int getNumberOfRelationships() const											{ assert(m_numRelationshipEnds % 2 == 0); return m_numRelationshipEnds/2; }
+
+	// These also include the infections and relationships of persons that have
+	// died since, so that the number of new ones in a time interval follows from
+	// the difference
+	int64_t getTotalHIVInfections() const											{ return m_totalHIVInfections; }
+	int64_t getTotalHSV2Infections() const											{ return m_totalHSV2Infections; }
+	int64_t getTotalRelationshipsFormed() const										{ assert(m_totalRelationshipEnds % 2 == 0); return m_totalRelationshipEnds/2; }
+private:
+	BirthDateIndex &getBirthDateIndex(PersonBase::Gender g)							{ assert(g == PersonBase::Male || g == PersonBase::Female); return (g == PersonBase::Male)?m_men:m_women; }
+
+	BirthDateIndex m_men, m_women;
+
+	int m_numInStage[Person_HIV::AIDSFinal+1];
+	int m_numDiagnosed;
+	int m_numOnTreatment;
+	int m_numHSV2Infected;
+	int m_numRelationshipEnds;	// each relationship is counted for both partners
+	int64_t m_totalHIVInfections;
+	int64_t m_totalHSV2Infections;
+	int64_t m_totalRelationshipEnds;
+};
+
+inline int PopulationAggregates::getNumberOfHIVInfected() const
+{
+	return m_numInStage[Person_HIV::Acute] + m_numInStage[Person_HIV::Chronic] + m_numInStage[Person_HIV::AIDS] + m_numInStage[Person_HIV::AIDSFinal];
+}
+
+#endif // POPULATIONAGGREGATES_H
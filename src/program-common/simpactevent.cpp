@@ -16,6 +16,10 @@ void getPersonProperties(double t, const Person *pPerson, std::string &name, int
 void SimpactEvent::writeEventLogStart(bool noExtraInfo, const std::string &eventName, double t, 
 		                      const Person *pPerson1, const Person *pPerson2)
 {
+	// Don't bother formatting anything if the event log is disabled
+	if (!LogEvent.isOpen())
+		return;
+
 	// time,eventname,name p1, id1, gender1, age1, name p2, id2, gender2, age2
 	string format = "%10.10f,%s,%s,%d,%d,%10.10f,%s,%d,%d,%10.10f";
 	string name1 = "(none)";
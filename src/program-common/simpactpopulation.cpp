@@ -12,6 +12,7 @@
 #include "eventsyncrefyear.h"
 #include "eventcheckstopalgorithm.h"
 #include "eventrelocation.h"
+#include "summarystatistics.h"
 #include "populationdistribution.h"
 #include "populationalgorithmadvanced.h"
 #include "populationalgorithmsimple.h"
@@ -24,6 +25,11 @@
 #include "fixedvaluedistribution2d.h"
 #include "util.h"
 #include "jsonconfig.h"
+#include "eventtracer.h"
+#ifndef DISABLEOPENMP
+#include <omp.h>
+#endif // !DISABLEOPENMP
+#include <algorithm>
 
 using namespace std;
 
@@ -33,6 +39,8 @@ SimpactPopulationConfig::SimpactPopulationConfig()
 	m_initialWomen = 100;
 	m_eyeCapsFraction = 1;
 	m_msm = false;
+	m_parallelInit = false;
+	m_useAttributeTable = true;
 }
 
 SimpactPopulationConfig::~SimpactPopulationConfig()
@@ -48,9 +56,11 @@ SimpactPopulation::SimpactPopulation(PopulationAlgorithmInterface &alg, Populati
 	//m_initialPopulationSize = -1;
 	m_lastKnownPopulationSize = -1;
 	m_lastKnownPopulationSizeTime = -1;
+	m_lastKnownPopulationSizeVersion = 0;
 	m_referenceYear = 0;
 	m_eyeCapsFraction = 1;
 	m_msm = false;
+	m_parallelInit = false;
 	m_pCoarseMap = 0;
 	
 
@@ -72,6 +82,8 @@ bool_t SimpactPopulation::init(const SimpactPopulationConfig &config, const Popu
 
 	m_eyeCapsFraction = eyeCapsFraction;
 	m_msm = config.getMSM();
+	m_parallelInit = config.getParallelInitialization();
+	m_attributeTable.setEnabled(config.getUseAttributeTable());
 
 	bool_t r;
 	if (!(r = createInitialPopulation(config, popDist)))
@@ -104,8 +116,19 @@ bool_t SimpactPopulation::createInitialPopulation(const SimpactPopulationConfig
 	if (numMen < 0 || numWomen < 0)
 		return "The number of men and women must be at least zero";
 
+	m_attributeTable.reserve(numMen + numWomen);
+
 	// Time zero is at the start of the simulation, so the birth dates are negative
 
+	if (m_parallelInit && popDist.hasBulkPicking() && Person::hasBulkPicking(Person::Male) && Person::hasBulkPicking(Person::Female))
+	{
+		createInitialPeopleInBlocks(popDist, true, numMen);
+		createInitialPeopleInBlocks(popDist, false, numWomen);
+
+		setLastKnownPopulationSize();
+		return true;
+	}
+
 	for (int i = 0 ; i < numMen ; i++)
 	{
 		double age = popDist.pickAge(true);
@@ -135,6 +158,166 @@ bool_t SimpactPopulation::createInitialPopulation(const SimpactPopulationConfig
 	return true;
 }
 
+// Like scheduleInitialEventsInBlocks below, the people are created in blocks of
+// fixed size, each with its own random number generator, of which the seed is
+// picked from the main one. In each block the ages are picked first, followed
+// by the other random values that are needed, one array at a time (see
+// Person::pickInitialValues). The people are added to the population in the
+// order of the blocks, so for a specific seed the result does not depend on
+// the number of threads that were used.
+void SimpactPopulation::createInitialPeopleInBlocks(const PopulationDistribution &popDist, bool male, int numPeople)
+{
+	const int blockSize = 256;
+	const int numBlocks = (numPeople+blockSize-1)/blockSize;
+	const Person::Gender gender = (male)?Person::Male:Person::Female;
+	const double debutAge = EventDebut::getDebutAge();
+	GslRandomNumberGenerator *pRndGen = getRandomNumberGenerator();
+	vector<int> seeds(numBlocks);
+	vector<vector<Person *> > blockPeople(numBlocks);
+
+	for (int b = 0 ; b < numBlocks ; b++)
+		seeds[b] = pRndGen->pickSubstreamSeed();
+
+#ifndef DISABLEOPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif // !DISABLEOPENMP
+	for (int b = 0 ; b < numBlocks ; b++)
+	{
+		GslRandomNumberGenerator blockRndGen(seeds[b], false);
+		const int num = std::min(numPeople, (b+1)*blockSize) - b*blockSize;
+		vector<double> ages(num);
+		PersonInitialValues values;
+
+		popDist.pickAges(&blockRndGen, male, &(ages[0]), num);
+		Person::pickInitialValues(gender, &blockRndGen, num, values);
+
+		vector<Person *> &people = blockPeople[b];
+		people.resize(num);
+		for (int i = 0 ; i < num ; i++)
+		{
+			if (male)
+				people[i] = new Man(-ages[i], values, i);
+			else
+				people[i] = new Woman(-ages[i], values, i);
+
+			if (ages[i] > debutAge)
+				people[i]->setSexuallyActive(0);
+		}
+	}
+
+	for (int b = 0 ; b < numBlocks ; b++)
+	{
+		vector<Person *> &people = blockPeople[b];
+
+		for (size_t i = 0 ; i < people.size() ; i++)
+			addNewPerson(people[i]);
+	}
+}
+
+// Used by the parallel initialization: creates the initial events that are
+// associated with a single item, e.g. a person
+class SimpactPopulation::InitialEventCreator
+{
+public:
+	InitialEventCreator()													{ }
+	virtual ~InitialEventCreator()											{ }
+
+	// Must be safe to call from several threads at once
+	virtual void createEvents(int item, vector<PopulationEvent *> &events) = 0;
+};
+
+class MortalityEventCreator : public SimpactPopulation::InitialEventCreator
+{
+public:
+	MortalityEventCreator(Person **ppPeople) : m_ppPeople(ppPeople)			{ }
+
+	void createEvents(int item, vector<PopulationEvent *> &events)			{ events.push_back(new EventMortality(m_ppPeople[item])); }
+private:
+	Person **m_ppPeople;
+};
+
+class DebutEventCreator : public SimpactPopulation::InitialEventCreator
+{
+public:
+	DebutEventCreator(Person **ppPeople) : m_ppPeople(ppPeople)				{ }
+
+	void createEvents(int item, vector<PopulationEvent *> &events)
+	{
+		Person *pPerson = m_ppPeople[item];
+		if (!pPerson->isSexuallyActive())
+			events.push_back(new EventDebut(pPerson));
+	}
+private:
+	Person **m_ppPeople;
+};
+
+class FormationEventCreator : public SimpactPopulation::InitialEventCreator
+{
+public:
+	FormationEventCreator(Woman **ppWomen, const vector<Man *> &activeMen) : m_ppWomen(ppWomen), m_activeMen(activeMen) { }
+
+	void createEvents(int item, vector<PopulationEvent *> &events)
+	{
+		Woman *pWoman = m_ppWomen[item];
+		assert(pWoman->getGender() == Person::Female);
+
+		if (!pWoman->isSexuallyActive())
+			return;
+
+		assert(pWoman->hiv().getInfectionStage() != Person_HIV::AIDSFinal);
+
+		for (size_t i = 0 ; i < m_activeMen.size() ; i++)
+			events.push_back(new EventFormation(m_activeMen[i], pWoman, -1, 0));
+	}
+private:
+	Woman **m_ppWomen;
+	const vector<Man *> &m_activeMen;
+};
+
+// The items are divided into blocks of fixed size, and each block gets its own
+// random number generator, of which the seed is picked from the main one. The
+// blocks are processed in parallel and the resulting events are then passed to
+// the algorithm in the order of the blocks, so for a specific seed the result
+// does not depend on the number of threads that were used.
+void SimpactPopulation::scheduleInitialEventsInBlocks(InitialEventCreator &creator, int numItems)
+{
+	const int blockSize = 64;
+	const int numBlocks = (numItems+blockSize-1)/blockSize;
+	const State *pState = &m_state;
+	GslRandomNumberGenerator *pRndGen = getRandomNumberGenerator();
+	vector<int> seeds(numBlocks);
+	vector<vector<PopulationEvent *> > blockEvents(numBlocks);
+
+	for (int b = 0 ; b < numBlocks ; b++)
+		seeds[b] = pRndGen->pickSubstreamSeed();
+
+#ifndef DISABLEOPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif // !DISABLEOPENMP
+	for (int b = 0 ; b < numBlocks ; b++)
+	{
+		GslRandomNumberGenerator blockRndGen(seeds[b], false);
+		vector<PopulationEvent *> &events = blockEvents[b];
+		int endItem = std::min(numItems, (b+1)*blockSize);
+
+		for (int i = b*blockSize ; i < endItem ; i++)
+			creator.createEvents(i, events);
+
+		for (size_t i = 0 ; i < events.size() ; i++)
+			events[i]->generateNewInternalTimeDifference(&blockRndGen, pState);
+	}
+
+	for (int b = 0 ; b < numBlocks ; b++)
+	{
+		vector<PopulationEvent *> &events = blockEvents[b];
+
+		if (events.size() > 0)
+			m_alg.onNewEvents(&(events[0]), (int)events.size());
+
+		vector<PopulationEvent *>().swap(events); // frees the memory
+	}
+}
+
 bool_t SimpactPopulation::scheduleInitialEvents()
 {
 	int numMen = getNumberOfMen();
@@ -147,23 +330,50 @@ bool_t SimpactPopulation::scheduleInitialEvents()
 
 	// Initialize the event list with the mortality events
 	// both normal and AIDS based
-	for (int i = 0 ; i < numPeople ; i++)
+	if (m_parallelInit)
 	{
-		Person *pPerson = ppPeople[i];
+		MortalityEventCreator mortalityCreator(ppPeople);
+		scheduleInitialEventsInBlocks(mortalityCreator, numPeople);
+	}
+	else
+	{
+		for (int i = 0 ; i < numPeople ; i++)
+		{
+			Person *pPerson = ppPeople[i];
 
-		EventMortality *pEvt = new EventMortality(pPerson);
-		onNewEvent(pEvt);
+			EventMortality *pEvt = new EventMortality(pPerson);
+			onNewEvent(pEvt);
+		}
 	}
 	
 	// Relationship formation. For heterosexual relations, we'll only process 
 	// the women, the events for the men are scheduled automatically
-	for (int i = 0 ; i < numWomen ; i++)
+	if (m_parallelInit && m_eyeCapsFraction >= 1.0)
 	{
-		Woman *pWoman = ppWomen[i];
-		assert(pWoman->getGender() == Person::Female);
+		// Same as initializeFormationEvents for a woman in the initialization phase
+		vector<Man *> activeMen;
+
+		for (int i = 0 ; i < numMen ; i++)
+		{
+			Man *pMan = ppMen[i];
+
+			if (pMan->isSexuallyActive() && pMan->hiv().getInfectionStage() != Person_HIV::AIDSFinal)
+				activeMen.push_back(pMan);
+		}
+
+		FormationEventCreator formationCreator(ppWomen, activeMen);
+		scheduleInitialEventsInBlocks(formationCreator, numWomen);
+	}
+	else
+	{
+		for (int i = 0 ; i < numWomen ; i++)
+		{
+			Woman *pWoman = ppWomen[i];
+			assert(pWoman->getGender() == Person::Female);
 
-		if (pWoman->isSexuallyActive())
-			initializeFormationEvents(pWoman, true, false, 0);
+			if (pWoman->isSexuallyActive())
+				initializeFormationEvents(pWoman, true, false, 0);
+		}
 	}
 
 	// For MSM relations, TODO: check this!
@@ -181,14 +391,22 @@ bool_t SimpactPopulation::scheduleInitialEvents()
 
 	// For the people who are not sexually active, set a debut event
 
-	for (int i = 0 ; i < numPeople ; i++)
+	if (m_parallelInit)
 	{
-		Person *pPerson = ppPeople[i];
-
-		if (!pPerson->isSexuallyActive())
+		DebutEventCreator debutCreator(ppPeople);
+		scheduleInitialEventsInBlocks(debutCreator, numPeople);
+	}
+	else
+	{
+		for (int i = 0 ; i < numPeople ; i++)
 		{
-			EventDebut *pEvt = new EventDebut(pPerson);
-			onNewEvent(pEvt);
+			Person *pPerson = ppPeople[i];
+
+			if (!pPerson->isSexuallyActive())
+			{
+				EventDebut *pEvt = new EventDebut(pPerson);
+				onNewEvent(pEvt);
+			}
 		}
 	}
 
@@ -262,6 +480,11 @@ void SimpactPopulation::onAboutToFire(PopulationEvent *pEvt)
 
 //	std::cout << t << "\t" << pEvent->getDescription(t) << std::endl;
 
+	TraceSpan span("writeLogs");
+
+	if (SummaryStatistics::isEnabled())
+		SummaryStatistics::onAboutToFire(*this, t);
+
 	pEvent->writeLogs(*this, t);
 }
 
@@ -605,6 +828,7 @@ void SimpactPopulation::setLastKnownPopulationSize()
 
 	m_lastKnownPopulationSizeTime = t;
 	m_lastKnownPopulationSize = getNumberOfPeople();
+	m_lastKnownPopulationSizeVersion++;
 }
 
 void SimpactPopulation::removePersonFromCoarseMap(Person *pPerson)
@@ -628,6 +852,7 @@ JSONConfig populationJSONConfig(R"JSON(
                 ["population.simtime", 15],
                 ["population.maxevents", -1],
                 ["population.agedistfile", "${SIMPACT_DATA_DIR}sa_2003.csv"],
+                ["population.agedistsampler", "auto", [ "auto", "search", "alias" ] ],
 				["population.msm", "no" ] ],
             "info": [
                 "By default, the 'maxevents' parameter is negative, causing it to be",
@@ -647,5 +872,28 @@ JSONConfig populationJSONConfig(R"JSON(
                 "only used in the initial scheduling of formation events, but also ",
                 "when a debut event fires, to limit the newly scheduled formation events."
             ]  
+        },
+
+        "Population_3": { 
+            "depends": null,
+            "params": [ ["population.parallelinit", "no"] ],
+            "info": [ 
+                "If enabled, the initial mortality, debut and (if 'population.eyecap.fraction'",
+                "is 1) formation events are created in parallel, with the random numbers for",
+                "their internal times coming from a separate random number generator for each",
+                "block of persons. For a specific seed, the results do not depend on the number",
+                "of threads, but will differ from the results without this setting."
+            ]  
+        },
+
+        "Population_4": { 
+            "depends": null,
+            "params": [ ["population.attributetable", "yes"] ],
+            "info": [ 
+                "If enabled, the formation hazards read the person attributes they need",
+                "from a compact table that's stored in the population, and the 'agegap'",
+                "formation hazard calculates the event times of several events at once.",
+                "The results are the same with or without this setting."
+            ]  
         })JSON");
 
@@ -5,6 +5,8 @@
 #include "populationinterfaces.h"
 #include "person.h"
 #include "coarsemap.h"
+#include "personattributetable.h"
+#include "populationaggregates.h"
 #include <assert.h>
 
 class PopulationDistribution;
@@ -22,15 +24,21 @@ public:
 	void setInitialWomen(int number)								{ m_initialWomen = number; }
 	void setEyeCapsFraction(double f)								{ m_eyeCapsFraction = f; }
 	void setMSM(bool f)												{ m_msm = f; }
+	void setParallelInitialization(bool f)							{ m_parallelInit = f; }
+	void setUseAttributeTable(bool f)								{ m_useAttributeTable = f; }
 
 	int getInitialMen() const										{ return m_initialMen; }
 	int getInitialWomen() const										{ return m_initialWomen; }
 	double getEyeCapsFraction() const								{ return m_eyeCapsFraction; }
 	bool getMSM() const												{ return m_msm; }
+	bool getParallelInitialization() const							{ return m_parallelInit; }
+	bool getUseAttributeTable() const								{ return m_useAttributeTable; }
 private:
 	int m_initialMen, m_initialWomen;
 	double m_eyeCapsFraction;
 	bool m_msm;
+	bool m_parallelInit;
+	bool m_useAttributeTable;
 };
 
 class SimpactPopulation : public PopulationStateExtra, public PopulationAlgorithmAboutToFireInterface
@@ -42,6 +50,7 @@ public:
 	virtual bool_t init(const SimpactPopulationConfig &popConfig, const PopulationDistribution &popDist);
 
 	bool_t run(double &tMax, int64_t &maxEvents, double startTime = 0) { return m_alg.run(tMax, maxEvents, startTime); }
+	int64_t getNumberOfRejectedCandidates() const { return m_alg.getNumberOfRejectedCandidates(); }
 
 	Person **getAllPeople()						{ return reinterpret_cast<Person**>(m_state.getAllPeople()); }
 	Man **getMen()								{ return reinterpret_cast<Man**>(m_state.getMen()); }
@@ -63,6 +72,8 @@ public:
 
 	int getLastKnownPopulationSize(double &popTime) const			{ popTime = m_lastKnownPopulationSizeTime; assert(popTime >= 0); assert(m_lastKnownPopulationSize >= 0); return m_lastKnownPopulationSize; }
 	void setLastKnownPopulationSize();
+	// Is increased every time setLastKnownPopulationSize is called
+	int getPopulationSizeVersion() const							{ return m_lastKnownPopulationSizeVersion; }
 
 	double getReferenceYear() const									{ return m_referenceYear; }
 	void setReferenceYear(double t)									{ assert(t >= 0); m_referenceYear = t; }
@@ -75,20 +86,39 @@ public:
 	// Needed by relocation event
 	void removePersonFromCoarseMap(Person *pPerson);
 	void addPersonToCoarseMap(Person *pPerson);
+
+	// Frequently used person attributes, stored per slot for the hazard calculations.
+	// The table is enabled or disabled by 'population.attributetable', the setter
+	// is mainly useful for benchmarks
+	const PersonAttributeTable &getAttributeTable() const			{ return m_attributeTable; }
+	void setAttributeTableEnabled(bool f)							{ m_attributeTable.setEnabled(f); }
+
+	// Counts of the living population (by age band, infection stage, treatment,
+	// relationships, ...) that are kept up to date as the events fire
+	const PopulationAggregates &getAggregates() const				{ return m_aggregates; }
+
+	// Used when 'population.parallelinit' is enabled, creates the initial
+	// events for a single person
+	class InitialEventCreator;
 protected:
 	virtual bool_t createInitialPopulation(const SimpactPopulationConfig &config, const PopulationDistribution &popDist);
 	virtual bool_t scheduleInitialEvents();
 	virtual void getInterestsForPerson(const Person *pPerson, std::vector<Person *> &interests, std::vector<Person *> &interestsMSM);
 private:
+	void createInitialPeopleInBlocks(const PopulationDistribution &popDist, bool male, int numPeople);
+	void scheduleInitialEventsInBlocks(InitialEventCreator &creator, int numItems);
+
 	void onAboutToFire(PopulationEvent *pEvt);
 
 	//int m_initialPopulationSize;
 	double m_eyeCapsFraction;
 	double m_referenceYear;
 	bool m_msm;
+	bool m_parallelInit;
 
 	int m_lastKnownPopulationSize;
 	double m_lastKnownPopulationSizeTime;
+	int m_lastKnownPopulationSizeVersion;
 
 	bool m_init;
 	
@@ -96,6 +126,8 @@ private:
 	PopulationAlgorithmInterface &m_alg;
 
 	CoarseMap *m_pCoarseMap;
+	PersonAttributeTable m_attributeTable;
+	PopulationAggregates m_aggregates;
 };
 
 inline SimpactPopulation &SIMPACTPOPULATION(State *pState)
@@ -117,6 +149,8 @@ inline const SimpactPopulation &SIMPACTPOPULATION(const State *pState)
 inline void SimpactPopulation::addNewPerson(Person *pPerson)	
 { 
 	m_state.addNewPerson(pPerson); 
+	pPerson->registerInAttributeTable(&m_attributeTable);
+	pPerson->registerInAggregates(&m_aggregates);
 
 	if (m_pCoarseMap)
 		m_pCoarseMap->addPerson(pPerson);
@@ -128,6 +162,8 @@ inline void SimpactPopulation::setPersonDied(Person *pPerson)
 		m_pCoarseMap->removePerson(pPerson);
 
 	m_state.setPersonDied(pPerson); 
+	pPerson->unregisterFromAttributeTable();
+	pPerson->unregisterFromAggregates();
 }
 
 #endif // SIMPACTPOPULATION_H
@@ -0,0 +1,827 @@
+#include "simpactserver.h"
+#include "signalhandlers.h"
+#include "jsonconfig.h"
+#include "configsettings.h"
+#include "csvfile.h"
+#include "discretedistributionwrapper2d.h"
+#include "util.h"
+#include "version.h"
+#include <iostream>
+
+using namespace std;
+
+#ifdef WIN32
+
+int runSimpactServer(int maxRuns, const string &socketPath, SimulationFunction runFunction)
+{
+	cerr << "The server mode is currently not supported on Windows" << endl;
+	return -1;
+}
+
+#else
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <map>
+#include <vector>
+#ifndef DISABLEOPENMP
+#include <omp.h>
+#include <thread>
+#endif // !DISABLEOPENMP
+
+// The settings of a single run, as read from a 'run' ... 'end' block
+class RunRequest
+{
+public:
+	RunRequest() : m_parallel(false), m_algo("opt"), m_invalid(false)			{ }
+
+	string m_id;
+	string m_configFile;
+	string m_directory;
+	string m_outputFile;
+	bool m_parallel;
+	string m_algo;
+	vector<pair<string, string> > m_environment;
+	bool m_invalid;
+};
+
+// Sets environment variables, and restores the previous values when it's destroyed
+class ScopedEnvironment
+{
+public:
+	ScopedEnvironment(const vector<pair<string, string> > &variables);
+	~ScopedEnvironment();
+private:
+	vector<pair<string, string> > m_oldValues;
+	vector<bool> m_wasSet;
+};
+
+ScopedEnvironment::ScopedEnvironment(const vector<pair<string, string> > &variables)
+{
+	for (size_t i = 0 ; i < variables.size() ; i++)
+	{
+		const char *pOldValue = getenv(variables[i].first.c_str());
+
+		m_oldValues.push_back(pair<string, string>(variables[i].first, (pOldValue)?string(pOldValue):string()));
+		m_wasSet.push_back(pOldValue != 0);
+		setenv(variables[i].first.c_str(), variables[i].second.c_str(), 1);
+	}
+}
+
+ScopedEnvironment::~ScopedEnvironment()
+{
+	// In reverse order, in case a variable was set more than once
+	for (size_t i = m_oldValues.size() ; i > 0 ; i--)
+	{
+		if (m_wasSet[i-1])
+			setenv(m_oldValues[i-1].first.c_str(), m_oldValues[i-1].second.c_str(), 1);
+		else
+			unsetenv(m_oldValues[i-1].first.c_str());
+	}
+}
+
+class SimpactServer
+{
+public:
+	SimpactServer(int maxRuns, SimulationFunction runFunction);
+	~SimpactServer();
+
+	bool_t init();
+
+	// Handles the requests on these file descriptors until the end of the input
+	// or a 'quit' or 'shutdown' command, and waits until all runs have finished.
+	// Returns true if the server should stop.
+	bool serveConnection(int inFd, int outFd, int listenFd);
+private:
+	bool handleLine(const string &line);
+	void handleRequestLine(const string &command, const string &argument);
+	void queueRequest();
+	void cancelRun(const string &id);
+	void startQueuedRuns();
+	void startPreload();
+	void finishPreload();
+	void preloadThread(RunRequest request);
+	void startRun(const RunRequest &request);
+	void runChild(const RunRequest &request);
+	void reapChildren();
+	void preloadDataFiles(const RunRequest &request);
+	void sendLine(const string &line);
+	void sendData(const string &data);
+
+	static string resolvePath(const string &directory, const string &path);
+	static void sigChildHandler(int sig);
+
+	int m_maxRuns;
+	SimulationFunction m_runFunction;
+	string m_optionsJSON;
+	int m_numThreads;
+
+	int m_inFd, m_outFd, m_listenFd;
+	string m_inputBuffer;
+	bool m_inRequest;
+	bool m_waitingForIdle;
+	RunRequest m_request;
+	deque<RunRequest> m_preloadQueue; // the first one is being loaded if m_preloading is set
+	deque<RunRequest> m_queue;
+	bool m_preloading;
+	bool m_preloadCancelled;
+#ifndef DISABLEOPENMP
+	thread m_preloadThread;
+#endif // !DISABLEOPENMP
+	int m_preloadPipe[2];
+	map<pid_t, string> m_runningIDs;
+
+	static int s_sigChildPipe[2];
+};
+
+int SimpactServer::s_sigChildPipe[2] = { -1, -1 };
+
+SimpactServer::SimpactServer(int maxRuns, SimulationFunction runFunction)
+{
+	m_maxRuns = maxRuns;
+	m_runFunction = runFunction;
+	m_numThreads = 1;
+	m_inFd = -1;
+	m_outFd = -1;
+	m_listenFd = -1;
+	m_inRequest = false;
+	m_waitingForIdle = false;
+	m_preloading = false;
+	m_preloadCancelled = false;
+	m_preloadPipe[0] = -1;
+	m_preloadPipe[1] = -1;
+}
+
+SimpactServer::~SimpactServer()
+{
+	signal(SIGCHLD, SIG_DFL);
+	for (int i = 0 ; i < 2 ; i++)
+	{
+		if (s_sigChildPipe[i] >= 0)
+			close(s_sigChildPipe[i]);
+		s_sigChildPipe[i] = -1;
+		if (m_preloadPipe[i] >= 0)
+			close(m_preloadPipe[i]);
+	}
+}
+
+bool_t SimpactServer::init()
+{
+	// A child that finishes writes a byte to this pipe, so that the main loop
+	// can wait for both input and finished runs using poll. The thread that
+	// loads the data files of a request does the same with the second pipe.
+	if (pipe(s_sigChildPipe) != 0 || pipe(m_preloadPipe) != 0)
+		return "Unable to create a pipe: " + string(strerror(errno));
+
+	for (int i = 0 ; i < 2 ; i++)
+	{
+		fcntl(s_sigChildPipe[i], F_SETFL, fcntl(s_sigChildPipe[i], F_GETFL) | O_NONBLOCK);
+		fcntl(s_sigChildPipe[i], F_SETFD, FD_CLOEXEC);
+		fcntl(m_preloadPipe[i], F_SETFL, fcntl(m_preloadPipe[i], F_GETFL) | O_NONBLOCK);
+		fcntl(m_preloadPipe[i], F_SETFD, FD_CLOEXEC);
+	}
+
+	signal(SIGCHLD, sigChildHandler);
+	signal(SIGPIPE, SIG_IGN); // a client that disconnects should not stop the server
+
+	m_optionsJSON = JSONConfig::getFullConfigurationString();
+	CSVFile::setCacheEnabled(true);
+	DiscreteDistributionWrapper2D::setCacheEnabled(true);
+
+	// Fork is not safe once the OpenMP threads have been started, so the server
+	// itself (e.g. when loading large CSV files) only uses a single thread. The
+	// original number is restored in each child.
+#ifndef DISABLEOPENMP
+	m_numThreads = omp_get_max_threads();
+	omp_set_num_threads(1);
+#endif // !DISABLEOPENMP
+	return true;
+}
+
+void SimpactServer::sigChildHandler(int sig)
+{
+	int oldErrno = errno;
+	char c = 0;
+	ssize_t num = write(s_sigChildPipe[1], &c, 1); // if the pipe is full, a notification is pending anyway
+
+	(void)num;
+	errno = oldErrno;
+}
+
+bool SimpactServer::serveConnection(int inFd, int outFd, int listenFd)
+{
+	m_inFd = inFd;
+	m_outFd = outFd;
+	m_listenFd = listenFd;
+	m_inputBuffer.clear();
+	m_inRequest = false;
+	m_waitingForIdle = false;
+
+	sendLine("ready " + string(SIMPACT_CYAN_VERSION));
+
+	bool inputDone = false;
+	bool stopServer = false;
+
+	while (true)
+	{
+		startPreload();
+		startQueuedRuns();
+
+		bool idle = (m_preloadQueue.empty() && m_queue.empty() && m_runningIDs.empty());
+
+		if (m_waitingForIdle && idle)
+		{
+			sendLine("idle");
+			m_waitingForIdle = false;
+		}
+
+		if (inputDone && idle)
+			break;
+
+		struct pollfd fds[3];
+		int numFds = 2;
+
+		fds[0].fd = s_sigChildPipe[0];
+		fds[0].events = POLLIN;
+		fds[1].fd = m_preloadPipe[0];
+		fds[1].events = POLLIN;
+		if (!inputDone)
+		{
+			fds[2].fd = m_inFd;
+			fds[2].events = POLLIN;
+			numFds = 3;
+		}
+
+		if (poll(fds, numFds, -1) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			abortWithMessage("Error waiting for input: " + string(strerror(errno)));
+		}
+
+		if (fds[0].revents & POLLIN)
+		{
+			char buf[256];
+			while (read(s_sigChildPipe[0], buf, sizeof(buf)) > 0)
+				;
+			reapChildren();
+		}
+
+		if (fds[1].revents & POLLIN)
+		{
+			char buf[256];
+			while (read(m_preloadPipe[0], buf, sizeof(buf)) > 0)
+				;
+			finishPreload();
+		}
+
+		if (numFds > 2 && fds[2].revents)
+		{
+			char buf[4096];
+			ssize_t num = read(m_inFd, buf, sizeof(buf));
+
+			if (num < 0 && errno == EINTR)
+				continue;
+
+			if (num <= 0) // end of input, or the connection was lost
+			{
+				inputDone = true;
+				continue;
+			}
+
+			m_inputBuffer.append(buf, (size_t)num);
+
+			size_t pos;
+			while (!inputDone && (pos = m_inputBuffer.find('\n')) != string::npos)
+			{
+				string line = m_inputBuffer.substr(0, pos);
+				m_inputBuffer.erase(0, pos + 1);
+
+				if (line.length() > 0 && line[line.length()-1] == '\r')
+					line = line.substr(0, line.length()-1);
+
+				if (!handleLine(line))
+				{
+					inputDone = true;
+					if (line == "shutdown")
+						stopServer = true;
+				}
+			}
+		}
+	}
+
+	// The runs of this connection are done, make sure the next connection
+	// doesn't get replies from an old SIGCHLD notification
+	reapChildren();
+	return stopServer;
+}
+
+// Returns false if no more input should be processed
+bool SimpactServer::handleLine(const string &line)
+{
+	string command = line;
+	string argument;
+	size_t pos = line.find(' ');
+
+	if (pos != string::npos)
+	{
+		command = line.substr(0, pos);
+		argument = line.substr(pos + 1);
+	}
+
+	if (m_inRequest)
+	{
+		handleRequestLine(command, argument);
+		return true;
+	}
+
+	if (command == "run")
+	{
+		if (argument.length() == 0 || argument.find(' ') != string::npos)
+		{
+			sendLine("error - A run request needs an identifier without spaces");
+			return true;
+		}
+
+		m_request = RunRequest();
+		m_request.m_id = argument;
+		m_inRequest = true;
+	}
+	else if (command == "options")
+	{
+		sendLine(strprintf("options %d", (int)m_optionsJSON.length()));
+		sendData(m_optionsJSON + "\n");
+	}
+	else if (command == "cancel")
+		cancelRun(argument);
+	else if (command == "wait")
+		m_waitingForIdle = true;
+	else if (command == "quit" || command == "shutdown")
+		return false;
+	else if (command.length() > 0 && command[0] != '#')
+		sendLine("error - Unknown command '" + command + "'");
+
+	return true;
+}
+
+void SimpactServer::handleRequestLine(const string &command, const string &argument)
+{
+	if (command == "config")
+		m_request.m_configFile = argument;
+	else if (command == "dir")
+		m_request.m_directory = argument;
+	else if (command == "output")
+		m_request.m_outputFile = argument;
+	else if (command == "parallel")
+		m_request.m_parallel = (atoi(argument.c_str()) == 1);
+	else if (command == "algo")
+		m_request.m_algo = argument;
+	else if (command == "env")
+	{
+		size_t pos = argument.find('=');
+		if (pos == string::npos || pos == 0)
+		{
+			sendLine("error " + m_request.m_id + " Expecting 'env NAME=VALUE'");
+			m_request.m_invalid = true;
+		}
+		else
+			m_request.m_environment.push_back(pair<string, string>(argument.substr(0, pos), argument.substr(pos + 1)));
+	}
+	else if (command == "end")
+	{
+		m_inRequest = false;
+		queueRequest();
+	}
+	else
+	{
+		sendLine("error " + m_request.m_id + " Unknown setting '" + command + "' in run request");
+		m_request.m_invalid = true;
+	}
+}
+
+// A request with an error is not executed, the error that was sent is the
+// final reply for it
+void SimpactServer::queueRequest()
+{
+	if (m_request.m_invalid)
+		return;
+
+	if (m_request.m_configFile.length() == 0)
+	{
+		sendLine("error " + m_request.m_id + " No config file was specified");
+		return;
+	}
+
+	m_preloadQueue.push_back(m_request);
+}
+
+// A run that's still queued is removed, and reported as if it was stopped by
+// SIGTERM. A running one is sent SIGTERM, and is reported when it has stopped.
+void SimpactServer::cancelRun(const string &id)
+{
+	for (deque<RunRequest>::iterator it = m_preloadQueue.begin() ; it != m_preloadQueue.end() ; ++it)
+	{
+		if (it->m_id == id)
+		{
+			// The files that are being loaded for it are still kept
+			if (m_preloading && it == m_preloadQueue.begin())
+			{
+				if (m_preloadCancelled)
+					break;
+				m_preloadCancelled = true;
+			}
+			else
+				m_preloadQueue.erase(it);
+
+			sendLine(strprintf("done %s %d", id.c_str(), -SIGTERM));
+			return;
+		}
+	}
+
+	for (deque<RunRequest>::iterator it = m_queue.begin() ; it != m_queue.end() ; ++it)
+	{
+		if (it->m_id == id)
+		{
+			m_queue.erase(it);
+			sendLine(strprintf("done %s %d", id.c_str(), -SIGTERM));
+			return;
+		}
+	}
+
+	for (map<pid_t, string>::const_iterator it = m_runningIDs.begin() ; it != m_runningIDs.end() ; ++it)
+	{
+		if (it->second == id)
+		{
+			kill(it->first, SIGTERM);
+			return;
+		}
+	}
+
+	sendLine("error - No run with identifier '" + id + "'");
+}
+
+// Fork is not safe while another thread is running, so no run is started while
+// data files are being loaded
+void SimpactServer::startQueuedRuns()
+{
+	if (m_preloading)
+		return;
+
+	while (!m_queue.empty() && (int)m_runningIDs.size() < m_maxRuns)
+	{
+		RunRequest request = m_queue.front();
+		m_queue.pop_front();
+		startRun(request);
+	}
+}
+
+// The data files of the first request that's waiting for them are loaded in a
+// separate thread, so that the main loop can still handle finished runs and
+// commands in the mean time
+void SimpactServer::startPreload()
+{
+	if (m_preloading || m_preloadQueue.empty())
+		return;
+
+	m_preloading = true;
+	m_preloadCancelled = false;
+#ifndef DISABLEOPENMP
+	m_preloadThread = thread(&SimpactServer::preloadThread, this, m_preloadQueue.front());
+#else
+	preloadThread(m_preloadQueue.front());
+#endif // !DISABLEOPENMP
+}
+
+void SimpactServer::preloadThread(RunRequest request)
+{
+#ifndef DISABLEOPENMP
+	omp_set_num_threads(1); // a new thread starts with the default settings
+#endif // !DISABLEOPENMP
+
+	preloadDataFiles(request);
+
+	char c = 0;
+	ssize_t num = write(m_preloadPipe[1], &c, 1);
+	(void)num;
+}
+
+void SimpactServer::finishPreload()
+{
+	if (!m_preloading)
+		return;
+
+#ifndef DISABLEOPENMP
+	m_preloadThread.join();
+#endif // !DISABLEOPENMP
+	m_preloading = false;
+
+	assert(!m_preloadQueue.empty());
+	if (!m_preloadCancelled)
+		m_queue.push_back(m_preloadQueue.front());
+	m_preloadQueue.pop_front();
+}
+
+void SimpactServer::startRun(const RunRequest &request)
+{
+	pid_t pid = fork();
+
+	if (pid < 0)
+	{
+		sendLine("error " + request.m_id + " Unable to start run: " + string(strerror(errno)));
+		return;
+	}
+
+	if (pid == 0)
+	{
+		runChild(request); // does not return
+		_exit(-1);
+	}
+
+	m_runningIDs[pid] = request.m_id;
+	sendLine(strprintf("started %s %d", request.m_id.c_str(), (int)pid));
+}
+
+// Executed in the child process: sets up the output, directory and environment
+// as if the program was started for this run only, and runs the simulation
+void SimpactServer::runChild(const RunRequest &request)
+{
+	signal(SIGCHLD, SIG_DFL);
+	signal(SIGPIPE, SIG_DFL);
+	close(s_sigChildPipe[0]);
+	close(s_sigChildPipe[1]);
+	close(m_preloadPipe[0]);
+	close(m_preloadPipe[1]);
+	if (m_listenFd >= 0)
+		close(m_listenFd);
+
+	int nullFd = open("/dev/null", O_RDWR);
+	int outputFd = nullFd;
+
+	if (request.m_outputFile.length() > 0)
+	{
+		string fileName = resolvePath(request.m_directory, request.m_outputFile);
+
+		outputFd = open(fileName.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
+		if (outputFd < 0)
+		{
+			cerr << "Unable to open output file " << fileName << endl;
+			_exit(-1);
+		}
+	}
+
+	// The protocol uses standard input/output or a socket connection, these
+	// must not be used by the simulation
+	dup2(nullFd, 0);
+	dup2(outputFd, 1);
+	if (request.m_outputFile.length() > 0)
+		dup2(outputFd, 2);
+	if (m_inFd > 2)
+		close(m_inFd);
+	if (m_outFd > 2 && m_outFd != m_inFd)
+		close(m_outFd);
+	if (outputFd > 2)
+		close(outputFd);
+	if (nullFd > 2 && nullFd != outputFd)
+		close(nullFd);
+
+	if (request.m_directory.length() > 0 && chdir(request.m_directory.c_str()) != 0)
+	{
+		cerr << "Unable to change to directory " << request.m_directory << endl;
+		_exit(-1);
+	}
+
+	for (size_t i = 0 ; i < request.m_environment.size() ; i++)
+		setenv(request.m_environment[i].first.c_str(), request.m_environment[i].second.c_str(), 1);
+
+#ifndef DISABLEOPENMP
+	omp_set_num_threads(m_numThreads);
+#endif // !DISABLEOPENMP
+
+	int status = -111;
+
+	try
+	{
+		status = m_runFunction(request.m_configFile, request.m_parallel, request.m_algo);
+	}
+	catch(const bad_alloc &e)
+	{
+		cerr << "Out of memory!" << endl;
+		writeUnexpectedTermination();
+	}
+	catch(const exception &e)
+	{
+		cerr << "Exception caught: " << e.what() << endl;
+		writeUnexpectedTermination();
+	}
+	catch(...)
+	{
+		cerr << "Unknown exception caught!" << endl;
+		writeUnexpectedTermination();
+	}
+
+	exit(status);
+}
+
+void SimpactServer::reapChildren()
+{
+	pid_t pid;
+	int status;
+
+	while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+	{
+		map<pid_t, string>::iterator it = m_runningIDs.find(pid);
+		if (it == m_runningIDs.end())
+			continue;
+
+		// Like the return code of a process in Python, a negative value
+		// is used for a run that was stopped by a signal
+		int code = -1;
+		if (WIFEXITED(status))
+			code = WEXITSTATUS(status);
+		else if (WIFSIGNALED(status))
+			code = -WTERMSIG(status);
+
+		sendLine(strprintf("done %s %d", it->second.c_str(), code));
+		m_runningIDs.erase(it);
+	}
+}
+
+// Loads the CSV files that are mentioned in the config file into the cache, as
+// well as the sampling tables for the discrete 2D distributions, so that each
+// run can use them. Errors are ignored here, they are reported by the run itself.
+// This is executed by the preload thread.
+void SimpactServer::preloadDataFiles(const RunRequest &request)
+{
+	ScopedEnvironment environment(request.m_environment); // variables may be used in the config file
+	ConfigSettings config;
+	string configFile = resolvePath(request.m_directory, request.m_configFile);
+
+	if (!config.load(configFile))
+		return;
+
+	vector<string> keys;
+	config.getKeys(keys);
+
+	for (size_t i = 0 ; i < keys.size() ; i++)
+	{
+		string value;
+		bool used;
+
+		// A density file (TIFF or CSV) with an optional mask, see getDistribution2DFromConfig
+		const string typeSuffix = ".dist2d.type";
+		if (endsWith(keys[i], typeSuffix) && config.getStringKeyValue(keys[i], value, used) && value == "discrete")
+		{
+			string prefix = keys[i].substr(0, keys[i].length() - typeSuffix.length()) + ".dist2d.discrete.";
+			string densFile, maskFile, cacheDir;
+			bool flipY = false, floor = false;
+
+			if (config.getKeyValue(prefix + "densfile", densFile) && config.getKeyValue(prefix + "maskfile", maskFile) &&
+			    config.getKeyValue(prefix + "flipy", flipY) && config.getKeyValue(prefix + "floor", floor) &&
+			    config.getKeyValue(prefix + "cachedir", cacheDir))
+			{
+				DiscreteDistributionWrapper2D::preload(resolvePath(request.m_directory, densFile),
+				                                       (maskFile.length() > 0)?resolvePath(request.m_directory, maskFile):maskFile,
+				                                       flipY, floor,
+				                                       (cacheDir.length() > 0)?resolvePath(request.m_directory, cacheDir):cacheDir);
+			}
+			continue;
+		}
+
+		// The names of the log files also end in .csv, these are skipped, as are
+		// the density files that were handled above
+		if (keys[i].find(".outfile.") != string::npos || keys[i].find(".dist2d.discrete.") != string::npos)
+			continue;
+
+		if (!config.getStringKeyValue(keys[i], value, used) || value.length() < 4)
+			continue;
+
+		string extension = value.substr(value.length() - 4);
+		for (size_t j = 0 ; j < extension.length() ; j++)
+			extension[j] = tolower(extension[j]);
+		if (extension != ".csv")
+			continue;
+
+		string fileName = resolvePath(request.m_directory, value);
+		struct stat st;
+
+		if (stat(fileName.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+			continue;
+
+		CSVFile csvFile;
+		csvFile.load(fileName);
+	}
+}
+
+string SimpactServer::resolvePath(const string &directory, const string &path)
+{
+	if (directory.length() == 0 || (path.length() > 0 && path[0] == '/'))
+		return path;
+	return directory + "/" + path;
+}
+
+void SimpactServer::sendLine(const string &line)
+{
+	sendData(line + "\n");
+}
+
+// Uses write directly instead of a stream, so that no buffered data ends up
+// in a child process
+void SimpactServer::sendData(const string &data)
+{
+	size_t pos = 0;
+
+	while (pos < data.length())
+	{
+		ssize_t num = write(m_outFd, data.c_str() + pos, data.length() - pos);
+		if (num < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return; // the client is gone, the runs are still waited for
+		}
+		pos += (size_t)num;
+	}
+}
+
+int runSimpactServer(int maxRuns, const string &socketPath, SimulationFunction runFunction)
+{
+	SimpactServer server(maxRuns, runFunction);
+	bool_t r;
+
+	if (!(r = server.init()))
+	{
+		cerr << r.getErrorString() << endl;
+		return -1;
+	}
+
+	if (socketPath.length() == 0)
+	{
+		server.serveConnection(0, 1, -1);
+		return 0;
+	}
+
+	struct sockaddr_un addr;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (socketPath.length() >= sizeof(addr.sun_path))
+	{
+		cerr << "Socket path " << socketPath << " is too long" << endl;
+		return -1;
+	}
+	strcpy(addr.sun_path, socketPath.c_str());
+
+	// Remove a socket that was left behind by a previous server, but nothing else
+	struct stat st;
+	if (stat(socketPath.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+		unlink(socketPath.c_str());
+
+	int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listenFd < 0)
+	{
+		cerr << "Unable to create socket: " << strerror(errno) << endl;
+		return -1;
+	}
+
+	if (bind(listenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listenFd, 16) != 0)
+	{
+		cerr << "Unable to listen on " << socketPath << ": " << strerror(errno) << endl;
+		close(listenFd);
+		return -1;
+	}
+
+	cerr << "# Simpact server listening on " << socketPath << endl;
+
+	bool stopServer = false;
+	while (!stopServer)
+	{
+		int fd = accept(listenFd, 0, 0);
+		if (fd < 0)
+		{
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			cerr << "Unable to accept connection: " << strerror(errno) << endl;
+			break;
+		}
+
+		stopServer = server.serveConnection(fd, fd, listenFd);
+		close(fd);
+	}
+
+	close(listenFd);
+	unlink(socketPath.c_str());
+	return 0;
+}
+
+#endif // WIN32
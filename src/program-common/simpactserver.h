@@ -0,0 +1,23 @@
+#ifndef SIMPACTSERVER_H
+
+#define SIMPACTSERVER_H
+
+#include <string>
+
+// Performs a single simulation, the arguments have the same meaning as the
+// command line arguments 'configfile parallel algo'
+typedef int (*SimulationFunction)(const std::string &confFileName, bool parallel, const std::string &algo);
+
+// Keeps the program running and starts a simulation for each run request that
+// is read, either from standard input or, if socketPath is not empty, from the
+// connections to a local (Unix domain) socket at that path. Each run is done in
+// a child process that is forked from this one, so that runs can't influence each
+// other, and at most maxRuns of them are executed at the same time. The option
+// schema is only created once, and the CSV files and discrete 2D densities that
+// are mentioned in the config file of a run are loaded before forking, so that a
+// run just uses the cached contents. This loading is done in a separate thread,
+// during which requests are still handled. The protocol is described in the
+// documentation.
+int runSimpactServer(int maxRuns, const std::string &socketPath, SimulationFunction runFunction);
+
+#endif // SIMPACTSERVER_H
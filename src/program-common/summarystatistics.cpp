@@ -0,0 +1,283 @@
+#include "summarystatistics.h"
+#include "simpactpopulation.h"
+#include "populationaggregates.h"
+#include "configsettings.h"
+#include "configwriter.h"
+#include "jsonconfig.h"
+#include "configfunctions.h"
+#include "util.h"
+#include <assert.h>
+#include <cmath>
+
+using namespace std;
+
+LogFile SummaryStatistics::s_logFile;
+string SummaryStatistics::s_logFileName;
+double SummaryStatistics::s_interval = -1;
+
+bool SummaryStatistics::s_started = false;
+double SummaryStatistics::s_binStart = 0;
+int64_t SummaryStatistics::s_prevHIVInfections = 0;
+int64_t SummaryStatistics::s_prevHSV2Infections = 0;
+int64_t SummaryStatistics::s_prevRelationshipsFormed = 0;
+int SummaryStatistics::s_prevRelationships = 0;
+int SummaryStatistics::s_prevDeaths = 0;
+
+const char *SummaryStatistics::s_columnNames[NumColumns] = { "PopSize", "Men", "Women", "Deaths", "HIVInfected", "HIVPrevalence",
+	"NewHIVInfections", "Diagnosed", "InTreatment", "ARTCoverage", "HSV2Infected", "NewHSV2Infections", "Relationships", 
+	"NewRelationships", "EndedRelationships" };
+vector<SummaryStatistics::Column> SummaryStatistics::s_columns;
+string SummaryStatistics::s_columnStr;
+
+void SummaryStatistics::start(const SimpactPopulation &pop, double t)
+{
+	// The state hasn't changed since the start of the first bin, so this
+	// is the state to compare the first row with
+	const PopulationAggregates &aggregates = pop.getAggregates();
+
+	s_started = true;
+	if (s_binStart < 0) // was re-enabled by an intervention, start from now
+		s_binStart = t;
+
+	s_prevHIVInfections = aggregates.getTotalHIVInfections();
+	s_prevHSV2Infections = aggregates.getTotalHSV2Infections();
+	s_prevRelationshipsFormed = aggregates.getTotalRelationshipsFormed();
+	s_prevRelationships = aggregates.getNumberOfRelationships();
+	s_prevDeaths = pop.getNumberOfDeceasedPeople();
+}
+
+void SummaryStatistics::onAboutToFire(const SimpactPopulation &pop, double t)
+{
+	assert(isEnabled());
+
+	if (!s_started)
+		start(pop, t);
+
+	// Events are often scheduled at a bin boundary (e.g. seeding at a specific
+	// year), these should always be counted in the next bin, also when the time
+	// was obtained by adding up time intervals and is slightly off
+	while (s_binStart + s_interval <= t + 1e-10*(1.0 + fabs(t)))
+	{
+		double binEnd = s_binStart + s_interval;
+
+		writeRow(pop, s_binStart, binEnd);
+		s_binStart = binEnd;
+	}
+}
+
+void SummaryStatistics::onSimulationEnd(const SimpactPopulation &pop, double t)
+{
+	assert(isEnabled());
+
+	if (!s_started)
+		start(pop, t);
+
+	// The state is now the one at time t, so first the bins that ended before
+	// that, and then the part of the current one
+	onAboutToFire(pop, t);
+
+	if (t > s_binStart)
+	{
+		writeRow(pop, s_binStart, t);
+		s_binStart = t;
+	}
+}
+
+void SummaryStatistics::writeRow(const SimpactPopulation &pop, double binStart, double binEnd)
+{
+	const PopulationAggregates &aggregates = pop.getAggregates();
+
+	int popSize = pop.getNumberOfPeople();
+	int numInfected = aggregates.getNumberOfHIVInfected();
+	int numInTreatment = aggregates.getNumberOnTreatment();
+	int numRelationships = aggregates.getNumberOfRelationships();
+	int numDeaths = pop.getNumberOfDeceasedPeople();
+	int64_t totalHIVInfections = aggregates.getTotalHIVInfections();
+	int64_t totalHSV2Infections = aggregates.getTotalHSV2Infections();
+	int64_t totalRelationshipsFormed = aggregates.getTotalRelationshipsFormed();
+
+	double prevalence = (popSize > 0)?((double)numInfected/(double)popSize):0;
+	double coverage = (numInfected > 0)?((double)numInTreatment/(double)numInfected):0;
+	int64_t newRelationships = totalRelationshipsFormed - s_prevRelationshipsFormed;
+	int64_t endedRelationships = newRelationships - (numRelationships - s_prevRelationships);
+
+	string row = strprintf("%10.10f,%10.10f", binStart, binEnd);
+
+	for (size_t i = 0 ; i < s_columns.size() ; i++)
+	{
+		switch(s_columns[i])
+		{
+		case PopSize:
+			row += strprintf(",%d", popSize);
+			break;
+		case Men:
+			row += strprintf(",%d", pop.getNumberOfMen());
+			break;
+		case Women:
+			row += strprintf(",%d", pop.getNumberOfWomen());
+			break;
+		case Deaths:
+			row += strprintf(",%d", numDeaths - s_prevDeaths);
+			break;
+		case HIVInfected:
+			row += strprintf(",%d", numInfected);
+			break;
+		case HIVPrevalence:
+			row += strprintf(",%10.10f", prevalence);
+			break;
+		case NewHIVInfections:
+			row += strprintf(",%d", (int)(totalHIVInfections - s_prevHIVInfections));
+			break;
+		case Diagnosed:
+			row += strprintf(",%d", aggregates.getNumberOfDiagnosed());
+			break;
+		case InTreatment:
+			row += strprintf(",%d", numInTreatment);
+			break;
+		case ARTCoverage:
+			row += strprintf(",%10.10f", coverage);
+			break;
+		case HSV2Infected:
+			row += strprintf(",%d", aggregates.getNumberOfHSV2Infected());
+			break;
+		case NewHSV2Infections:
+			row += strprintf(",%d", (int)(totalHSV2Infections - s_prevHSV2Infections));
+			break;
+		case Relationships:
+			row += strprintf(",%d", numRelationships);
+			break;
+		case NewRelationships:
+			row += strprintf(",%d", (int)newRelationships);
+			break;
+		case EndedRelationships:
+			row += strprintf(",%d", (int)endedRelationships);
+			break;
+		default:
+			abortWithMessage("SummaryStatistics: unknown column");
+		}
+	}
+
+	s_logFile.print("%s", row.c_str());
+
+	s_prevHIVInfections = totalHIVInfections;
+	s_prevHSV2Infections = totalHSV2Infections;
+	s_prevRelationshipsFormed = totalRelationshipsFormed;
+	s_prevRelationships = numRelationships;
+	s_prevDeaths = numDeaths;
+}
+
+void SummaryStatistics::processConfig(ConfigSettings &config, GslRandomNumberGenerator *pRndGen)
+{
+	string oldLogFileName = s_logFileName;
+	string oldColumnStr = s_columnStr;
+	bool_t r;
+
+	if (!(r = config.getKeyValue("summary.interval", s_interval)) ||
+	    !(r = config.getKeyValue("summary.outfile.logsummary", s_logFileName)) ||
+	    !(r = config.getKeyValue("summary.columns", s_columnStr)) )
+		abortWithMessage(r.getErrorString());
+
+	parseColumns(s_columnStr, s_columns);
+
+	if (s_interval > 0)
+	{
+		if (oldLogFileName != s_logFileName) // other file was specified, or none at all
+		{
+			s_logFile.close();
+			if (s_logFileName.length() > 0) // try to open a file
+			{
+				if (!( r = s_logFile.open(s_logFileName)))
+					abortWithMessage(r.getErrorString());
+
+				writeHeader();
+			}
+		}
+		else if (oldColumnStr != s_columnStr && s_logFile.isOpen()) // the header was already written
+			abortWithMessage("SummaryStatistics: the columns can only be changed together with the summary log file");
+	}
+	else if (s_started) // disabled during the simulation, if enabled again start a new bin at that time
+	{
+		s_started = false;
+		s_binStart = -1;
+	}
+}
+
+void SummaryStatistics::writeHeader()
+{
+	string header = "TStart,TEnd";
+
+	for (size_t i = 0 ; i < s_columns.size() ; i++)
+		header += string(",") + s_columnNames[s_columns[i]];
+
+	s_logFile.print("%s", header.c_str());
+}
+
+// Either 'all', or a comma separated list of column names, which are then
+// written in that order
+void SummaryStatistics::parseColumns(const string &columnStr, vector<Column> &columns)
+{
+	columns.clear();
+
+	if (trim(columnStr) == "all")
+	{
+		for (int i = 0 ; i < NumColumns ; i++)
+			columns.push_back((Column)i);
+		return;
+	}
+
+	vector<string> names;
+	SplitLine(columnStr, names, ", \t", "", "", true);
+
+	if (names.size() == 0)
+		abortWithMessage("SummaryStatistics: no columns were specified in 'summary.columns'");
+
+	for (size_t i = 0 ; i < names.size() ; i++)
+	{
+		int col = 0;
+		while (col < NumColumns && names[i] != s_columnNames[col])
+			col++;
+
+		if (col == NumColumns)
+			abortWithMessage("SummaryStatistics: unknown column '" + names[i] + "' in 'summary.columns'");
+
+		for (size_t j = 0 ; j < columns.size() ; j++)
+		{
+			if (columns[j] == (Column)col)
+				abortWithMessage("SummaryStatistics: column '" + names[i] + "' is specified more than once in 'summary.columns'");
+		}
+
+		columns.push_back((Column)col);
+	}
+}
+
+void SummaryStatistics::obtainConfig(ConfigWriter &config)
+{
+	bool_t r;
+
+	if (!(r = config.addKey("summary.interval", s_interval)) ||
+	    !(r = config.addKey("summary.outfile.logsummary", s_logFileName)) ||
+	    !(r = config.addKey("summary.columns", s_columnStr)) )
+		abortWithMessage(r.getErrorString());
+}
+
+ConfigFunctions summaryStatisticsConfigFunctions(SummaryStatistics::processConfig, SummaryStatistics::obtainConfig,
+		                                         "SummaryStatistics");
+
+JSONConfig summaryStatisticsJSONConfig(R"JSON(
+        "SummaryStatistics": {
+            "depends": null,
+            "params": [
+                [ "summary.interval", -1 ],
+                [ "summary.outfile.logsummary", "${SIMPACT_OUTPUT_PREFIX}summarylog.csv" ],
+                [ "summary.columns", "all" ]
+            ],
+            "info": [
+                "If the interval is positive, the simulation time is divided in bins of this",
+                "size, and for each bin a line is written to the summary log file, with the",
+                "state of the population at the end of the bin and the number of infections,",
+                "relationships and deaths during the bin. This does not add any events to the",
+                "simulation. The columns can be 'all', or a comma separated list of the column",
+                "names that should be written."
+            ]
+        })JSON");
+
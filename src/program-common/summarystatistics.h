@@ -0,0 +1,64 @@
+#ifndef SUMMARYSTATISTICS_H
+
+#define SUMMARYSTATISTICS_H
+
+#include "logfile.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class ConfigSettings;
+class ConfigWriter;
+class GslRandomNumberGenerator;
+class SimpactPopulation;
+
+// Writes a small table with the state of the population at the end of each
+// time bin, and the number of infections, relationships and deaths during
+// that bin. Unlike the periodic logging event, no event is used for this, the
+// table is filled in from SimpactPopulation::onAboutToFire: since the state
+// doesn't change in between events, the state right before the first event at
+// or after the end of a bin is the state at that time. Enabling this therefore
+// doesn't influence the simulation in any way.
+//
+// All numbers are read from the PopulationAggregates, so that writing a row
+// doesn't depend on the population size. Which of them are written is set by
+// 'summary.columns', and when the simulation stops, a last row is written for
+// the part of the bin that had started.
+class SummaryStatistics
+{
+public:
+	static void processConfig(ConfigSettings &config, GslRandomNumberGenerator *pRndGen);
+	static void obtainConfig(ConfigWriter &config);
+
+	static bool isEnabled()															{ return (s_interval > 0 && s_logFile.isOpen()); }
+
+	// Writes the rows of the time bins that ended at or before t
+	static void onAboutToFire(const SimpactPopulation &pop, double t);
+
+	// Writes the remaining rows when the simulation stopped at time t, for
+	// whatever reason, the last one ending at t
+	static void onSimulationEnd(const SimpactPopulation &pop, double t);
+private:
+	enum Column { PopSize, Men, Women, Deaths, HIVInfected, HIVPrevalence, NewHIVInfections, Diagnosed, InTreatment, 
+	              ARTCoverage, HSV2Infected, NewHSV2Infections, Relationships, NewRelationships, EndedRelationships, NumColumns };
+
+	static void start(const SimpactPopulation &pop, double t);
+	static void writeRow(const SimpactPopulation &pop, double binStart, double binEnd);
+	static void writeHeader();
+	static void parseColumns(const std::string &columnStr, std::vector<Column> &columns);
+
+	static const char *s_columnNames[NumColumns];
+	static std::vector<Column> s_columns;
+	static std::string s_columnStr;
+
+	static LogFile s_logFile;
+	static std::string s_logFileName;
+	static double s_interval;
+
+	static bool s_started;
+	static double s_binStart;
+	static int64_t s_prevHIVInfections, s_prevHSV2Infections, s_prevRelationshipsFormed;
+	static int s_prevRelationships, s_prevDeaths;
+};
+
+#endif // SUMMARYSTATISTICS_H
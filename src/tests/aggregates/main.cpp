@@ -0,0 +1,232 @@
+// Checks the counts of BirthDateIndex, which PopulationAggregates uses for the
+// number of persons in an age range, against a scan over all living persons.
+// The program exits with a non-zero status if one of the checks fails, so that
+// it can be run as a test.
+
+#include "birthdateindex.h"
+#include "gslrandomnumbergenerator.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// The same information, kept in the most straightforward way
+class BruteForceIndex
+{
+public:
+	void add(int handle, double dateOfBirth)
+	{
+		if (handle >= (int)m_datesOfBirth.size())
+		{
+			m_datesOfBirth.resize(handle+1, 0);
+			m_alive.resize(handle+1, false);
+		}
+		if (m_alive[handle])
+		{
+			cerr << "Handle " << handle << " is still in use" << endl;
+			m_errors++;
+		}
+		m_datesOfBirth[handle] = dateOfBirth;
+		m_alive[handle] = true;
+	}
+
+	void remove(int handle)
+	{
+		m_alive[handle] = false;
+	}
+
+	int countUpTo(double dateOfBirth) const
+	{
+		int count = 0;
+		for (size_t i = 0 ; i < m_datesOfBirth.size() ; i++)
+		{
+			if (m_alive[i] && m_datesOfBirth[i] <= dateOfBirth)
+				count++;
+		}
+		return count;
+	}
+
+	int countAges(double minAge, double maxAge, double t) const
+	{
+		int count = 0;
+		for (size_t i = 0 ; i < m_datesOfBirth.size() ; i++)
+		{
+			double age = t - m_datesOfBirth[i];
+			if (m_alive[i] && age >= minAge && age < maxAge)
+				count++;
+		}
+		return count;
+	}
+
+	std::vector<int> getLivingHandles() const
+	{
+		std::vector<int> handles;
+		for (size_t i = 0 ; i < m_alive.size() ; i++)
+		{
+			if (m_alive[i])
+				handles.push_back((int)i);
+		}
+		return handles;
+	}
+
+	double getDateOfBirth(int handle) const									{ return m_datesOfBirth[handle]; }
+	int getNumberOfErrors() const											{ return m_errors; }
+
+	BruteForceIndex() : m_errors(0)											{ }
+private:
+	std::vector<double> m_datesOfBirth;
+	std::vector<bool> m_alive;
+	int m_errors;
+};
+
+// Same as PopulationAggregates::getNumberOfPeople
+static int countAges(BirthDateIndex &index, double minAge, double maxAge, double t)
+{
+	if (!index.isSorted())
+		index.sort();
+
+	return index.countUpTo(t - minAge) - index.countUpTo(t - maxAge);
+}
+
+static int compareCounts(BirthDateIndex &index, const BruteForceIndex &check, double t, GslRandomNumberGenerator &rng, const string &name)
+{
+	int count = 0;
+
+	if (!index.isSorted())
+		index.sort();
+
+	if (index.getNumberOfLivingPersons() != check.countUpTo(t))
+	{
+		cerr << name << " t=" << t << ": " << index.getNumberOfLivingPersons() << " living persons, expected " << check.countUpTo(t) << endl;
+		count++;
+	}
+
+	// Both at random dates and at the dates of birth themselves, where the
+	// upper bound of the interval matters
+	std::vector<int> handles = check.getLivingHandles();
+	for (int i = 0 ; i < 20 ; i++)
+	{
+		double dob = t - 100.0*rng.pickRandomDouble();
+		if (handles.size() > 0 && i%2 == 0)
+			dob = check.getDateOfBirth(handles[rng.pickRandomInt(0, handles.size()-1)]);
+
+		int n1 = index.countUpTo(dob);
+		int n2 = check.countUpTo(dob);
+		if (n1 != n2)
+		{
+			cerr << name << " t=" << t << " countUpTo(" << dob << ") = " << n1 << ", expected " << n2 << endl;
+			count++;
+		}
+	}
+
+	// Age ranges as used in the summary statistics, including empty and
+	// very wide ones
+	const double ageBands[][2] = { { 0, 15 }, { 15, 25 }, { 25, 50 }, { 15, 49 }, { 50, 1000 }, { 30, 30 }, { 0, 1000 } };
+	for (size_t i = 0 ; i < sizeof(ageBands)/sizeof(ageBands[0]) ; i++)
+	{
+		int n1 = countAges(index, ageBands[i][0], ageBands[i][1], t);
+		int n2 = check.countAges(ageBands[i][0], ageBands[i][1], t);
+		if (n1 != n2)
+		{
+			cerr << name << " t=" << t << " ages [" << ageBands[i][0] << ", " << ageBands[i][1] << ") = " << n1 << ", expected " << n2 << endl;
+			count++;
+		}
+	}
+	return count;
+}
+
+// Starts with an initial population in random order, after which births add
+// persons at the current time and deaths remove random persons. If the death
+// rate is larger than the birth rate, the population shrinks, which is when the
+// index needs to be compacted
+static int runIndexTest(int initialSize, int numSteps, double birthFraction, const string &name, GslRandomNumberGenerator &rng)
+{
+	BirthDateIndex index;
+	BruteForceIndex check;
+	std::vector<int> living;
+	int count = 0;
+	int maxLiving = 0;
+	double t = 0;
+
+	for (int i = 0 ; i < initialSize ; i++)
+	{
+		// Rounded, so that there are persons with the same date of birth
+		double dob = -(double)rng.pickRandomInt(0, 8000)/100.0;
+		int handle = index.add(dob);
+		check.add(handle, dob);
+		living.push_back(handle);
+	}
+	maxLiving = (int)living.size();
+
+	count += compareCounts(index, check, t, rng, name);
+
+	for (int step = 0 ; step < numSteps ; step++)
+	{
+		t += 0.01*rng.pickRandomDouble();
+
+		if (living.size() == 0 || rng.pickRandomDouble() < birthFraction)
+		{
+			int handle = index.add(t);
+			check.add(handle, t);
+			living.push_back(handle);
+			maxLiving = std::max(maxLiving, (int)living.size());
+		}
+		else
+		{
+			int pos = rng.pickRandomInt(0, living.size()-1);
+			int handle = living[pos];
+
+			living[pos] = living.back();
+			living.pop_back();
+			index.remove(handle);
+			check.remove(handle);
+		}
+
+		// The removed persons may not take up more space than the living
+		// ones, apart from a fixed amount
+		int numRemoved = index.getNumberOfPositions() - index.getNumberOfLivingPersons();
+		if (numRemoved >= 1024 && numRemoved > index.getNumberOfLivingPersons())
+		{
+			cerr << name << " step " << step << ": " << numRemoved << " removed persons are still stored for " << index.getNumberOfLivingPersons() << " living ones" << endl;
+			count++;
+		}
+		if (index.getNumberOfHandles() > maxLiving)
+		{
+			cerr << name << " step " << step << ": " << index.getNumberOfHandles() << " handles for at most " << maxLiving << " living persons" << endl;
+			count++;
+		}
+
+		if (step%500 == 0)
+			count += compareCounts(index, check, t, rng, name);
+
+		if (count > 10)
+			break;
+	}
+
+	count += compareCounts(index, check, t, rng, name);
+	count += check.getNumberOfErrors();
+
+	cerr << "# " << name << ": " << ((count == 0)?"ok":"FAILED") << " (" << index.getNumberOfLivingPersons() << " living persons, "
+	     << index.getNumberOfPositions() << " positions)" << endl;
+
+	return (count == 0)?0:1;
+}
+
+int main(int argc, char *argv[])
+{
+	GslRandomNumberGenerator rndGen(12345, false);
+	int failures = 0;
+
+	failures += runIndexTest(5000, 20000, 0.5, "BirthDateIndex(stable population)", rndGen);
+	failures += runIndexTest(10000, 15000, 0.2, "BirthDateIndex(shrinking population)", rndGen);
+	failures += runIndexTest(100, 20000, 0.9, "BirthDateIndex(growing population)", rndGen);
+	failures += runIndexTest(0, 5000, 0.3, "BirthDateIndex(empty start)", rndGen);
+
+	if (failures != 0)
+	{
+		cerr << "# " << failures << " failures" << endl;
+		return -1;
+	}
+	return 0;
+}
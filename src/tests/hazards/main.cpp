@@ -0,0 +1,348 @@
+// Checks the time mappings of some hazard functions from the library, both
+// against each other and against the analytic expressions. The program exits
+// with a non-zero status if one of the checks fails, so that it can be run
+// as a test.
+
+#include "gslrandomnumbergenerator.h"
+#include "hazardfunctionexp.h"
+#include "hazardfunctionexpbound.h"
+#include "tabulatedhazardfunction.h"
+#include "uniformdistribution.h"
+#include "util.h"
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+// Decreasing exponential hazard, with its time mappings written out explicitly
+class TestHazardFunction : public HazardFunction
+{
+public:
+	TestHazardFunction()					{ }
+	~TestHazardFunction()					{ }
+
+	double evaluate(double t)
+	{
+		return std::exp(-t);
+	}
+
+	double calculateInternalTimeInterval(double t0, double dt)
+	{
+		return std::exp(-t0)*(1.0-exp(-dt));
+	}
+
+	double solveForRealTimeInterval(double t0, double Tdiff)
+	{
+		return -std::log(1.0-Tdiff*exp(t0));
+	}
+};
+
+// Not of the exponential form, only used to test TabulatedHazardFunction
+class TestHazardFunction2 : public HazardFunction
+{
+public:
+	TestHazardFunction2()					{ }
+	~TestHazardFunction2()					{ }
+
+	double evaluate(double t)
+	{
+		return 1.0/(1.0+t) + 0.01*t;
+	}
+
+	double calculateInternalTimeInterval(double t0, double dt)
+	{
+		double t1 = t0+dt;
+		return std::log((1.0+t1)/(1.0+t0)) + 0.005*(t1*t1-t0*t0);
+	}
+
+	double solveForRealTimeInterval(double t0, double Tdiff)
+	{
+		abortWithMessage("TestHazardFunction2::solveForRealTimeInterval: not implemented");
+		return 0;
+	}
+};
+
+// Checks that both time mappings of h are each other's inverse and that the
+// internal time interval agrees with a numerical integration; returns the
+// number of failures
+int runHazardTest(HazardFunction &h, const string &name, GslRandomNumberGenerator &rndGen)
+{
+	int N = 10000;
+	int count = 0;
+
+	UniformDistribution tDist(0,50, &rndGen);
+	UniformDistribution dtDist(0,10, &rndGen);
+
+	for (int i = 0 ; i < N ; i++)
+	{
+		double t0 = tDist.pickNumber();
+		double dt = dtDist.pickNumber();
+
+		double Tdiff = h.calculateInternalTimeInterval(t0, dt);
+		double dt2 = h.solveForRealTimeInterval(t0, Tdiff);
+		double numTdiff = h.integrateNumerically(t0, dt);
+		double delta = 0.5*(std::abs(Tdiff-numTdiff)/Tdiff + std::abs(Tdiff-numTdiff)/numTdiff) ;
+		double delta2 = std::abs(dt-dt2);
+
+		const double tol = 1e-7;
+
+		if (!(delta < tol && delta2 < tol))
+		{
+			cerr << name << " t0=" << t0 << " dt=" << dt << " Tdiff=" << Tdiff << " dt2=" << dt2 << " numTdiff=" << numTdiff << " delta=" << delta << " delta2=" << delta2 << endl;
+			count++;
+		}
+	}
+
+	cerr << "# " << name << ": " << ((count == 0)?"ok":"FAILED") << endl;
+	return count;
+}
+
+// Compares the time mappings of the tabulated version of a hazard to the ones
+// of the original, for start times in [tMin, tMax]. If the original hazard
+// can't solve for the real time interval, only the consistency of the table
+// itself is checked in that direction. Returns the number of failures.
+int runTabulatedHazardTest(HazardFunction &hOrig, double tStart, double tEnd, double tMin, double tMax, bool origCanSolve,
+                           const string &name, GslRandomNumberGenerator &rndGen)
+{
+	TabulatedHazardFunction h(hOrig, tStart, tEnd, 1e-9, 1e-15);
+	TabulatedHazardFunction hDefault(hOrig, tStart, tEnd);
+	int N = 10000;
+	int count = 0;
+
+	UniformDistribution tDist(tMin, tMax, &rndGen);
+	UniformDistribution dtDist(0,10, &rndGen);
+
+	for (int i = 0 ; i < N ; i++)
+	{
+		double t0 = tDist.pickNumber();
+		double dt = dtDist.pickNumber();
+
+		double Tdiff = h.calculateInternalTimeInterval(t0, dt);
+		double origTdiff = hOrig.calculateInternalTimeInterval(t0, dt);
+		double dt2 = h.solveForRealTimeInterval(t0, origTdiff);
+		double dt3 = h.solveForRealTimeInterval(t0, Tdiff);
+		double delta = std::abs(Tdiff-origTdiff)/origTdiff;
+		double delta2 = std::abs(dt-dt2);
+		double delta3 = std::abs(dt-dt3);
+		double delta4 = 0;
+
+		if (origCanSolve)
+			delta4 = std::abs(hOrig.solveForRealTimeInterval(t0, Tdiff) - dt);
+
+		const double tol = 1e-7;
+
+		if (!(delta < tol && delta2 < tol && delta3 < 1e-10 && delta4 < tol))
+		{
+			cerr << name << " t0=" << t0 << " dt=" << dt << " Tdiff=" << Tdiff << " origTdiff=" << origTdiff << " dt2=" << dt2 << " dt3=" << dt3 
+			     << " delta=" << delta << " delta2=" << delta2 << " delta3=" << delta3 << " delta4=" << delta4 << endl;
+			count++;
+		}
+	}
+
+	cerr << "# " << name << ": " << ((count == 0)?"ok":"FAILED") << " (" << h.getNumberOfSegments() << " segments, " 
+	     << hDefault.getNumberOfSegments() << " with default tolerances)" << endl;
+	return count;
+}
+
+// Samples the first fire time after t0 of the hazard exp(A+Bt), which stays
+// constant after tMax, by thinning with HazardFunctionExpBound in the same way
+// as the formation event does: after a rejected candidate, and at a random time
+// in between to mimic a recalculation that's due to a change in the state of
+// another person, a new bound is used from that time on. Once tMax has been
+// reached, the exact mapping is used.
+double sampleThinned(double A, double B, double tMax, double t0, GslRandomNumberGenerator &rndGen, int &candidates, int &rejected)
+{
+	HazardFunctionExp hExp(A, B);
+	TimeLimitedHazardFunction hExact(hExp, tMax);
+	double t = t0;
+	double Tdiff = -std::log(rndGen.pickRandomDouble());
+
+	while (true)
+	{
+		if (t >= tMax)
+			return t + hExact.solveForRealTimeInterval(t, Tdiff);
+
+		HazardFunctionExpBound hBound(hExp.evaluate(t), t, B, tMax);
+		double tCandidate = t + hBound.solveForRealTimeInterval(t, Tdiff);
+
+		// Half of the time, recalculate at a time before the candidate
+		if (rndGen.pickRandomDouble() < 0.5)
+		{
+			double tRecalc = t + rndGen.pickRandomDouble()*(tCandidate - t);
+
+			Tdiff -= hBound.calculateInternalTimeInterval(t, tRecalc - t);
+			if (Tdiff < 0)
+				Tdiff = 0;
+			t = tRecalc;
+			continue;
+		}
+
+		candidates++;
+		if (rndGen.pickRandomDouble() < hBound.getAcceptanceProbability(tCandidate))
+			return tCandidate;
+
+		rejected++;
+		t = tCandidate;
+		Tdiff = -std::log(rndGen.pickRandomDouble());
+	}
+	return -1;
+}
+
+// Two-sample Kolmogorov-Smirnov statistic
+double getKSStatistic(vector<double> &x, vector<double> &y)
+{
+	sort(x.begin(), x.end());
+	sort(y.begin(), y.end());
+
+	size_t i = 0, j = 0;
+	double D = 0;
+
+	while (i < x.size() && j < y.size())
+	{
+		double v = std::min(x[i], y[j]);
+
+		while (i < x.size() && x[i] <= v)
+			i++;
+		while (j < y.size() && y[j] <= v)
+			j++;
+
+		double diff = std::abs((double)i/(double)x.size() - (double)j/(double)y.size());
+		if (diff > D)
+			D = diff;
+	}
+	return D;
+}
+
+// Compares the distribution of the fire times that are obtained by thinning to
+// the one from the exact mapping, using a two-sample Kolmogorov-Smirnov test;
+// also checks that at least half of the candidates are accepted. Returns the
+// number of failures.
+int runThinningTest(double A, double B, double tMax, double t0, const string &name, GslRandomNumberGenerator &rndGen)
+{
+	HazardFunctionExp hExp(A, B);
+	TimeLimitedHazardFunction hExact(hExp, tMax);
+	const int N = 20000;
+	vector<double> exact(N), thinned(N);
+	int candidates = 0, rejected = 0;
+
+	for (int i = 0 ; i < N ; i++)
+	{
+		exact[i] = t0 + hExact.solveForRealTimeInterval(t0, -std::log(rndGen.pickRandomDouble()));
+		thinned[i] = sampleThinned(A, B, tMax, t0, rndGen, candidates, rejected);
+	}
+
+	// Critical value for a significance level of 0.001
+	double D = getKSStatistic(exact, thinned);
+	double Dcrit = 1.95*std::sqrt(2.0/(double)N);
+	double acceptFraction = 1.0 - (double)rejected/(double)candidates;
+	int count = 0;
+
+	if (!(D < Dcrit))
+	{
+		cerr << name << " KS statistic " << D << " exceeds " << Dcrit << endl;
+		count++;
+	}
+	if (!(acceptFraction >= 0.5))
+	{
+		cerr << name << " only " << acceptFraction << " of the candidates were accepted" << endl;
+		count++;
+	}
+
+	cerr << "# " << name << ": " << ((count == 0)?"ok":"FAILED") << " (D = " << D << ", accepted fraction " << acceptFraction << ")" << endl;
+	return count;
+}
+
+// Checks that the time mappings of the bound are each other's inverse and that
+// the bound is never smaller than the hazard itself
+int runBoundTest(double A, double B, double tMax, double tStart, const string &name, GslRandomNumberGenerator &rndGen)
+{
+	HazardFunctionExp hExp(A, B);
+	HazardFunctionExpBound h(hExp.evaluate(tStart), tStart, B, tMax);
+	int N = 10000;
+	int count = 0;
+
+	UniformDistribution tDist(tStart, tStart + 2.0*(tMax - tStart), &rndGen);
+	UniformDistribution dtDist(0, tMax - tStart, &rndGen);
+
+	for (int i = 0 ; i < N ; i++)
+	{
+		double t0 = tDist.pickNumber();
+		double dt = dtDist.pickNumber();
+
+		double Tdiff = h.calculateInternalTimeInterval(t0, dt);
+		double dt2 = h.solveForRealTimeInterval(t0, Tdiff);
+		double delta = std::abs(dt - dt2);
+		double p = h.getAcceptanceProbability(t0);
+
+		if (!(delta < 1e-8 && p <= 1.0 + 1e-12 && p >= 0.5 - 1e-12))
+		{
+			cerr << name << " t0=" << t0 << " dt=" << dt << " Tdiff=" << Tdiff << " dt2=" << dt2 << " delta=" << delta << " p=" << p << endl;
+			count++;
+		}
+	}
+
+	cerr << "# " << name << ": " << ((count == 0)?"ok":"FAILED") << endl;
+	return count;
+}
+
+int main(int argc, char *argv[])
+{
+	GslRandomNumberGenerator rndGen(12345, false);
+	int failures = 0;
+
+	{
+		TestHazardFunction h0;
+		TimeLimitedHazardFunction h(h0, 80);
+		failures += runHazardTest(h, "TestHazardFunction", rndGen);
+		failures += runTabulatedHazardTest(h, 0, 80, 0, 50, true, "TabulatedHazardFunction(TestHazardFunction)", rndGen);
+	}
+
+	{
+		TestHazardFunction2 h;
+		failures += runTabulatedHazardTest(h, 0, 60, 0, 50, false, "TabulatedHazardFunction(TestHazardFunction2)", rndGen);
+	}
+
+	{
+		HazardFunctionExp h0(1.23);
+		TimeLimitedHazardFunction h(h0, 120);
+		failures += runHazardTest(h, "HazardFunctionExp1", rndGen);
+	}
+
+	{
+		HazardFunctionExp h0(1.23,4.56);
+		TimeLimitedHazardFunction h(h0, 120);
+		failures += runHazardTest(h, "HazardFunctionExp2", rndGen);
+	}
+
+	// The form that's used by the relocation event, as a function of age: the
+	// table ends at t_max, after which both versions use a constant hazard
+	{
+		HazardFunctionExp h0(-2.0, 0.05);
+		TimeLimitedHazardFunction h(h0, 60);
+		failures += runTabulatedHazardTest(h, 0, 60, 0, 100, true, "TabulatedHazardFunction(TimeLimited(HazardFunctionExp), increasing)", rndGen);
+	}
+
+	{
+		HazardFunctionExp h0(1.0, -0.1);
+		TimeLimitedHazardFunction h(h0, 60);
+		failures += runTabulatedHazardTest(h, 0, 60, 0, 100, true, "TabulatedHazardFunction(TimeLimited(HazardFunctionExp), decreasing)", rndGen);
+	}
+
+	failures += runBoundTest(-3.0, 0.1, 60, 20, "HazardFunctionExpBound(slow increase)", rndGen);
+	failures += runBoundTest(-20.0, 1.5, 30, 10, "HazardFunctionExpBound(fast increase)", rndGen);
+	failures += runBoundTest(-3.0, 0.1, 60, 59.9, "HazardFunctionExpBound(close to tMax)", rndGen);
+
+	failures += runThinningTest(-3.0, 0.1, 60, 20, "Thinning(slow increase)", rndGen);
+	failures += runThinningTest(-20.0, 1.5, 30, 10, "Thinning(fast increase)", rndGen);
+	failures += runThinningTest(-6.0, 0.3, 25, 15, "Thinning(reaches tMax)", rndGen);
+
+	if (failures != 0)
+	{
+		cerr << "# " << failures << " failures" << endl;
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,69 @@
+#!/usr/bin/env python
+
+from __future__ import print_function
+import sys
+import json
+
+# For each of these values: the name in the results file, whether a higher
+# value is better, and the name to show
+metrics = [ ("eventspersecond", True, "events/s"),
+            ("startupseconds", False, "startup"),
+            ("peakrsskib", False, "peak RSS") ]
+
+def main():
+
+    try:
+        oldFile = sys.argv[1]
+        newFile = sys.argv[2]
+        threshold = float(sys.argv[3]) if len(sys.argv) > 3 else 10.0
+
+        if len(sys.argv) > 4:
+            raise Exception("Too many arguments")
+    except Exception as e:
+        print("Error: {}".format(e))
+        print("Usage: {} old.json new.json [threshold_percent]".format(sys.argv[0]))
+        print("")
+        print("Compares two result files of simpactbench.py, and reports a regression")
+        print("if a value became worse by more than the threshold (default 10%).")
+        sys.exit(-1)
+
+    with open(oldFile, "rt") as f:
+        oldResults = json.load(f)["results"]
+    with open(newFile, "rt") as f:
+        newResults = json.load(f)["results"]
+
+    oldMap = { (r["workload"], r["algorithm"]): r for r in oldResults }
+
+    regressions = 0
+    for new in newResults:
+        key = (new["workload"], new["algorithm"])
+        if not key in oldMap:
+            print("{:<20} {:<12} not present in {}".format(key[0], key[1], oldFile))
+            continue
+
+        old = oldMap[key]
+        if old["events"] != new["events"]:
+            print("{:<20} {:<12} WARNING: number of events differs ({} vs {})".format(key[0], key[1], old["events"], new["events"]))
+
+        for name, higherIsBetter, desc in metrics:
+            o, n = float(old[name]), float(new[name])
+            change = 100.0*(n - o)/o if o > 0 else 0.0
+            worse = -change if higherIsBetter else change
+
+            flag = ""
+            if worse > threshold:
+                flag = "REGRESSION"
+                regressions += 1
+            elif -worse > threshold:
+                flag = "improvement"
+
+            print("{:<20} {:<12} {:<9} {:>14.6g} -> {:>14.6g} ({:+.1f}%) {}".format(key[0], key[1], desc, o, n, change, flag))
+
+    if regressions > 0:
+        print("\n{} regression(s) found".format(regressions))
+        sys.exit(1)
+
+    print("\nNo regressions found")
+
+if __name__ == "__main__":
+    main()
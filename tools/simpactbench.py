@@ -0,0 +1,230 @@
+#!/usr/bin/env python
+
+from __future__ import print_function
+import pysimpactcyan
+import sys
+import os
+import json
+import time
+import shutil
+import platform
+import subprocess
+import tempfile
+
+# The standard workloads, these are used if no 'benchsettings.py' file is
+# present. Each workload is run with the algorithms listed in 'algorithms';
+# the 'simple' algorithm is only used for the small populations since it
+# becomes far too slow for the larger ones.
+defaultWorkloads = [
+    { "name": "small",
+      "config": { "population.nummen": 100, "population.numwomen": 100, "population.simtime": 20,
+                  "population.eyecap.fraction": 1 },
+      "algorithms": [ "simple", "opt", "opt-parallel" ] },
+    { "name": "small-eyecap0.1",
+      "config": { "population.nummen": 100, "population.numwomen": 100, "population.simtime": 20,
+                  "population.eyecap.fraction": 0.1 },
+      "algorithms": [ "simple", "opt", "opt-parallel" ] },
+    { "name": "medium",
+      "config": { "population.nummen": 1000, "population.numwomen": 1000, "population.simtime": 5,
+                  "population.eyecap.fraction": 1 },
+      "algorithms": [ "opt", "opt-parallel" ] },
+    { "name": "medium-eyecap0.1",
+      "config": { "population.nummen": 1000, "population.numwomen": 1000, "population.simtime": 10,
+                  "population.eyecap.fraction": 0.1 },
+      "algorithms": [ "opt", "opt-parallel" ] },
+    { "name": "medium-relocation",
+      "config": { "population.nummen": 1000, "population.numwomen": 1000, "population.simtime": 10,
+                  "population.eyecap.fraction": 0.1, "relocation.enabled": "yes",
+                  "relocation.hazard.a": -2, "relocation.hazard.b": 0 },
+      "algorithms": [ "opt", "opt-parallel" ] },
+    { "name": "medium-msm",
+      "config": { "population.nummen": 1000, "population.numwomen": 1000, "population.simtime": 10,
+                  "population.eyecap.fraction": 0.1, "population.msm": "yes" },
+      "algorithms": [ "opt", "opt-parallel" ] },
+    { "name": "medium-intervention",
+      "config": { "population.nummen": 1000, "population.numwomen": 1000, "population.simtime": 10,
+                  "population.eyecap.fraction": 0.1 },
+      "interventions": [ { "time": 3, "monitoring.cd4.threshold": 350 },
+                         { "time": 6, "monitoring.cd4.threshold": 500 } ],
+      "algorithms": [ "opt", "opt-parallel" ] },
+    # With an eyecap fraction of 1, a population of this size would need billions
+    # of formation events
+    { "name": "large",
+      "config": { "population.nummen": 50000, "population.numwomen": 50000, "population.simtime": 1,
+                  "population.eyecap.fraction": 0.002 },
+      "algorithms": [ "opt", "opt-parallel" ] },
+]
+defaultRepeats = 3
+defaultSeed = 12345
+
+try:
+    import benchsettings
+    workloads = benchsettings.workloads
+    repeats = benchsettings.repeats
+    seed = benchsettings.seed
+except ImportError:
+    print("""
+No 'benchsettings.py' file found, using the standard workloads. To use other
+settings, create such a file containing e.g.
+
+    # The workloads to run, each with the algorithms to use ('simple', 'opt' or
+    # 'opt-parallel'), and optionally with a list of interventions
+    workloads = [ { "name": "test",
+                    "config": { "population.nummen": 500, "population.numwomen": 500 },
+                    "interventions": [ { "time": 5, "monitoring.cd4.threshold": 500 } ],
+                    "algorithms": [ "opt", "opt-parallel" ] } ]
+
+    # Each run is repeated this amount of times, the median is reported
+    repeats = 3
+
+    # The same seed is used for all runs, so that two builds can be compared
+    seed = 12345
+""")
+    workloads = defaultWorkloads
+    repeats = defaultRepeats
+    seed = defaultSeed
+
+# Name, parallel flag and algorithm argument of the executable
+algorithms = { "simple": ("0", "simple"),
+               "opt": ("0", "opt"),
+               "opt-parallel": ("1", "opt") }
+
+def median(values):
+    values = sorted(values)
+    n = len(values)
+    if n == 0:
+        return 0.0
+    if n % 2 == 1:
+        return values[n//2]
+    return 0.5*(values[n//2-1] + values[n//2])
+
+def writeConfig(executable, workload, destDir, maxEvents = None):
+
+    config = dict(workload["config"])
+    if maxEvents is not None:
+        config["population.maxevents"] = maxEvents
+
+    interventions = workload.get("interventions", [])
+    if interventions:
+        config["intervention.enabled"] = "yes"
+        config["intervention.times"] = ",".join([ str(float(iv["time"])) for iv in interventions ])
+        config["intervention.fileids"] = ",".join([ str(i+1) for i in range(len(interventions)) ])
+        config["intervention.baseconfigname"] = "interventionconfig_%.txt"
+
+        for i in range(len(interventions)):
+            with open(os.path.join(destDir, "interventionconfig_{}.txt".format(i+1)), "wt") as f:
+                for k in interventions[i]:
+                    if k != "time":
+                        f.write("{} = {}\n".format(k, interventions[i][k]))
+
+    lines = pysimpactcyan.createConfigLines([ executable, "--showconfigoptions" ], config)[1]
+
+    configFile = os.path.join(destDir, "config.txt")
+    with open(configFile, "wt") as f:
+        f.write("$SIMPACT_OUTPUT_PREFIX = \n\n")
+        for l in lines:
+            f.write(l + "\n")
+
+    return configFile
+
+# Runs the executable in its own directory, and returns the wall clock time,
+# the number of events and the peak resident set size in KiB
+def timeRun(executable, dataDir, workload, algorithm, maxEvents = None):
+
+    destDir = tempfile.mkdtemp(prefix = "simpactbench-")
+    try:
+        configFile = writeConfig(executable, workload, destDir, maxEvents)
+
+        env = dict(os.environ)
+        env["MNRM_DEBUG_SEED"] = str(seed)
+        env["SIMPACT_DATA_DIR"] = dataDir
+
+        parallelStr, algoStr = algorithms[algorithm]
+        with open(os.path.join(destDir, "output.txt"), "w+t") as f:
+            t0 = time.time()
+            proc = subprocess.Popen([ executable, configFile, parallelStr, algoStr ], stdout = f, stderr = f,
+                                    cwd = destDir, env = env)
+            _, status, usage = os.wait4(proc.pid, 0)
+            dt = time.time() - t0
+            proc.returncode = status
+
+            f.seek(0)
+            lines = f.readlines()
+
+        if status != 0:
+            raise Exception("Error running workload '{}' with algorithm '{}':\n{}".format(workload["name"], algorithm, "".join(lines[-5:])))
+
+        numEvtsPrefix = "# Number of events executed is "
+        numEvents = [ int(l[len(numEvtsPrefix):]) for l in lines if l.startswith(numEvtsPrefix) ][0]
+
+        # On OS X, ru_maxrss is in bytes instead of kilobytes
+        peakRSS = usage.ru_maxrss
+        if platform.system() == "Darwin":
+            peakRSS //= 1024
+
+        return (dt, numEvents, peakRSS)
+    finally:
+        shutil.rmtree(destDir, ignore_errors = True)
+
+def main():
+
+    try:
+        simpactDir = sys.argv[1]
+        dataDir = sys.argv[2]
+        outputFile = sys.argv[3]
+
+        if len(sys.argv) > 4:
+            raise Exception("Too many arguments")
+    except Exception as e:
+        print("Error: {}".format(e))
+        print("Usage: {} simpactdir datadir results.json".format(sys.argv[0]))
+        sys.exit(-1)
+
+    executable = os.path.abspath(os.path.join(simpactDir, "simpact-cyan-release"))
+    dataDir = os.path.join(os.path.abspath(dataDir), "")
+
+    results = [ ]
+    for w in workloads:
+        for a in w["algorithms"]:
+
+            # The startup time is the time needed to read the configuration, create the
+            # population and schedule the initial events, measured by stopping after the
+            # first event
+            startup = median([ timeRun(executable, dataDir, w, a, maxEvents = 1)[0] for r in range(repeats) ])
+
+            runs = [ timeRun(executable, dataDir, w, a) for r in range(repeats) ]
+            wallTime = median([ r[0] for r in runs ])
+            numEvents = runs[0][1]
+            peakRSS = max([ r[2] for r in runs ])
+
+            eventTime = max(wallTime - startup, 1e-9)
+            r = { "workload": w["name"],
+                  "algorithm": a,
+                  "events": numEvents,
+                  "wallseconds": wallTime,
+                  "startupseconds": startup,
+                  "eventspersecond": numEvents/eventTime,
+                  "nsperevent": eventTime*1e9/max(numEvents, 1),
+                  "peakrsskib": peakRSS }
+            results.append(r)
+
+            print("BENCH: {:<20} {:<12} events = {:<9} {:.0f} events/s {:.0f} ns/event startup = {:.3f}s peak RSS = {} KiB".format(
+                  w["name"], a, numEvents, r["eventspersecond"], r["nsperevent"], startup, peakRSS))
+            sys.stdout.flush()
+
+    info = { "executable": executable,
+             "host": platform.node(),
+             "date": time.strftime("%Y-%m-%d %H:%M:%S"),
+             "ompnumthreads": os.environ.get("OMP_NUM_THREADS", ""),
+             "seed": seed,
+             "repeats": repeats,
+             "results": results }
+
+    with open(outputFile, "wt") as f:
+        json.dump(info, f, indent = 4, sort_keys = True)
+        f.write("\n")
+
+    print("Results written to {}".format(outputFile))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,107 @@
+#!/usr/bin/env python
+
+from __future__ import print_function
+import pysimpactcyan
+import sys
+import os
+import random
+import time
+
+# These are used if no 'scalingsettings.py' file is present
+defaultScalingTests = [
+    { "population.nummen": 1000, "population.numwomen": 1000, "population.simtime": 20 },
+    { "population.nummen": 5000, "population.numwomen": 5000, "population.simtime": 10 },
+    { "population.nummen": 20000, "population.numwomen": 20000, "population.simtime": 5 },
+]
+defaultThreadCounts = [ 1, 2, 4, 8 ]
+defaultRepeats = 3
+
+try:
+    import scalingsettings
+    scalingTests = scalingsettings.scalingTests
+    threadCounts = scalingsettings.threadCounts
+    repeats = scalingsettings.repeats
+except ImportError:
+    print("""
+No 'scalingsettings.py' file found, using default settings. To use other
+settings, create such a file containing e.g.
+
+    # Config settings for which the thread scaling is measured
+    scalingTests = [ { "population.nummen": 5000, "population.numwomen": 5000 } ]
+
+    # Values of OMP_NUM_THREADS to use
+    threadCounts = [ 1, 2, 4, 8 ]
+
+    # Each run is repeated this amount of times, and the average and standard
+    # deviation will be calculated
+    repeats = 3
+""")
+    scalingTests = defaultScalingTests
+    threadCounts = defaultThreadCounts
+    repeats = defaultRepeats
+
+# Besides the default thresholds to decide if a step of the parallel version is
+# actually done in parallel, the run is also done with the thresholds set to
+# zero, so that every step is done in parallel
+modes = [ ("adaptive", { }),
+          ("always", { "MNRM_PARALLEL_MINEVENTS": "0", "MNRM_PARALLEL_MINPEOPLE": "0" }) ]
+
+def calcAvgAndDev(tlist):
+    if len(tlist) == 0:
+        return (0.0,0.0)
+
+    avg = sum(tlist)/len(tlist)
+    dev = (sum([ (t-avg)**2 for t in tlist ])/len(tlist))**0.5
+    return (avg, dev)
+
+def timeRun(simpact, config, outputDir, parallel, seed, env):
+
+    origEnv = dict(os.environ)
+    os.environ.update(env)
+    try:
+        t0 = time.time()
+        simpact.run(config, outputDir, parallel = parallel, opt = True, release = True, seed = seed, quiet = True)
+        return time.time() - t0
+    finally:
+        os.environ.clear()
+        os.environ.update(origEnv)
+
+def main():
+
+    try:
+        simpactDir = sys.argv[1]
+        outputDir = sys.argv[2]
+
+        if len(sys.argv) > 3:
+            raise Exception("Too many arguments")
+    except Exception as e:
+        print("Error: {}".format(e))
+        print("Usage: {} simpactdir outputdir".format(sys.argv[0]))
+        sys.exit(-1)
+
+    simpact = pysimpactcyan.PySimpactCyan()
+    simpact.setSimpactDirectory(simpactDir)
+
+    for t in scalingTests:
+        seed = int(random.random() * 1000000)
+        print("SCALING: config = {} seed = {}".format(t, seed))
+
+        times = [ timeRun(simpact, t, outputDir, False, seed, { }) for r in range(repeats) ]
+        serialAvg, serialDev = calcAvgAndDev(times)
+        print("SCALING: serial {:.3f} +/- {:.3f}".format(serialAvg, serialDev))
+        sys.stdout.flush()
+
+        for name, env in modes:
+            for n in threadCounts:
+                runEnv = dict(env)
+                runEnv["OMP_NUM_THREADS"] = str(n)
+
+                times = [ timeRun(simpact, t, outputDir, True, seed, runEnv) for r in range(repeats) ]
+                avg, dev = calcAvgAndDev(times)
+                print("SCALING: {} threads = {} {:.3f} +/- {:.3f} speedup = {:.2f}".format(name, n, avg, dev, serialAvg/avg))
+                sys.stdout.flush()
+
+        print("SCALING: ------------------------------------------------------")
+
+if __name__ == "__main__":
+    main()